@@ -70,9 +70,13 @@ static const float3 g_material_base_color = float3(0, 0, 1);
 static const float3 g_material_fresnel0 = float3(0.7f, 0.7f, 0.7f);
 
 
-TextureCube g_tex_irradiance_map	: register(t0);
-TextureCube g_tex_reflection_map	: register(t1);
-Texture2D g_tex_brdf_map			: register(t2);
+cbuffer cb_pixel_shader : register(b0) {
+	// irradiance of the envmap, see cg::data::sh9.
+	float4 g_irradiance_sh[9]		: packoffset(c0);
+};
+
+TextureCube g_tex_reflection_map	: register(t0);
+Texture2D g_tex_brdf_map			: register(t1);
 SamplerState g_sampler_state		: register(s0);
 
 struct ps_output {
@@ -89,6 +93,17 @@ float distribution(float3 h_ts, float at, float ab)
 	return 1.0f / (pi * at * ab * denom * denom);
 }
 
+// Evaluates the irradiance sh in the direction n. The result is divided by pi like the former irradiance map.
+float3 irradiance_sh9(float3 n)
+{
+	float3 e = 0.282095f * g_irradiance_sh[0].rgb;
+	e += 0.488603f * (n.y * g_irradiance_sh[1].rgb + n.z * g_irradiance_sh[2].rgb + n.x * g_irradiance_sh[3].rgb);
+	e += 1.092548f * (n.x * n.y * g_irradiance_sh[4].rgb + n.y * n.z * g_irradiance_sh[5].rgb + n.x * n.z * g_irradiance_sh[7].rgb);
+	e += 0.315392f * (3.0f * n.z * n.z - 1.0f) * g_irradiance_sh[6].rgb;
+	e += 0.546274f * (n.x * n.x - n.y * n.y) * g_irradiance_sh[8].rgb;
+	return max(e, 0.0f) / pi;
+}
+
 float3 ibl_result(float3 pixel_n_ms, float3 pixel_v_ms, float3 f0, float cos_theta_v)
 {
 	const float a = g_material_roughness * g_material_roughness;
@@ -96,7 +111,7 @@ float3 ibl_result(float3 pixel_n_ms, float3 pixel_v_ms, float3 f0, float cos_the
 	const float3 v_ms = normalize(pixel_v_ms);
 	const float3 r_ms = reflect(-v_ms, n_ms);
 
-	const float3 irradiance = g_tex_irradiance_map.Sample(g_sampler_state, n_ms).rgb;
+	const float3 irradiance = irradiance_sh9(n_ms);
 	const float3 reflection = g_tex_reflection_map.SampleLevel(g_sampler_state, r_ms, 4 * a).rgb;
 	const float2 brdf = g_tex_brdf_map.Sample(g_sampler_state, float2(cos_theta_v, a));
 
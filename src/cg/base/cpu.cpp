@@ -0,0 +1,41 @@
+#include "cg/base/cpu.h"
+
+#include <intrin.h>
+
+
+namespace {
+
+cg::cpu_features query_cpu_features() noexcept
+{
+	cg::cpu_features features;
+
+	int info[4] = {};
+	__cpuid(info, 0);
+	if (info[0] < 1) return features;
+
+	__cpuid(info, 1);
+	const int ecx = info[2];
+	features.ssse3 = (ecx & (1 << 9)) != 0;
+	features.sse4_1 = (ecx & (1 << 19)) != 0;
+
+	// the OS saves YMM registers on context switches (XCR0 bits 1 & 2).
+	const bool osxsave = (ecx & (1 << 27)) != 0;
+	const bool ymm_enabled = osxsave && ((_xgetbv(0) & 0x6) == 0x6);
+	features.avx = ymm_enabled && ((ecx & (1 << 28)) != 0);
+	features.f16c = features.avx && ((ecx & (1 << 29)) != 0);
+
+	return features;
+}
+
+} // namespace
+
+
+namespace cg {
+
+const cpu_features& get_cpu_features() noexcept
+{
+	static const cpu_features features = query_cpu_features();
+	return features;
+}
+
+} // namespace cg
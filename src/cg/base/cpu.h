@@ -0,0 +1,23 @@
+#ifndef CG_BASE_CPU_H_
+#define CG_BASE_CPU_H_
+
+
+namespace cg {
+
+// Instruction set extensions which are used by the SIMD code paths.
+// SSE2 is not listed, it is always available on x64.
+struct cpu_features final {
+	bool ssse3 = false;
+	bool sse4_1 = false;
+	// AVX instructions are supported by the CPU and YMM state is enabled by the OS.
+	bool avx = false;
+	// Half <-> float conversions. Requires avx.
+	bool f16c = false;
+};
+
+// Returns the features of the current CPU. The features are queried once.
+const cpu_features& get_cpu_features() noexcept;
+
+} // namespace cg
+
+#endif // CG_BASE_CPU_H_
@@ -0,0 +1,157 @@
+#include "cg/base/half.h"
+
+#include <cassert>
+#include <cstring>
+#include <emmintrin.h>
+#include <immintrin.h>
+#include "cg/base/cpu.h"
+
+
+namespace {
+
+// Converts 4 floats, the halves are in the low 16 bits of the 32-bit lanes (sign extended).
+// Based on Fabian Giesen's float_to_half_rtne_SSE2.
+inline __m128i float_to_half_sse2(__m128 f) noexcept
+{
+	const __m128i mask_sign = _mm_set1_epi32(int(0x80000000u));
+	const __m128i f16_max = _mm_set1_epi32((127 + 16) << 23);		// floats >= this become infinities.
+	const __m128i nan_bit = _mm_set1_epi32(0x200);
+	const __m128i inf_as_f16 = _mm_set1_epi32(0x7c00);
+	const __m128i min_normal = _mm_set1_epi32((127 - 14) << 23);	// the smallest float which becomes a normal half.
+	const __m128i subnorm_magic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+	const __m128i normal_bias = _mm_set1_epi32(0xfff - ((127 - 15) << 23));
+
+	const __m128 just_sign = _mm_and_ps(_mm_castsi128_ps(mask_sign), f);
+	const __m128 abs_f = _mm_xor_ps(f, just_sign);
+	const __m128i abs_i = _mm_castps_si128(abs_f);
+	const __m128 is_nan = _mm_cmpunord_ps(abs_f, abs_f);
+	const __m128i is_regular = _mm_cmpgt_epi32(f16_max, abs_i);
+	const __m128i inf_or_nan = _mm_or_si128(_mm_and_si128(_mm_castps_si128(is_nan), nan_bit), inf_as_f16);
+	const __m128i is_subnormal = _mm_cmpgt_epi32(min_normal, abs_i);
+
+	// subnormal results: the magic value rounds the mantissa.
+	const __m128 subnorm_f = _mm_add_ps(abs_f, _mm_castsi128_ps(subnorm_magic));
+	const __m128i subnorm = _mm_sub_epi32(_mm_castps_si128(subnorm_f), subnorm_magic);
+
+	// normal results: rebias the exponent, round to nearest even.
+	const __m128i mant_odd = _mm_srai_epi32(_mm_slli_epi32(abs_i, 31 - 13), 31);
+	const __m128i rounded = _mm_sub_epi32(_mm_add_epi32(abs_i, normal_bias), mant_odd);
+	const __m128i normal = _mm_srli_epi32(rounded, 13);
+
+	const __m128i non_special = _mm_or_si128(_mm_and_si128(subnorm, is_subnormal), _mm_andnot_si128(is_subnormal, normal));
+	const __m128i joined = _mm_or_si128(_mm_and_si128(non_special, is_regular), _mm_andnot_si128(is_regular, inf_or_nan));
+	return _mm_or_si128(joined, _mm_srai_epi32(_mm_castps_si128(just_sign), 16));
+}
+
+// Converts 4 halves which are in the low 16 bits of the 32-bit lanes.
+// Based on Fabian Giesen's half_to_float_SSE2.
+inline __m128 half_to_float_sse2(__m128i h) noexcept
+{
+	const __m128i mask_no_sign = _mm_set1_epi32(0x7fff);
+	const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));
+	const __m128i was_inf_nan = _mm_set1_epi32(0x7bff);
+	const __m128i exp_inf_nan = _mm_set1_epi32(255 << 23);
+
+	const __m128i exp_mant = _mm_and_si128(mask_no_sign, h);
+	const __m128i just_sign = _mm_xor_si128(h, exp_mant);
+	const __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(exp_mant, 13)), magic);
+	const __m128i inf_nan = _mm_and_si128(_mm_cmpgt_epi32(exp_mant, was_inf_nan), exp_inf_nan);
+	const __m128i sign = _mm_slli_epi32(just_sign, 16);
+	return _mm_or_ps(scaled, _mm_castsi128_ps(_mm_or_si128(sign, inf_nan)));
+}
+
+void float_to_half_sse2(const float* src, uint16_t* dst, size_t count) noexcept
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m128i lo = float_to_half_sse2(_mm_loadu_ps(src + i));
+		const __m128i hi = float_to_half_sse2(_mm_loadu_ps(src + i + 4));
+		// the lanes are sign extended 16-bit values, signed saturation keeps them as they are.
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(lo, hi));
+	}
+
+	for (; i < count; ++i)
+		dst[i] = uint16_t(_mm_cvtsi128_si32(float_to_half_sse2(_mm_set_ss(src[i]))));
+}
+
+void half_to_float_sse2(const uint16_t* src, float* dst, size_t count) noexcept
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		_mm_storeu_ps(dst + i, half_to_float_sse2(_mm_unpacklo_epi16(h, zero)));
+		_mm_storeu_ps(dst + i + 4, half_to_float_sse2(_mm_unpackhi_epi16(h, zero)));
+	}
+
+	for (; i < count; ++i)
+		_mm_store_ss(dst + i, half_to_float_sse2(_mm_cvtsi32_si128(src[i])));
+}
+
+void float_to_half_f16c(const float* src, uint16_t* dst, size_t count) noexcept
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m128i lo = _mm_cvtps_ph(_mm_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+		const __m128i hi = _mm_cvtps_ph(_mm_loadu_ps(src + i + 4), _MM_FROUND_TO_NEAREST_INT);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi64(lo, hi));
+	}
+
+	if (i < count) {
+		// the tail goes through a zero padded buffer.
+		alignas(16) float f[8] = {};
+		alignas(16) uint16_t h[8];
+		std::memcpy(f, src + i, (count - i) * sizeof(float));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(h), _mm_cvtps_ph(_mm_load_ps(f), _MM_FROUND_TO_NEAREST_INT));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(h + 4), _mm_cvtps_ph(_mm_load_ps(f + 4), _MM_FROUND_TO_NEAREST_INT));
+		std::memcpy(dst + i, h, (count - i) * sizeof(uint16_t));
+	}
+}
+
+void half_to_float_f16c(const uint16_t* src, float* dst, size_t count) noexcept
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		_mm_storeu_ps(dst + i, _mm_cvtph_ps(h));
+		_mm_storeu_ps(dst + i + 4, _mm_cvtph_ps(_mm_unpackhi_epi64(h, h)));
+	}
+
+	if (i < count) {
+		alignas(16) uint16_t h[8] = {};
+		alignas(16) float f[8];
+		std::memcpy(h, src + i, (count - i) * sizeof(uint16_t));
+		const __m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(h));
+		_mm_store_ps(f, _mm_cvtph_ps(v));
+		_mm_store_ps(f + 4, _mm_cvtph_ps(_mm_unpackhi_epi64(v, v)));
+		std::memcpy(dst + i, f, (count - i) * sizeof(float));
+	}
+}
+
+} // namespace
+
+
+namespace cg {
+
+void float_to_half(const float* src, uint16_t* dst, size_t count) noexcept
+{
+	assert(count == 0 || (src && dst));
+
+	if (get_cpu_features().f16c)
+		float_to_half_f16c(src, dst, count);
+	else
+		float_to_half_sse2(src, dst, count);
+}
+
+void half_to_float(const uint16_t* src, float* dst, size_t count) noexcept
+{
+	assert(count == 0 || (src && dst));
+
+	if (get_cpu_features().f16c)
+		half_to_float_f16c(src, dst, count);
+	else
+		half_to_float_sse2(src, dst, count);
+}
+
+} // namespace cg
@@ -0,0 +1,36 @@
+#ifndef CG_BASE_HALF_H_
+#define CG_BASE_HALF_H_
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace cg {
+
+// Half precision floats (IEEE 754 binary16) are stored as uint16_t.
+// float -> half conversion rounds to nearest even, overflows become infinities, NaNs stay NaNs.
+// F16C instructions are used if the CPU supports them, SSE2 otherwise.
+
+// Converts count floats into half floats.
+void float_to_half(const float* src, uint16_t* dst, size_t count) noexcept;
+
+// Converts count half floats into floats.
+void half_to_float(const uint16_t* src, float* dst, size_t count) noexcept;
+
+inline uint16_t float_to_half(float v) noexcept
+{
+	uint16_t h;
+	float_to_half(&v, &h, 1);
+	return h;
+}
+
+inline float half_to_float(uint16_t h) noexcept
+{
+	float v;
+	half_to_float(&h, &v, 1);
+	return v;
+}
+
+} // namespace cg
+
+#endif // CG_BASE_HALF_H_
@@ -0,0 +1,80 @@
+#include "cg/base/thread_pool.h"
+
+#include <algorithm>
+
+
+namespace cg {
+
+// ----- thread_pool -----
+
+thread_pool::thread_pool(size_t thread_count)
+{
+	if (thread_count == 0)
+		thread_count = hardware_thread_count();
+
+	threads_.reserve(thread_count);
+	for (size_t i = 0; i < thread_count; ++i)
+		threads_.emplace_back(&thread_pool::worker_main, this);
+}
+
+thread_pool::~thread_pool() noexcept
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+
+	cond_var_.notify_all();
+	for (auto& t : threads_)
+		t.join();
+}
+
+void thread_pool::run(task_priority priority, std::function<void()> func)
+{
+	assert(func);
+	assert(size_t(priority) < priority_count);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		assert(!stop_);
+		queues_[size_t(priority)].push_back(std::move(func));
+	}
+
+	cond_var_.notify_one();
+}
+
+void thread_pool::worker_main()
+{
+	while (true) {
+		std::function<void()> func;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			cond_var_.wait(lock, [this] {
+				return stop_ || std::any_of(std::cbegin(queues_), std::cend(queues_),
+					[](const auto& q) { return !q.empty(); });
+			});
+
+			// the highest priority non-empty queue.
+			auto it = std::find_if(std::rbegin(queues_), std::rend(queues_),
+				[](const auto& q) { return !q.empty(); });
+			
+			// stop_ is set and all the tasks are completed.
+			if (it == std::rend(queues_)) return;
+
+			func = std::move(it->front());
+			it->pop_front();
+		}
+
+		func();
+	}
+}
+
+// ----- funcs -----
+
+size_t hardware_thread_count() noexcept
+{
+	return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+} // namespace cg
@@ -0,0 +1,155 @@
+#ifndef CG_BASE_THREAD_POOL_H_
+#define CG_BASE_THREAD_POOL_H_
+
+#include <cassert>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace cg {
+
+// Tasks of higher priority are always dequeued before tasks of lower priority.
+// Tasks of the same priority are processed in FIFO order.
+enum class task_priority : unsigned char {
+	low = 0,
+	normal = 1,
+	high = 2
+};
+
+// thread_pool owns a fixed number of worker threads which process enqueued tasks.
+// The destructor waits until all the enqueued tasks are completed.
+class thread_pool final {
+public:
+
+	// Creates a pool of thread_count worker threads.
+	// If thread_count equals to zero the number of hardware threads is used.
+	explicit thread_pool(size_t thread_count = 0);
+
+	thread_pool(const thread_pool&) = delete;
+
+	thread_pool(thread_pool&&) = delete;
+
+	~thread_pool() noexcept;
+
+
+	thread_pool& operator=(const thread_pool&) = delete;
+
+	thread_pool& operator=(thread_pool&&) = delete;
+
+
+	// Enqueues func for execution by one of the worker threads.
+	// Returns a future which receives func's result or the exception thrown by func.
+	template<typename Func>
+	auto enqueue(task_priority priority, Func&& func) -> std::future<std::invoke_result_t<std::decay_t<Func>>>;
+
+	// Enqueues func for execution by one of the worker threads.
+	// func must not throw.
+	void run(task_priority priority, std::function<void()> func);
+
+	// The number of worker threads.
+	size_t thread_count() const noexcept
+	{
+		return threads_.size();
+	}
+
+private:
+
+	static constexpr size_t priority_count = 3;
+
+	void worker_main();
+
+
+	std::vector<std::thread> threads_;
+	std::mutex mutex_;
+	std::condition_variable cond_var_;
+	std::deque<std::function<void()>> queues_[priority_count];
+	bool stop_ = false;
+};
+
+template<typename Func>
+auto thread_pool::enqueue(task_priority priority, Func&& func) -> std::future<std::invoke_result_t<std::decay_t<Func>>>
+{
+	using Result = std::invoke_result_t<std::decay_t<Func>>;
+
+	// std::function requires copyable targets, std::packaged_task is move only.
+	auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Func>(func));
+	std::future<Result> future = task->get_future();
+	run(priority, [task] { (*task)(); });
+	return future;
+}
+
+// Returns the number of hardware threads. The value is at least 1.
+size_t hardware_thread_count() noexcept;
+
+// Splits [0, count) into ranges of grain_size elements and calls func(first, last) for each range.
+// The ranges are processed by the workers of the pool and by the calling thread,
+// so parallel_for may be called from a task which is run by the pool.
+// Blocks until all the ranges are processed. The first exception thrown by func is rethrown.
+template<typename Func>
+void parallel_for(thread_pool& pool, size_t count, size_t grain_size, const Func& func)
+{
+	if (count == 0) return;
+	if (grain_size == 0) grain_size = 1;
+
+	const size_t range_count = (count + grain_size - 1) / grain_size;
+	if (range_count == 1 || pool.thread_count() == 0) {
+		func(size_t(0), count);
+		return;
+	}
+
+	struct shared_state final {
+		std::atomic<size_t> next_range{ 0 };
+		std::atomic<size_t> processed_range_count{ 0 };
+		std::mutex mutex;
+		std::condition_variable cond_var;
+		std::exception_ptr exception;
+	};
+
+	auto state = std::make_shared<shared_state>();
+
+	// A task might start after parallel_for has returned, func is called only if a range has been claimed.
+	auto process_ranges = [state, range_count, count, grain_size, &func] {
+		size_t processed_count = 0;
+		for (size_t r = state->next_range++; r < range_count; r = state->next_range++, ++processed_count) {
+			const size_t first = r * grain_size;
+			try {
+				func(first, std::min(first + grain_size, count));
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(state->mutex);
+				if (!state->exception) state->exception = std::current_exception();
+			}
+		}
+
+		if (processed_count == 0) return;
+		if (state->processed_range_count.fetch_add(processed_count) + processed_count == range_count) {
+			std::lock_guard<std::mutex> lock(state->mutex);
+			state->cond_var.notify_all();
+		}
+	};
+
+	const size_t task_count = std::min(pool.thread_count(), range_count - 1);
+	for (size_t i = 0; i < task_count; ++i)
+		pool.run(task_priority::normal, process_ranges);
+
+	process_ranges();
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->cond_var.wait(lock, [&state, range_count] { return state->processed_range_count == range_count; });
+	if (state->exception) std::rethrow_exception(state->exception);
+}
+
+} // namespace cg
+
+#endif // CG_BASE_THREAD_POOL_H_
@@ -0,0 +1,118 @@
+#include "cg/data/asset_loader.h"
+
+#include <iterator>
+#include "cg/data/file.h"
+
+
+namespace cg {
+namespace data {
+
+// ----- asset_loader -----
+
+asset_loader::asset_loader(size_t thread_count)
+	: thread_pool_(thread_count)
+{}
+
+size_t asset_loader::dispatch_callbacks()
+{
+	std::vector<std::function<void()>> callbacks;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		callbacks.swap(completed_callbacks_);
+	}
+
+	size_t i = 0;
+	try {
+		for (; i < callbacks.size(); ++i) {
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				--pending_callback_count_;
+			}
+
+			callbacks[i]();
+		}
+	}
+	catch (...) {
+		// callbacks that have not been invoked go back to the queue.
+		std::lock_guard<std::mutex> lock(mutex_);
+		completed_callbacks_.insert(completed_callbacks_.begin(),
+			std::make_move_iterator(callbacks.begin() + i + 1),
+			std::make_move_iterator(callbacks.end()));
+		throw;
+	}
+
+	return callbacks.size();
+}
+
+void asset_loader::dispatch_callbacks_wait_all()
+{
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			cond_var_.wait(lock, [this] {
+				return !completed_callbacks_.empty() || (pending_callback_count_ == 0);
+			});
+
+			if (pending_callback_count_ == 0) return;
+		}
+
+		dispatch_callbacks();
+	}
+}
+
+std::future<image_2d> asset_loader::load_image(std::string filename, uint8_t channel_count,
+	bool flip_vertically, task_priority priority)
+{
+	return thread_pool_.enqueue(priority, [filename = std::move(filename), channel_count, flip_vertically] {
+		return image_2d(filename, channel_count, flip_vertically);
+	});
+}
+
+void asset_loader::load_image(std::string filename, uint8_t channel_count, bool flip_vertically,
+	task_priority priority, callback<image_2d> cb)
+{
+	enqueue_with_callback(priority, [filename = std::move(filename), channel_count, flip_vertically] {
+		return image_2d(filename, channel_count, flip_vertically);
+	}, std::move(cb));
+}
+
+std::future<std::shared_ptr<const image_2d>> asset_loader::load_image(image_cache& cache, std::string filename,
+	uint8_t channel_count, bool flip_vertically, task_priority priority)
+{
+	return thread_pool_.enqueue(priority, [&cache, filename = std::move(filename), channel_count, flip_vertically] {
+		return cache.get(filename, channel_count, flip_vertically);
+	});
+}
+
+std::future<Glsl_program_desc> asset_loader::load_glsl_program_desc(std::string name, std::string filename,
+	task_priority priority)
+{
+	return thread_pool_.enqueue(priority, [name = std::move(name), filename = std::move(filename)] {
+		return cg::data::load_glsl_program_desc(name, filename);
+	});
+}
+
+void asset_loader::load_glsl_program_desc(std::string name, std::string filename,
+	task_priority priority, callback<Glsl_program_desc> cb)
+{
+	enqueue_with_callback(priority, [name = std::move(name), filename = std::move(filename)] {
+		return cg::data::load_glsl_program_desc(name, filename);
+	}, std::move(cb));
+}
+
+std::future<std::string> asset_loader::load_text(std::string filename, task_priority priority)
+{
+	return thread_pool_.enqueue(priority, [filename = std::move(filename)] {
+		return cg::data::load_text(filename);
+	});
+}
+
+void asset_loader::load_text(std::string filename, task_priority priority, callback<std::string> cb)
+{
+	enqueue_with_callback(priority, [filename = std::move(filename)] {
+		return cg::data::load_text(filename);
+	}, std::move(cb));
+}
+
+} // namespace data
+} // namespace cg
@@ -0,0 +1,158 @@
+#ifndef CG_DATA_ASSET_LOADER_H_
+#define CG_DATA_ASSET_LOADER_H_
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "cg/base/thread_pool.h"
+#include "cg/data/image.h"
+#include "cg/data/image_cache.h"
+#include "cg/data/model.h"
+#include "cg/data/shader.h"
+
+
+namespace cg {
+namespace data {
+
+// asset_loader loads images, models and shader sources on a pool of worker threads.
+// Each load_* method returns immediately. The result is delivered either through the returned
+// std::future or through a callback. Callbacks are not invoked on worker threads,
+// they are queued and invoked by dispatch_callbacks() on the thread that calls it,
+// so it is safe to create GPU resources from a callback.
+// The destructor waits until all the enqueued loads are completed, pending callbacks are dropped.
+class asset_loader final {
+public:
+
+	template<typename T>
+	using callback = std::function<void(T&&)>;
+
+
+	// Creates a loader with thread_count worker threads.
+	// If thread_count equals to zero the number of hardware threads is used.
+	explicit asset_loader(size_t thread_count = 0);
+
+	asset_loader(const asset_loader&) = delete;
+
+	asset_loader(asset_loader&&) = delete;
+
+
+	asset_loader& operator=(const asset_loader&) = delete;
+
+	asset_loader& operator=(asset_loader&&) = delete;
+
+
+	// Invokes callbacks of all the loads that have completed so far.
+	// Rethrows an exception if any of the completed loads has failed,
+	// the rest of the callbacks stay queued in this case.
+	// Returns the number of invoked callbacks.
+	size_t dispatch_callbacks();
+
+	// Blocks until all the enqueued loads are completed and invokes their callbacks.
+	// Rethrows the first exception of a failed load.
+	void dispatch_callbacks_wait_all();
+
+	std::future<image_2d> load_image(std::string filename, uint8_t channel_count = 0,
+		bool flip_vertically = false, task_priority priority = task_priority::normal);
+
+	void load_image(std::string filename, uint8_t channel_count, bool flip_vertically,
+		task_priority priority, callback<image_2d> cb);
+
+	// Takes the image from the cache on a worker thread, the cache decodes it if it is not resident.
+	// The cache must outlive the load.
+	std::future<std::shared_ptr<const image_2d>> load_image(image_cache& cache, std::string filename,
+		uint8_t channel_count = 0, bool flip_vertically = false, task_priority priority = task_priority::normal);
+
+	template<vertex_attribs attribs>
+	std::future<Model_geometry_data<attribs>> load_model(std::string filename,
+		task_priority priority = task_priority::normal);
+
+	template<vertex_attribs attribs>
+	void load_model(std::string filename, task_priority priority, callback<Model_geometry_data<attribs>> cb);
+
+	std::future<Glsl_program_desc> load_glsl_program_desc(std::string name, std::string filename,
+		task_priority priority = task_priority::normal);
+
+	void load_glsl_program_desc(std::string name, std::string filename,
+		task_priority priority, callback<Glsl_program_desc> cb);
+
+	std::future<std::string> load_text(std::string filename, task_priority priority = task_priority::normal);
+
+	void load_text(std::string filename, task_priority priority, callback<std::string> cb);
+
+	// The number of loads which have been enqueued but whose callbacks have not been dispatched yet.
+	size_t pending_callback_count() const noexcept
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return pending_callback_count_;
+	}
+
+private:
+
+	// Runs load on a worker thread and queues invocation of cb with the result.
+	template<typename Load, typename T>
+	void enqueue_with_callback(task_priority priority, Load&& load, callback<T> cb);
+
+
+	mutable std::mutex mutex_;
+	std::condition_variable cond_var_;
+	std::vector<std::function<void()>> completed_callbacks_;
+	size_t pending_callback_count_ = 0;
+	// Has to be the last member, its destructor waits for workers which use the members above.
+	thread_pool thread_pool_;
+};
+
+template<vertex_attribs attribs>
+std::future<Model_geometry_data<attribs>> asset_loader::load_model(std::string filename, task_priority priority)
+{
+	return thread_pool_.enqueue(priority, [filename = std::move(filename)] {
+		return cg::data::load_model<attribs>(filename);
+	});
+}
+
+template<vertex_attribs attribs>
+void asset_loader::load_model(std::string filename, task_priority priority, 
+	callback<Model_geometry_data<attribs>> cb)
+{
+	enqueue_with_callback(priority, [filename = std::move(filename)] {
+		return cg::data::load_model<attribs>(filename);
+	}, std::move(cb));
+}
+
+template<typename Load, typename T>
+void asset_loader::enqueue_with_callback(task_priority priority, Load&& load, callback<T> cb)
+{
+	assert(cb);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		++pending_callback_count_;
+	}
+
+	thread_pool_.run(priority, [this, load = std::forward<Load>(load), cb = std::move(cb)]() mutable {
+		std::function<void()> completion;
+		try {
+			// std::function requires copyable targets, the result is shared.
+			auto result = std::make_shared<T>(load());
+			completion = [cb = std::move(cb), result] { cb(std::move(*result)); };
+		}
+		catch (...) {
+			completion = [exc = std::current_exception()] { std::rethrow_exception(exc); };
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			completed_callbacks_.push_back(std::move(completion));
+		}
+		cond_var_.notify_all();
+	});
+}
+
+} // namespace data
+} // namespace cg
+
+#endif // CG_DATA_ASSET_LOADER_H_
@@ -1,9 +1,59 @@
 #include "cg/data/file.h"
 
 #include <cstring>
+#include <algorithm>
 #include <type_traits>
+#include <emmintrin.h>
+#include <intrin.h>
 #include <windows.h>
 #include "cg/base/base.h"
+#include "cg/data/pack.h"
+
+
+namespace {
+
+// By_line_iterator reads files by chunks of this size.
+constexpr size_t read_chunk_byte_count = cg::kilobytes(64);
+
+// Appends [first, last) to str skipping all the '\r' characters.
+void append_skip_cr(std::string& str, const char* first, const char* last)
+{
+	while (first != last) {
+		const char* cr = static_cast<const char*>(std::memchr(first, '\r', last - first));
+		if (!cr) {
+			str.append(first, last);
+			return;
+		}
+
+		str.append(first, cr);
+		first = cr + 1;
+	}
+}
+
+// Returns a pointer to the first '\n' in [first, last) or last if there is no line feed.
+// Compares 16 characters at a time.
+const char* find_line_feed(const char* first, const char* last) noexcept
+{
+	const __m128i lf = _mm_set1_epi8('\n');
+
+	for (; (last - first) >= 16; first += 16) {
+		const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+		const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chars, lf));
+		if (mask == 0) continue;
+
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return first + index;
+	}
+
+	for (; first != last; ++first) {
+		if (*first == '\n') return first;
+	}
+
+	return last;
+}
+
+} // namespace
 
 
 namespace cg {
@@ -11,6 +61,8 @@ namespace data {
 
 // ----- File -----
 
+File::File() noexcept = default;
+
 File::File(const std::string& filename) :
 	File(filename.c_str())
 {}
@@ -22,7 +74,10 @@ File::File(const char* filename)
 
 File::File(File&& f) noexcept :
 _filename(std::move(f._filename)),
-_handle(f._handle)
+_handle(f._handle),
+_pack_file(std::move(f._pack_file)),
+_pack_position(f._pack_position),
+_pack_eof(f._pack_eof)
 {
 	f._handle = nullptr;
 }
@@ -39,6 +94,9 @@ File& File::operator=(File&& f) noexcept
 	close();
 	_filename = std::move(f._filename);
 	_handle = f._handle;
+	_pack_file = std::move(f._pack_file);
+	_pack_position = f._pack_position;
+	_pack_eof = f._pack_eof;
 	f._handle = nullptr;
 
 	return *this;
@@ -46,11 +104,14 @@ File& File::operator=(File&& f) noexcept
 
 void File::close() noexcept
 {
-	if (!_handle) return;
+	if (!is_open()) return;
 
 	_filename.clear();
-	fclose(_handle);
+	if (_handle) fclose(_handle);
 	_handle = nullptr;
+	_pack_file.reset();
+	_pack_position = 0;
+	_pack_eof = false;
 }
 
 void File::open(const std::string& filename)
@@ -66,6 +127,12 @@ void File::open(const char* filename)
 
 	assert(filename);
 
+	_pack_file = open_from_packs(filename);
+	if (_pack_file) {
+		_filename = filename;
+		return;
+	}
+
 	_handle = std::fopen(filename, "rb");
 	ENFORCE(_handle, "Failed to open file: ", filename);
 	_filename = filename;
@@ -75,7 +142,9 @@ void File::open(const char* filename)
 bool File::read_byte(void* buff) const
 {
 	assert(buff);
-	assert(_handle);
+	assert(is_open());
+
+	if (_pack_file) return (read_bytes(buff, 1) == 1);
 
 	int res = std::fgetc(_handle);
 	if (res == EOF) return false;
@@ -88,20 +157,165 @@ size_t File::read_bytes(void* buff, size_t byte_count) const
 {
 	assert(buff);
 	assert(byte_count);
-	assert(_handle);
+	assert(is_open());
+
+	if (_pack_file) {
+		const auto bytes = _pack_file->bytes();
+		const size_t available = (_pack_position < bytes.size()) ? (bytes.size() - _pack_position) : 0;
+		const size_t count = std::min(byte_count, available);
+
+		// same as fread: eof is set when a read attempt goes past the end.
+		if (count < byte_count) _pack_eof = true;
+		if (count > 0) std::memcpy(buff, bytes.data() + _pack_position, count);
+		_pack_position += count;
+		return count;
+	}
 
 	return fread(buff, sizeof(unsigned char), byte_count, _handle);
 }
 
 void File::seek(long offset, File_seek_origin origin) const
 {
-	assert(_handle);
+	assert(is_open());
+
+	if (_pack_file) {
+		const long long base = (origin == File_seek_origin::current_position) ? _pack_position : 0;
+		ENFORCE(base + offset >= 0, "File seek error: ", _filename);
+
+		_pack_position = size_t(base + offset);
+		_pack_eof = false;
+		return;
+	}
+
 	int res = std::fseek(_handle, offset,
 		(origin == File_seek_origin::current_position) ? SEEK_CUR : SEEK_SET);
 
 	ENFORCE(res == 0, "File seek error: ", _filename);
 }
 
+// ----- Mapped_file -----
+
+Mapped_file::Mapped_file() noexcept = default;
+
+Mapped_file::Mapped_file(const std::string& filename, bool search_packs)
+	: Mapped_file(filename.c_str(), search_packs)
+{}
+
+Mapped_file::Mapped_file(const char* filename, bool search_packs)
+{
+	open(filename, search_packs);
+}
+
+Mapped_file::Mapped_file(Mapped_file&& f) noexcept
+	: _filename(std::move(f._filename)),
+	_file_handle(f._file_handle),
+	_mapping_handle(f._mapping_handle),
+	_pack_file(std::move(f._pack_file)),
+	_data(f._data),
+	_byte_count(f._byte_count)
+{
+	f._file_handle = nullptr;
+	f._mapping_handle = nullptr;
+	f._data = nullptr;
+	f._byte_count = 0;
+}
+
+Mapped_file::~Mapped_file() noexcept
+{
+	close();
+}
+
+Mapped_file& Mapped_file::operator=(Mapped_file&& f) noexcept
+{
+	if (this == &f) return *this;
+
+	close();
+	_filename = std::move(f._filename);
+	_file_handle = f._file_handle;
+	_mapping_handle = f._mapping_handle;
+	_pack_file = std::move(f._pack_file);
+	_data = f._data;
+	_byte_count = f._byte_count;
+
+	f._file_handle = nullptr;
+	f._mapping_handle = nullptr;
+	f._data = nullptr;
+	f._byte_count = 0;
+
+	return *this;
+}
+
+void Mapped_file::close() noexcept
+{
+	if (!is_open()) return;
+
+	if (_file_handle) {
+		if (_data) UnmapViewOfFile(_data);
+		if (_mapping_handle) CloseHandle(_mapping_handle);
+		CloseHandle(_file_handle);
+	}
+
+	_pack_file.reset();
+	_filename.clear();
+	_file_handle = nullptr;
+	_mapping_handle = nullptr;
+	_data = nullptr;
+	_byte_count = 0;
+}
+
+void Mapped_file::open(const std::string& filename, bool search_packs)
+{
+	open(filename.c_str(), search_packs);
+}
+
+void Mapped_file::open(const char* filename, bool search_packs)
+{
+	close();
+
+	assert(filename);
+
+	if (search_packs) _pack_file = open_from_packs(filename);
+	if (_pack_file) {
+		const auto bytes = _pack_file->bytes();
+		_filename = filename;
+		_data = (bytes.empty()) ? nullptr : bytes.data();
+		_byte_count = bytes.size();
+		return;
+	}
+
+	// FILE_FLAG_SEQUENTIAL_SCAN lets the cache manager read ahead aggressively.
+	HANDLE file_handle = CreateFile(filename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	ENFORCE(file_handle != INVALID_HANDLE_VALUE, "Failed to open file: ", filename);
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file_handle, &size)) {
+		CloseHandle(file_handle);
+		throw std::runtime_error(EXCEPTION_MSG("Failed to get size of file: ", filename));
+	}
+
+	// an empty file can not be mapped.
+	HANDLE mapping_handle = nullptr;
+	void* data = nullptr;
+	if (size.QuadPart > 0) {
+		mapping_handle = CreateFileMapping(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping_handle)
+			data = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+
+		if (!data) {
+			if (mapping_handle) CloseHandle(mapping_handle);
+			CloseHandle(file_handle);
+			throw std::runtime_error(EXCEPTION_MSG("Failed to map file: ", filename));
+		}
+	}
+
+	_filename = filename;
+	_file_handle = file_handle;
+	_mapping_handle = mapping_handle;
+	_data = static_cast<const unsigned char*>(data);
+	_byte_count = size_t(size.QuadPart);
+}
+
 // ----- By_line_iteator -----
 
 const By_line_iterator By_line_iterator::end{};
@@ -111,7 +325,7 @@ By_line_iterator::By_line_iterator(const std::string& filename, bool keep_line_f
 {}
 
 By_line_iterator::By_line_iterator(const char* filename, bool keep_line_feed)
-	: _file(filename), _keep_line_feed(keep_line_feed)
+	: _file(filename), _keep_line_feed(keep_line_feed), _read_buffer(read_chunk_byte_count)
 {
 	read_next_line();
 }
@@ -119,8 +333,15 @@ By_line_iterator::By_line_iterator(const char* filename, bool keep_line_feed)
 By_line_iterator::By_line_iterator(By_line_iterator&& it) noexcept
 	: _file(std::move(it._file)),
 	_keep_line_feed(it._keep_line_feed),
-	_line_buffer(std::move(it._line_buffer))
-{}
+	_file_exhausted(it._file_exhausted),
+	_line_buffer(std::move(it._line_buffer)),
+	_read_buffer(std::move(it._read_buffer)),
+	_read_position(it._read_position),
+	_read_end(it._read_end)
+{
+	it._read_position = 0;
+	it._read_end = 0;
+}
 
 By_line_iterator::~By_line_iterator() noexcept
 {
@@ -131,33 +352,83 @@ By_line_iterator& By_line_iterator::operator=(By_line_iterator&& it) noexcept
 {
 	_file = std::move(it._file);
 	_keep_line_feed = it._keep_line_feed;
+	_file_exhausted = it._file_exhausted;
 	_line_buffer = std::move(it._line_buffer);
+	_read_buffer = std::move(it._read_buffer);
+	_read_position = it._read_position;
+	_read_end = it._read_end;
+
+	it._read_position = 0;
+	it._read_end = 0;
 	return *this;
 }
 
+bool By_line_iterator::read_next_chunk()
+{
+	_read_position = 0;
+	_read_end = _file.read_bytes(_read_buffer.data(), _read_buffer.size());
+	return (_read_end > 0);
+}
+
 void By_line_iterator::read_next_line()
 {
 	_line_buffer.clear();
 
-	if (_file.eof()) {
+	if (_file_exhausted) {
 		_file.close();
 		return;
 	}
 
 	while (true) {
-		char ch;
+		const char* first = _read_buffer.data() + _read_position;
+		const char* last = _read_buffer.data() + _read_end;
+		const char* lf = find_line_feed(first, last);
+		append_skip_cr(_line_buffer, first, lf);
+
+		if (lf != last) {
+			_read_position += (lf - first) + 1;
+			break;
+		}
+
+		if (!read_next_chunk()) {
+			_file_exhausted = true;
+			break;
+		}
+	}
+
+	if (_keep_line_feed)
+		_line_buffer.push_back('\n');
+}
+
+// ----- By_line_view_iterator -----
 
-		bool res = _file.read_byte(&ch);
-		if (!res) break;
+const By_line_view_iterator By_line_view_iterator::end{};
 
-		if (ch == '\r') continue; // skip the abomination.
-		if (ch == '\n') break;
+By_line_view_iterator::By_line_view_iterator(std::string_view text) noexcept
+	: _next(text.data()),
+	_last(text.data() + text.size()),
+	_text_exhausted(false)
+{
+	read_next_line();
+}
 
-		_line_buffer.push_back(ch);
+void By_line_view_iterator::read_next_line() noexcept
+{
+	if (_text_exhausted) {
+		_line = std::string_view();
+		_has_line = false;
+		return;
 	}
 
-	if (_keep_line_feed)
-		_line_buffer.push_back('\n');
+	const char* lf = find_line_feed(_next, _last);
+	_line = std::string_view(_next, lf - _next);
+	if (!_line.empty() && _line.back() == '\r')
+		_line.remove_suffix(1);
+
+	if (lf == _last) _text_exhausted = true;
+	else _next = lf + 1;
+
+	_has_line = true;
 }
 
 // ----- funcs ------
@@ -165,6 +436,7 @@ void By_line_iterator::read_next_line()
 bool exists(const std::string& filename)
 {
 	if (filename.empty()) return false;
+	if (exists_in_packs(filename.c_str())) return true;
 
 	assert(filename.size() < MAX_PATH); // :'(
 	return (GetFileAttributes(filename.c_str()) != INVALID_FILE_ATTRIBUTES);
@@ -174,6 +446,7 @@ bool exists(const char* filename)
 {
 	size_t len = std::strlen(filename);
 	if (len == 0) return false;
+	if (exists_in_packs(filename)) return true;
 
 	assert(len < MAX_PATH); // :'(
 	return (GetFileAttributes(filename) != INVALID_FILE_ATTRIBUTES);
@@ -186,18 +459,9 @@ std::string load_text(const std::string& filename)
 
 std::string load_text(const char* filename)
 {
-	File f(filename);
-
-	std::string text;
-
-	char buffer_id[1024];
-	while (!f.eof()) {
-		size_t actual_bytes = f.read_bytes(buffer_id, std::extent<decltype(buffer_id)>::value);
-		if (actual_bytes)
-			text.append(buffer_id, actual_bytes);
-	}
-
-	return text;
+	// the file's size is known upfront, the string is allocated once.
+	Mapped_file f(filename);
+	return std::string(f.text());
 }
 
 } // namespace data
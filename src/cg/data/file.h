@@ -4,22 +4,29 @@
 #include <cassert>
 #include <cstdio>
 #include <iterator>
+#include <memory>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
 
 
 namespace cg {
 namespace data {
 
+class pack_file;
+
 enum class File_seek_origin : unsigned char {
 	current_position = 0,
 	file_start = 1,
 };
 
 // Handles all files as binary. Implements only read facilities.
+// If the file is stored in a mounted pack (see pack.h) it is read from the pack.
 class File final {
 public:
 
-	File() noexcept = default;
+	File() noexcept;
 
 	explicit File(const std::string& filename);
 
@@ -42,7 +49,8 @@ public:
 	// Also returns true if this->handle() equals to nullptr.
 	bool eof() const
 	{
-		assert(_handle);
+		assert(is_open());
+		if (_pack_file) return _pack_eof;
 		return (std::feof(_handle) != 0);
 	}
 
@@ -55,7 +63,7 @@ public:
 	// Returns true if the file has been opened.
 	bool is_open() const noexcept
 	{
-		return (_handle != nullptr);
+		return (_handle != nullptr) || (_pack_file != nullptr);
 	}
 
 	void open(const std::string& filename);
@@ -79,6 +87,96 @@ public:
 private:
 	std::string _filename;
 	mutable FILE* _handle = nullptr;
+	std::unique_ptr<pack_file> _pack_file;
+	mutable size_t _pack_position = 0;
+	mutable bool _pack_eof = false;
+};
+
+// Mapped_file maps the whole content of a file into the address space of the process.
+// The mapping is read-only. data(), bytes() & text() are valid until the file is closed,
+// they point directly into the mapped memory and no copy of the file's content is made.
+// If the file is stored in a mounted pack (see pack.h) the pack's memory is used instead,
+// compressed pack entries are decompressed into memory owned by the Mapped_file.
+class Mapped_file final {
+public:
+
+	Mapped_file() noexcept;
+
+	// search_packs == false opens the file from the file system even if a mounted pack stores it.
+	explicit Mapped_file(const std::string& filename, bool search_packs = true);
+
+	explicit Mapped_file(const char* filename, bool search_packs = true);
+
+	Mapped_file(const Mapped_file&) = delete;
+
+	Mapped_file(Mapped_file&& f) noexcept;
+
+	~Mapped_file() noexcept;
+
+
+	Mapped_file& operator=(const Mapped_file&) = delete;
+
+	Mapped_file& operator=(Mapped_file&& f) noexcept;
+
+
+	// Returns the number of bytes the file consists of.
+	size_t byte_count() const noexcept
+	{
+		return _byte_count;
+	}
+
+	// Returns the whole content of the file as a byte view.
+	std::basic_string_view<unsigned char> bytes() const & noexcept
+	{
+		return std::basic_string_view<unsigned char>(_data, _byte_count);
+	}
+
+	// The view would outlive the mapping.
+	std::basic_string_view<unsigned char> bytes() const && = delete;
+
+	// Unmaps the file and sets filename & data to empty string and nullptr respectively.
+	void close() noexcept;
+
+	// Pointer to the first byte of the mapped file.
+	// Returns nullptr if the file is empty or has not been opened.
+	const unsigned char* data() const noexcept
+	{
+		return _data;
+	}
+
+	// Returns the name of the mapped file.
+	const std::string& filename() const noexcept
+	{
+		return _filename;
+	}
+
+	// Returns true if the file has been opened.
+	// Empty files are opened but have no mapped memory.
+	bool is_open() const noexcept
+	{
+		return (_file_handle != nullptr) || (_pack_file != nullptr);
+	}
+
+	void open(const std::string& filename, bool search_packs = true);
+
+	void open(const char* filename, bool search_packs = true);
+
+	// Returns the whole content of the file as a text view.
+	std::string_view text() const & noexcept
+	{
+		return std::string_view(reinterpret_cast<const char*>(_data), _byte_count);
+	}
+
+	// The view would outlive the mapping.
+	std::string_view text() const && = delete;
+
+private:
+	std::string _filename;
+	void* _file_handle = nullptr;
+	void* _mapping_handle = nullptr;
+	std::unique_ptr<pack_file> _pack_file;
+	const unsigned char* _data = nullptr;
+	size_t _byte_count = 0;
 };
 
 // By_line_iterator is an input iterator that provides ability to read from file one line at a time.
@@ -87,6 +185,7 @@ private:
 // Also By_line_iterator::end static member can be used as the end iterator.
 // Each call to operator++ invalidates internal line buffer, so the caller
 // must copy its content when retention is needed.
+// The file is read in large chunks, line feeds are searched for a chunk at a time.
 class By_line_iterator final {
 	class Proxy {
 	public:
@@ -174,14 +273,90 @@ public:
 	}
 
 private:
+	// Reads the next chunk of the file into _read_buffer.
+	// Returns false if there is nothing left to read.
+	bool read_next_chunk();
+
 	void read_next_line();
 
 	File _file;
 	bool _keep_line_feed;
+	bool _file_exhausted = false;
 	std::string _line_buffer;
+	std::vector<char> _read_buffer;
+	size_t _read_position = 0;
+	size_t _read_end = 0;
+};
+
+// By_line_view_iterator is an input iterator over the lines of a text that is already in memory,
+// for example Mapped_file::text(). Each line is a view into the text, nothing is copied.
+// Line terminators (\n or \r\n) are not included into lines.
+// After construction By_line_view_iterator already points to the first line of the text.
+// Default constructor can be used to create the end iterator.
+// Also By_line_view_iterator::end static member can be used as the end iterator.
+class By_line_view_iterator final {
+public:
+	using iterator_category = std::input_iterator_tag;
+	using difference_type = ptrdiff_t;
+	using reference = const std::string_view&;
+	using pointer = const std::string_view*;
+	using value_type = std::string_view;
+
+	static const By_line_view_iterator end;
+
+	// Constructs the end iterator.
+	By_line_view_iterator() noexcept = default;
+
+	explicit By_line_view_iterator(std::string_view text) noexcept;
+
+
+	reference operator*() const noexcept
+	{
+		return _line;
+	}
+
+	pointer operator->() const noexcept
+	{
+		return &_line;
+	}
+
+	By_line_view_iterator& operator++() noexcept
+	{
+		read_next_line();
+		return *this;
+	}
+
+	By_line_view_iterator operator++(int) noexcept
+	{
+		By_line_view_iterator it = *this;
+		read_next_line();
+		return it;
+	}
+
+
+	friend bool operator==(const By_line_view_iterator& l, const By_line_view_iterator& r) noexcept
+	{
+		return (l._has_line == r._has_line)
+			&& (!l._has_line || (l._line.data() == r._line.data()));
+	}
+
+	friend bool operator!=(const By_line_view_iterator& l, const By_line_view_iterator& r) noexcept
+	{
+		return !(l == r);
+	}
+
+private:
+	void read_next_line() noexcept;
+
+	const char* _next = nullptr;
+	const char* _last = nullptr;
+	std::string_view _line;
+	bool _has_line = false;
+	bool _text_exhausted = true;
 };
 
 // Returns true if the given file (or directory) exists.
+// Mounted packs are checked first, the file system is not touched if the file is in a pack.
 bool exists(const std::string& filename);
 
 // Returns true if the given file (or directory) exists.
@@ -193,6 +368,20 @@ std::string load_text(const std::string& filename);
 // Returns the content of the specified text file
 std::string load_text(const char* filename);
 
+// Maps the specified text file into memory. Use Mapped_file::text() to access the content.
+// The content is not copied. It stays valid as long as the returned object is alive,
+// that is why text() can not be called on the temporary result.
+inline Mapped_file load_text_view(const std::string& filename)
+{
+	return Mapped_file(filename);
+}
+
+// ditto
+inline Mapped_file load_text_view(const char* filename)
+{
+	return Mapped_file(filename);
+}
+
 } // namespace data
 } // namespace cg
 
@@ -0,0 +1,335 @@
+#include "cg/data/ibl.h"
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <emmintrin.h>
+#include "cg/base/base.h"
+#include "cg/data/image_convert.h"
+#include "cg/data/image_disk_cache.h"
+#include "cg/data/pack.h"
+
+
+namespace {
+
+using cg::data::cube_face;
+using cg::data::cube_face_count;
+using cg::data::ggx_prefilter_desc;
+using cg::data::image_2d;
+using cg::data::image_cube;
+using cg::data::image_view;
+using cg::data::pixel_format;
+
+// Number of face rows which are processed by one task.
+constexpr size_t row_grain_size = 4;
+
+constexpr float pi_f = 3.14159265f;
+
+// Light direction in the tangent space of the normal & its weight.
+struct ggx_sample final {
+	float3 l;
+	float weight;
+};
+
+// i-th point of the Hammersley set of count points.
+inline float2 hammersley(uint32_t i, uint32_t count) noexcept
+{
+	uint32_t bits = i;
+	bits = (bits << 16u) | (bits >> 16u);
+	bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+	bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+	bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+	bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+	return float2(float(i) / float(count), float(bits) * 2.3283064365386963e-10f);
+}
+
+// Samples the half vectors of the GGX distribution & reflects n == v == (0, 0, 1) about them.
+// The samples below the horizon are dropped, the rest are weighted by cos(theta_l).
+std::vector<ggx_sample> make_ggx_samples(float alpha, uint32_t sample_count)
+{
+	// all the half vectors of a perfect mirror are the normal.
+	if (alpha == 0.0f) return { ggx_sample{ float3(0.0f, 0.0f, 1.0f), 1.0f } };
+
+	std::vector<ggx_sample> samples;
+	samples.reserve(sample_count);
+
+	for (uint32_t i = 0; i < sample_count; ++i) {
+		const float2 xi = hammersley(i, sample_count);
+		const float phi = 2.0f * pi_f * xi.x;
+		const float cos_theta = std::sqrt((1.0f - xi.y) / (1.0f + (alpha * alpha - 1.0f) * xi.y));
+		const float sin_theta = std::sqrt(1.0f - cos_theta * cos_theta);
+		const float3 h(std::cos(phi) * sin_theta, std::sin(phi) * sin_theta, cos_theta);
+
+		// l = reflect(-v, h)
+		const float3 l = (2.0f * h.z) * h - float3(0.0f, 0.0f, 1.0f);
+		if (l.z > 0.0f)
+			samples.push_back(ggx_sample{ l, l.z });
+	}
+
+	return samples;
+}
+
+// GGX half vectors of one alpha in the SoA layout. Only x & z are needed: v lies in the xz plane.
+// The count is a multiple of 4, the padding half vectors are zero and never pass the horizon test.
+struct ggx_half_vectors final {
+	std::vector<float> x;
+	std::vector<float> z;
+};
+
+ggx_half_vectors make_ggx_half_vectors(float alpha, uint32_t sample_count)
+{
+	const size_t count = (sample_count + 3) & ~size_t(3);
+	ggx_half_vectors h;
+	h.x.resize(count, 0.0f);
+	h.z.resize(count, 0.0f);
+
+	for (uint32_t i = 0; i < sample_count; ++i) {
+		const float2 xi = hammersley(i, sample_count);
+		const float phi = 2.0f * pi_f * xi.x;
+		const float cos_theta = std::sqrt((1.0f - xi.y) / (1.0f + (alpha * alpha - 1.0f) * xi.y));
+		const float sin_theta = std::sqrt(1.0f - cos_theta * cos_theta);
+		h.x[i] = std::cos(phi) * sin_theta;
+		h.z[i] = cos_theta;
+	}
+
+	return h;
+}
+
+// Smith GGX Lambda of one direction: (sqrt(1 + alpha^2 * tan^2) - 1) / 2
+// == (sqrt(alpha^2 + (1 - alpha^2) * cos^2) - cos) / (2 * cos), which needs no tangent.
+inline __m128 smith_lambda(__m128 cos_theta, __m128 alpha_sq) noexcept
+{
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 cos_sq = _mm_mul_ps(cos_theta, cos_theta);
+	const __m128 root = _mm_sqrt_ps(_mm_add_ps(alpha_sq, _mm_mul_ps(_mm_sub_ps(one, alpha_sq), cos_sq)));
+	return _mm_div_ps(_mm_sub_ps(root, cos_theta), _mm_add_ps(cos_theta, cos_theta));
+}
+
+// Integrates the BRDF for the view direction (sqrt(1 - cos_v^2), 0, cos_v), returns the scale & bias.
+float2 integrate_brdf(const ggx_half_vectors& h, float alpha, float cos_v, uint32_t sample_count) noexcept
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 alpha_sq = _mm_set1_ps(alpha * alpha);
+	const __m128 vx = _mm_set1_ps(std::sqrt(1.0f - cos_v * cos_v));
+	const __m128 vz = _mm_set1_ps(cos_v);
+	const __m128 lambda_v = smith_lambda(vz, alpha_sq);
+
+	__m128 scale = zero;
+	__m128 bias = zero;
+	for (size_t i = 0; i < h.x.size(); i += 4) {
+		const __m128 hx = _mm_loadu_ps(h.x.data() + i);
+		const __m128 hz = _mm_loadu_ps(h.z.data() + i);
+
+		// l = reflect(-v, h), only the samples above the horizon contribute.
+		const __m128 vh = _mm_max_ps(_mm_add_ps(_mm_mul_ps(vx, hx), _mm_mul_ps(vz, hz)), zero);
+		const __m128 lz = _mm_sub_ps(_mm_mul_ps(_mm_add_ps(vh, vh), hz), vz);
+		const __m128 mask = _mm_cmpgt_ps(lz, zero);
+
+		// height-correlated Smith G = 1 / (1 + Lambda(v) + Lambda(l)) (Heitz 2014).
+		// G * (v.h) / ((n.h) * (n.v)), the pdf of the sample cancels the distribution term.
+		// The samples below the horizon divide by zero, the mask drops them.
+		const __m128 lambda_l = smith_lambda(_mm_max_ps(lz, zero), alpha_sq);
+		const __m128 g = _mm_div_ps(one, _mm_add_ps(one, _mm_add_ps(lambda_v, lambda_l)));
+		const __m128 g_vis = _mm_div_ps(_mm_mul_ps(g, vh), _mm_mul_ps(hz, vz));
+		const __m128 c = _mm_sub_ps(one, vh);
+		const __m128 c2 = _mm_mul_ps(c, c);
+		const __m128 fc = _mm_mul_ps(_mm_mul_ps(c2, c2), c);
+
+		scale = _mm_add_ps(scale, _mm_and_ps(mask, _mm_mul_ps(_mm_sub_ps(one, fc), g_vis)));
+		bias = _mm_add_ps(bias, _mm_and_ps(mask, _mm_mul_ps(fc, g_vis)));
+	}
+
+	float s[4];
+	float b[4];
+	_mm_storeu_ps(s, scale);
+	_mm_storeu_ps(b, bias);
+	return float2((s[0] + s[1] + s[2] + s[3]) / sample_count, (b[0] + b[1] + b[2] + b[3]) / sample_count);
+}
+
+// Samples the rgba_32f cube bilinearly. Texels outside the face are clamped to its edge.
+inline __m128 sample_cube(const image_cube& cube, const float3& direction) noexcept
+{
+	float2 uv;
+	const cube_face face = cg::data::cube_face_uv(direction, uv);
+	const float* pixels = reinterpret_cast<const float*>(cube.face(face).data);
+	const size_t side_size = cube.side_size();
+	const float max_coord = float(side_size - 1);
+
+	const float fx = std::min(std::max(uv.x * side_size - 0.5f, 0.0f), max_coord);
+	const float fy = std::min(std::max(uv.y * side_size - 0.5f, 0.0f), max_coord);
+	const size_t x0 = size_t(fx);
+	const size_t y0 = size_t(fy);
+	const size_t x1 = std::min(x0 + 1, side_size - 1);
+	const size_t y1 = std::min(y0 + 1, side_size - 1);
+	const __m128 tx = _mm_set1_ps(fx - float(x0));
+	const __m128 ty = _mm_set1_ps(fy - float(y0));
+
+	const __m128 p00 = _mm_loadu_ps(pixels + (y0 * side_size + x0) * 4);
+	const __m128 p01 = _mm_loadu_ps(pixels + (y0 * side_size + x1) * 4);
+	const __m128 p10 = _mm_loadu_ps(pixels + (y1 * side_size + x0) * 4);
+	const __m128 p11 = _mm_loadu_ps(pixels + (y1 * side_size + x1) * 4);
+
+	const __m128 top = _mm_add_ps(p00, _mm_mul_ps(_mm_sub_ps(p01, p00), tx));
+	const __m128 bottom = _mm_add_ps(p10, _mm_mul_ps(_mm_sub_ps(p11, p10), tx));
+	return _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), ty));
+}
+
+// Filters the row y of the face, writes side_size float4 pixels into dst.
+void prefilter_row(const image_cube& envmap, const std::vector<ggx_sample>& samples, cube_face face,
+	uint32_t side_size, uint32_t y, float* dst) noexcept
+{
+	const float inv_side_size = 1.0f / side_size;
+	const float v = (y + 0.5f) * inv_side_size;
+
+	for (uint32_t x = 0; x < side_size; ++x) {
+		const float3 n = normalize(cg::data::cube_direction(face, (x + 0.5f) * inv_side_size, v));
+		const float3 up = (std::abs(n.z) < 0.999f) ? float3::unit_z : float3::unit_x;
+		const float3 tangent = normalize(cross(up, n));
+		const float3 bitangent = cross(n, tangent);
+
+		__m128 color = _mm_setzero_ps();
+		float total_weight = 0.0f;
+		for (const ggx_sample& s : samples) {
+			const float3 l = s.l.x * tangent + s.l.y * bitangent + s.l.z * n;
+			color = _mm_add_ps(color, _mm_mul_ps(sample_cube(envmap, l), _mm_set1_ps(s.weight)));
+			total_weight += s.weight;
+		}
+
+		_mm_storeu_ps(dst + x * 4, _mm_div_ps(color, _mm_set1_ps(total_weight)));
+	}
+}
+
+// Prefilters the level of the rgba_32f envmap, returns the faces as one side x (6 * side) image of the format fmt.
+image_2d prefilter_level(const image_cube& envmap, const ggx_prefilter_desc& desc, uint32_t level,
+	pixel_format fmt, cg::thread_pool& pool)
+{
+	assert(envmap.format() == pixel_format::rgba_32f);
+
+	const float alpha = (desc.mip_level_count > 1) ? float(level) / (desc.mip_level_count - 1) : 0.0f;
+	const std::vector<ggx_sample> samples = make_ggx_samples(alpha, desc.sample_count);
+	const uint32_t side_size = desc.side_size >> level;
+
+	image_2d faces(uint2(side_size, side_size * uint32_t(cube_face_count)), fmt);
+	const size_t row_byte_count = side_size * byte_count(fmt);
+	unsigned char* dst = reinterpret_cast<unsigned char*>(faces.data);
+
+	cg::parallel_for(pool, size_t(side_size) * cube_face_count, row_grain_size, [&](size_t first, size_t last) {
+		std::vector<float> row(side_size * 4);
+
+		for (size_t r = first; r < last; ++r) {
+			prefilter_row(envmap, samples, cube_face(r / side_size), side_size, uint32_t(r % side_size), row.data());
+			convert(image_view(row.data(), uint2(side_size, 1), pixel_format::rgba_32f), fmt, dst + r * row_byte_count);
+		}
+	});
+
+	return faces;
+}
+
+} // namespace
+
+
+namespace cg {
+namespace data {
+
+image_2d brdf_lut(const uint2& size, uint32_t sample_count, pixel_format fmt, thread_pool& pool)
+{
+	assert(size.x > 0 && size.y > 0);
+	assert(sample_count > 0);
+	assert(fmt == pixel_format::rg_32f || fmt == pixel_format::rg_16f);
+
+	image_2d lut(size, fmt);
+	const size_t row_byte_count = size.x * byte_count(fmt);
+
+	parallel_for(pool, size.y, 1, [&](size_t first, size_t last) {
+		std::vector<float2> row(size.x);
+
+		for (size_t y = first; y < last; ++y) {
+			const float alpha = (y + 0.5f) / size.y;
+			const ggx_half_vectors h = make_ggx_half_vectors(alpha, sample_count);
+
+			for (size_t x = 0; x < size.x; ++x)
+				row[x] = integrate_brdf(h, alpha, (x + 0.5f) / size.x, sample_count);
+
+			convert(image_view(row.data(), uint2(size.x, 1), pixel_format::rg_32f), fmt,
+				reinterpret_cast<uint8_t*>(lut.data) + y * row_byte_count);
+		}
+	});
+
+	return lut;
+}
+
+cached_image load_brdf_lut_cached(const std::string& filename, const uint2& size, uint32_t sample_count,
+	pixel_format fmt, thread_pool& pool)
+{
+	// the table has no source file, the params are its source.
+	cgimg_source source;
+	source.hash = pack_path_hash(concat("brdf_lut|", size.x, '|', size.y, '|', sample_count, '|', int(fmt)));
+
+	return load_cgimg_or_compute(filename, source, [&] { return brdf_lut(size, sample_count, fmt, pool); });
+}
+
+std::vector<image_cube> prefilter_ggx(const image_cube& envmap, const ggx_prefilter_desc& desc, thread_pool& pool)
+{
+	assert(envmap.side_size() > 0);
+	assert(!is_block_compressed(envmap.format()));
+	assert(desc.mip_level_count > 0);
+	assert((desc.side_size >> (desc.mip_level_count - 1)) > 0);
+	assert(desc.sample_count > 0);
+
+	// the samples are taken from rgba_32f faces.
+	image_cube source(envmap.side_size(), pixel_format::rgba_32f);
+	convert(envmap.faces(), pixel_format::rgba_32f, source.face_data(cube_face::positive_x), pool);
+
+	std::vector<image_cube> levels;
+	levels.reserve(desc.mip_level_count);
+	for (uint32_t level = 0; level < desc.mip_level_count; ++level)
+		levels.emplace_back(cached_image(prefilter_level(source, desc, level, envmap.format(), pool)));
+
+	return levels;
+}
+
+std::vector<image_cube> load_prefiltered_cached(const std::string& filename, uint32_t envmap_side_size,
+	const ggx_prefilter_desc& desc, pixel_format fmt, thread_pool& pool)
+{
+	assert(envmap_side_size > 0);
+	assert(fmt != pixel_format::none);
+	assert(!is_block_compressed(fmt));
+	assert(desc.mip_level_count > 0);
+	assert((desc.side_size >> (desc.mip_level_count - 1)) > 0);
+	assert(desc.sample_count > 0);
+
+	// the envmap is projected (or mapped) once, only if a level has to be prefiltered.
+	image_cube envmap;
+	const auto prefilter = [&](uint32_t level) {
+		if (envmap.side_size() == 0)
+			envmap = load_cube_cached(filename, envmap_side_size, pixel_format::rgba_32f, pool);
+
+		return prefilter_level(envmap, desc, level, fmt, pool);
+	};
+
+	cgimg_source source;
+	const bool cacheable = get_cgimg_source(filename, 4, false, false, source);
+
+	std::vector<image_cube> levels;
+	levels.reserve(desc.mip_level_count);
+	for (uint32_t level = 0; level < desc.mip_level_count; ++level) {
+		if (!cacheable) {
+			levels.emplace_back(cached_image(prefilter(level)));
+			continue;
+		}
+
+		// every level has its own file, the bake params are a part of the source description.
+		cgimg_source level_source = source;
+		level_source.hash = pack_path_hash(concat(source.hash, '|', envmap_side_size, '|', desc.side_size,
+			'|', desc.mip_level_count, '|', desc.sample_count, '|', level, '|', int(fmt)));
+		const std::string level_filename = concat(filename, ".ggx", desc.side_size, '_', level, ".cgimg");
+
+		levels.emplace_back(load_cgimg_or_compute(level_filename, level_source, [&] { return prefilter(level); }));
+	}
+
+	return levels;
+}
+
+} // namespace data
+} // namespace cg
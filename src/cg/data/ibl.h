@@ -0,0 +1,56 @@
+#ifndef CG_DATA_IBL_H_
+#define CG_DATA_IBL_H_
+
+#include <string>
+#include <vector>
+#include "cg/base/thread_pool.h"
+#include "cg/data/image.h"
+#include "cg/data/image_cube.h"
+#include "cg/data/image_disk_cache.h"
+
+
+namespace cg {
+namespace data {
+
+// Parameters of the GGX prefiltered reflection map.
+struct ggx_prefilter_desc final {
+	// The side size of the first mip level.
+	uint32_t side_size = 128;
+
+	// Mip level i is filtered with GGX alpha == i / (mip_level_count - 1).
+	uint32_t mip_level_count = 5;
+
+	// The number of Hammersley samples per texel.
+	uint32_t sample_count = 1024;
+};
+
+// Integrates the GGX specular BRDF over the hemisphere for the split sum approximation (Karis 2013).
+// The result is the scale & bias of the Schlick Fresnel term: F0 * lut.r + lut.g.
+// Column x is cos(theta_v) == (x + 0.5) / size.x, row y is GGX alpha == (y + 0.5) / size.y.
+// Masking-shadowing is the height-correlated Smith GGX term (Heitz 2014). fmt is rg_32f or rg_16f.
+// Rows are split between the workers of the pool, samples are processed 4 at a time.
+image_2d brdf_lut(const uint2& size, uint32_t sample_count, pixel_format fmt, thread_pool& pool);
+
+// Loads the lookup table from the .cgimg file, the table is computed and written if the file is missing
+// or has been written for other params. The returned table is mapped from the file if it is up to date.
+cached_image load_brdf_lut_cached(const std::string& filename, const uint2& size, uint32_t sample_count,
+	pixel_format fmt, thread_pool& pool);
+
+// Prefilters the envmap for the split sum approximation (Karis 2013, the view direction equals the normal).
+// Returns mip_level_count cubes, the side of the level i is side_size >> i.
+// Texels of every level are split between the workers of the pool, the cubes have the pixel format of the envmap.
+std::vector<image_cube> prefilter_ggx(const image_cube& envmap, const ggx_prefilter_desc& desc, thread_pool& pool);
+
+// Loads the prefiltered levels of the equirectangular panorama from the .cgimg files next to it.
+// The levels which are missing or have been made of another version of the panorama are prefiltered from
+// the cube of envmap_side_size (see load_cube_cached) and cached. The levels have the specified pixel format,
+// the cached ones are mapped.
+// The panorama is identified by its path, size & last write time (see get_cgimg_source), its content is not hashed:
+// a panorama replaced by another one of the same size & write time (e.g. extracted from an archive) is not noticed.
+std::vector<image_cube> load_prefiltered_cached(const std::string& filename, uint32_t envmap_side_size,
+	const ggx_prefilter_desc& desc, pixel_format fmt, thread_pool& pool);
+
+} // namespace data
+} // namespace cg
+
+#endif // CG_DATA_IBL_H_
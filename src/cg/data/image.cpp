@@ -3,36 +3,84 @@
 #include <cassert>
 #include <cstring>
 #include <algorithm>
+#include <emmintrin.h>
+#include <exception>
+#include <future>
 #include <limits>
 #include <vector>
 #include "cg/base/base.h"
+#include "cg/base/half.h"
+#include "cg/base/thread_pool.h"
+#include "cg/data/file.h"
+#include "cg/data/image_hdr.h"
+#include "cg/data/image_png.h"
 #define STB_IMAGE_IMPLEMENTATION
 #define STBI_FAILURE_USERMSG 
 #include "stb/stb_image.h"
 
 
-
 namespace cg {
 namespace data {
 
-image_2d::image_2d(const char* filename, uint8_t channel_count, bool flip_vertically)
+image_2d::image_2d(const char* filename, uint8_t channel_count, bool flip_vertically, bool half_float)
 {
 	assert(filename && std::strlen(filename));
 
-	stbi_set_flip_vertically_on_load(flip_vertically);
+	// stbi_set_flip_vertically_on_load changes global state, images are flipped
+	// after decoding so that several images can be decoded concurrently.
+	// The file is mapped once (or taken from a mounted pack) and decoded from memory,
+	// stbi_is_hdr & stbi_load would open it twice.
+	const Mapped_file file(filename);
+	ENFORCE(file.byte_count() <= size_t(std::numeric_limits<int>::max()), "Image file is too big: ", filename);
+
+	const stbi_uc* bytes = file.data();
+	const int len = int(file.byte_count());
+
+	// RGBE images of 3 & 4 channels are decoded straight into the final format (see image_hdr.h).
+	if ((channel_count == 0 || channel_count >= 3) && is_hdr(bytes, file.byte_count())) {
+		const bool rgba = (channel_count == 4);
+		const data::pixel_format fmt = (half_float)
+			? ((rgba) ? pixel_format::rgba_16f : pixel_format::rgb_16f)
+			: ((rgba) ? pixel_format::rgba_32f : pixel_format::rgb_32f);
+
+		try {
+			*this = decode_hdr(bytes, file.byte_count(), fmt, flip_vertically);
+		}
+		catch (...) {
+			std::throw_with_nested(std::runtime_error(EXCEPTION_MSG("Loading ", filename, " image error.")));
+		}
+
+		return;
+	}
+
+	// PNG images are decoded straight into the pixels of the image (see image_png.h),
+	// interlaced ones are left to stb_image.
+	if (is_png(bytes, file.byte_count())) {
+		try {
+			if (!read_png_info(bytes, file.byte_count()).interlaced) {
+				*this = decode_png(bytes, file.byte_count(), channel_count, flip_vertically);
+				return;
+			}
+		}
+		catch (...) {
+			std::throw_with_nested(std::runtime_error(EXCEPTION_MSG("Loading ", filename, " image error.")));
+		}
+	}
 
 	int width = 0;
 	int height = 0;
 	int actual_channel_count = 0;
-	const bool is_hdr = stbi_is_hdr(filename);
-	
-	if (is_hdr)
-		data = stbi_loadf(filename, &width, &height, &actual_channel_count, channel_count);
+	const bool is_hdr = (bytes) && stbi_is_hdr_from_memory(bytes, len);
+
+	if (!bytes)
+		data = nullptr;
+	else if (is_hdr)
+		data = stbi_loadf_from_memory(bytes, len, &width, &height, &actual_channel_count, channel_count);
 	else
-		data = stbi_load(filename, &width, &height, &actual_channel_count, channel_count);
-	
+		data = stbi_load_from_memory(bytes, len, &width, &height, &actual_channel_count, channel_count);
+
 	if (!data) {
-		const char* stb_error = stbi_failure_reason();
+		const char* stb_error = (bytes) ? stbi_failure_reason() : "The file is empty.";
 		throw std::runtime_error(EXCEPTION_MSG("Loading ", filename, " image error. ", stb_error));
 	}
 
@@ -45,10 +93,34 @@ image_2d::image_2d(const char* filename, uint8_t channel_count, bool flip_vertic
 		case 3: pixel_format = (is_hdr) ? (pixel_format::rgb_32f) : (pixel_format::rgb_8); break;
 		case 4: pixel_format = (is_hdr) ? (pixel_format::rgba_32f) : (pixel_format::rgba_8); break;
 	}
+
+	if (flip_vertically)
+		cg::data::flip_vertically(data, size, pixel_format);
+
+	if (half_float && (pixel_format == pixel_format::rgb_32f || pixel_format == pixel_format::rgba_32f)) {
+		const data::pixel_format half_format = (pixel_format == pixel_format::rgb_32f)
+			? pixel_format::rgb_16f : pixel_format::rgba_16f;
+
+		image_2d half_image(size, half_format);
+		float_to_half(reinterpret_cast<const float*>(data), reinterpret_cast<uint16_t*>(half_image.data),
+			square(size) * cg::data::channel_count(half_format));
+		*this = std::move(half_image);
+	}
 }
 
-image_2d::image_2d(const std::string& filename, uint8_t channel_count, bool flip_vertically)
-	: image_2d(filename.c_str(), channel_count, flip_vertically)
+image_2d::image_2d(const uint2& size, data::pixel_format fmt)
+	: size(size), pixel_format(fmt)
+{
+	assert(size.x > 0 && size.y > 0);
+	assert(fmt != pixel_format::none);
+
+	// dispose() releases the pixels with stbi_image_free which uses STBI_FREE.
+	data = STBI_MALLOC(byte_count(size, fmt));
+	ENFORCE(data, "Failed to allocate pixels of a ", size.x, 'x', size.y, " image.");
+}
+
+image_2d::image_2d(const std::string& filename, uint8_t channel_count, bool flip_vertically, bool half_float)
+	: image_2d(filename.c_str(), channel_count, flip_vertically, half_float)
 {}
 
 image_2d::image_2d(image_2d&& image) noexcept
@@ -108,6 +180,10 @@ std::ostream& operator<<(std::ostream& out, const pixel_format& fmt)
 			out << "rgb_32f";
 			break;
 
+		case pixel_format::rgba_32f:
+			out << "rgba_32f";
+			break;
+
 		case pixel_format::red_8:
 			out << "red_8";
 			break;
@@ -123,6 +199,38 @@ std::ostream& operator<<(std::ostream& out, const pixel_format& fmt)
 		case pixel_format::rgba_8:
 			out << "rgba_8";
 			break;
+
+		case pixel_format::bc1:
+			out << "bc1";
+			break;
+
+		case pixel_format::bc3:
+			out << "bc3";
+			break;
+
+		case pixel_format::bc4:
+			out << "bc4";
+			break;
+
+		case pixel_format::bc5:
+			out << "bc5";
+			break;
+
+		case pixel_format::rgb_16f:
+			out << "rgb_16f";
+			break;
+
+		case pixel_format::rgba_16f:
+			out << "rgba_16f";
+			break;
+
+		case pixel_format::rg_32f:
+			out << "rg_32f";
+			break;
+
+		case pixel_format::rg_16f:
+			out << "rg_16f";
+			break;
 	}
 
 	return out;
@@ -160,6 +268,38 @@ std::wostream& operator<<(std::wostream& out, const pixel_format& fmt)
 		case pixel_format::rgba_8:
 			out << "rgba_8";
 			break;
+
+		case pixel_format::bc1:
+			out << "bc1";
+			break;
+
+		case pixel_format::bc3:
+			out << "bc3";
+			break;
+
+		case pixel_format::bc4:
+			out << "bc4";
+			break;
+
+		case pixel_format::bc5:
+			out << "bc5";
+			break;
+
+		case pixel_format::rgb_16f:
+			out << "rgb_16f";
+			break;
+
+		case pixel_format::rgba_16f:
+			out << "rgba_16f";
+			break;
+
+		case pixel_format::rg_32f:
+			out << "rg_32f";
+			break;
+
+		case pixel_format::rg_16f:
+			out << "rg_16f";
+			break;
 	}
 
 	return out;
@@ -176,6 +316,54 @@ size_t byte_count(const pixel_format& fmt) noexcept
 		case pixel_format::rg_8: return 2;
 		case pixel_format::rgb_8: return 3;
 		case pixel_format::rgba_8: return 4;
+		case pixel_format::rgb_16f: return 3 * sizeof(uint16_t);
+		case pixel_format::rgba_16f: return 4 * sizeof(uint16_t);
+		case pixel_format::rg_32f: return 2 * sizeof(float);
+		case pixel_format::rg_16f: return 2 * sizeof(uint16_t);
+	}
+}
+
+size_t byte_count(const uint2& size, const pixel_format& fmt) noexcept
+{
+	const size_t block_bytes = block_byte_count(fmt);
+	if (block_bytes == 0) return square(size) * byte_count(fmt);
+
+	const size_t block_count = size_t((size.x + 3) / 4) * ((size.y + 3) / 4);
+	return block_count * block_bytes;
+}
+
+size_t block_byte_count(const pixel_format& fmt) noexcept
+{
+	switch (fmt) {
+		default: return 0;
+		case pixel_format::bc1: return 8;
+		case pixel_format::bc3: return 16;
+		case pixel_format::bc4: return 8;
+		case pixel_format::bc5: return 16;
+	}
+}
+
+void flip_vertically(void* data, const uint2& size, pixel_format fmt) noexcept
+{
+	assert(data);
+	assert(!is_block_compressed(fmt));
+	if (size.y < 2) return;
+
+	const size_t row_byte_count = size.x * byte_count(fmt);
+	unsigned char* top = reinterpret_cast<unsigned char*>(data);
+	unsigned char* bottom = top + (size.y - 1) * row_byte_count;
+
+	for (; top < bottom; top += row_byte_count, bottom -= row_byte_count) {
+		size_t i = 0;
+		for (; i + 16 <= row_byte_count; i += 16) {
+			const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + i));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(top + i), b);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(bottom + i), t);
+		}
+
+		for (; i < row_byte_count; ++i)
+			std::swap(top[i], bottom[i]);
 	}
 }
 
@@ -186,20 +374,60 @@ size_t channel_count(const pixel_format& fmt) noexcept
 		case pixel_format::none: return 0;
 		
 		case pixel_format::red_8: 
+		case pixel_format::bc4:
 			return 1;
 
 		case pixel_format::rg_8:
+		case pixel_format::bc5:
+		case pixel_format::rg_32f:
+		case pixel_format::rg_16f:
 			return 2;
 		
 		case pixel_format::rgb_32f:
 		case pixel_format::rgb_8:
+		case pixel_format::bc1:
+		case pixel_format::rgb_16f:
 			return 3;
 
 		case pixel_format::rgba_32f:
 		case pixel_format::rgba_8:
+		case pixel_format::bc3:
+		case pixel_format::rgba_16f:
 			return 4;
 	}
 }
 
+std::vector<image_2d> decode_images(const image_request* requests, size_t count, thread_pool& pool)
+{
+	assert(requests || count == 0);
+
+	std::vector<std::future<image_2d>> futures;
+	futures.reserve(count);
+	for (size_t i = 0; i < count; ++i) {
+		const image_request* req = requests + i;
+		futures.push_back(pool.enqueue(task_priority::normal, [req] {
+			return image_2d(req->filename, req->channel_count, req->flip_vertically, req->half_float);
+		}));
+	}
+
+	// all the tasks must complete before the requests go out of scope,
+	// the first exception is rethrown afterwards.
+	for (auto& f : futures) f.wait();
+
+	std::vector<image_2d> images;
+	images.reserve(count);
+	for (auto& f : futures) images.push_back(f.get());
+
+	return images;
+}
+
+std::vector<image_2d> decode_images(const std::vector<image_request>& requests)
+{
+	if (requests.empty()) return {};
+
+	thread_pool pool(std::min(requests.size(), hardware_thread_count()));
+	return decode_images(requests, pool);
+}
+
 } // namespace data
 } // namespace cg
\ No newline at end of file
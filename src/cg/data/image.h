@@ -3,10 +3,15 @@
 
 #include <cstdint>
 #include <iostream>
+#include <string>
+#include <vector>
 #include "cg/base/math.h"
 
 
 namespace cg {
+
+class thread_pool;
+
 namespace data {
 
 // Describes pixel's channels and their size. 
@@ -19,19 +24,42 @@ enum class pixel_format :unsigned char {
 	red_8,
 	rg_8,
 	rgb_8,
-	rgba_8
+	rgba_8,
+
+	// Block compressed formats. Each 4x4 block of pixels is stored in 8 or 16 bytes,
+	// partial blocks at the right & bottom edges are stored as whole blocks.
+	bc1,	// rgb, 8 bytes per block.
+	bc3,	// rgba, 16 bytes per block.
+	bc4,	// red, 8 bytes per block.
+	bc5,	// rg, 16 bytes per block.
+
+	// Half precision floats (see cg/base/half.h).
+	rgb_16f,
+	rgba_16f,
+
+	// Two channel float formats, e.g. lookup tables of two values.
+	rg_32f,
+	rg_16f
 };
 
-// NOTE(ref2401): If you ever need any image processing then you should implement
-// processing algorithms as func(Image_data): write, flip, rg_swap, convert, etc...
-// struct Image_view { pointer, size, pixel_format };
+// image_2d owns the pixels of an image. Rows are tightly packed, the first row is the top one
+// unless the image is loaded with flip_vertically set.
+// Processing algorithms are free functions which take image_view (see image_convert.h).
 struct image_2d final {
 
 	image_2d() noexcept = default;
 
-	image_2d(const char* filename, uint8_t channel_count = 0, bool flip_vertically = false);
+	// Allocates uninitialized pixels of an image of the specified size & format.
+	image_2d(const uint2& size, pixel_format fmt);
+
+	// Decodes the specified image file.
+	// If half_float is set HDR images are stored as rgb_16f/rgba_16f instead of rgb_32f/rgba_32f,
+	// the flag does not affect other images.
+	image_2d(const char* filename, uint8_t channel_count = 0, bool flip_vertically = false,
+		bool half_float = false);
 
-	image_2d(const std::string& filename, uint8_t channel_count = 0, bool flip_vertically = false);
+	image_2d(const std::string& filename, uint8_t channel_count = 0, bool flip_vertically = false,
+		bool half_float = false);
 
 	image_2d(image_2d&& image) noexcept;
 	
@@ -54,6 +82,40 @@ struct image_2d final {
 	pixel_format pixel_format = pixel_format::none;
 };
 
+// image_view is a non-owning view of pixels which are stored elsewhere:
+// in an image_2d, in a mapped file, etc.
+struct image_view final {
+
+	image_view() noexcept = default;
+
+	image_view(const void* data, const uint2& size, pixel_format pixel_format) noexcept
+		: data(data), size(size), pixel_format(pixel_format)
+	{}
+
+	image_view(const image_2d& image) noexcept
+		: data(image.data), size(image.size), pixel_format(image.pixel_format)
+	{}
+
+
+	// Pointer to the first pixel. Rows are tightly packed.
+	const void* data = nullptr;
+
+	// Size of the image in pixels.
+	uint2 size;
+
+	// Pixel format of the image.
+	pixel_format pixel_format = pixel_format::none;
+};
+
+// Describes an image which has to be loaded by decode_images.
+// Params have the same meaning as the params of image_2d constructor.
+struct image_request final {
+	std::string filename;
+	uint8_t channel_count = 0;
+	bool flip_vertically = false;
+	bool half_float = false;
+};
+
 // ----- funcs -----
 
 std::ostream& operator<<(std::ostream& out, const pixel_format& fmt);
@@ -62,17 +124,74 @@ std::wostream& operator<<(std::wostream& out, const pixel_format& fmt);
 
 
 // Returns the number of bytes occupied by one pixel of the specified format.
+// Returns 0 for block compressed formats, see block_byte_count.
 size_t byte_count(const pixel_format& fmt) noexcept;
 
+// Returns the number of bytes occupied by the pixels of an image of the specified size & format.
+size_t byte_count(const uint2& size, const pixel_format& fmt) noexcept;
+
 // Total number of bytes occupied by this image.
 inline size_t byte_count(const image_2d& image) noexcept
 {
-	return square(image.size) * byte_count(image.pixel_format);
+	return byte_count(image.size, image.pixel_format);
+}
+
+// Total number of bytes occupied by the pixels of this view.
+inline size_t byte_count(const image_view& image) noexcept
+{
+	return byte_count(image.size, image.pixel_format);
 }
 
+// Returns the number of bytes occupied by one 4x4 block of the specified block compressed format.
+// Returns 0 if the format is not block compressed.
+size_t block_byte_count(const pixel_format& fmt) noexcept;
+
 // Returns the number of color channels for the given image format.
 size_t channel_count(const pixel_format& fmt) noexcept;
 
+// Flips the pixels in place: the first row becomes the last one and so on.
+// Block compressed formats are not supported.
+void flip_vertically(void* data, const uint2& size, pixel_format fmt) noexcept;
+
+// ditto
+inline void flip_vertically(image_2d& image) noexcept
+{
+	flip_vertically(image.data, image.size, image.pixel_format);
+}
+
+// Returns true if fmt is one of the *_16f formats.
+inline bool is_half_format(const pixel_format& fmt) noexcept
+{
+	return (fmt == pixel_format::rg_16f) || (fmt == pixel_format::rgb_16f) || (fmt == pixel_format::rgba_16f);
+}
+
+// Returns true if fmt is one of the *_32f or *_16f formats.
+inline bool is_float_format(const pixel_format& fmt) noexcept
+{
+	return (fmt == pixel_format::rg_32f) || (fmt == pixel_format::rgb_32f) || (fmt == pixel_format::rgba_32f)
+		|| is_half_format(fmt);
+}
+
+// Returns true if fmt is one of the bc* formats.
+inline bool is_block_compressed(const pixel_format& fmt) noexcept
+{
+	return block_byte_count(fmt) > 0;
+}
+
+// Decodes the requested images in parallel on the workers of the pool.
+// The i-th image corresponds to the i-th request. Blocks until all the images are decoded.
+// If an image fails to load the exception of the first failed request is rethrown.
+std::vector<image_2d> decode_images(const image_request* requests, size_t count, thread_pool& pool);
+
+// ditto
+inline std::vector<image_2d> decode_images(const std::vector<image_request>& requests, thread_pool& pool)
+{
+	return decode_images(requests.data(), requests.size(), pool);
+}
+
+// Decodes the requested images in parallel on a temporary pool of worker threads.
+std::vector<image_2d> decode_images(const std::vector<image_request>& requests);
+
 } // namespace data
 } // namespace cg
 
@@ -0,0 +1,297 @@
+#include "cg/data/image_bc.h"
+
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <emmintrin.h>
+#include "cg/base/half.h"
+#include "cg/base/thread_pool.h"
+
+
+namespace {
+
+using cg::data::image_view;
+using cg::data::pixel_format;
+
+// Number of block rows which are processed by one task.
+constexpr size_t block_row_grain_size = 4;
+
+inline uint8_t unorm_8(float v) noexcept
+{
+	return uint8_t(std::min(std::max(v, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+// Reads the 4x4 block at (bx, by) as 16 rgba_8 pixels.
+void load_block(const image_view& image, uint32_t bx, uint32_t by, uint8_t* block) noexcept
+{
+	const size_t cc = cg::data::channel_count(image.pixel_format);
+	const bool is_half = cg::data::is_half_format(image.pixel_format);
+	const bool is_float = !is_half && cg::data::is_float_format(image.pixel_format);
+
+	for (uint32_t y = 0; y < 4; ++y) {
+		const size_t iy = std::min(by * 4 + y, image.size.y - 1);
+
+		for (uint32_t x = 0; x < 4; ++x, block += 4) {
+			const size_t ix = std::min(bx * 4 + x, image.size.x - 1);
+			const size_t offset = (iy * image.size.x + ix) * cc;
+			block[0] = block[1] = block[2] = 0;
+			block[3] = 255;
+
+			if (is_half) {
+				float p[4];
+				cg::half_to_float(reinterpret_cast<const uint16_t*>(image.data) + offset, p, cc);
+				for (size_t c = 0; c < cc; ++c) block[c] = unorm_8(p[c]);
+			}
+			else if (is_float) {
+				const float* p = reinterpret_cast<const float*>(image.data) + offset;
+				for (size_t c = 0; c < cc; ++c) block[c] = unorm_8(p[c]);
+			}
+			else {
+				const uint8_t* p = reinterpret_cast<const uint8_t*>(image.data) + offset;
+				for (size_t c = 0; c < cc; ++c) block[c] = p[c];
+			}
+		}
+	}
+}
+
+inline uint16_t pack_565(int r, int g, int b) noexcept
+{
+	return uint16_t((((r * 31 + 127) / 255) << 11) | (((g * 63 + 127) / 255) << 5) | ((b * 31 + 127) / 255));
+}
+
+// Expands 565 color to 8 bits per channel the way GPUs do.
+inline void unpack_565(uint16_t c, int* rgb) noexcept
+{
+	const int r = (c >> 11) & 31;
+	const int g = (c >> 5) & 63;
+	const int b = c & 31;
+	rgb[0] = (r << 3) | (r >> 2);
+	rgb[1] = (g << 2) | (g >> 4);
+	rgb[2] = (b << 3) | (b >> 2);
+}
+
+// Computes dot(pixel - e0, d) of 4 rgba_8 pixels. e0 & d are (x, y, z, 0, x, y, z, 0) 16-bit vectors.
+inline __m128 project_pixels(__m128i pixels, __m128i e0, __m128i d) noexcept
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i lo = _mm_madd_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(pixels, zero), e0), d);
+	__m128i hi = _mm_madd_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(pixels, zero), e0), d);
+	lo = _mm_add_epi32(lo, _mm_srli_epi64(lo, 32));
+	hi = _mm_add_epi32(hi, _mm_srli_epi64(hi, 32));
+
+	const __m128 dots = _mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(2, 0, 2, 0));
+	return _mm_cvtepi32_ps(_mm_castps_si128(dots));
+}
+
+// Encodes rgb of 16 rgba_8 pixels into a bc1 color block (8 bytes).
+// End points are the corners of the colors' bounding box inset by 1/16 of its size.
+void encode_color_block(const uint8_t* block, uint8_t* dst) noexcept
+{
+	const __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+	const __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16));
+	const __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 32));
+	const __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 48));
+
+	__m128i mn = _mm_min_epu8(_mm_min_epu8(r0, r1), _mm_min_epu8(r2, r3));
+	__m128i mx = _mm_max_epu8(_mm_max_epu8(r0, r1), _mm_max_epu8(r2, r3));
+	mn = _mm_min_epu8(mn, _mm_shuffle_epi32(mn, _MM_SHUFFLE(2, 3, 0, 1)));
+	mn = _mm_min_epu8(mn, _mm_shuffle_epi32(mn, _MM_SHUFFLE(1, 0, 3, 2)));
+	mx = _mm_max_epu8(mx, _mm_shuffle_epi32(mx, _MM_SHUFFLE(2, 3, 0, 1)));
+	mx = _mm_max_epu8(mx, _mm_shuffle_epi32(mx, _MM_SHUFFLE(1, 0, 3, 2)));
+
+	const uint32_t mn_rgba = uint32_t(_mm_cvtsi128_si32(mn));
+	const uint32_t mx_rgba = uint32_t(_mm_cvtsi128_si32(mx));
+	int lo[3];
+	int hi[3];
+	for (int c = 0; c < 3; ++c) {
+		lo[c] = (mn_rgba >> (8 * c)) & 0xff;
+		hi[c] = (mx_rgba >> (8 * c)) & 0xff;
+		const int inset = (hi[c] - lo[c]) >> 4;
+		lo[c] += inset;
+		hi[c] -= inset;
+	}
+
+	// the box diagonal has to follow the colors: channels which decrease
+	// while the widest channel increases get their end points swapped.
+	int ref = 0;
+	for (int c = 1; c < 3; ++c)
+		if (hi[c] - lo[c] > hi[ref] - lo[ref]) ref = c;
+
+	int mean[3] = { 0, 0, 0 };
+	for (size_t i = 0; i < 16; ++i)
+		for (int c = 0; c < 3; ++c) mean[c] += block[i * 4 + c];
+
+	for (int c = 0; c < 3; ++c) {
+		if (c == ref) continue;
+
+		int cov = 0;
+		for (size_t i = 0; i < 16; ++i)
+			cov += (block[i * 4 + ref] * 16 - mean[ref]) * (block[i * 4 + c] * 16 - mean[c]);
+
+		if (cov < 0) std::swap(lo[c], hi[c]);
+	}
+
+	// c0 > c1 keeps the block in 4 color mode, c0 == c1 means a solid block.
+	uint16_t c0 = pack_565(hi[0], hi[1], hi[2]);
+	uint16_t c1 = pack_565(lo[0], lo[1], lo[2]);
+	if (c0 < c1) std::swap(c0, c1);
+	std::memcpy(dst, &c0, 2);
+	std::memcpy(dst + 2, &c1, 2);
+
+	uint32_t indices = 0;
+	if (c0 != c1) {
+		int e0[3];
+		int e1[3];
+		unpack_565(c0, e0);
+		unpack_565(c1, e1);
+		const int d[3] = { e1[0] - e0[0], e1[1] - e0[1], e1[2] - e0[2] };
+		const int dd = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+
+		const __m128i e0v = _mm_setr_epi16(short(e0[0]), short(e0[1]), short(e0[2]), 0,
+			short(e0[0]), short(e0[1]), short(e0[2]), 0);
+		const __m128i dv = _mm_setr_epi16(short(d[0]), short(d[1]), short(d[2]), 0,
+			short(d[0]), short(d[1]), short(d[2]), 0);
+		const __m128 scale = _mm_set1_ps(3.0f / dd);
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 three = _mm_set1_ps(3.0f);
+
+		// position on the e0 -> e1 segment: 0, 1/3, 2/3, 1 -> palette indices 0, 2, 3, 1.
+		constexpr uint32_t palette_index[4] = { 0, 2, 3, 1 };
+		const __m128i rows[4] = { r0, r1, r2, r3 };
+		for (int r = 0; r < 4; ++r) {
+			__m128 t = _mm_mul_ps(project_pixels(rows[r], e0v, dv), scale);
+			t = _mm_min_ps(_mm_max_ps(_mm_add_ps(t, half), _mm_setzero_ps()), three);
+
+			alignas(16) int32_t pos[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(pos), _mm_cvttps_epi32(t));
+			for (int i = 0; i < 4; ++i)
+				indices |= palette_index[pos[i]] << (2 * (r * 4 + i));
+		}
+	}
+
+	std::memcpy(dst + 4, &indices, 4);
+}
+
+// Encodes the c-th channel of 16 rgba_8 pixels into a bc4 block (8 bytes).
+void encode_channel_block(const uint8_t* block, size_t c, uint8_t* dst) noexcept
+{
+	alignas(16) uint8_t values[16];
+	for (size_t i = 0; i < 16; ++i) values[i] = block[i * 4 + c];
+
+	const __m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(values));
+	__m128i mn = _mm_min_epu8(v, _mm_srli_si128(v, 8));
+	__m128i mx = _mm_max_epu8(v, _mm_srli_si128(v, 8));
+	mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 4));
+	mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 4));
+	mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 2));
+	mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 2));
+	mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 1));
+	mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 1));
+
+	const uint8_t a0 = uint8_t(_mm_cvtsi128_si32(mx));
+	const uint8_t a1 = uint8_t(_mm_cvtsi128_si32(mn));
+	dst[0] = a0;
+	dst[1] = a1;
+
+	uint64_t indices = 0;
+	if (a0 != a1) {
+		// a0 > a1: 8 value mode. Position on the a0 -> a1 segment: 0, 1/7, ..., 1 -> indices 0, 2, ..., 7, 1.
+		constexpr uint64_t palette_index[8] = { 0, 2, 3, 4, 5, 6, 7, 1 };
+		const __m128i zero = _mm_setzero_si128();
+		const __m128 max_v = _mm_set1_ps(float(a0));
+		const __m128 scale = _mm_set1_ps(7.0f / (a0 - a1));
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128i v16[2] = { _mm_unpacklo_epi8(v, zero), _mm_unpackhi_epi8(v, zero) };
+
+		for (int r = 0; r < 4; ++r) {
+			const __m128i v32 = (r % 2 == 0) ? _mm_unpacklo_epi16(v16[r / 2], zero) : _mm_unpackhi_epi16(v16[r / 2], zero);
+			const __m128 t = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(max_v, _mm_cvtepi32_ps(v32)), scale), half);
+
+			alignas(16) int32_t pos[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(pos), _mm_cvttps_epi32(t));
+			for (int i = 0; i < 4; ++i)
+				indices |= palette_index[std::min(pos[i], 7)] << (3 * (r * 4 + i));
+		}
+	}
+
+	for (int i = 0; i < 6; ++i)
+		dst[2 + i] = uint8_t(indices >> (8 * i));
+}
+
+void encode_block(const uint8_t* block, pixel_format format, uint8_t* dst) noexcept
+{
+	switch (format) {
+		default: assert(false); break;
+
+		case pixel_format::bc1:
+			encode_color_block(block, dst);
+			break;
+
+		case pixel_format::bc3:
+			encode_channel_block(block, 3, dst);
+			encode_color_block(block, dst + 8);
+			break;
+
+		case pixel_format::bc4:
+			encode_channel_block(block, 0, dst);
+			break;
+
+		case pixel_format::bc5:
+			encode_channel_block(block, 0, dst);
+			encode_channel_block(block, 1, dst + 8);
+			break;
+	}
+}
+
+} // namespace
+
+
+namespace cg {
+namespace data {
+
+void encode_bc(const image_view& image, pixel_format format, void* dst, thread_pool& pool)
+{
+	assert(image.data);
+	assert(image.size.x > 0 && image.size.y > 0);
+	assert(!is_block_compressed(image.pixel_format));
+	assert(is_block_compressed(format));
+	assert(dst);
+
+	const uint32_t block_count_x = (image.size.x + 3) / 4;
+	const uint32_t block_count_y = (image.size.y + 3) / 4;
+	const size_t block_bytes = block_byte_count(format);
+	uint8_t* blocks = reinterpret_cast<uint8_t*>(dst);
+
+	parallel_for(pool, block_count_y, block_row_grain_size, [&](size_t first, size_t last) {
+		alignas(16) uint8_t block[64];
+
+		for (size_t by = first; by < last; ++by) {
+			uint8_t* d = blocks + by * block_count_x * block_bytes;
+			for (uint32_t bx = 0; bx < block_count_x; ++bx, d += block_bytes) {
+				load_block(image, bx, uint32_t(by), block);
+				encode_block(block, format, d);
+			}
+		}
+	});
+}
+
+image_mip_chain encode_bc(const image_view& image, pixel_format format, thread_pool& pool)
+{
+	image_mip_chain chain(format, image.size, 1);
+	encode_bc(image, format, chain.level_data(0), pool);
+	return chain;
+}
+
+image_mip_chain encode_bc(const image_mip_chain& mip_chain, pixel_format format, thread_pool& pool)
+{
+	assert(mip_chain.level_count() > 0);
+
+	image_mip_chain chain(format, mip_chain.level(0).size, mip_chain.level_count());
+	for (size_t i = 0; i < mip_chain.level_count(); ++i)
+		encode_bc(mip_chain.level(i), format, chain.level_data(i), pool);
+
+	return chain;
+}
+
+} // namespace data
+} // namespace cg
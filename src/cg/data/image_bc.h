@@ -0,0 +1,30 @@
+#ifndef CG_DATA_IMAGE_BC_H_
+#define CG_DATA_IMAGE_BC_H_
+
+#include "cg/data/image.h"
+#include "cg/data/image_mip_chain.h"
+
+
+namespace cg {
+namespace data {
+
+// Block compression (BCn) encoder.
+// The source pixels are read as rgba: missing color channels are 0, missing alpha is 255,
+// float channels are clamped to [0, 1]. Each format takes the channels it needs:
+// bc1 - rgb, bc3 - rgba, bc4 - r, bc5 - rg.
+// Pixels of partial blocks which are outside the image repeat the edge pixels.
+
+// Encodes the image into blocks of the specified bc* format on the workers of the pool.
+// dst must point to at least byte_count(image.size, format) bytes.
+void encode_bc(const image_view& image, pixel_format format, void* dst, thread_pool& pool);
+
+// Encodes the image into blocks of the specified bc* format. Returns a chain of one level.
+image_mip_chain encode_bc(const image_view& image, pixel_format format, thread_pool& pool);
+
+// Encodes all the levels of the mip chain into blocks of the specified bc* format.
+image_mip_chain encode_bc(const image_mip_chain& mip_chain, pixel_format format, thread_pool& pool);
+
+} // namespace data
+} // namespace cg
+
+#endif // CG_DATA_IMAGE_BC_H_
@@ -0,0 +1,151 @@
+#include "cg/data/image_cache.h"
+
+#include <cassert>
+#include <exception>
+#include <utility>
+#include "cg/base/base.h"
+
+
+namespace {
+
+// Unique key of the image_2d constructor params.
+inline std::string make_key(const std::string& filename, uint8_t channel_count, bool flip_vertically)
+{
+	return cg::concat(filename, '|', int(channel_count), '|', int(flip_vertically));
+}
+
+} // namespace
+
+
+namespace cg {
+namespace data {
+
+image_cache::image_cache(size_t budget_byte_count)
+	: budget_byte_count_(budget_byte_count)
+{}
+
+std::shared_ptr<const image_2d> image_cache::get(const std::string& filename, uint8_t channel_count,
+	bool flip_vertically)
+{
+	assert(filename.size() > 0);
+
+	const std::string key = make_key(filename, channel_count, flip_vertically);
+	std::promise<std::shared_ptr<const image_2d>> promise;
+
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		auto it = entries_.find(key);
+
+		if (it != entries_.end()) {
+			entry& e = it->second;
+
+			if (e.image) {
+				lru_.splice(lru_.begin(), lru_, e.lru_it);
+				return e.image;
+			}
+
+			// another thread is decoding the image.
+			if (e.decoding.valid()) {
+				std::shared_future<std::shared_ptr<const image_2d>> decoding = e.decoding;
+				lock.unlock();
+				return decoding.get();
+			}
+
+			// evicted but still held by a user.
+			if (std::shared_ptr<const image_2d> image = e.handed_out.lock()) {
+				make_resident(key, e, image);
+				evict_images();
+				return image;
+			}
+		}
+
+		entries_[key].decoding = promise.get_future().share();
+	}
+
+	std::shared_ptr<const image_2d> image;
+	try {
+		image = std::make_shared<const image_2d>(filename, channel_count, flip_vertically);
+	}
+	catch (...) {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			entries_.erase(key);
+		}
+
+		promise.set_exception(std::current_exception());
+		throw;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		entry& e = entries_[key];
+		// the future would keep the image alive after its eviction.
+		e.decoding = std::shared_future<std::shared_ptr<const image_2d>>();
+		e.handed_out = image;
+		make_resident(key, e, image);
+		evict_images();
+	}
+
+	promise.set_value(image);
+	return image;
+}
+
+void image_cache::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	for (auto it = entries_.begin(); it != entries_.end();) {
+		// images which are being decoded are not resident yet.
+		if (it->second.decoding.valid()) {
+			++it;
+			continue;
+		}
+
+		it->second.image.reset();
+		it = (it->second.handed_out.expired()) ? entries_.erase(it) : std::next(it);
+	}
+
+	lru_.clear();
+	resident_byte_count_ = 0;
+}
+
+size_t image_cache::resident_byte_count() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return resident_byte_count_;
+}
+
+size_t image_cache::resident_image_count() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return lru_.size();
+}
+
+void image_cache::make_resident(const std::string& key, entry& e, std::shared_ptr<const image_2d> image)
+{
+	assert(!e.image);
+
+	resident_byte_count_ += byte_count(*image);
+	e.image = std::move(image);
+	lru_.push_front(key);
+	e.lru_it = lru_.begin();
+}
+
+void image_cache::evict_images()
+{
+	while (resident_byte_count_ > budget_byte_count_ && lru_.size() > 1) {
+		auto it = entries_.find(lru_.back());
+		assert(it != entries_.end());
+
+		resident_byte_count_ -= byte_count(*it->second.image);
+		it->second.image.reset();
+		lru_.pop_back();
+
+		// nobody holds the image, the entry is of no use.
+		if (it->second.handed_out.expired())
+			entries_.erase(it);
+	}
+}
+
+} // namespace data
+} // namespace cg
@@ -0,0 +1,95 @@
+#ifndef CG_DATA_IMAGE_CACHE_H_
+#define CG_DATA_IMAGE_CACHE_H_
+
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "cg/data/image.h"
+
+
+namespace cg {
+namespace data {
+
+// image_cache hands out decoded images which are shared by all the users of the same
+// (filename, channel_count, flip_vertically) key, the key has the meaning of image_2d constructor params.
+// The images are immutable, each one is decoded once even if several threads request it at the same time.
+// The cache keeps the recently used images resident until their total size exceeds the budget,
+// the least recently used ones are released first. An evicted image which is still held by a user
+// is handed out again instead of being decoded one more time.
+// All the methods are thread safe.
+class image_cache final {
+public:
+
+	static constexpr size_t default_budget_byte_count = 256 * 1024 * 1024;
+
+	explicit image_cache(size_t budget_byte_count = default_budget_byte_count);
+
+	image_cache(const image_cache&) = delete;
+
+	image_cache(image_cache&&) = delete;
+
+
+	image_cache& operator=(const image_cache&) = delete;
+
+	image_cache& operator=(image_cache&&) = delete;
+
+
+	size_t budget_byte_count() const noexcept
+	{
+		return budget_byte_count_;
+	}
+
+	// Returns the image, decodes it if it is neither resident nor held by a user.
+	// Rethrows the decoding error, the failed image is decoded again by the next request.
+	std::shared_ptr<const image_2d> get(const std::string& filename, uint8_t channel_count = 0,
+		bool flip_vertically = false);
+
+	// Releases all the resident images. The images which are held by users stay valid.
+	void clear();
+
+	// Returns the total size of the resident images in bytes.
+	size_t resident_byte_count() const;
+
+	// Returns the number of resident images.
+	size_t resident_image_count() const;
+
+private:
+
+	struct entry final {
+		// Valid while the image is being decoded.
+		std::shared_future<std::shared_ptr<const image_2d>> decoding;
+
+		// Non-null while the image is resident.
+		std::shared_ptr<const image_2d> image;
+
+		// Tracks the image after it has been evicted.
+		std::weak_ptr<const image_2d> handed_out;
+
+		// Position in lru_, valid while the image is resident.
+		std::list<std::string>::iterator lru_it;
+	};
+
+	// Makes the image of the entry resident & the most recently used. mutex_ must be locked.
+	void make_resident(const std::string& key, entry& e, std::shared_ptr<const image_2d> image);
+
+	// Evicts the least recently used images until the resident images fit the budget.
+	// The most recently used image is never evicted. mutex_ must be locked.
+	void evict_images();
+
+	const size_t budget_byte_count_;
+
+	mutable std::mutex mutex_;
+	// The most recently used key is the first one.
+	std::list<std::string> lru_;
+	std::unordered_map<std::string, entry> entries_;
+	size_t resident_byte_count_ = 0;
+};
+
+} // namespace data
+} // namespace cg
+
+#endif // CG_DATA_IMAGE_CACHE_H_
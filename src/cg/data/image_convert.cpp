@@ -0,0 +1,364 @@
+#include "cg/data/image_convert.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include "cg/base/cpu.h"
+#include "cg/base/half.h"
+
+
+namespace {
+
+using cg::data::is_float_format;
+using cg::data::is_half_format;
+using cg::data::pixel_format;
+
+// Converts pixel_count pixels of one row (or of several tightly packed rows).
+using row_kernel = void(*)(const void* src, void* dst, size_t pixel_count);
+
+inline uint8_t to_unorm_8(float v) noexcept
+{
+	// rounds to nearest even as _mm_cvtps_epi32 does.
+	return uint8_t(std::lrint(std::min(std::max(v, 0.0f), 1.0f) * 255.0f));
+}
+
+// ----- 8-bit kernels -----
+
+void rgb8_to_rgba8(const void* src, void* dst, size_t pixel_count)
+{
+	const uint8_t* s = reinterpret_cast<const uint8_t*>(src);
+	uint8_t* d = reinterpret_cast<uint8_t*>(dst);
+	for (size_t i = 0; i < pixel_count; ++i, s += 3, d += 4) {
+		d[0] = s[0];
+		d[1] = s[1];
+		d[2] = s[2];
+		d[3] = 255;
+	}
+}
+
+void rgb8_to_rgba8_ssse3(const void* src, void* dst, size_t pixel_count)
+{
+	const uint8_t* s = reinterpret_cast<const uint8_t*>(src);
+	uint8_t* d = reinterpret_cast<uint8_t*>(dst);
+	const __m128i mask = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m128i alpha = _mm_set1_epi32(int(0xff000000));
+
+	// 16 pixels: 48 bytes -> 64 bytes.
+	size_t i = 0;
+	for (; i + 16 <= pixel_count; i += 16, s += 48, d += 64) {
+		const __m128i in0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+		const __m128i in1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 16));
+		const __m128i in2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 32));
+
+		const __m128i p0 = _mm_shuffle_epi8(in0, mask);
+		const __m128i p1 = _mm_shuffle_epi8(_mm_alignr_epi8(in1, in0, 12), mask);
+		const __m128i p2 = _mm_shuffle_epi8(_mm_alignr_epi8(in2, in1, 8), mask);
+		const __m128i p3 = _mm_shuffle_epi8(_mm_srli_si128(in2, 4), mask);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(d), _mm_or_si128(p0, alpha));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(d + 16), _mm_or_si128(p1, alpha));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(d + 32), _mm_or_si128(p2, alpha));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(d + 48), _mm_or_si128(p3, alpha));
+	}
+
+	rgb8_to_rgba8(s, d, pixel_count - i);
+}
+
+void rgba8_to_rgb8(const void* src, void* dst, size_t pixel_count)
+{
+	const uint8_t* s = reinterpret_cast<const uint8_t*>(src);
+	uint8_t* d = reinterpret_cast<uint8_t*>(dst);
+	for (size_t i = 0; i < pixel_count; ++i, s += 4, d += 3) {
+		d[0] = s[0];
+		d[1] = s[1];
+		d[2] = s[2];
+	}
+}
+
+void rgba8_to_rgb8_ssse3(const void* src, void* dst, size_t pixel_count)
+{
+	const uint8_t* s = reinterpret_cast<const uint8_t*>(src);
+	uint8_t* d = reinterpret_cast<uint8_t*>(dst);
+	const __m128i mask = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+	// 16 pixels: 64 bytes -> 48 bytes.
+	size_t i = 0;
+	for (; i + 16 <= pixel_count; i += 16, s += 64, d += 48) {
+		const __m128i p0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s)), mask);
+		const __m128i p1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 16)), mask);
+		const __m128i p2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 32)), mask);
+		const __m128i p3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 48)), mask);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(d), _mm_or_si128(p0, _mm_slli_si128(p1, 12)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(d + 16), _mm_or_si128(_mm_srli_si128(p1, 4), _mm_slli_si128(p2, 8)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(d + 32), _mm_or_si128(_mm_srli_si128(p2, 8), _mm_slli_si128(p3, 4)));
+	}
+
+	rgba8_to_rgb8(s, d, pixel_count - i);
+}
+
+void red8_to_rgba8(const void* src, void* dst, size_t pixel_count)
+{
+	const uint8_t* s = reinterpret_cast<const uint8_t*>(src);
+	uint8_t* d = reinterpret_cast<uint8_t*>(dst);
+	const __m128i alpha = _mm_set1_epi32(int(0xff000000));
+
+	// 16 pixels: 16 bytes -> 64 bytes.
+	size_t i = 0;
+	for (; i + 16 <= pixel_count; i += 16, s += 16, d += 64) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+		const __m128i lo = _mm_unpacklo_epi8(v, v);
+		const __m128i hi = _mm_unpackhi_epi8(v, v);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(d), _mm_or_si128(_mm_unpacklo_epi16(lo, lo), alpha));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(d + 16), _mm_or_si128(_mm_unpackhi_epi16(lo, lo), alpha));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(d + 32), _mm_or_si128(_mm_unpacklo_epi16(hi, hi), alpha));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(d + 48), _mm_or_si128(_mm_unpackhi_epi16(hi, hi), alpha));
+	}
+
+	for (; i < pixel_count; ++i, ++s, d += 4) {
+		d[0] = d[1] = d[2] = s[0];
+		d[3] = 255;
+	}
+}
+
+void red8_to_rgb8(const void* src, void* dst, size_t pixel_count)
+{
+	const uint8_t* s = reinterpret_cast<const uint8_t*>(src);
+	uint8_t* d = reinterpret_cast<uint8_t*>(dst);
+	for (size_t i = 0; i < pixel_count; ++i, ++s, d += 3)
+		d[0] = d[1] = d[2] = s[0];
+}
+
+// ----- float <-> 8-bit kernels of the same channel count -----
+
+template<size_t channel_count>
+void f32_to_u8(const void* src, void* dst, size_t pixel_count)
+{
+	const float* s = reinterpret_cast<const float*>(src);
+	uint8_t* d = reinterpret_cast<uint8_t*>(dst);
+	const size_t count = pixel_count * channel_count;
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set1_ps(255.0f);
+
+	// 16 channels per iteration.
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		__m128i v[4];
+		for (size_t k = 0; k < 4; ++k) {
+			const __m128 f = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(s + i + k * 4), zero), one);
+			v[k] = _mm_cvtps_epi32(_mm_mul_ps(f, scale));
+		}
+
+		const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(v[0], v[1]), _mm_packs_epi32(v[2], v[3]));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), packed);
+	}
+
+	for (; i < count; ++i)
+		d[i] = to_unorm_8(s[i]);
+}
+
+template<size_t channel_count>
+void u8_to_f32(const void* src, void* dst, size_t pixel_count)
+{
+	const uint8_t* s = reinterpret_cast<const uint8_t*>(src);
+	float* d = reinterpret_cast<float*>(dst);
+	const size_t count = pixel_count * channel_count;
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+
+	// 16 channels per iteration.
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+		const __m128i lo = _mm_unpacklo_epi8(v, zero);
+		const __m128i hi = _mm_unpackhi_epi8(v, zero);
+
+		_mm_storeu_ps(d + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+		_mm_storeu_ps(d + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+		_mm_storeu_ps(d + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+		_mm_storeu_ps(d + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+	}
+
+	for (; i < count; ++i)
+		d[i] = s[i] * (1.0f / 255.0f);
+}
+
+// ----- float <-> half kernels of the same channel count -----
+
+template<size_t channel_count>
+void f32_to_f16(const void* src, void* dst, size_t pixel_count)
+{
+	cg::float_to_half(reinterpret_cast<const float*>(src), reinterpret_cast<uint16_t*>(dst),
+		pixel_count * channel_count);
+}
+
+template<size_t channel_count>
+void f16_to_f32(const void* src, void* dst, size_t pixel_count)
+{
+	cg::half_to_float(reinterpret_cast<const uint16_t*>(src), reinterpret_cast<float*>(dst),
+		pixel_count * channel_count);
+}
+
+// ----- generic conversion -----
+
+// Reads one pixel as rgba.
+inline void load_pixel(const void* src, size_t index, pixel_format fmt, float* rgba) noexcept
+{
+	const size_t cc = cg::data::channel_count(fmt);
+	rgba[0] = rgba[1] = rgba[2] = 0.0f;
+	rgba[3] = 1.0f;
+
+	if (is_half_format(fmt)) {
+		const uint16_t* p = reinterpret_cast<const uint16_t*>(src) + index * cc;
+		cg::half_to_float(p, rgba, cc);
+	}
+	else if (is_float_format(fmt)) {
+		const float* p = reinterpret_cast<const float*>(src) + index * cc;
+		for (size_t c = 0; c < cc; ++c) rgba[c] = p[c];
+	}
+	else {
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(src) + index * cc;
+		for (size_t c = 0; c < cc; ++c) rgba[c] = p[c] * (1.0f / 255.0f);
+	}
+
+	if (cc == 1) rgba[1] = rgba[2] = rgba[0];
+}
+
+inline void store_pixel(const float* rgba, void* dst, size_t index, pixel_format fmt) noexcept
+{
+	const size_t cc = cg::data::channel_count(fmt);
+
+	if (is_half_format(fmt)) {
+		uint16_t* p = reinterpret_cast<uint16_t*>(dst) + index * cc;
+		cg::float_to_half(rgba, p, cc);
+	}
+	else if (is_float_format(fmt)) {
+		float* p = reinterpret_cast<float*>(dst) + index * cc;
+		for (size_t c = 0; c < cc; ++c) p[c] = rgba[c];
+	}
+	else {
+		uint8_t* p = reinterpret_cast<uint8_t*>(dst) + index * cc;
+		for (size_t c = 0; c < cc; ++c) p[c] = to_unorm_8(rgba[c]);
+	}
+}
+
+void convert_generic(const void* src, pixel_format src_format, void* dst, pixel_format dst_format, size_t pixel_count)
+{
+	float rgba[4];
+	for (size_t i = 0; i < pixel_count; ++i) {
+		load_pixel(src, i, src_format, rgba);
+		store_pixel(rgba, dst, i, dst_format);
+	}
+}
+
+// Number of rows which are converted by one task.
+constexpr size_t row_grain_size = 64;
+
+// Returns a vectorized kernel for the conversion or nullptr if there is no such kernel.
+row_kernel select_kernel(pixel_format src_format, pixel_format dst_format) noexcept
+{
+	const bool ssse3 = cg::get_cpu_features().ssse3;
+
+	if (src_format == pixel_format::rgb_8 && dst_format == pixel_format::rgba_8)
+		return (ssse3) ? rgb8_to_rgba8_ssse3 : rgb8_to_rgba8;
+	if (src_format == pixel_format::rgba_8 && dst_format == pixel_format::rgb_8)
+		return (ssse3) ? rgba8_to_rgb8_ssse3 : rgba8_to_rgb8;
+	if (src_format == pixel_format::red_8 && dst_format == pixel_format::rgba_8)
+		return red8_to_rgba8;
+	if (src_format == pixel_format::red_8 && dst_format == pixel_format::rgb_8)
+		return red8_to_rgb8;
+	if (src_format == pixel_format::rgb_32f && dst_format == pixel_format::rgb_8)
+		return f32_to_u8<3>;
+	if (src_format == pixel_format::rgba_32f && dst_format == pixel_format::rgba_8)
+		return f32_to_u8<4>;
+	if (src_format == pixel_format::rgb_8 && dst_format == pixel_format::rgb_32f)
+		return u8_to_f32<3>;
+	if (src_format == pixel_format::rgba_8 && dst_format == pixel_format::rgba_32f)
+		return u8_to_f32<4>;
+	if (src_format == pixel_format::rg_32f && dst_format == pixel_format::rg_16f)
+		return f32_to_f16<2>;
+	if (src_format == pixel_format::rgb_32f && dst_format == pixel_format::rgb_16f)
+		return f32_to_f16<3>;
+	if (src_format == pixel_format::rgba_32f && dst_format == pixel_format::rgba_16f)
+		return f32_to_f16<4>;
+	if (src_format == pixel_format::rg_16f && dst_format == pixel_format::rg_32f)
+		return f16_to_f32<2>;
+	if (src_format == pixel_format::rgb_16f && dst_format == pixel_format::rgb_32f)
+		return f16_to_f32<3>;
+	if (src_format == pixel_format::rgba_16f && dst_format == pixel_format::rgba_32f)
+		return f16_to_f32<4>;
+
+	return nullptr;
+}
+
+} // namespace
+
+
+namespace cg {
+namespace data {
+
+void convert(const image_view& src, pixel_format dst_format, void* dst, bool flip_vertically)
+{
+	assert(src.data);
+	assert(dst);
+	assert(src.pixel_format != pixel_format::none && dst_format != pixel_format::none);
+	assert(!is_block_compressed(src.pixel_format) && !is_block_compressed(dst_format));
+
+	if (src.data == dst) {
+		assert(src.pixel_format == dst_format);
+		if (flip_vertically) data::flip_vertically(dst, src.size, dst_format);
+		return;
+	}
+
+	const size_t src_row_byte_count = src.size.x * byte_count(src.pixel_format);
+	const size_t dst_row_byte_count = src.size.x * byte_count(dst_format);
+	const row_kernel kernel = select_kernel(src.pixel_format, dst_format);
+
+	// rows are converted in one go unless they have to be reordered.
+	const size_t row_count = (flip_vertically) ? src.size.y : 1;
+	const size_t pixel_count = (flip_vertically) ? src.size.x : square(src.size);
+
+	for (size_t y = 0; y < row_count; ++y) {
+		const size_t dst_y = (flip_vertically) ? (row_count - 1 - y) : y;
+		const void* s = reinterpret_cast<const uint8_t*>(src.data) + y * src_row_byte_count;
+		void* d = reinterpret_cast<uint8_t*>(dst) + dst_y * dst_row_byte_count;
+
+		if (src.pixel_format == dst_format)
+			std::memcpy(d, s, pixel_count * byte_count(dst_format));
+		else if (kernel)
+			kernel(s, d, pixel_count);
+		else
+			convert_generic(s, src.pixel_format, d, dst_format, pixel_count);
+	}
+}
+
+void convert(const image_view& src, pixel_format dst_format, void* dst, thread_pool& pool)
+{
+	assert(src.data);
+	assert(dst);
+	assert(src.data != dst);
+
+	const size_t src_row_byte_count = src.size.x * byte_count(src.pixel_format);
+	const size_t dst_row_byte_count = src.size.x * byte_count(dst_format);
+
+	parallel_for(pool, src.size.y, row_grain_size, [&](size_t first, size_t last) {
+		const image_view rows(reinterpret_cast<const uint8_t*>(src.data) + first * src_row_byte_count,
+			uint2(src.size.x, uint32_t(last - first)), src.pixel_format);
+		convert(rows, dst_format, reinterpret_cast<uint8_t*>(dst) + first * dst_row_byte_count);
+	});
+}
+
+image_2d convert(const image_view& src, pixel_format dst_format, bool flip_vertically)
+{
+	image_2d image(src.size, dst_format);
+	convert(src, dst_format, image.data, flip_vertically);
+	return image;
+}
+
+} // namespace data
+} // namespace cg
@@ -0,0 +1,33 @@
+#ifndef CG_DATA_IMAGE_CONVERT_H_
+#define CG_DATA_IMAGE_CONVERT_H_
+
+#include "cg/base/thread_pool.h"
+#include "cg/data/image.h"
+
+
+namespace cg {
+namespace data {
+
+// Pixel format conversion.
+// Channels which the source format does not have are filled as follows:
+// red_8 is replicated into rgb (grayscale), other missing color channels are 0, missing alpha is opaque.
+// Float channels are clamped to [0, 1] when converted to 8-bit ones.
+// Block compressed formats are not supported.
+
+// Converts the pixels of src into dst_format and writes them into dst.
+// dst must point to byte_count(src.size, dst_format) bytes.
+// If flip_vertically is set the first row of src becomes the last row of dst.
+// dst may be equal to src.data only if dst_format == src.pixel_format, the image is flipped in place.
+void convert(const image_view& src, pixel_format dst_format, void* dst, bool flip_vertically = false);
+
+// Converts the pixels of src into dst_format on the workers of the pool, rows are split between the tasks.
+// dst must point to byte_count(src.size, dst_format) bytes and must not overlap src.
+void convert(const image_view& src, pixel_format dst_format, void* dst, thread_pool& pool);
+
+// Returns a new image which stores the pixels of src converted into dst_format.
+image_2d convert(const image_view& src, pixel_format dst_format, bool flip_vertically = false);
+
+} // namespace data
+} // namespace cg
+
+#endif // CG_DATA_IMAGE_CONVERT_H_
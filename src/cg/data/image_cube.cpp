@@ -0,0 +1,221 @@
+#include "cg/data/image_cube.h"
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <emmintrin.h>
+#include "cg/base/base.h"
+#include "cg/data/image_convert.h"
+#include "cg/data/image_disk_cache.h"
+#include "cg/data/pack.h"
+
+
+namespace {
+
+using cg::data::cube_face;
+using cg::data::cube_face_count;
+using cg::data::image_2d;
+using cg::data::image_view;
+using cg::data::pixel_format;
+
+// Number of face rows which are processed by one task.
+constexpr size_t row_grain_size = 8;
+
+constexpr double pi = 3.14159265358979323846;
+
+// Samples the rgba_32f panorama at (u, v). u wraps around, v is clamped.
+inline __m128 sample_bilinear(const float* pixels, const uint2& size, float u, float v) noexcept
+{
+	const float fx = u * size.x - 0.5f;
+	const float fy = std::min(std::max(v * size.y - 0.5f, 0.0f), float(size.y - 1));
+	const float x0f = std::floor(fx);
+	const float y0f = std::floor(fy);
+	const __m128 tx = _mm_set1_ps(fx - x0f);
+	const __m128 ty = _mm_set1_ps(fy - y0f);
+
+	const ptrdiff_t w = ptrdiff_t(size.x);
+	const size_t x0 = size_t(((ptrdiff_t(x0f) % w) + w) % w);
+	const size_t x1 = (x0 + 1 == size.x) ? 0 : x0 + 1;
+	const size_t y0 = size_t(y0f);
+	const size_t y1 = std::min(y0 + 1, size_t(size.y - 1));
+
+	const __m128 p00 = _mm_loadu_ps(pixels + (y0 * size.x + x0) * 4);
+	const __m128 p01 = _mm_loadu_ps(pixels + (y0 * size.x + x1) * 4);
+	const __m128 p10 = _mm_loadu_ps(pixels + (y1 * size.x + x0) * 4);
+	const __m128 p11 = _mm_loadu_ps(pixels + (y1 * size.x + x1) * 4);
+
+	const __m128 top = _mm_add_ps(p00, _mm_mul_ps(_mm_sub_ps(p01, p00), tx));
+	const __m128 bottom = _mm_add_ps(p10, _mm_mul_ps(_mm_sub_ps(p11, p10), tx));
+	return _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), ty));
+}
+
+// Projects the row y of the face, writes side_size float4 pixels into dst.
+void project_row(const float* panorama, const uint2& panorama_size, cube_face face, uint32_t side_size,
+	uint32_t y, float* dst) noexcept
+{
+	const float inv_side_size = 1.0f / side_size;
+	const float v = (y + 0.5f) * inv_side_size;
+
+	for (uint32_t x = 0; x < side_size; ++x) {
+		const float3 d = cg::data::cube_direction(face, (x + 0.5f) * inv_side_size, v);
+		const float len = std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
+
+		const float pu = float(std::atan2(d.z, d.x) / (2.0 * pi) + 0.5);
+		const float pv = float(0.5 - std::asin(std::min(std::max(d.y / len, -1.0f), 1.0f)) / pi);
+		_mm_storeu_ps(dst + x * 4, sample_bilinear(panorama, panorama_size, pu, pv));
+	}
+}
+
+// Projects the panorama onto the faces of a cube, returns them as one side x (6 * side) image of the format fmt.
+image_2d project_faces(const image_view& panorama, uint32_t side_size, pixel_format fmt, cg::thread_pool& pool)
+{
+	// the sampler reads rgba_32f pixels, panoramas of other formats are converted once.
+	image_2d pixels;
+	const float* p = reinterpret_cast<const float*>(panorama.data);
+	if (panorama.pixel_format != pixel_format::rgba_32f) {
+		pixels = image_2d(panorama.size, pixel_format::rgba_32f);
+		convert(panorama, pixel_format::rgba_32f, pixels.data, pool);
+		p = reinterpret_cast<const float*>(pixels.data);
+	}
+
+	image_2d faces(uint2(side_size, side_size * uint32_t(cube_face_count)), fmt);
+	const size_t row_byte_count = side_size * byte_count(fmt);
+	unsigned char* dst = reinterpret_cast<unsigned char*>(faces.data);
+
+	// the rows of all the faces are one range.
+	cg::parallel_for(pool, size_t(side_size) * cube_face_count, row_grain_size, [&](size_t first, size_t last) {
+		std::vector<float> row(side_size * 4);
+
+		for (size_t r = first; r < last; ++r) {
+			const cube_face face = cube_face(r / side_size);
+			project_row(p, panorama.size, face, side_size, uint32_t(r % side_size), row.data());
+			convert(image_view(row.data(), uint2(side_size, 1), pixel_format::rgba_32f),
+				fmt, dst + r * row_byte_count);
+		}
+	});
+
+	return faces;
+}
+
+} // namespace
+
+
+namespace cg {
+namespace data {
+
+// ----- image_cube -----
+
+image_cube::image_cube(uint32_t side_size, pixel_format fmt)
+	: faces_(image_2d(uint2(side_size, side_size * uint32_t(cube_face_count)), fmt)),
+	side_size_(side_size)
+{
+	assert(side_size > 0);
+	assert(fmt != pixel_format::none);
+}
+
+image_cube::image_cube(cached_image&& faces) noexcept
+	: faces_(std::move(faces)),
+	side_size_(faces_.view().size.x)
+{
+	assert(side_size_ > 0);
+	assert(faces_.view().size.y == side_size_ * uint32_t(cube_face_count));
+	assert(faces_.view().pixel_format != pixel_format::none);
+}
+
+image_view image_cube::face(cube_face face) const noexcept
+{
+	assert(size_t(face) < cube_face_count);
+	const image_view& v = faces_.view();
+	const size_t face_byte_count = byte_count(uint2(side_size_, side_size_), v.pixel_format);
+	return image_view(static_cast<const unsigned char*>(v.data) + size_t(face) * face_byte_count,
+		uint2(side_size_, side_size_), v.pixel_format);
+}
+
+void* image_cube::face_data(cube_face face) noexcept
+{
+	assert(size_t(face) < cube_face_count);
+	const size_t face_byte_count = byte_count(uint2(side_size_, side_size_), format());
+	return static_cast<unsigned char*>(faces_.data()) + size_t(face) * face_byte_count;
+}
+
+image_view image_cube::faces() const noexcept
+{
+	return faces_.view();
+}
+
+// ----- funcs -----
+
+float3 cube_direction(cube_face face, float u, float v) noexcept
+{
+	const float s = 2.0f * u - 1.0f;
+	const float t = 2.0f * v - 1.0f;
+
+	switch (face) {
+		default:
+		case cube_face::positive_x: return float3(1.0f, -t, -s);
+		case cube_face::negative_x: return float3(-1.0f, -t, s);
+		case cube_face::positive_y: return float3(s, 1.0f, t);
+		case cube_face::negative_y: return float3(s, -1.0f, -t);
+		case cube_face::positive_z: return float3(s, -t, 1.0f);
+		case cube_face::negative_z: return float3(-s, -t, -1.0f);
+	}
+}
+
+cube_face cube_face_uv(const float3& direction, float2& uv) noexcept
+{
+	const float ax = std::abs(direction.x);
+	const float ay = std::abs(direction.y);
+	const float az = std::abs(direction.z);
+	assert(ax > 0.0f || ay > 0.0f || az > 0.0f);
+
+	cube_face face;
+	float s, t;
+	if (ax >= ay && ax >= az) {
+		face = (direction.x > 0.0f) ? cube_face::positive_x : cube_face::negative_x;
+		s = ((direction.x > 0.0f) ? -direction.z : direction.z) / ax;
+		t = -direction.y / ax;
+	}
+	else if (ay >= az) {
+		face = (direction.y > 0.0f) ? cube_face::positive_y : cube_face::negative_y;
+		s = direction.x / ay;
+		t = ((direction.y > 0.0f) ? direction.z : -direction.z) / ay;
+	}
+	else {
+		face = (direction.z > 0.0f) ? cube_face::positive_z : cube_face::negative_z;
+		s = ((direction.z > 0.0f) ? direction.x : -direction.x) / az;
+		t = -direction.y / az;
+	}
+
+	uv = float2(0.5f * s + 0.5f, 0.5f * t + 0.5f);
+	return face;
+}
+
+image_cube equirect_to_cube(const image_view& panorama, uint32_t side_size, thread_pool& pool)
+{
+	assert(panorama.data);
+	assert(panorama.size.x > 0 && panorama.size.y > 0);
+	assert(panorama.pixel_format != pixel_format::none);
+	assert(!is_block_compressed(panorama.pixel_format));
+	assert(side_size > 0);
+
+	return image_cube(cached_image(project_faces(panorama, side_size, panorama.pixel_format, pool)));
+}
+
+image_cube load_cube_cached(const std::string& filename, uint32_t side_size, pixel_format fmt, thread_pool& pool)
+{
+	assert(side_size > 0);
+	assert(fmt != pixel_format::none);
+	assert(!is_block_compressed(fmt));
+
+	const auto project = [&] { return project_faces(image_2d(filename, 4), side_size, fmt, pool); };
+
+	cgimg_source source;
+	if (!get_cgimg_source(filename, 4, false, false, source)) return image_cube(cached_image(project()));
+
+	// the cube params are a part of the source description.
+	source.hash = pack_path_hash(concat(source.hash, '|', side_size, '|', int(fmt)));
+	return image_cube(load_cgimg_or_compute(concat(filename, ".cube", side_size, ".cgimg"), source, project));
+}
+
+} // namespace data
+} // namespace cg
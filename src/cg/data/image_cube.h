@@ -0,0 +1,102 @@
+#ifndef CG_DATA_IMAGE_CUBE_H_
+#define CG_DATA_IMAGE_CUBE_H_
+
+#include <string>
+#include <vector>
+#include "cg/base/math.h"
+#include "cg/base/thread_pool.h"
+#include "cg/data/image.h"
+#include "cg/data/image_disk_cache.h"
+
+
+namespace cg {
+namespace data {
+
+// Faces of a cube map in the order of D3D11 texture array slices & GL_TEXTURE_CUBE_MAP_POSITIVE_X + i.
+enum class cube_face : unsigned char {
+	positive_x,
+	negative_x,
+	positive_y,
+	negative_y,
+	positive_z,
+	negative_z
+};
+
+constexpr size_t cube_face_count = 6;
+
+// image_cube stores 6 square faces of the same size & pixel format.
+// The faces are stored one after another in one buffer, so all of them can be viewed
+// as a single side x (6 * side) image (see image_cube::faces).
+// The buffer is either allocated or mapped from a .cgimg file, mapped faces are read-only.
+class image_cube final {
+public:
+
+	image_cube() noexcept = default;
+
+	// Allocates uninitialized faces.
+	image_cube(uint32_t side_size, pixel_format fmt);
+
+	// Takes the faces stored as a single side x (6 * side) image.
+	explicit image_cube(cached_image&& faces) noexcept;
+
+	image_cube(const image_cube&) = delete;
+
+	image_cube(image_cube&&) noexcept = default;
+
+
+	image_cube& operator=(const image_cube&) = delete;
+
+	image_cube& operator=(image_cube&&) noexcept = default;
+
+
+	image_view face(cube_face face) const noexcept;
+
+	// The faces must not be mapped.
+	void* face_data(cube_face face) noexcept;
+
+	// All the faces as one image, the face i occupies the rows [i * side_size, (i + 1) * side_size).
+	image_view faces() const noexcept;
+
+	pixel_format format() const noexcept
+	{
+		return faces_.view().pixel_format;
+	}
+
+	// Returns true if the faces are mapped from a .cgimg file.
+	bool is_mapped() const noexcept
+	{
+		return faces_.is_mapped();
+	}
+
+	uint32_t side_size() const noexcept
+	{
+		return side_size_;
+	}
+
+private:
+	cached_image faces_;
+	uint32_t side_size_ = 0;
+};
+
+// Returns the direction (not normalized) which passes through the point (u, v) of the face.
+// u & v are in [0, 1], (0, 0) is the top left corner of the face. Faces are oriented as D3D & OpenGL define.
+float3 cube_direction(cube_face face, float u, float v) noexcept;
+
+// Returns the face which the direction passes through & writes the point of the face into uv.
+// The inverse of cube_direction. direction must not be zero.
+cube_face cube_face_uv(const float3& direction, float2& uv) noexcept;
+
+// Projects the equirectangular panorama onto the faces of a cube. The panorama is sampled bilinearly.
+// The top row of the panorama is +Y, the horizontal coordinate is atan2(z, x) / (2 pi) + 0.5.
+// The cube has the pixel format of the panorama. Rows of the faces are split between the workers of the pool.
+image_cube equirect_to_cube(const image_view& panorama, uint32_t side_size, thread_pool& pool);
+
+// Loads the equirectangular panorama, projects it onto a cube of the specified format & caches the faces
+// in a .cgimg file next to the source file. The cache is used while the source file does not change,
+// the returned faces are mapped from it.
+image_cube load_cube_cached(const std::string& filename, uint32_t side_size, pixel_format fmt, thread_pool& pool);
+
+} // namespace data
+} // namespace cg
+
+#endif // CG_DATA_IMAGE_CUBE_H_
@@ -0,0 +1,162 @@
+#include "cg/data/image_disk_cache.h"
+
+#include <cassert>
+#include <cstdio>
+#include <functional>
+#include <thread>
+#include <windows.h>
+#include "cg/base/base.h"
+#include "cg/data/pack.h"
+
+
+namespace {
+
+using cg::data::cgimg_header;
+
+// Pixels follow the header, 64 bytes header keeps them aligned for SIMD loads.
+constexpr uint64_t cgimg_data_offset = sizeof(cgimg_header);
+
+// A corrupted header might contain any value.
+bool is_valid_pixel_format(cg::data::pixel_format fmt) noexcept
+{
+	using cg::data::pixel_format;
+	return (pixel_format::none < fmt) && (fmt <= pixel_format::rg_16f);
+}
+
+} // namespace
+
+
+namespace cg {
+namespace data {
+
+std::string cgimg_filename(const std::string& filename, uint8_t channel_count, bool flip_vertically,
+	bool half_float)
+{
+	return concat(filename, '.', int(channel_count), (flip_vertically) ? "f" : "", (half_float) ? "h" : "", ".cgimg");
+}
+
+bool get_cgimg_source(const std::string& filename, uint8_t channel_count, bool flip_vertically,
+	bool half_float, cgimg_source& source)
+{
+	WIN32_FILE_ATTRIBUTE_DATA attribs;
+	if (!GetFileAttributesEx(filename.c_str(), GetFileExInfoStandard, &attribs)) return false;
+
+	const std::string key = concat(normalize_pack_path(filename), '|', int(channel_count), '|', flip_vertically,
+		'|', half_float);
+	source.hash = pack_path_hash(key);
+	source.byte_count = (uint64_t(attribs.nFileSizeHigh) << 32) | attribs.nFileSizeLow;
+	source.write_time = (uint64_t(attribs.ftLastWriteTime.dwHighDateTime) << 32)
+		| attribs.ftLastWriteTime.dwLowDateTime;
+
+	return true;
+}
+
+cached_image load_image_cached(const std::string& filename, uint8_t channel_count, bool flip_vertically,
+	bool half_float)
+{
+	cgimg_source source;
+	if (!get_cgimg_source(filename, channel_count, flip_vertically, half_float, source))
+		return cached_image(image_2d(filename, channel_count, flip_vertically, half_float));
+
+	return load_cgimg_or_compute(cgimg_filename(filename, channel_count, flip_vertically, half_float), source,
+		[&] { return image_2d(filename, channel_count, flip_vertically, half_float); });
+}
+
+cached_image load_cgimg_or_compute(const std::string& filename, const cgimg_source& source,
+	const std::function<image_2d()>& compute)
+{
+	cached_image cached = map_cgimg(filename, source);
+	if (cached.is_mapped()) return cached;
+
+	image_2d image = compute();
+	try {
+		write_cgimg(filename, image, source);
+	}
+	catch (...) {
+		// the cache is an optimization, the image has been computed anyway.
+	}
+
+	return cached_image(std::move(image));
+}
+
+cached_image map_cgimg(const std::string& filename, const cgimg_source& source)
+{
+	cached_image cached = map_cgimg(filename);
+	if (!cached.is_mapped()) return cached;
+
+	const cgimg_header* header = cached.header();
+	const bool up_to_date = (header->source_hash == source.hash)
+		&& (header->source_byte_count == source.byte_count)
+		&& (header->source_write_time == source.write_time);
+
+	return (up_to_date) ? std::move(cached) : cached_image();
+}
+
+cached_image map_cgimg(const std::string& filename)
+{
+	// caches live next to their sources on disk, a pack might store a stale copy of one.
+	if (GetFileAttributes(filename.c_str()) == INVALID_FILE_ATTRIBUTES) return cached_image();
+
+	Mapped_file file(filename, false);
+	if (file.byte_count() < sizeof(cgimg_header)) return cached_image();
+
+	const cgimg_header* header = reinterpret_cast<const cgimg_header*>(file.data());
+	if (!is_valid_pixel_format(header->pixel_format)) return cached_image();
+
+	const uint64_t expected_byte_count = byte_count(uint2(header->width, header->height), header->pixel_format);
+	const bool valid = (header->magic == cgimg_header::magic_value)
+		&& (header->version == cgimg_header::version_value)
+		&& (header->data_byte_count == expected_byte_count)
+		&& (header->data_offset <= file.byte_count())
+		&& (header->data_byte_count <= file.byte_count() - header->data_offset);
+
+	if (!valid) return cached_image();
+
+	const image_view view(file.data() + header->data_offset,
+		uint2(header->width, header->height), header->pixel_format);
+
+	return cached_image(std::move(file), view);
+}
+
+#pragma warning(push)
+#pragma warning(disable:4996)
+void write_cgimg(const std::string& filename, const image_view& image, const cgimg_source& source)
+{
+	assert(image.data);
+
+	cgimg_header header = {};
+	header.magic = cgimg_header::magic_value;
+	header.version = cgimg_header::version_value;
+	header.width = image.size.x;
+	header.height = image.size.y;
+	header.pixel_format = image.pixel_format;
+	header.data_offset = cgimg_data_offset;
+	header.data_byte_count = byte_count(image);
+	header.source_hash = source.hash;
+	header.source_byte_count = source.byte_count;
+	header.source_write_time = source.write_time;
+
+	// several threads might cache the same image at the same time.
+	const std::string tmp_filename = concat(filename, '.',
+		std::hash<std::thread::id>()(std::this_thread::get_id()), ".tmp");
+
+	FILE* handle = std::fopen(tmp_filename.c_str(), "wb");
+	ENFORCE(handle, "Failed to create file: ", tmp_filename);
+
+	const bool res = (std::fwrite(&header, sizeof(header), 1, handle) == 1)
+		&& (std::fwrite(image.data, 1, size_t(header.data_byte_count), handle) == header.data_byte_count);
+
+	if (std::fclose(handle) != 0 || !res) {
+		DeleteFile(tmp_filename.c_str());
+		throw std::runtime_error(EXCEPTION_MSG("Failed to write file: ", tmp_filename));
+	}
+
+	if (!MoveFileEx(tmp_filename.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+		DeleteFile(tmp_filename.c_str());
+		throw std::runtime_error(EXCEPTION_MSG("Failed to write file: ", filename));
+	}
+}
+#pragma warning(pop)
+
+} // namespace data
+} // namespace cg
@@ -0,0 +1,142 @@
+#ifndef CG_DATA_IMAGE_DISK_CACHE_H_
+#define CG_DATA_IMAGE_DISK_CACHE_H_
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "cg/data/file.h"
+#include "cg/data/image.h"
+
+
+namespace cg {
+namespace data {
+
+// .cgimg file stores decoded pixels of an image: cgimg_header followed by the pixels.
+// Rows are tightly packed, the first pixel is at cgimg_header::data_offset.
+// The pixels are mapped and used as they are, no decoding is required.
+struct cgimg_header final {
+	static constexpr uint32_t magic_value = 0x474d4943; // "CIMG"
+	static constexpr uint32_t version_value = 1;
+
+	uint32_t magic;
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	pixel_format pixel_format;
+	uint8_t reserved[3];
+	uint64_t data_offset;
+	uint64_t data_byte_count;
+	// Identifies the source image and the load params (see cgimg_source).
+	uint64_t source_hash;
+	uint64_t source_byte_count;
+	uint64_t source_write_time;
+};
+
+static_assert(sizeof(cgimg_header) == 64, "cgimg_header must not contain padding.");
+
+// cgimg_source describes the image a .cgimg file has been made of.
+// A .cgimg file is up to date if its source description equals to the current one.
+struct cgimg_source final {
+	// Hash of the source's filename & the load params.
+	uint64_t hash = 0;
+	uint64_t byte_count = 0;
+	// Last write time of the source file.
+	uint64_t write_time = 0;
+};
+
+// cached_image owns the pixels returned by load_image_cached.
+// The pixels are either mapped from a .cgimg file or decoded from the source image.
+class cached_image final {
+public:
+
+	cached_image() noexcept = default;
+
+	explicit cached_image(image_2d&& image) noexcept
+		: image_(std::move(image)), view_(image_)
+	{}
+
+	cached_image(Mapped_file&& file, const image_view& view) noexcept
+		: file_(std::move(file)), view_(view)
+	{}
+
+	cached_image(const cached_image&) = delete;
+
+	cached_image(cached_image&&) noexcept = default;
+
+
+	cached_image& operator=(const cached_image&) = delete;
+
+	cached_image& operator=(cached_image&&) noexcept = default;
+
+
+	// Returns the header of the mapped .cgimg file or nullptr if the pixels are not mapped.
+	const cgimg_header* header() const noexcept
+	{
+		return (file_.is_open()) ? reinterpret_cast<const cgimg_header*>(file_.data()) : nullptr;
+	}
+
+	// Returns true if the pixels are mapped from a .cgimg file.
+	bool is_mapped() const noexcept
+	{
+		return file_.is_open();
+	}
+
+	// Returns the pixels of the image which is not mapped, the mapped pixels are read-only.
+	void* data() noexcept
+	{
+		assert(!is_mapped());
+		return image_.data;
+	}
+
+	const image_view& view() const noexcept
+	{
+		return view_;
+	}
+
+private:
+	Mapped_file file_;
+	image_2d image_;
+	image_view view_;
+};
+
+// Returns the name of the .cgimg file which caches the specified image loaded with the specified params.
+// The cache file is placed next to the source file.
+std::string cgimg_filename(const std::string& filename, uint8_t channel_count, bool flip_vertically,
+	bool half_float = false);
+
+// Describes the current state of the source image file.
+// Returns false if the file does not exist on disk.
+bool get_cgimg_source(const std::string& filename, uint8_t channel_count, bool flip_vertically,
+	bool half_float, cgimg_source& source);
+
+// Loads the image from its .cgimg file if the file is up to date.
+// Otherwise decodes the image and (re)writes the .cgimg file. Failure to write the cache is ignored.
+// Images which do not exist on disk (e.g. stored in a mounted pack) are just decoded.
+// half_float has the same meaning as in image_2d's constructor.
+cached_image load_image_cached(const std::string& filename, uint8_t channel_count = 0, bool flip_vertically = false,
+	bool half_float = false);
+
+// Maps the specified .cgimg file if it is up to date. Otherwise calls compute and (re)writes the file,
+// failure to write the cache is ignored. source must describe everything the computed image depends on.
+cached_image load_cgimg_or_compute(const std::string& filename, const cgimg_source& source,
+	const std::function<image_2d()>& compute);
+
+// Maps the specified .cgimg file. Returns an empty cached_image (cached_image::is_mapped() == false)
+// if the file does not exist, is corrupted or is made of a source different from the specified one.
+// .cgimg files are always opened from the file system, mounted packs are not searched.
+cached_image map_cgimg(const std::string& filename, const cgimg_source& source);
+
+// Maps the specified .cgimg file regardless of the source it has been made of.
+// Returns an empty cached_image if the file does not exist on disk or is corrupted.
+cached_image map_cgimg(const std::string& filename);
+
+// Writes the pixels into the specified .cgimg file.
+// The file is written under a temporary name and renamed afterwards,
+// concurrent readers never see partially written files.
+void write_cgimg(const std::string& filename, const image_view& image, const cgimg_source& source);
+
+} // namespace data
+} // namespace cg
+
+#endif // CG_DATA_IMAGE_DISK_CACHE_H_
@@ -0,0 +1,335 @@
+#include "cg/data/image_filter.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <emmintrin.h>
+#include "cg/data/image_convert.h"
+
+
+namespace {
+
+using cg::data::image_2d;
+using cg::data::image_view;
+using cg::data::pixel_format;
+
+// Number of rows which are processed by one task.
+constexpr size_t row_grain_size = 16;
+
+// Range weights of the bilateral filter are looked up: exp(-t), t in [0, range_table_max).
+// Farther colors get zero weight.
+constexpr size_t range_table_size = 1024;
+constexpr float range_table_max = 9.0f;
+
+// Gaussian of the rgb distance between two colors.
+class range_weights final {
+public:
+
+	explicit range_weights(float sigma)
+		: scale_(range_table_size / (range_table_max * 2.0f * sigma * sigma))
+	{
+		for (size_t i = 0; i < range_table_size; ++i)
+			table_[i] = std::exp(-range_table_max * (i + 0.5f) / range_table_size);
+	}
+
+	// Returns the weight of the squared distance.
+	float operator()(float distance_sq) const noexcept
+	{
+		const float t = distance_sq * scale_;
+		return (t < float(range_table_size)) ? table_[size_t(t)] : 0.0f;
+	}
+
+private:
+	float table_[range_table_size];
+	float scale_;
+};
+
+inline size_t clamp_index(ptrdiff_t i, size_t count) noexcept
+{
+	return size_t(std::min(std::max(i, ptrdiff_t(0)), ptrdiff_t(count) - 1));
+}
+
+// Squared length of the rgb part of v in the first lane.
+inline float distance_sq(__m128 v) noexcept
+{
+	const __m128 rgb = _mm_and_ps(v, _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1)));
+	__m128 d = _mm_mul_ps(rgb, rgb);
+	d = _mm_add_ps(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(2, 3, 0, 1)));
+	d = _mm_add_ps(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(1, 0, 3, 2)));
+	return _mm_cvtss_f32(d);
+}
+
+// Copies the row into dst and extends it by radius edge pixels on each side.
+void pad_row(const float* row, size_t width, size_t radius, float* dst) noexcept
+{
+	for (size_t i = 0; i < radius; ++i)
+		std::memcpy(dst + i * 4, row, 4 * sizeof(float));
+
+	std::memcpy(dst + radius * 4, row, width * 4 * sizeof(float));
+
+	for (size_t i = 0; i < radius; ++i)
+		std::memcpy(dst + (radius + width + i) * 4, row + (width - 1) * 4, 4 * sizeof(float));
+}
+
+// Calls row_func(padded_row, dst_row) for every row of the image. Rows are split between the tasks.
+template<typename Row_func>
+void filter_rows(const float* src, const uint2& size, size_t radius, float* dst,
+	cg::thread_pool& pool, const Row_func& row_func)
+{
+	const size_t float_count = size_t(size.x) * 4;
+
+	cg::parallel_for(pool, size.y, row_grain_size, [&](size_t first, size_t last) {
+		std::vector<float> padded((size.x + 2 * radius) * 4);
+
+		for (size_t y = first; y < last; ++y) {
+			pad_row(src + y * float_count, size.x, radius, padded.data());
+			row_func(padded.data(), dst + y * float_count);
+		}
+	});
+}
+
+// ----- gaussian -----
+
+void convolve_row(const float* padded, size_t width, const std::vector<float>& kernel, float* dst) noexcept
+{
+	for (size_t x = 0; x < width; ++x) {
+		const float* p = padded + x * 4;
+		__m128 acc = _mm_setzero_ps();
+		for (size_t k = 0; k < kernel.size(); ++k)
+			acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(p + k * 4), _mm_load1_ps(&kernel[k])));
+
+		_mm_storeu_ps(dst + x * 4, acc);
+	}
+}
+
+// Convolves the columns of the rows [first, last). Whole rows are processed at once.
+void convolve_columns(const float* src, const uint2& size, const std::vector<float>& kernel, float* dst,
+	size_t first, size_t last) noexcept
+{
+	const size_t float_count = size_t(size.x) * 4;
+	const ptrdiff_t radius = ptrdiff_t(kernel.size() / 2);
+
+	for (size_t y = first; y < last; ++y) {
+		float* d = dst + y * float_count;
+		std::memset(d, 0, float_count * sizeof(float));
+
+		for (size_t k = 0; k < kernel.size(); ++k) {
+			const float* s = src + clamp_index(ptrdiff_t(y) + ptrdiff_t(k) - radius, size.y) * float_count;
+			const __m128 w = _mm_load1_ps(&kernel[k]);
+			for (size_t i = 0; i < float_count; i += 4)
+				_mm_storeu_ps(d + i, _mm_add_ps(_mm_loadu_ps(d + i), _mm_mul_ps(_mm_loadu_ps(s + i), w)));
+		}
+	}
+}
+
+// ----- box -----
+
+// Sliding window sum, each pixel costs one add & one subtract.
+void box_row(const float* padded, size_t width, size_t radius, float* dst) noexcept
+{
+	const size_t tap_count = 2 * radius + 1;
+	const __m128 scale = _mm_set1_ps(1.0f / tap_count);
+
+	__m128 sum = _mm_setzero_ps();
+	for (size_t k = 0; k < tap_count; ++k)
+		sum = _mm_add_ps(sum, _mm_loadu_ps(padded + k * 4));
+
+	for (size_t x = 0; x < width; ++x) {
+		_mm_storeu_ps(dst + x * 4, _mm_mul_ps(sum, scale));
+		if (x + 1 == width) break;
+
+		const __m128 incoming = _mm_loadu_ps(padded + (x + tap_count) * 4);
+		const __m128 outgoing = _mm_loadu_ps(padded + x * 4);
+		sum = _mm_add_ps(sum, _mm_sub_ps(incoming, outgoing));
+	}
+}
+
+// Sliding window sum of whole rows.
+void box_columns(const float* src, const uint2& size, size_t radius, float* dst, size_t first, size_t last)
+{
+	const size_t float_count = size_t(size.x) * 4;
+	const __m128 scale = _mm_set1_ps(1.0f / (2 * radius + 1));
+	const auto row = [&](ptrdiff_t y) { return src + clamp_index(y, size.y) * float_count; };
+
+	std::vector<float> sum(float_count, 0.0f);
+	for (ptrdiff_t k = -ptrdiff_t(radius); k <= ptrdiff_t(radius); ++k) {
+		const float* s = row(ptrdiff_t(first) + k);
+		for (size_t i = 0; i < float_count; i += 4)
+			_mm_storeu_ps(&sum[i], _mm_add_ps(_mm_loadu_ps(&sum[i]), _mm_loadu_ps(s + i)));
+	}
+
+	for (size_t y = first; y < last; ++y) {
+		const float* incoming = row(ptrdiff_t(y + radius + 1));
+		const float* outgoing = row(ptrdiff_t(y) - ptrdiff_t(radius));
+		float* d = dst + y * float_count;
+
+		for (size_t i = 0; i < float_count; i += 4) {
+			const __m128 s = _mm_loadu_ps(&sum[i]);
+			_mm_storeu_ps(d + i, _mm_mul_ps(s, scale));
+			_mm_storeu_ps(&sum[i], _mm_add_ps(s, _mm_sub_ps(_mm_loadu_ps(incoming + i), _mm_loadu_ps(outgoing + i))));
+		}
+	}
+}
+
+// ----- bilateral -----
+
+// Filters one pixel. tap(k) returns the k-th of the kernel.size() taps, the center one is the reference.
+template<typename Tap_func>
+inline __m128 bilateral_pixel(const std::vector<float>& kernel, const range_weights& range, const Tap_func& tap) noexcept
+{
+	const __m128 reference = tap(kernel.size() / 2);
+	__m128 acc = _mm_setzero_ps();
+	float weight_sum = 0.0f;
+
+	for (size_t k = 0; k < kernel.size(); ++k) {
+		const __m128 s = tap(k);
+		const float w = kernel[k] * range(distance_sq(_mm_sub_ps(s, reference)));
+		acc = _mm_add_ps(acc, _mm_mul_ps(s, _mm_set1_ps(w)));
+		weight_sum += w;
+	}
+
+	// the reference pixel always has a non-zero weight.
+	return _mm_div_ps(acc, _mm_set1_ps(weight_sum));
+}
+
+void bilateral_row(const float* padded, size_t width, const std::vector<float>& kernel,
+	const range_weights& range, float* dst) noexcept
+{
+	for (size_t x = 0; x < width; ++x) {
+		const float* p = padded + x * 4;
+		const __m128 v = bilateral_pixel(kernel, range, [p](size_t k) { return _mm_loadu_ps(p + k * 4); });
+		_mm_storeu_ps(dst + x * 4, v);
+	}
+}
+
+void bilateral_columns(const float* src, const uint2& size, const std::vector<float>& kernel,
+	const range_weights& range, float* dst, size_t first, size_t last)
+{
+	const size_t float_count = size_t(size.x) * 4;
+	const ptrdiff_t radius = ptrdiff_t(kernel.size() / 2);
+	std::vector<const float*> rows(kernel.size());
+
+	for (size_t y = first; y < last; ++y) {
+		for (size_t k = 0; k < kernel.size(); ++k)
+			rows[k] = src + clamp_index(ptrdiff_t(y) + ptrdiff_t(k) - radius, size.y) * float_count;
+
+		float* d = dst + y * float_count;
+		for (size_t x = 0; x < size.x; ++x) {
+			const size_t offset = x * 4;
+			const __m128 v = bilateral_pixel(kernel, range, [&rows, offset](size_t k) { return _mm_loadu_ps(rows[k] + offset); });
+			_mm_storeu_ps(d + offset, v);
+		}
+	}
+}
+
+// ----- float pixels -----
+
+// Unpacks the image into rgba_32f pixels.
+image_2d unpack(const image_view& image, cg::thread_pool& pool)
+{
+	assert(image.data);
+	assert(image.size.x > 0 && image.size.y > 0);
+	assert(image.pixel_format != pixel_format::none);
+	assert(!cg::data::is_block_compressed(image.pixel_format));
+
+	image_2d pixels(image.size, pixel_format::rgba_32f);
+	cg::data::convert(image, pixel_format::rgba_32f, pixels.data, pool);
+	return pixels;
+}
+
+// Packs the rgba_32f pixels into the specified format.
+image_2d pack(image_2d&& pixels, pixel_format fmt, cg::thread_pool& pool)
+{
+	if (fmt == pixel_format::rgba_32f) return std::move(pixels);
+
+	image_2d image(pixels.size, fmt);
+	cg::data::convert(pixels, fmt, image.data, pool);
+	return image;
+}
+
+} // namespace
+
+
+namespace cg {
+namespace data {
+
+std::vector<float> gaussian_kernel(size_t radius, float sigma)
+{
+	assert(sigma > 0.0f);
+
+	std::vector<float> kernel(2 * radius + 1);
+	double sum = 0.0;
+	for (size_t i = 0; i < kernel.size(); ++i) {
+		const double x = double(i) - double(radius);
+		const double w = std::exp(-x * x / (2.0 * sigma * sigma));
+		kernel[i] = float(w);
+		sum += w;
+	}
+
+	for (float& w : kernel) w = float(w / sum);
+	return kernel;
+}
+
+image_2d gaussian_filter(const image_view& image, size_t radius, float sigma, thread_pool& pool)
+{
+	const std::vector<float> kernel = gaussian_kernel(radius, sigma);
+	image_2d pixels = unpack(image, pool);
+	image_2d tmp(image.size, pixel_format::rgba_32f);
+	float* p = reinterpret_cast<float*>(pixels.data);
+	float* t = reinterpret_cast<float*>(tmp.data);
+
+	filter_rows(p, image.size, radius, t, pool, [&](const float* padded, float* dst) {
+		convolve_row(padded, image.size.x, kernel, dst);
+	});
+
+	parallel_for(pool, image.size.y, row_grain_size, [&](size_t first, size_t last) {
+		convolve_columns(t, image.size, kernel, p, first, last);
+	});
+
+	return pack(std::move(pixels), image.pixel_format, pool);
+}
+
+image_2d box_filter(const image_view& image, size_t radius, thread_pool& pool)
+{
+	image_2d pixels = unpack(image, pool);
+	image_2d tmp(image.size, pixel_format::rgba_32f);
+	float* p = reinterpret_cast<float*>(pixels.data);
+	float* t = reinterpret_cast<float*>(tmp.data);
+
+	filter_rows(p, image.size, radius, t, pool, [&](const float* padded, float* dst) {
+		box_row(padded, image.size.x, radius, dst);
+	});
+
+	parallel_for(pool, image.size.y, row_grain_size, [&](size_t first, size_t last) {
+		box_columns(t, image.size, radius, p, first, last);
+	});
+
+	return pack(std::move(pixels), image.pixel_format, pool);
+}
+
+image_2d bilateral_filter(const image_view& image, size_t radius, float spatial_sigma, float range_sigma,
+	thread_pool& pool)
+{
+	assert(range_sigma > 0.0f);
+
+	const std::vector<float> kernel = gaussian_kernel(radius, spatial_sigma);
+	const range_weights range(range_sigma);
+	image_2d pixels = unpack(image, pool);
+	image_2d tmp(image.size, pixel_format::rgba_32f);
+	float* p = reinterpret_cast<float*>(pixels.data);
+	float* t = reinterpret_cast<float*>(tmp.data);
+
+	filter_rows(p, image.size, radius, t, pool, [&](const float* padded, float* dst) {
+		bilateral_row(padded, image.size.x, kernel, range, dst);
+	});
+
+	parallel_for(pool, image.size.y, row_grain_size, [&](size_t first, size_t last) {
+		bilateral_columns(t, image.size, kernel, range, p, first, last);
+	});
+
+	return pack(std::move(pixels), image.pixel_format, pool);
+}
+
+} // namespace data
+} // namespace cg
@@ -0,0 +1,38 @@
+#ifndef CG_DATA_IMAGE_FILTER_H_
+#define CG_DATA_IMAGE_FILTER_H_
+
+#include <vector>
+#include "cg/base/thread_pool.h"
+#include "cg/data/image.h"
+
+
+namespace cg {
+namespace data {
+
+// CPU counterparts of the compute shader filters (learn_dx11/image_processing).
+// All the filters are separable: a horizontal pass is followed by a vertical one.
+// Pixels are filtered as 4 floats, the result has the pixel format of the source image.
+// Pixels outside the image are clamped to the edge.
+// Block compressed formats are not supported.
+
+// Returns 2 * radius + 1 normalized weights of the Gaussian with the specified standard deviation.
+// Weight of the center pixel is kernel[radius].
+std::vector<float> gaussian_kernel(size_t radius, float sigma);
+
+// Filters the image with the (2 * radius + 1) x (2 * radius + 1) Gaussian kernel.
+image_2d gaussian_filter(const image_view& image, size_t radius, float sigma, thread_pool& pool);
+
+// Averages (2 * radius + 1) x (2 * radius + 1) pixels. The cost does not depend on the radius.
+image_2d box_filter(const image_view& image, size_t radius, thread_pool& pool);
+
+// Edge preserving blur. Each tap is weighted by the spatial Gaussian (spatial_sigma)
+// and by the Gaussian of the rgb distance between the tap & the center pixel (range_sigma).
+// As in bilateral_filter.compute.hlsl the filter is applied as two 1D passes,
+// which is an approximation of the 2D bilateral filter.
+image_2d bilateral_filter(const image_view& image, size_t radius, float spatial_sigma, float range_sigma,
+	thread_pool& pool);
+
+} // namespace data
+} // namespace cg
+
+#endif // CG_DATA_IMAGE_FILTER_H_
@@ -0,0 +1,449 @@
+#include "cg/data/image_hdr.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <emmintrin.h>
+#include <exception>
+#include <string_view>
+#include "cg/base/base.h"
+#include "cg/data/file.h"
+#include "cg/data/image_convert.h"
+
+
+namespace {
+
+using cg::data::image_2d;
+using cg::data::image_view;
+using cg::data::pixel_format;
+
+// New run length encoding is used by the scanlines which width is in [min, max].
+constexpr size_t rle_min_width = 8;
+constexpr size_t rle_max_width = 0x7fff;
+
+// Shorter runs are stored as literals by the encoder.
+constexpr size_t rle_min_run_length = 4;
+
+// Planes are padded so that the vectorized loops have no tails.
+constexpr size_t plane_alignment = 16;
+
+// Describes the image which follows the header.
+struct hdr_header final {
+	uint2 size;
+	// The resolution string is +Y, the first scanline is the bottom one.
+	bool bottom_up = false;
+	size_t data_offset = 0;
+};
+
+// The scanline split into r, g, b & e planes of padded_width bytes each.
+struct rgbe_planes final {
+	explicit rgbe_planes(size_t width)
+		: width(width),
+		padded_width((width + plane_alignment - 1) & ~(plane_alignment - 1)),
+		bytes(padded_width * 4, 0)
+	{}
+
+	uint8_t* plane(size_t c) noexcept
+	{
+		return bytes.data() + c * padded_width;
+	}
+
+	const uint8_t* plane(size_t c) const noexcept
+	{
+		return bytes.data() + c * padded_width;
+	}
+
+	size_t width;
+	size_t padded_width;
+	std::vector<uint8_t> bytes;
+};
+
+// Reads the line which starts at offset, moves offset past the line feed.
+std::string_view read_line(const uint8_t* bytes, size_t byte_count, size_t& offset)
+{
+	const uint8_t* begin = bytes + offset;
+	const uint8_t* end = static_cast<const uint8_t*>(std::memchr(begin, '\n', byte_count - offset));
+	ENFORCE(end, "RGBE image error. The header is truncated.");
+
+	offset = size_t(end - bytes) + 1;
+	return std::string_view(reinterpret_cast<const char*>(begin), size_t(end - begin));
+}
+
+// Parses the positive integer which follows the prefix, e.g. "-Y 512" or " +X 1024".
+uint32_t parse_dimension(std::string_view& str, std::string_view prefix)
+{
+	ENFORCE(str.substr(0, prefix.size()) == prefix, "RGBE image error. Unsupported resolution string.");
+	str.remove_prefix(prefix.size());
+
+	uint64_t value = 0;
+	size_t digit_count = 0;
+	for (; digit_count < str.size() && '0' <= str[digit_count] && str[digit_count] <= '9'; ++digit_count) {
+		value = value * 10 + uint32_t(str[digit_count] - '0');
+		ENFORCE(value <= 0x7fffffff, "RGBE image error. The image is too big.");
+	}
+
+	ENFORCE(digit_count > 0 && value > 0, "RGBE image error. Invalid resolution string.");
+	str.remove_prefix(digit_count);
+	return uint32_t(value);
+}
+
+hdr_header parse_header(const uint8_t* bytes, size_t byte_count)
+{
+	ENFORCE(cg::data::is_hdr(bytes, byte_count), "RGBE image error. Invalid signature.");
+
+	hdr_header header;
+	size_t offset = 0;
+	read_line(bytes, byte_count, offset);
+
+	// variables end with an empty line, only FORMAT matters.
+	while (true) {
+		const std::string_view line = read_line(bytes, byte_count, offset);
+		if (line.empty()) break;
+
+		if (line.substr(0, 7) == "FORMAT=")
+			ENFORCE(line == "FORMAT=32-bit_rle_rgbe", "RGBE image error. Unsupported format: ", line);
+	}
+
+	// the columns always go left to right, -Y is the usual top to bottom order.
+	std::string_view res = read_line(bytes, byte_count, offset);
+	header.bottom_up = (res.substr(0, 2) == "+Y");
+	header.size.y = parse_dimension(res, (header.bottom_up) ? "+Y " : "-Y ");
+	header.size.x = parse_dimension(res, " +X ");
+	header.data_offset = offset;
+	return header;
+}
+
+// Reads width pixels which are stored as rgbe quads. (1, 1, 1, n) repeats the previous pixel,
+// consecutive repeats are the next bytes of the count (the old Radiance run length encoding).
+void decode_flat_scanline(const uint8_t* bytes, size_t byte_count, size_t& offset, rgbe_planes& planes)
+{
+	uint8_t* r = planes.plane(0);
+	uint8_t* g = planes.plane(1);
+	uint8_t* b = planes.plane(2);
+	uint8_t* e = planes.plane(3);
+	unsigned shift = 0;
+
+	for (size_t x = 0; x < planes.width;) {
+		ENFORCE(byte_count - offset >= 4, "RGBE image error. The scanline is truncated.");
+		const uint8_t* p = bytes + offset;
+		offset += 4;
+
+		if (p[0] == 1 && p[1] == 1 && p[2] == 1) {
+			ENFORCE(x > 0 && shift < 24, "RGBE image error. Invalid run.");
+			const size_t count = size_t(p[3]) << shift;
+			ENFORCE(count <= planes.width - x, "RGBE image error. The run overflows the scanline.");
+
+			std::memset(r + x, r[x - 1], count);
+			std::memset(g + x, g[x - 1], count);
+			std::memset(b + x, b[x - 1], count);
+			std::memset(e + x, e[x - 1], count);
+			x += count;
+			shift += 8;
+		}
+		else {
+			r[x] = p[0];
+			g[x] = p[1];
+			b[x] = p[2];
+			e[x] = p[3];
+			++x;
+			shift = 0;
+		}
+	}
+}
+
+// Reads the 4 run length encoded planes of the scanline. Runs & literals are whole memset/memcpy calls.
+void decode_rle_scanline(const uint8_t* bytes, size_t byte_count, size_t& offset, rgbe_planes& planes)
+{
+	for (size_t c = 0; c < 4; ++c) {
+		uint8_t* plane = planes.plane(c);
+
+		for (size_t x = 0; x < planes.width;) {
+			ENFORCE(offset < byte_count, "RGBE image error. The scanline is truncated.");
+			const size_t code = bytes[offset++];
+
+			if (code > 128) {
+				const size_t count = code - 128;
+				ENFORCE(count <= planes.width - x && offset < byte_count, "RGBE image error. Invalid run.");
+				std::memset(plane + x, bytes[offset++], count);
+				x += count;
+			}
+			else {
+				ENFORCE(code > 0 && code <= planes.width - x && code <= byte_count - offset,
+					"RGBE image error. Invalid literal.");
+				std::memcpy(plane + x, bytes + offset, code);
+				offset += code;
+				x += code;
+			}
+		}
+	}
+}
+
+void decode_scanline(const uint8_t* bytes, size_t byte_count, size_t& offset, rgbe_planes& planes)
+{
+	const size_t width = planes.width;
+	const bool rle = (rle_min_width <= width && width <= rle_max_width)
+		&& (byte_count - offset >= 4)
+		&& (bytes[offset] == 2) && (bytes[offset + 1] == 2) && (bytes[offset + 2] < 128);
+
+	if (!rle) {
+		decode_flat_scanline(bytes, byte_count, offset, planes);
+		return;
+	}
+
+	ENFORCE(((size_t(bytes[offset + 2]) << 8) | bytes[offset + 3]) == width,
+		"RGBE image error. The scanline width mismatch.");
+	offset += 4;
+	decode_rle_scanline(bytes, byte_count, offset, planes);
+}
+
+// Converts the planes to rgba_32f pixels, 4 pixels at a time: value == mantissa * 2^(e - 136).
+// dst must have room for padded_width pixels.
+void planes_to_rgba_32f(const rgbe_planes& planes, float* dst) noexcept
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i bias = _mm_set1_epi32(9);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const uint8_t* r = planes.plane(0);
+	const uint8_t* g = planes.plane(1);
+	const uint8_t* b = planes.plane(2);
+	const uint8_t* e = planes.plane(3);
+
+	auto widen = [zero](const uint8_t* p) {
+		int32_t v;
+		std::memcpy(&v, p, sizeof(v));
+		const __m128i b8 = _mm_cvtsi32_si128(v);
+		return _mm_unpacklo_epi16(_mm_unpacklo_epi8(b8, zero), zero);
+	};
+
+	for (size_t x = 0; x < planes.width; x += 4) {
+		// 2^(e - 136) is built from its bits, e <= 9 is too small for a normal float and is flushed to zero.
+		const __m128i exp = _mm_sub_epi32(widen(e + x), bias);
+		const __m128i exp_mask = _mm_cmpgt_epi32(exp, zero);
+		const __m128 scale = _mm_castsi128_ps(_mm_and_si128(exp_mask, _mm_slli_epi32(exp, 23)));
+
+		__m128 vr = _mm_mul_ps(_mm_cvtepi32_ps(widen(r + x)), scale);
+		__m128 vg = _mm_mul_ps(_mm_cvtepi32_ps(widen(g + x)), scale);
+		__m128 vb = _mm_mul_ps(_mm_cvtepi32_ps(widen(b + x)), scale);
+		__m128 va = one;
+		_MM_TRANSPOSE4_PS(vr, vg, vb, va);
+
+		float* p = dst + x * 4;
+		_mm_storeu_ps(p, vr);
+		_mm_storeu_ps(p + 4, vg);
+		_mm_storeu_ps(p + 8, vb);
+		_mm_storeu_ps(p + 12, va);
+	}
+}
+
+// Interleaves the planes into rgbe quads, 16 pixels at a time. dst must have room for padded_width pixels.
+void planes_to_rgbe(const rgbe_planes& planes, uint8_t* dst) noexcept
+{
+	const uint8_t* r = planes.plane(0);
+	const uint8_t* g = planes.plane(1);
+	const uint8_t* b = planes.plane(2);
+	const uint8_t* e = planes.plane(3);
+
+	for (size_t x = 0; x < planes.width; x += 16) {
+		const __m128i vr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r + x));
+		const __m128i vg = _mm_loadu_si128(reinterpret_cast<const __m128i*>(g + x));
+		const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + x));
+		const __m128i ve = _mm_loadu_si128(reinterpret_cast<const __m128i*>(e + x));
+
+		const __m128i rg_lo = _mm_unpacklo_epi8(vr, vg);
+		const __m128i rg_hi = _mm_unpackhi_epi8(vr, vg);
+		const __m128i be_lo = _mm_unpacklo_epi8(vb, ve);
+		const __m128i be_hi = _mm_unpackhi_epi8(vb, ve);
+
+		__m128i* p = reinterpret_cast<__m128i*>(dst + x * 4);
+		_mm_storeu_si128(p, _mm_unpacklo_epi16(rg_lo, be_lo));
+		_mm_storeu_si128(p + 1, _mm_unpackhi_epi16(rg_lo, be_lo));
+		_mm_storeu_si128(p + 2, _mm_unpacklo_epi16(rg_hi, be_hi));
+		_mm_storeu_si128(p + 3, _mm_unpackhi_epi16(rg_hi, be_hi));
+	}
+}
+
+// Ward's float to rgbe conversion, negative values are clamped to zero.
+inline void float_to_rgbe(const float* rgb, uint8_t* r, uint8_t* g, uint8_t* b, uint8_t* e) noexcept
+{
+	const float vr = std::max(rgb[0], 0.0f);
+	const float vg = std::max(rgb[1], 0.0f);
+	const float vb = std::max(rgb[2], 0.0f);
+	const float v = std::max(vr, std::max(vg, vb));
+
+	if (v < 1e-32f) {
+		*r = *g = *b = *e = 0;
+		return;
+	}
+
+	int exp;
+	const float scale = std::frexp(v, &exp) * 256.0f / v;
+	*r = uint8_t(std::min(vr * scale, 255.0f));
+	*g = uint8_t(std::min(vg * scale, 255.0f));
+	*b = uint8_t(std::min(vb * scale, 255.0f));
+	*e = uint8_t(std::min(exp + 128, 255));
+}
+
+// Appends the run length encoded plane: runs of at least rle_min_run_length bytes, literals in between.
+void encode_rle_plane(const uint8_t* plane, size_t width, std::vector<uint8_t>& out)
+{
+	size_t x = 0;
+	while (x < width) {
+		// the beginning of the next long enough run.
+		size_t run_begin = x;
+		size_t run_length = 0;
+		while (run_begin < width) {
+			run_length = 1;
+			while (run_begin + run_length < width && run_length < 127
+				&& plane[run_begin + run_length] == plane[run_begin]) ++run_length;
+
+			if (run_length >= rle_min_run_length) break;
+			run_begin += run_length;
+			run_length = 0;
+		}
+
+		while (x < run_begin) {
+			const size_t count = std::min<size_t>(128, run_begin - x);
+			out.push_back(uint8_t(count));
+			out.insert(out.end(), plane + x, plane + x + count);
+			x += count;
+		}
+
+		if (run_length > 0) {
+			out.push_back(uint8_t(128 + run_length));
+			out.push_back(plane[run_begin]);
+			x += run_length;
+		}
+	}
+}
+
+} // namespace
+
+
+namespace cg {
+namespace data {
+
+bool is_hdr(const uint8_t* bytes, size_t byte_count) noexcept
+{
+	if (!bytes) return false;
+
+	const std::string_view str(reinterpret_cast<const char*>(bytes), byte_count);
+	return str.substr(0, 11) == "#?RADIANCE\n" || str.substr(0, 7) == "#?RGBE\n";
+}
+
+image_2d decode_hdr(const uint8_t* bytes, size_t byte_count, pixel_format fmt, bool flip_vertically)
+{
+	assert(fmt == pixel_format::rgb_32f || fmt == pixel_format::rgba_32f
+		|| fmt == pixel_format::rgb_16f || fmt == pixel_format::rgba_16f
+		|| fmt == pixel_format::rgba_8);
+
+	const hdr_header header = parse_header(bytes, byte_count);
+	const uint2 size = header.size;
+
+	image_2d image(size, fmt);
+	const size_t row_byte_count = size.x * cg::data::byte_count(fmt);
+	rgbe_planes planes(size.x);
+	// rgba_32f or rgbe pixels of the padded scanline.
+	std::vector<float> row((fmt == pixel_format::rgba_8) ? planes.padded_width : planes.padded_width * 4);
+	size_t offset = header.data_offset;
+
+	for (size_t i = 0; i < size.y; ++i) {
+		decode_scanline(bytes, byte_count, offset, planes);
+
+		const size_t y = (flip_vertically != header.bottom_up) ? (size.y - 1 - i) : i;
+		uint8_t* dst = reinterpret_cast<uint8_t*>(image.data) + y * row_byte_count;
+
+		if (fmt == pixel_format::rgba_8) {
+			planes_to_rgbe(planes, reinterpret_cast<uint8_t*>(row.data()));
+			std::memcpy(dst, row.data(), row_byte_count);
+			continue;
+		}
+
+		planes_to_rgba_32f(planes, row.data());
+		if (fmt == pixel_format::rgba_32f)
+			std::memcpy(dst, row.data(), row_byte_count);
+		else
+			convert(image_view(row.data(), uint2(size.x, 1), pixel_format::rgba_32f), fmt, dst);
+	}
+
+	return image;
+}
+
+image_2d load_hdr(const std::string& filename, pixel_format fmt, bool flip_vertically)
+{
+	assert(filename.size() > 0);
+
+	try {
+		const Mapped_file file(filename);
+		return decode_hdr(file.data(), file.byte_count(), fmt, flip_vertically);
+	}
+	catch (...) {
+		std::throw_with_nested(std::runtime_error(EXCEPTION_MSG("Loading ", filename, " image error.")));
+	}
+}
+
+std::vector<uint8_t> encode_hdr(const image_view& image)
+{
+	assert(image.data);
+	assert(image.size.x > 0 && image.size.y > 0);
+	assert(!is_block_compressed(image.pixel_format));
+
+	const uint2 size = image.size;
+	const std::string header = concat("#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y ", size.y, " +X ", size.x, '\n');
+	std::vector<uint8_t> out(header.begin(), header.end());
+	out.reserve(out.size() + square(size) * 4);
+
+	const bool rle = (rle_min_width <= size.x && size.x <= rle_max_width);
+	const size_t src_row_byte_count = size.x * cg::data::byte_count(image.pixel_format);
+	std::vector<float> rgb(size.x * 3);
+	rgbe_planes planes(size.x);
+
+	for (size_t y = 0; y < size.y; ++y) {
+		const image_view src_row(reinterpret_cast<const uint8_t*>(image.data) + y * src_row_byte_count,
+			uint2(size.x, 1), image.pixel_format);
+		convert(src_row, pixel_format::rgb_32f, rgb.data());
+
+		for (size_t x = 0; x < size.x; ++x) {
+			float_to_rgbe(rgb.data() + x * 3,
+				planes.plane(0) + x, planes.plane(1) + x, planes.plane(2) + x, planes.plane(3) + x);
+		}
+
+		if (!rle) {
+			for (size_t x = 0; x < size.x; ++x) {
+				for (size_t c = 0; c < 4; ++c)
+					out.push_back(planes.plane(c)[x]);
+			}
+
+			continue;
+		}
+
+		out.push_back(2);
+		out.push_back(2);
+		out.push_back(uint8_t(size.x >> 8));
+		out.push_back(uint8_t(size.x & 0xff));
+		for (size_t c = 0; c < 4; ++c)
+			encode_rle_plane(planes.plane(c), size.x, out);
+	}
+
+	return out;
+}
+
+#pragma warning(push)
+#pragma warning(disable:4996)
+void write_hdr(const std::string& filename, const image_view& image)
+{
+	assert(filename.size() > 0);
+
+	const std::vector<uint8_t> bytes = encode_hdr(image);
+
+	FILE* handle = std::fopen(filename.c_str(), "wb");
+	ENFORCE(handle, "Failed to create file: ", filename);
+
+	const bool res = (std::fwrite(bytes.data(), 1, bytes.size(), handle) == bytes.size());
+	ENFORCE(std::fclose(handle) == 0 && res, "Failed to write file: ", filename);
+}
+#pragma warning(pop)
+
+} // namespace data
+} // namespace cg
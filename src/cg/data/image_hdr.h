@@ -0,0 +1,36 @@
+#ifndef CG_DATA_IMAGE_HDR_H_
+#define CG_DATA_IMAGE_HDR_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "cg/data/image.h"
+
+
+namespace cg {
+namespace data {
+
+// Returns true if the bytes start with the signature of a Radiance RGBE (.hdr) file.
+bool is_hdr(const uint8_t* bytes, size_t byte_count) noexcept;
+
+// Decodes a Radiance RGBE (.hdr) image straight into the specified format:
+// rgb_32f, rgba_32f, rgb_16f, rgba_16f or rgba_8 which keeps the packed RGBE pixels
+// (the mantissas in rgb, the shared exponent in alpha). Alpha of the float formats is 1.
+// Flat, old & new run length encoded scanlines are supported.
+// Throws if the bytes are not a valid 32-bit_rle_rgbe image.
+image_2d decode_hdr(const uint8_t* bytes, size_t byte_count, pixel_format fmt, bool flip_vertically = false);
+
+// Maps the file and decodes it (see decode_hdr).
+image_2d load_hdr(const std::string& filename, pixel_format fmt, bool flip_vertically = false);
+
+// Encodes the image as a Radiance RGBE file with run length encoded scanlines.
+// image can have any format which is not block compressed, alpha is dropped.
+std::vector<uint8_t> encode_hdr(const image_view& image);
+
+// Encodes the image and writes it to the file (see encode_hdr).
+void write_hdr(const std::string& filename, const image_view& image);
+
+} // namespace data
+} // namespace cg
+
+#endif // CG_DATA_IMAGE_HDR_H_
@@ -0,0 +1,429 @@
+#include "cg/data/image_mip_chain.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <emmintrin.h>
+#include "cg/base/base.h"
+#include "cg/base/half.h"
+#include "cg/base/thread_pool.h"
+
+
+namespace {
+
+using cg::data::image_view;
+using cg::data::is_float_format;
+using cg::data::is_half_format;
+using cg::data::mip_content;
+using cg::data::mip_filter;
+using cg::data::pixel_format;
+
+// Number of rows which are processed by one task.
+constexpr size_t row_grain_size = 16;
+
+// Kaiser filter covers kaiser_radius destination pixels on each side of the pixel's center.
+constexpr double kaiser_radius = 2.0;
+constexpr double kaiser_alpha = 4.0;
+
+constexpr double pi = 3.14159265358979323846;
+
+// sRGB to linear conversion of all the 8-bit values.
+const std::array<float, 256>& srgb_to_linear_table()
+{
+	static const std::array<float, 256> table = [] {
+		std::array<float, 256> t;
+		for (size_t i = 0; i < t.size(); ++i) {
+			const double v = i / 255.0;
+			t[i] = float((v <= 0.04045) ? (v / 12.92) : std::pow((v + 0.055) / 1.055, 2.4));
+		}
+		return t;
+	}();
+
+	return table;
+}
+
+// linear_to_srgb_table()[i] = srgb(i / 4096) * 255. Values in between are linearly interpolated,
+// the error is less than 0.01 of 8-bit step.
+const std::array<float, 4097>& linear_to_srgb_table()
+{
+	static const std::array<float, 4097> table = [] {
+		std::array<float, 4097> t;
+		for (size_t i = 0; i < t.size(); ++i) {
+			const double v = i / 4096.0;
+			t[i] = float(255.0 * ((v <= 0.0031308) ? (v * 12.92) : (1.055 * std::pow(v, 1.0 / 2.4) - 0.055)));
+		}
+		return t;
+	}();
+
+	return table;
+}
+
+inline uint8_t linear_to_srgb(float v) noexcept
+{
+	const std::array<float, 4097>& table = linear_to_srgb_table();
+	const float x = std::min(std::max(v, 0.0f), 1.0f) * 4096.0f;
+	const size_t i = std::min(size_t(x), size_t(4095));
+	const float f = x - float(i);
+	return uint8_t(table[i] + f * (table[i + 1] - table[i]) + 0.5f);
+}
+
+inline uint8_t unorm_8(float v) noexcept
+{
+	return uint8_t(std::min(std::max(v, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+// Modified Bessel function of the first kind of order 0.
+double bessel_i0(double x) noexcept
+{
+	double sum = 1.0;
+	double term = 1.0;
+	for (int k = 1; k < 32; ++k) {
+		const double t = x / (2.0 * k);
+		term *= t * t;
+		sum += term;
+		if (term < sum * 1e-12) break;
+	}
+
+	return sum;
+}
+
+// x is the distance from the pixel's center measured in destination pixels.
+double kaiser_weight(double x) noexcept
+{
+	x = std::abs(x);
+	if (x >= kaiser_radius) return 0.0;
+
+	const double u = x / kaiser_radius;
+	const double sinc = (x < 1e-9) ? 1.0 : std::sin(pi * x) / (pi * x);
+	return sinc * bessel_i0(kaiser_alpha * std::sqrt(1.0 - u * u)) / bessel_i0(kaiser_alpha);
+}
+
+// filter_weights describes which source pixels contribute to each destination pixel of a row (column).
+// The i-th destination pixel = sum(weights[i * tap_count + k] * src[first[i] + k]), k in [0, tap_count).
+// Pixels outside the image are clamped to the edge, their weights are added to the edge pixels' ones.
+struct filter_weights final {
+	size_t tap_count = 0;
+	std::vector<uint32_t> first;
+	std::vector<float> weights;
+};
+
+filter_weights make_filter_weights(size_t src_size, size_t dst_size, mip_filter filter)
+{
+	assert(src_size >= dst_size);
+	assert(dst_size > 0);
+
+	const double scale = double(src_size) / dst_size;
+	const double support = (filter == mip_filter::box) ? (0.5 * scale) : (kaiser_radius * scale);
+
+	filter_weights fw;
+	fw.tap_count = std::min(size_t(std::ceil(2.0 * support)) + 1, src_size);
+	fw.first.resize(dst_size);
+	fw.weights.resize(dst_size * fw.tap_count, 0.0f);
+
+	std::vector<double> w(fw.tap_count);
+	for (size_t i = 0; i < dst_size; ++i) {
+		const double center = (i + 0.5) * scale;
+
+		// source pixels whose centers are within (center - support, center + support).
+		const ptrdiff_t j_first = ptrdiff_t(std::floor(center - support - 0.5)) + 1;
+		const ptrdiff_t j_last = ptrdiff_t(std::ceil(center + support - 0.5)) - 1;
+		const ptrdiff_t first = std::min(std::max<ptrdiff_t>(j_first, 0), ptrdiff_t(src_size - fw.tap_count));
+		fw.first[i] = uint32_t(first);
+
+		std::fill(w.begin(), w.end(), 0.0);
+		double sum = 0.0;
+		for (ptrdiff_t j = j_first; j <= j_last; ++j) {
+			double v;
+			if (filter == mip_filter::box) {
+				v = std::min(j + 1.0, center + support) - std::max(double(j), center - support);
+				v = std::max(v, 0.0);
+			}
+			else {
+				v = kaiser_weight((j + 0.5 - center) / scale);
+			}
+
+			if (v == 0.0) continue;
+
+			const ptrdiff_t k = std::min(std::max<ptrdiff_t>(j, 0), ptrdiff_t(src_size - 1)) - first;
+			assert(0 <= k && k < ptrdiff_t(fw.tap_count));
+			w[size_t(k)] += v;
+			sum += v;
+		}
+
+		assert(sum > 0.0);
+		for (size_t k = 0; k < fw.tap_count; ++k)
+			fw.weights[i * fw.tap_count + k] = float(w[k] / sum);
+	}
+
+	return fw;
+}
+
+// Converts the rows [first_row, last_row) of the image to 4 floats per pixel.
+void unpack_rows(const image_view& image, mip_content content, float* dst, size_t first_row, size_t last_row)
+{
+	const size_t cc = cg::data::channel_count(image.pixel_format);
+	const size_t pixel_count = (last_row - first_row) * image.size.x;
+	const size_t first_pixel = first_row * image.size.x;
+	dst += first_pixel * 4;
+
+	if (is_half_format(image.pixel_format)) {
+		const uint16_t* src = reinterpret_cast<const uint16_t*>(image.data) + first_pixel * cc;
+		float p[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (size_t i = 0; i < pixel_count; ++i, src += cc, dst += 4) {
+			cg::half_to_float(src, p, cc);
+			std::memcpy(dst, p, sizeof(p));
+		}
+
+		return;
+	}
+
+	if (is_float_format(image.pixel_format)) {
+		const float* src = reinterpret_cast<const float*>(image.data) + first_pixel * cc;
+		float p[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (size_t i = 0; i < pixel_count; ++i, src += cc, dst += 4) {
+			std::memcpy(p, src, cc * sizeof(float));
+			std::memcpy(dst, p, sizeof(p));
+		}
+
+		return;
+	}
+
+	const std::array<float, 256>& srgb_table = srgb_to_linear_table();
+	const uint8_t* src = reinterpret_cast<const uint8_t*>(image.data) + first_pixel * cc;
+	for (size_t i = 0; i < pixel_count; ++i, src += cc, dst += 4) {
+		dst[0] = dst[1] = dst[2] = dst[3] = 0.0f;
+
+		for (size_t c = 0; c < cc; ++c) {
+			const bool is_alpha = (c == 3);
+			if (content == mip_content::srgb_color && !is_alpha)
+				dst[c] = srgb_table[src[c]];
+			else if (content == mip_content::normal_map && !is_alpha)
+				dst[c] = src[c] * (2.0f / 255.0f) - 1.0f;
+			else
+				dst[c] = src[c] * (1.0f / 255.0f);
+		}
+
+		// two channel normal maps store only x & y.
+		if (content == mip_content::normal_map && cc == 2)
+			dst[2] = std::sqrt(std::max(0.0f, 1.0f - dst[0] * dst[0] - dst[1] * dst[1]));
+	}
+}
+
+// Converts the rows [first_row, last_row) from 4 floats per pixel to the pixel format.
+void pack_rows(const float* src, const uint2& size, pixel_format fmt, mip_content content,
+	unsigned char* dst, size_t first_row, size_t last_row)
+{
+	const size_t cc = cg::data::channel_count(fmt);
+	const size_t pixel_count = (last_row - first_row) * size.x;
+	const size_t first_pixel = first_row * size.x;
+	src += first_pixel * 4;
+
+	if (is_half_format(fmt)) {
+		uint16_t* d = reinterpret_cast<uint16_t*>(dst) + first_pixel * cc;
+		for (size_t i = 0; i < pixel_count; ++i, src += 4, d += cc)
+			cg::float_to_half(src, d, cc);
+
+		return;
+	}
+
+	if (is_float_format(fmt)) {
+		float* d = reinterpret_cast<float*>(dst) + first_pixel * cc;
+		for (size_t i = 0; i < pixel_count; ++i, src += 4, d += cc)
+			std::memcpy(d, src, cc * sizeof(float));
+
+		return;
+	}
+
+	uint8_t* d = reinterpret_cast<uint8_t*>(dst) + first_pixel * cc;
+	for (size_t i = 0; i < pixel_count; ++i, src += 4, d += cc) {
+		for (size_t c = 0; c < cc; ++c) {
+			const bool is_alpha = (c == 3);
+			if (content == mip_content::srgb_color && !is_alpha)
+				d[c] = linear_to_srgb(src[c]);
+			else if (content == mip_content::normal_map && !is_alpha)
+				d[c] = unorm_8(src[c] * 0.5f + 0.5f);
+			else
+				d[c] = unorm_8(src[c]);
+		}
+	}
+}
+
+// Filters the rows [first_row, last_row) of src horizontally.
+void filter_rows(const float* src, size_t src_width, const filter_weights& fw,
+	float* dst, size_t dst_width, size_t first_row, size_t last_row)
+{
+	for (size_t y = first_row; y < last_row; ++y) {
+		const float* src_row = src + y * src_width * 4;
+		float* dst_row = dst + y * dst_width * 4;
+		const float* w = fw.weights.data();
+
+		for (size_t x = 0; x < dst_width; ++x, w += fw.tap_count) {
+			const float* s = src_row + fw.first[x] * 4;
+			__m128 acc = _mm_setzero_ps();
+			for (size_t k = 0; k < fw.tap_count; ++k)
+				acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w[k]), _mm_loadu_ps(s + k * 4)));
+
+			_mm_storeu_ps(dst_row + x * 4, acc);
+		}
+	}
+}
+
+// Filters the destination rows [first_row, last_row) vertically.
+// Whole source rows are accumulated, so that memory is read sequentially.
+void filter_columns(const float* src, const filter_weights& fw, float* dst, size_t width,
+	size_t first_row, size_t last_row)
+{
+	const size_t float_count = width * 4;
+
+	for (size_t y = first_row; y < last_row; ++y) {
+		float* dst_row = dst + y * float_count;
+		const float* w = fw.weights.data() + y * fw.tap_count;
+		std::fill(dst_row, dst_row + float_count, 0.0f);
+
+		for (size_t k = 0; k < fw.tap_count; ++k) {
+			const float* src_row = src + (fw.first[y] + k) * float_count;
+			const __m128 wk = _mm_set1_ps(w[k]);
+			for (size_t i = 0; i < float_count; i += 4) {
+				const __m128 v = _mm_add_ps(_mm_loadu_ps(dst_row + i), _mm_mul_ps(wk, _mm_loadu_ps(src_row + i)));
+				_mm_storeu_ps(dst_row + i, v);
+			}
+		}
+	}
+}
+
+// Renormalizes xyz of the pixels [first, last). w is not changed.
+void normalize_pixels(float* pixels, size_t first, size_t last)
+{
+	const __m128 xyz_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+	const __m128 w_mask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+
+	for (float* p = pixels + first * 4; p < pixels + last * 4; p += 4) {
+		const __m128 v = _mm_loadu_ps(p);
+		const __m128 xyz = _mm_and_ps(v, xyz_mask);
+
+		// dot(xyz, xyz) in all the lanes.
+		__m128 d = _mm_mul_ps(xyz, xyz);
+		d = _mm_add_ps(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(2, 3, 0, 1)));
+		d = _mm_add_ps(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(1, 0, 3, 2)));
+
+		if (_mm_cvtss_f32(d) < 1e-12f) continue;
+		const __m128 n = _mm_div_ps(xyz, _mm_sqrt_ps(d));
+		_mm_storeu_ps(p, _mm_or_ps(n, _mm_and_ps(v, w_mask)));
+	}
+}
+
+} // namespace
+
+
+namespace cg {
+namespace data {
+
+// ----- image_mip_chain -----
+
+image_mip_chain::image_mip_chain(const image_view& image, mip_filter filter, mip_content content,
+	thread_pool& pool, size_t level_count)
+{
+	assert(image.data);
+	assert(image.pixel_format != pixel_format::none);
+	assert(image.size.x > 0 && image.size.y > 0);
+	assert(!is_block_compressed(image.pixel_format));
+
+	// normals can not be reconstructed from a single channel.
+	if (content == mip_content::normal_map && channel_count(image.pixel_format) < 2)
+		content = mip_content::linear;
+
+	const size_t max_level_count = mip_level_count(image.size);
+	if (level_count == 0 || level_count > max_level_count)
+		level_count = max_level_count;
+
+	*this = image_mip_chain(image.pixel_format, image.size, level_count);
+	std::memcpy(data_.data(), image.data, byte_count(image));
+	if (level_count == 1) return;
+
+	// filtering is done in linear space with 4 floats per pixel.
+	std::vector<float> src(square(image.size) * 4);
+	std::vector<float> tmp;
+	std::vector<float> dst;
+
+	parallel_for(pool, image.size.y, row_grain_size, [&](size_t first, size_t last) {
+		unpack_rows(image, content, src.data(), first, last);
+	});
+
+	for (size_t l = 1; l < level_count; ++l) {
+		const uint2 src_size = levels_[l - 1].size;
+		const uint2 dst_size = levels_[l].size;
+		const filter_weights fw_x = make_filter_weights(src_size.x, dst_size.x, filter);
+		const filter_weights fw_y = make_filter_weights(src_size.y, dst_size.y, filter);
+
+		tmp.resize(size_t(dst_size.x) * src_size.y * 4);
+		dst.resize(square(dst_size) * 4);
+
+		parallel_for(pool, src_size.y, row_grain_size, [&](size_t first, size_t last) {
+			filter_rows(src.data(), src_size.x, fw_x, tmp.data(), dst_size.x, first, last);
+		});
+
+		parallel_for(pool, dst_size.y, row_grain_size, [&](size_t first, size_t last) {
+			filter_columns(tmp.data(), fw_y, dst.data(), dst_size.x, first, last);
+
+			if (content == mip_content::normal_map)
+				normalize_pixels(dst.data(), first * dst_size.x, last * dst_size.x);
+
+			pack_rows(dst.data(), dst_size, pixel_format_, content, data_.data() + levels_[l].offset, first, last);
+		});
+
+		// the next level is computed from this one.
+		std::swap(src, dst);
+	}
+}
+
+image_mip_chain::image_mip_chain(const image_view& image, mip_filter filter, mip_content content, size_t level_count)
+{
+	thread_pool pool;
+	*this = image_mip_chain(image, filter, content, pool, level_count);
+}
+
+image_mip_chain::image_mip_chain(pixel_format format, const uint2& size, size_t level_count)
+	: pixel_format_(format)
+{
+	assert(format != pixel_format::none);
+	assert(size.x > 0 && size.y > 0);
+	assert(0 < level_count && level_count <= mip_level_count(size));
+
+	// all the levels are stored in one buffer.
+	size_t total_byte_count = 0;
+	levels_.reserve(level_count);
+	for (uint2 s = size; levels_.size() < level_count; s = uint2(std::max(1u, s.x / 2), std::max(1u, s.y / 2))) {
+		levels_.push_back({ total_byte_count, s });
+		total_byte_count += byte_count(s, format);
+	}
+
+	data_.resize(total_byte_count);
+}
+
+image_view image_mip_chain::level(size_t index) const noexcept
+{
+	assert(index < levels_.size());
+	return image_view(data_.data() + levels_[index].offset, levels_[index].size, pixel_format_);
+}
+
+void* image_mip_chain::level_data(size_t index) noexcept
+{
+	assert(index < levels_.size());
+	return data_.data() + levels_[index].offset;
+}
+
+// ----- funcs -----
+
+size_t mip_level_count(const uint2& size) noexcept
+{
+	size_t count = 1;
+	for (uint32_t s = std::max(size.x, size.y); s > 1; s /= 2)
+		++count;
+
+	return count;
+}
+
+} // namespace data
+} // namespace cg
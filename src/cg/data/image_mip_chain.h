@@ -0,0 +1,99 @@
+#ifndef CG_DATA_IMAGE_MIP_CHAIN_H_
+#define CG_DATA_IMAGE_MIP_CHAIN_H_
+
+#include <vector>
+#include "cg/base/math.h"
+#include "cg/data/image.h"
+
+
+namespace cg {
+namespace data {
+
+// Filter which is used to compute a mip level from the previous one.
+enum class mip_filter : unsigned char {
+	// Averages the pixels which are covered by the destination pixel.
+	box,
+
+	// Kaiser windowed sinc. Keeps more detail than box, a bit slower.
+	kaiser
+};
+
+// Describes what the pixels of an image mean. Determines how the pixels are filtered.
+enum class mip_content : unsigned char {
+	// Pixels are filtered as they are.
+	linear,
+
+	// RGB channels of 8-bit formats are sRGB encoded. They are converted to linear space
+	// before filtering and back afterwards. Alpha is always linear.
+	srgb_color,
+
+	// RGB channels store unit vectors: xyz * 0.5 + 0.5 for 8-bit formats, xyz for float formats.
+	// Filtered vectors are renormalized.
+	normal_map
+};
+
+// image_mip_chain stores an image and its mip levels. Each level is half the size of the previous one
+// (rounded down, at least 1). All the levels have the same pixel format.
+class image_mip_chain final {
+public:
+
+	image_mip_chain() noexcept = default;
+
+	// Computes mip levels of the image on the workers of the pool.
+	// level_count == 0 means the full chain, down to 1x1.
+	image_mip_chain(const image_view& image, mip_filter filter, mip_content content,
+		thread_pool& pool, size_t level_count = 0);
+
+	// Computes mip levels of the image on a temporary pool of worker threads.
+	image_mip_chain(const image_view& image, mip_filter filter, mip_content content, size_t level_count = 0);
+
+	// Allocates level_count uninitialized levels of the specified format, the first level is size x size.
+	// Used by the algorithms which produce all the levels themselves (e.g. encode_bc).
+	image_mip_chain(pixel_format format, const uint2& size, size_t level_count);
+
+	image_mip_chain(const image_mip_chain&) = delete;
+
+	image_mip_chain(image_mip_chain&&) noexcept = default;
+
+
+	image_mip_chain& operator=(const image_mip_chain&) = delete;
+
+	image_mip_chain& operator=(image_mip_chain&&) noexcept = default;
+
+
+	// Returns the index-th level. Level 0 is a copy of the source image.
+	image_view level(size_t index) const noexcept;
+
+	// Returns a pointer to the pixels of the index-th level.
+	void* level_data(size_t index) noexcept;
+
+	size_t level_count() const noexcept
+	{
+		return levels_.size();
+	}
+
+	// Pixel format of all the levels.
+	pixel_format format() const noexcept
+	{
+		return pixel_format_;
+	}
+
+private:
+
+	struct level_desc final {
+		size_t offset;
+		uint2 size;
+	};
+
+	std::vector<unsigned char> data_;
+	std::vector<level_desc> levels_;
+	pixel_format pixel_format_ = pixel_format::none;
+};
+
+// Returns the number of levels in the full mip chain of an image of the specified size.
+size_t mip_level_count(const uint2& size) noexcept;
+
+} // namespace data
+} // namespace cg
+
+#endif // CG_DATA_IMAGE_MIP_CHAIN_H_
@@ -0,0 +1,1047 @@
+#include "cg/data/image_png.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <emmintrin.h>
+#include <exception>
+#include <vector>
+#include "cg/base/base.h"
+#include "cg/data/file.h"
+
+
+namespace {
+
+using cg::data::image_2d;
+using cg::data::pixel_format;
+using cg::data::png_info;
+
+// ----- inflate -----
+
+constexpr uint16_t length_base[29] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+constexpr uint8_t length_extra_bits[29] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+constexpr uint16_t distance_base[30] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+
+constexpr uint8_t distance_extra_bits[30] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// The order in which the lengths of the code length alphabet are stored.
+constexpr uint8_t code_length_order[19] = {
+	16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+// Reverses the order of the lowest count bits of v.
+inline uint32_t reverse_bits(uint32_t v, uint32_t count) noexcept
+{
+	assert(count <= 16);
+
+	v = ((v & 0xaaaa) >> 1) | ((v & 0x5555) << 1);
+	v = ((v & 0xcccc) >> 2) | ((v & 0x3333) << 2);
+	v = ((v & 0xf0f0) >> 4) | ((v & 0x0f0f) << 4);
+	v = ((v & 0xff00) >> 8) | ((v & 0x00ff) << 8);
+	return v >> (16 - count);
+}
+
+// bit_reader reads the deflate stream least significant bit first, 64 bits are buffered at a time.
+class bit_reader final {
+public:
+
+	bit_reader(const uint8_t* bytes, size_t byte_count) noexcept
+		: cur_(bytes), end_(bytes + byte_count)
+	{}
+
+
+	// The buffered bits, the next bit of the stream is the lowest one.
+	uint64_t bits() const noexcept
+	{
+		return bits_;
+	}
+
+	const uint8_t* end() const noexcept
+	{
+		return end_;
+	}
+
+	// True if the zeros which follow the end of the stream have been consumed.
+	bool overrun() const noexcept
+	{
+		return padding_byte_count_ * 8 > bit_count_;
+	}
+
+	// Discards the bits up to the next byte boundary, returns the next byte of the stream.
+	const uint8_t* align_to_byte()
+	{
+		consume(bit_count_ & 7);
+		ENFORCE(!overrun(), "Zlib stream error. The stream is truncated.");
+
+		cur_ -= bit_count_ / 8 - padding_byte_count_;
+		bits_ = 0;
+		bit_count_ = 0;
+		padding_byte_count_ = 0;
+		return cur_;
+	}
+
+	void consume(uint32_t count) noexcept
+	{
+		assert(count <= bit_count_);
+		bits_ >>= count;
+		bit_count_ -= count;
+	}
+
+	uint32_t read(uint32_t count) noexcept
+	{
+		const uint32_t v = uint32_t(bits_ & ((uint64_t(1) << count) - 1));
+		consume(count);
+		return v;
+	}
+
+	// Makes at least 56 bits available, the stream is followed by zeros.
+	void refill() noexcept
+	{
+		if (end_ - cur_ >= 8) {
+			uint64_t v;
+			std::memcpy(&v, cur_, sizeof(v));
+			bits_ |= v << bit_count_;
+			cur_ += (63 - bit_count_) >> 3;
+			bit_count_ |= 56;
+			return;
+		}
+
+		while (bit_count_ <= 56) {
+			if (cur_ < end_) bits_ |= uint64_t(*cur_++) << bit_count_;
+			else ++padding_byte_count_;
+			bit_count_ += 8;
+		}
+	}
+
+	// Continues reading at p which follows a stored block.
+	void skip_to(const uint8_t* p) noexcept
+	{
+		assert(bit_count_ == 0);
+		assert(cur_ <= p && p <= end_);
+		cur_ = p;
+	}
+
+private:
+
+	const uint8_t* cur_;
+	const uint8_t* end_;
+	uint64_t bits_ = 0;
+	uint32_t bit_count_ = 0;
+	// The number of zero bytes which have been buffered after the end of the stream.
+	size_t padding_byte_count_ = 0;
+};
+
+// Canonical Huffman code of a deflate alphabet.
+// The codes which are at most fast_bits long are decoded by a single lookup.
+struct huffman_table final {
+	static constexpr uint32_t fast_bits = 10;
+	static constexpr uint32_t fast_mask = (1 << fast_bits) - 1;
+
+	// Builds the code of the alphabet of count symbols, zero length symbols are not used.
+	void build(const uint8_t* lengths, size_t count)
+	{
+		assert(count <= 288);
+
+		uint32_t counts[16] = {};
+		for (size_t i = 0; i < count; ++i) ++counts[lengths[i]];
+		counts[0] = 0;
+
+		uint32_t next_code[16] = {};
+		uint32_t code = 0;
+		uint32_t symbol_index = 0;
+		for (uint32_t l = 1; l < 16; ++l) {
+			ENFORCE(code + counts[l] <= (1u << l), "Zlib stream error. Over-subscribed Huffman code.");
+
+			next_code[l] = code;
+			first_code[l] = uint16_t(code);
+			first_symbol[l] = uint16_t(symbol_index);
+			code += counts[l];
+			symbol_index += counts[l];
+			max_code[l] = code << (16 - l);
+			code <<= 1;
+		}
+		max_code[16] = 0x10000;
+
+		std::memset(fast, 0, sizeof(fast));
+		symbol_count = symbol_index;
+
+		for (size_t i = 0; i < count; ++i) {
+			const uint32_t l = lengths[i];
+			if (l == 0) continue;
+
+			const uint32_t index = next_code[l] - first_code[l] + first_symbol[l];
+			sorted_lengths[index] = uint8_t(l);
+			sorted_symbols[index] = uint16_t(i);
+
+			if (l <= fast_bits) {
+				for (uint32_t j = reverse_bits(next_code[l], l); j <= fast_mask; j += (1 << l))
+					fast[j] = uint16_t((l << 9) | i);
+			}
+
+			++next_code[l];
+		}
+	}
+
+	// (code length << 9) | symbol, 0 if the code is longer than fast_bits.
+	uint16_t fast[1 << fast_bits];
+	uint16_t first_code[16];
+	uint16_t first_symbol[16];
+	// The codes of length l (left aligned to 16 bits) are less than max_code[l].
+	uint32_t max_code[17];
+	// The symbols sorted by their codes.
+	uint8_t sorted_lengths[288];
+	uint16_t sorted_symbols[288];
+	uint32_t symbol_count;
+};
+
+// Decodes the next symbol, at least 16 bits must be buffered.
+inline uint32_t decode_symbol(bit_reader& reader, const huffman_table& table)
+{
+	const uint64_t bits = reader.bits();
+	const uint16_t entry = table.fast[bits & huffman_table::fast_mask];
+	if (entry) {
+		reader.consume(entry >> 9);
+		return entry & 0x1ff;
+	}
+
+	// the code is longer than fast_bits.
+	const uint32_t k = reverse_bits(uint32_t(bits & 0xffff), 16);
+	uint32_t l = huffman_table::fast_bits + 1;
+	while (k >= table.max_code[l]) ++l;
+	ENFORCE(l < 16, "Zlib stream error. Invalid Huffman code.");
+
+	const uint32_t index = (k >> (16 - l)) - table.first_code[l] + table.first_symbol[l];
+	ENFORCE(index < table.symbol_count && table.sorted_lengths[index] == l,
+		"Zlib stream error. Invalid Huffman code.");
+
+	reader.consume(l);
+	return table.sorted_symbols[index];
+}
+
+const huffman_table& fixed_literal_table()
+{
+	static const huffman_table table = [] {
+		uint8_t lengths[288];
+		std::fill(lengths, lengths + 144, uint8_t(8));
+		std::fill(lengths + 144, lengths + 256, uint8_t(9));
+		std::fill(lengths + 256, lengths + 280, uint8_t(7));
+		std::fill(lengths + 280, lengths + 288, uint8_t(8));
+
+		huffman_table t;
+		t.build(lengths, 288);
+		return t;
+	}();
+
+	return table;
+}
+
+const huffman_table& fixed_distance_table()
+{
+	static const huffman_table table = [] {
+		uint8_t lengths[32];
+		std::fill(lengths, lengths + 32, uint8_t(5));
+
+		huffman_table t;
+		t.build(lengths, 32);
+		return t;
+	}();
+
+	return table;
+}
+
+// Reads the code lengths of a dynamic block & builds its literal/length & distance codes.
+void read_dynamic_tables(bit_reader& reader, huffman_table& literal_table, huffman_table& distance_table)
+{
+	reader.refill();
+	const uint32_t literal_count = reader.read(5) + 257;
+	const uint32_t distance_count = reader.read(5) + 1;
+	const uint32_t code_length_count = reader.read(4) + 4;
+	ENFORCE(literal_count <= 286 && distance_count <= 30, "Zlib stream error. Invalid dynamic block header.");
+
+	uint8_t code_length_lengths[19] = {};
+	for (uint32_t i = 0; i < code_length_count; ++i) {
+		reader.refill();
+		code_length_lengths[code_length_order[i]] = uint8_t(reader.read(3));
+	}
+
+	huffman_table code_length_table;
+	code_length_table.build(code_length_lengths, 19);
+
+	// the literal/length & distance code lengths form a single sequence.
+	uint8_t lengths[286 + 30];
+	const uint32_t total_count = literal_count + distance_count;
+	uint32_t i = 0;
+	while (i < total_count) {
+		reader.refill();
+		const uint32_t symbol = decode_symbol(reader, code_length_table);
+
+		if (symbol < 16) {
+			lengths[i++] = uint8_t(symbol);
+			continue;
+		}
+
+		uint8_t length = 0;
+		uint32_t repeat_count = 0;
+		if (symbol == 16) {
+			ENFORCE(i > 0, "Zlib stream error. Invalid code lengths.");
+			length = lengths[i - 1];
+			repeat_count = 3 + reader.read(2);
+		}
+		else if (symbol == 17) {
+			repeat_count = 3 + reader.read(3);
+		}
+		else {
+			repeat_count = 11 + reader.read(7);
+		}
+
+		ENFORCE(i + repeat_count <= total_count, "Zlib stream error. Invalid code lengths.");
+		std::memset(lengths + i, length, repeat_count);
+		i += repeat_count;
+	}
+
+	ENFORCE(!reader.overrun(), "Zlib stream error. The stream is truncated.");
+	ENFORCE(lengths[256] > 0, "Zlib stream error. The block has no end of block code.");
+
+	literal_table.build(lengths, literal_count);
+	distance_table.build(lengths + literal_count, distance_count);
+}
+
+// Copies a stored block to out. Returns true if out_end has been reached and the rest of the stream
+// has to be dropped, which is allowed only if stop_when_full is set.
+bool inflate_stored_block(bit_reader& reader, uint8_t*& out, uint8_t* out_end, bool stop_when_full)
+{
+	const uint8_t* p = reader.align_to_byte();
+	ENFORCE(reader.end() - p >= 4, "Zlib stream error. The stream is truncated.");
+
+	const size_t length = size_t(p[0]) | (size_t(p[1]) << 8);
+	const size_t length_complement = size_t(p[2]) | (size_t(p[3]) << 8);
+	ENFORCE(length == (~length_complement & 0xffff), "Zlib stream error. Corrupted stored block length.");
+	p += 4;
+
+	ENFORCE(size_t(reader.end() - p) >= length, "Zlib stream error. The stream is truncated.");
+
+	if (length > size_t(out_end - out)) {
+		ENFORCE(stop_when_full, "Zlib stream error. The inflated data does not fit the buffer.");
+		std::memcpy(out, p, size_t(out_end - out));
+		out = out_end;
+		return true;
+	}
+
+	std::memcpy(out, p, length);
+	out += length;
+	reader.skip_to(p + length);
+	return false;
+}
+
+// Decodes a block which is compressed with the specified codes.
+// Returns true if out_end has been reached, see inflate_stored_block.
+bool inflate_block(bit_reader& reader, const huffman_table& literal_table, const huffman_table& distance_table,
+	uint8_t* out_begin, uint8_t*& out, uint8_t* out_end, bool stop_when_full)
+{
+	for (;;) {
+		// a literal or a match takes at most 48 bits.
+		reader.refill();
+		uint32_t symbol = decode_symbol(reader, literal_table);
+
+		if (symbol < 256) {
+			if (out == out_end) {
+				ENFORCE(stop_when_full, "Zlib stream error. The inflated data does not fit the buffer.");
+				return true;
+			}
+
+			*out++ = uint8_t(symbol);
+			continue;
+		}
+
+		if (symbol == 256) return false;
+
+		symbol -= 257;
+		ENFORCE(symbol < 29, "Zlib stream error. Invalid length code.");
+		const size_t match_length = length_base[symbol] + reader.read(length_extra_bits[symbol]);
+
+		const uint32_t distance_symbol = decode_symbol(reader, distance_table);
+		ENFORCE(distance_symbol < 30, "Zlib stream error. Invalid distance code.");
+		const size_t distance = distance_base[distance_symbol] + reader.read(distance_extra_bits[distance_symbol]);
+
+		ENFORCE(distance <= size_t(out - out_begin), "Zlib stream error. The distance is too far back.");
+
+		size_t length = match_length;
+		const bool full = (length > size_t(out_end - out));
+		if (full) {
+			ENFORCE(stop_when_full, "Zlib stream error. The inflated data does not fit the buffer.");
+			length = size_t(out_end - out);
+		}
+
+		const uint8_t* src = out - distance;
+		if (distance >= 8 && size_t(out_end - out) >= length + 8) {
+			// 8-byte chunks do not overlap, the bytes written past the match are overwritten later.
+			for (uint8_t* o = out; o < out + length; o += 8, src += 8)
+				std::memcpy(o, src, 8);
+		}
+		else if (distance == 1) {
+			std::memset(out, out[-1], length);
+		}
+		else {
+			for (size_t i = 0; i < length; ++i)
+				out[i] = src[i];
+		}
+
+		out += length;
+		if (full) return true;
+	}
+}
+
+// Inflates the zlib stream into dst (see inflate_zlib). If stop_when_full is set the data which
+// does not fit dst is dropped instead of being an error, the rest of the stream is not read.
+size_t inflate_zlib_stream(const uint8_t* bytes, size_t byte_count, uint8_t* dst, size_t dst_byte_count,
+	bool stop_when_full)
+{
+	assert(bytes || byte_count == 0);
+	assert(dst || dst_byte_count == 0);
+
+	ENFORCE(byte_count >= 2, "Zlib stream error. The stream is truncated.");
+	const uint32_t cmf = bytes[0];
+	const uint32_t flg = bytes[1];
+	ENFORCE((cmf & 0xf) == 8 && (cmf >> 4) <= 7, "Zlib stream error. Unknown compression method.");
+	ENFORCE((cmf * 256 + flg) % 31 == 0, "Zlib stream error. Corrupted header.");
+	ENFORCE((flg & 0x20) == 0, "Zlib stream error. Preset dictionaries are not supported.");
+
+	bit_reader reader(bytes + 2, byte_count - 2);
+	uint8_t* out = dst;
+	uint8_t* out_end = dst + dst_byte_count;
+	huffman_table literal_table;
+	huffman_table distance_table;
+
+	for (bool final_block = false; !final_block;) {
+		reader.refill();
+		final_block = (reader.read(1) == 1);
+		const uint32_t block_type = reader.read(2);
+		bool full = false;
+
+		switch (block_type) {
+			case 0:
+				full = inflate_stored_block(reader, out, out_end, stop_when_full);
+				break;
+
+			case 1:
+				full = inflate_block(reader, fixed_literal_table(), fixed_distance_table(),
+					dst, out, out_end, stop_when_full);
+				break;
+
+			case 2:
+				read_dynamic_tables(reader, literal_table, distance_table);
+				full = inflate_block(reader, literal_table, distance_table, dst, out, out_end, stop_when_full);
+				break;
+
+			default:
+				throw std::runtime_error(EXCEPTION_MSG("Zlib stream error. Invalid block type."));
+		}
+
+		ENFORCE(!reader.overrun(), "Zlib stream error. The stream is truncated.");
+		if (full) break;
+	}
+
+	return size_t(out - dst);
+}
+
+// ----- png -----
+
+constexpr uint8_t png_signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+constexpr uint32_t make_chunk_type(char a, char b, char c, char d) noexcept
+{
+	return (uint32_t(uint8_t(a)) << 24) | (uint32_t(uint8_t(b)) << 16) | (uint32_t(uint8_t(c)) << 8) | uint8_t(d);
+}
+
+constexpr uint32_t chunk_ihdr = make_chunk_type('I', 'H', 'D', 'R');
+constexpr uint32_t chunk_plte = make_chunk_type('P', 'L', 'T', 'E');
+constexpr uint32_t chunk_trns = make_chunk_type('t', 'R', 'N', 'S');
+constexpr uint32_t chunk_idat = make_chunk_type('I', 'D', 'A', 'T');
+constexpr uint32_t chunk_iend = make_chunk_type('I', 'E', 'N', 'D');
+
+enum class color_type : uint8_t {
+	gray = 0,
+	rgb = 2,
+	palette = 3,
+	gray_alpha = 4,
+	rgba = 6
+};
+
+enum class filter_type : uint8_t {
+	none = 0,
+	sub = 1,
+	up = 2,
+	average = 3,
+	paeth = 4
+};
+
+inline uint32_t read_u16_be(const uint8_t* p) noexcept
+{
+	return (uint32_t(p[0]) << 8) | p[1];
+}
+
+inline uint32_t read_u32_be(const uint8_t* p) noexcept
+{
+	return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+// The chunks of a PNG image which are needed to decode it.
+struct png_image final {
+	png_info info;
+	color_type color = color_type::gray;
+
+	// The number of samples per pixel of the filtered scanlines.
+	uint32_t sample_count = 0;
+
+	// rgba entries of the palette, the missing entries are opaque black.
+	std::array<uint8_t, 256 * 4> palette;
+	uint32_t palette_size = 0;
+
+	// The transparent color of gray & rgb images in the bit depth of the image.
+	bool has_transparent_color = false;
+	uint32_t transparent_color[3] = {};
+
+	// The data of the IDAT chunks, the chunks form a single zlib stream.
+	std::vector<std::pair<const uint8_t*, size_t>> idat_chunks;
+};
+
+void parse_ihdr(const uint8_t* data, size_t length, png_image& png)
+{
+	ENFORCE(length == 13, "PNG image error. Invalid IHDR chunk.");
+
+	const uint32_t width = read_u32_be(data);
+	const uint32_t height = read_u32_be(data + 4);
+	ENFORCE(0 < width && width <= (1 << 24) && 0 < height && height <= (1 << 24),
+		"PNG image error. Invalid image size ", width, 'x', height, '.');
+
+	const uint8_t bit_depth = data[8];
+	const uint8_t color = data[9];
+	bool valid_depth = false;
+	switch (color_type(color)) {
+		case color_type::gray:
+			png.sample_count = 1;
+			valid_depth = (bit_depth == 1 || bit_depth == 2 || bit_depth == 4 || bit_depth == 8 || bit_depth == 16);
+			break;
+
+		case color_type::palette:
+			png.sample_count = 1;
+			valid_depth = (bit_depth == 1 || bit_depth == 2 || bit_depth == 4 || bit_depth == 8);
+			break;
+
+		case color_type::rgb:
+			png.sample_count = 3;
+			valid_depth = (bit_depth == 8 || bit_depth == 16);
+			break;
+
+		case color_type::gray_alpha:
+			png.sample_count = 2;
+			valid_depth = (bit_depth == 8 || bit_depth == 16);
+			break;
+
+		case color_type::rgba:
+			png.sample_count = 4;
+			valid_depth = (bit_depth == 8 || bit_depth == 16);
+			break;
+
+		default:
+			throw std::runtime_error(EXCEPTION_MSG("PNG image error. Unknown color type ", int(color), '.'));
+	}
+
+	ENFORCE(valid_depth, "PNG image error. Invalid bit depth ", int(bit_depth), " of color type ", int(color), '.');
+	ENFORCE(data[10] == 0, "PNG image error. Unknown compression method.");
+	ENFORCE(data[11] == 0, "PNG image error. Unknown filter method.");
+	ENFORCE(data[12] <= 1, "PNG image error. Unknown interlace method.");
+
+	png.info.size = uint2(width, height);
+	png.info.bit_depth = bit_depth;
+	png.info.interlaced = (data[12] == 1);
+	png.color = color_type(color);
+}
+
+void parse_plte(const uint8_t* data, size_t length, png_image& png)
+{
+	ENFORCE(length % 3 == 0 && 0 < length && length <= 256 * 3, "PNG image error. Invalid PLTE chunk.");
+
+	png.palette_size = uint32_t(length / 3);
+	for (size_t i = 0; i < png.palette_size; ++i) {
+		png.palette[i * 4 + 0] = data[i * 3 + 0];
+		png.palette[i * 4 + 1] = data[i * 3 + 1];
+		png.palette[i * 4 + 2] = data[i * 3 + 2];
+	}
+}
+
+void parse_trns(const uint8_t* data, size_t length, png_image& png)
+{
+	switch (png.color) {
+		case color_type::palette:
+			ENFORCE(png.palette_size > 0, "PNG image error. tRNS chunk precedes PLTE chunk.");
+			ENFORCE(length <= png.palette_size, "PNG image error. Invalid tRNS chunk.");
+			for (size_t i = 0; i < length; ++i) png.palette[i * 4 + 3] = data[i];
+			png.has_transparent_color = (length > 0);
+			break;
+
+		case color_type::gray:
+			ENFORCE(length == 2, "PNG image error. Invalid tRNS chunk.");
+			png.transparent_color[0] = read_u16_be(data);
+			png.has_transparent_color = true;
+			break;
+
+		case color_type::rgb:
+			ENFORCE(length == 6, "PNG image error. Invalid tRNS chunk.");
+			for (size_t i = 0; i < 3; ++i) png.transparent_color[i] = read_u16_be(data + i * 2);
+			png.has_transparent_color = true;
+			break;
+
+		default:
+			// images with alpha must not have tRNS chunk.
+			break;
+	}
+}
+
+png_image parse_png(const uint8_t* bytes, size_t byte_count)
+{
+	ENFORCE(cg::data::is_png(bytes, byte_count), "PNG image error. The signature is missing.");
+
+	png_image png;
+	for (size_t i = 0; i < 256; ++i) {
+		png.palette[i * 4 + 0] = 0;
+		png.palette[i * 4 + 1] = 0;
+		png.palette[i * 4 + 2] = 0;
+		png.palette[i * 4 + 3] = 255;
+	}
+
+	size_t offset = sizeof(png_signature);
+	bool has_ihdr = false;
+	for (;;) {
+		ENFORCE(byte_count - offset >= 12, "PNG image error. The file is truncated.");
+
+		const size_t length = read_u32_be(bytes + offset);
+		const uint32_t type = read_u32_be(bytes + offset + 4);
+		const uint8_t* data = bytes + offset + 8;
+		ENFORCE(length <= byte_count - offset - 12, "PNG image error. The file is truncated.");
+		ENFORCE(has_ihdr || type == chunk_ihdr, "PNG image error. The first chunk is not IHDR.");
+
+		// crc of the chunks is not verified.
+		offset += length + 12;
+
+		if (type == chunk_ihdr) {
+			ENFORCE(!has_ihdr, "PNG image error. Multiple IHDR chunks.");
+			parse_ihdr(data, length, png);
+			has_ihdr = true;
+		}
+		else if (type == chunk_plte) {
+			parse_plte(data, length, png);
+		}
+		else if (type == chunk_trns) {
+			parse_trns(data, length, png);
+		}
+		else if (type == chunk_idat) {
+			png.idat_chunks.emplace_back(data, length);
+		}
+		else if (type == chunk_iend) {
+			break;
+		}
+		else {
+			// bit 5 of the first letter is set in the type of ancillary chunks.
+			ENFORCE(type & 0x20000000, "PNG image error. Unknown critical chunk ",
+				char(type >> 24), char(type >> 16), char(type >> 8), char(type), '.');
+		}
+	}
+
+	ENFORCE(png.idat_chunks.size() > 0, "PNG image error. IDAT chunk is missing.");
+	ENFORCE(png.color != color_type::palette || png.palette_size > 0, "PNG image error. PLTE chunk is missing.");
+
+	const bool has_alpha = (png.color == color_type::gray_alpha || png.color == color_type::rgba);
+	const uint32_t color_channel_count = (png.color == color_type::palette) ? 3 : png.sample_count;
+	png.info.channel_count = uint8_t(color_channel_count + ((png.has_transparent_color && !has_alpha) ? 1 : 0));
+
+	return png;
+}
+
+// ----- unfiltering -----
+
+// Loads the pixel to the lowest bytes of the register.
+template<size_t bpp>
+inline __m128i load_pixel(const uint8_t* p) noexcept
+{
+	int v = 0;
+	std::memcpy(&v, p, bpp);
+	return _mm_cvtsi32_si128(v);
+}
+
+template<size_t bpp>
+inline void store_pixel(uint8_t* p, __m128i x) noexcept
+{
+	const int v = _mm_cvtsi128_si32(x);
+	std::memcpy(p, &v, bpp);
+}
+
+// m ? a : b
+inline __m128i select_si128(__m128i m, __m128i a, __m128i b) noexcept
+{
+	return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+}
+
+inline __m128i abs_epi16(__m128i v) noexcept
+{
+	return _mm_max_epi16(v, _mm_sub_epi16(_mm_setzero_si128(), v));
+}
+
+inline uint8_t paeth_predictor(int a, int b, int c) noexcept
+{
+	const int pa = std::abs(b - c);
+	const int pb = std::abs(a - c);
+	const int pc = std::abs(a + b - 2 * c);
+
+	if (pa <= pb && pa <= pc) return uint8_t(a);
+	return (pb <= pc) ? uint8_t(b) : uint8_t(c);
+}
+
+// Every pixel depends on the previous one, the vectorized filters process a whole pixel per step.
+
+template<size_t bpp>
+void unfilter_sub_sse(uint8_t* row, size_t byte_count) noexcept
+{
+	__m128i a = _mm_setzero_si128();
+	for (size_t i = 0; i < byte_count; i += bpp) {
+		a = _mm_add_epi8(load_pixel<bpp>(row + i), a);
+		store_pixel<bpp>(row + i, a);
+	}
+}
+
+template<size_t bpp>
+void unfilter_average_sse(uint8_t* row, const uint8_t* prior, size_t byte_count) noexcept
+{
+	const __m128i one = _mm_set1_epi8(1);
+	__m128i a = _mm_setzero_si128();
+
+	for (size_t i = 0; i < byte_count; i += bpp) {
+		const __m128i b = load_pixel<bpp>(prior + i);
+		// _mm_avg_epu8 rounds up, (a + b) >> 1 rounds down.
+		const __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+		a = _mm_add_epi8(load_pixel<bpp>(row + i), avg);
+		store_pixel<bpp>(row + i, a);
+	}
+}
+
+template<size_t bpp>
+void unfilter_paeth_sse(uint8_t* row, const uint8_t* prior, size_t byte_count) noexcept
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i low_byte_mask = _mm_set1_epi16(0xff);
+	__m128i a = zero;
+	__m128i c = zero;
+
+	for (size_t i = 0; i < byte_count; i += bpp) {
+		const __m128i b = _mm_unpacklo_epi8(load_pixel<bpp>(prior + i), zero);
+		const __m128i x = _mm_unpacklo_epi8(load_pixel<bpp>(row + i), zero);
+
+		// p = a + b - c, |p - a| = |b - c|, |p - b| = |a - c|, |p - c| = |(b - c) + (a - c)|
+		const __m128i b_c = _mm_sub_epi16(b, c);
+		const __m128i a_c = _mm_sub_epi16(a, c);
+		const __m128i pa = abs_epi16(b_c);
+		const __m128i pb = abs_epi16(a_c);
+		const __m128i pc = abs_epi16(_mm_add_epi16(b_c, a_c));
+
+		const __m128i b_or_c = select_si128(_mm_cmpgt_epi16(pb, pc), c, b);
+		const __m128i predictor = select_si128(_mm_cmpgt_epi16(pa, _mm_min_epi16(pb, pc)), b_or_c, a);
+
+		a = _mm_and_si128(_mm_add_epi16(x, predictor), low_byte_mask);
+		store_pixel<bpp>(row + i, _mm_packus_epi16(a, a));
+		c = b;
+	}
+}
+
+void unfilter_up(uint8_t* row, const uint8_t* prior, size_t byte_count) noexcept
+{
+	size_t i = 0;
+	for (; i + 16 <= byte_count; i += 16) {
+		const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+		const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prior + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), _mm_add_epi8(x, b));
+	}
+
+	for (; i < byte_count; ++i)
+		row[i] += prior[i];
+}
+
+// Reverses the filter of the scanline in place. prior is the unfiltered previous scanline or zeros.
+// bpp is the number of bytes per complete pixel rounded up to 1.
+void unfilter_row(filter_type filter, uint8_t* row, const uint8_t* prior, size_t byte_count, size_t bpp)
+{
+	switch (filter) {
+		case filter_type::none:
+			break;
+
+		case filter_type::sub:
+			if (bpp == 3) unfilter_sub_sse<3>(row, byte_count);
+			else if (bpp == 4) unfilter_sub_sse<4>(row, byte_count);
+			else {
+				for (size_t i = bpp; i < byte_count; ++i)
+					row[i] += row[i - bpp];
+			}
+			break;
+
+		case filter_type::up:
+			unfilter_up(row, prior, byte_count);
+			break;
+
+		case filter_type::average:
+			if (bpp == 3) unfilter_average_sse<3>(row, prior, byte_count);
+			else if (bpp == 4) unfilter_average_sse<4>(row, prior, byte_count);
+			else {
+				for (size_t i = 0; i < bpp; ++i)
+					row[i] += prior[i] >> 1;
+				for (size_t i = bpp; i < byte_count; ++i)
+					row[i] += uint8_t((uint32_t(row[i - bpp]) + prior[i]) >> 1);
+			}
+			break;
+
+		case filter_type::paeth:
+			if (bpp == 3) unfilter_paeth_sse<3>(row, prior, byte_count);
+			else if (bpp == 4) unfilter_paeth_sse<4>(row, prior, byte_count);
+			else {
+				for (size_t i = 0; i < bpp; ++i)
+					row[i] += prior[i];
+				for (size_t i = bpp; i < byte_count; ++i)
+					row[i] += paeth_predictor(row[i - bpp], prior[i], prior[i - bpp]);
+			}
+			break;
+
+		default:
+			throw std::runtime_error(EXCEPTION_MSG("PNG image error. Unknown filter type ", int(filter), '.'));
+	}
+}
+
+// ----- pixel conversion -----
+
+// Returns the index-th sample of the scanline whose samples are less than 8 bits.
+inline uint32_t read_packed_sample(const uint8_t* row, size_t index, uint32_t bit_depth) noexcept
+{
+	const size_t bit = index * bit_depth;
+	return (row[bit >> 3] >> (8 - bit_depth - (bit & 7))) & ((1u << bit_depth) - 1);
+}
+
+// Converts the unfiltered scanline to 8-bit pixels of png.info.channel_count channels.
+void expand_row(const png_image& png, const uint8_t* row, uint8_t* dst)
+{
+	const size_t width = png.info.size.x;
+	const uint32_t bit_depth = png.info.bit_depth;
+	const uint32_t sample_count = png.sample_count;
+	const uint32_t* key = png.transparent_color;
+
+	if (png.color == color_type::palette) {
+		const size_t channel_count = png.info.channel_count;
+		for (size_t x = 0; x < width; ++x, dst += channel_count) {
+			const uint32_t index = (bit_depth == 8) ? row[x] : read_packed_sample(row, x, bit_depth);
+			std::memcpy(dst, png.palette.data() + index * 4, channel_count);
+		}
+		return;
+	}
+
+	if (bit_depth == 8) {
+		if (!png.has_transparent_color) {
+			std::memcpy(dst, row, width * sample_count);
+			return;
+		}
+
+		for (size_t x = 0; x < width; ++x, row += sample_count, dst += sample_count + 1) {
+			bool transparent = true;
+			for (size_t s = 0; s < sample_count; ++s) {
+				dst[s] = row[s];
+				transparent &= (row[s] == key[s]);
+			}
+			dst[sample_count] = (transparent) ? 0 : 255;
+		}
+		return;
+	}
+
+	if (bit_depth == 16) {
+		const size_t dst_sample_count = sample_count + ((png.has_transparent_color) ? 1 : 0);
+		for (size_t x = 0; x < width; ++x, row += sample_count * 2, dst += dst_sample_count) {
+			bool transparent = true;
+			for (size_t s = 0; s < sample_count; ++s) {
+				dst[s] = row[s * 2];
+				transparent &= (read_u16_be(row + s * 2) == key[s]);
+			}
+			if (png.has_transparent_color) dst[sample_count] = (transparent) ? 0 : 255;
+		}
+		return;
+	}
+
+	// gray of 1, 2 or 4 bits is scaled to the whole 8-bit range.
+	const uint32_t scale = 255 / ((1u << bit_depth) - 1);
+	for (size_t x = 0; x < width; ++x) {
+		const uint32_t v = read_packed_sample(row, x, bit_depth);
+		*dst++ = uint8_t(v * scale);
+		if (png.has_transparent_color) *dst++ = (v == key[0]) ? 0 : 255;
+	}
+}
+
+inline uint8_t luma(const uint8_t* p) noexcept
+{
+	return uint8_t((uint32_t(p[0]) * 77 + uint32_t(p[1]) * 150 + uint32_t(p[2]) * 29) >> 8);
+}
+
+// Converts the pixels between gray, gray & alpha, rgb & rgba the way stb_image does.
+void convert_channels(const uint8_t* src, size_t src_channel_count, uint8_t* dst, size_t dst_channel_count,
+	size_t width) noexcept
+{
+	assert(src_channel_count != dst_channel_count);
+
+	for (size_t x = 0; x < width; ++x, src += src_channel_count, dst += dst_channel_count) {
+		const bool src_color = (src_channel_count >= 3);
+		const bool src_alpha = (src_channel_count == 2 || src_channel_count == 4);
+		const uint8_t alpha = (src_alpha) ? src[src_channel_count - 1] : 255;
+
+		if (dst_channel_count <= 2) {
+			dst[0] = (src_color) ? luma(src) : src[0];
+		}
+		else if (src_color) {
+			dst[0] = src[0];
+			dst[1] = src[1];
+			dst[2] = src[2];
+		}
+		else {
+			dst[0] = dst[1] = dst[2] = src[0];
+		}
+
+		if (dst_channel_count == 2 || dst_channel_count == 4)
+			dst[dst_channel_count - 1] = alpha;
+	}
+}
+
+void decode_png_image(const png_image& png, uint8_t channel_count, bool flip_vertically, uint8_t* dst)
+{
+	assert(channel_count <= 4);
+	ENFORCE(!png.info.interlaced, "PNG image error. Interlaced images are not supported.");
+
+	const size_t width = png.info.size.x;
+	const size_t height = png.info.size.y;
+	const size_t bits_per_pixel = size_t(png.sample_count) * png.info.bit_depth;
+	const size_t row_byte_count = (width * bits_per_pixel + 7) / 8;
+	const size_t bpp = std::max<size_t>(1, bits_per_pixel / 8);
+	// every scanline starts with its filter type.
+	const size_t filtered_row_byte_count = row_byte_count + 1;
+
+	// the chunks are merged only if the stream is split.
+	std::vector<uint8_t> merged_stream;
+	const uint8_t* stream = png.idat_chunks[0].first;
+	size_t stream_byte_count = png.idat_chunks[0].second;
+	if (png.idat_chunks.size() > 1) {
+		for (const auto& chunk : png.idat_chunks)
+			merged_stream.insert(merged_stream.end(), chunk.first, chunk.first + chunk.second);
+
+		stream = merged_stream.data();
+		stream_byte_count = merged_stream.size();
+	}
+
+	std::vector<uint8_t> scanlines(height * filtered_row_byte_count);
+	// data past the last scanline is ignored, as the other decoders do.
+	const size_t inflated_byte_count = inflate_zlib_stream(stream, stream_byte_count,
+		scanlines.data(), scanlines.size(), true);
+	ENFORCE(inflated_byte_count == scanlines.size(), "PNG image error. The image data is truncated.");
+
+	const size_t src_channel_count = png.info.channel_count;
+	const size_t dst_channel_count = (channel_count) ? channel_count : src_channel_count;
+	const size_t dst_row_byte_count = width * dst_channel_count;
+	const std::vector<uint8_t> zero_row(row_byte_count, 0);
+	// expanded pixels which are converted to dst_channel_count channels.
+	std::vector<uint8_t> expanded_row((src_channel_count != dst_channel_count) ? width * src_channel_count : 0);
+
+	const uint8_t* prior = zero_row.data();
+	for (size_t y = 0; y < height; ++y) {
+		uint8_t* row = scanlines.data() + y * filtered_row_byte_count;
+		unfilter_row(filter_type(row[0]), row + 1, prior, row_byte_count, bpp);
+		prior = row + 1;
+
+		uint8_t* dst_row = dst + ((flip_vertically) ? (height - 1 - y) : y) * dst_row_byte_count;
+		if (src_channel_count == dst_channel_count) {
+			expand_row(png, row + 1, dst_row);
+		}
+		else {
+			expand_row(png, row + 1, expanded_row.data());
+			convert_channels(expanded_row.data(), src_channel_count, dst_row, dst_channel_count, width);
+		}
+	}
+}
+
+} // namespace
+
+
+namespace cg {
+namespace data {
+
+bool is_png(const uint8_t* bytes, size_t byte_count) noexcept
+{
+	return (bytes) && (byte_count >= sizeof(png_signature))
+		&& (std::memcmp(bytes, png_signature, sizeof(png_signature)) == 0);
+}
+
+png_info read_png_info(const uint8_t* bytes, size_t byte_count)
+{
+	return parse_png(bytes, byte_count).info;
+}
+
+size_t inflate_zlib(const uint8_t* bytes, size_t byte_count, uint8_t* dst, size_t dst_byte_count)
+{
+	return inflate_zlib_stream(bytes, byte_count, dst, dst_byte_count, false);
+}
+
+void decode_png(const uint8_t* bytes, size_t byte_count, uint8_t channel_count, bool flip_vertically, void* dst)
+{
+	assert(channel_count <= 4);
+	assert(dst);
+
+	const png_image png = parse_png(bytes, byte_count);
+	decode_png_image(png, channel_count, flip_vertically, static_cast<uint8_t*>(dst));
+}
+
+image_2d decode_png(const uint8_t* bytes, size_t byte_count, uint8_t channel_count, bool flip_vertically)
+{
+	assert(channel_count <= 4);
+
+	const png_image png = parse_png(bytes, byte_count);
+	ENFORCE(!png.info.interlaced, "PNG image error. Interlaced images are not supported.");
+
+	const uint8_t cc = (channel_count) ? channel_count : png.info.channel_count;
+	const pixel_format fmt = (cc == 1) ? pixel_format::red_8
+		: (cc == 2) ? pixel_format::rg_8
+		: (cc == 3) ? pixel_format::rgb_8 : pixel_format::rgba_8;
+
+	image_2d image(png.info.size, fmt);
+	decode_png_image(png, cc, flip_vertically, static_cast<uint8_t*>(image.data));
+	return image;
+}
+
+image_2d load_png(const std::string& filename, uint8_t channel_count, bool flip_vertically)
+{
+	assert(filename.size() > 0);
+
+	try {
+		const Mapped_file file(filename);
+		return decode_png(file.data(), file.byte_count(), channel_count, flip_vertically);
+	}
+	catch (...) {
+		std::throw_with_nested(std::runtime_error(EXCEPTION_MSG("Loading ", filename, " image error.")));
+	}
+}
+
+} // namespace data
+} // namespace cg
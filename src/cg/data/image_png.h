@@ -0,0 +1,58 @@
+#ifndef CG_DATA_IMAGE_PNG_H_
+#define CG_DATA_IMAGE_PNG_H_
+
+#include <cstdint>
+#include <string>
+#include "cg/base/math.h"
+#include "cg/data/image.h"
+
+
+namespace cg {
+namespace data {
+
+// Describes a PNG image, see read_png_info.
+struct png_info final {
+	uint2 size;
+
+	// The number of channels of the decoded image: 1 gray, 2 gray & alpha, 3 rgb, 4 rgba.
+	// Palette images have 3 channels or 4 if the palette has alpha,
+	// a transparent color (tRNS) of gray & rgb images adds the alpha channel.
+	uint8_t channel_count = 0;
+
+	// Bits per sample: 1, 2, 4, 8 or 16.
+	uint8_t bit_depth = 0;
+
+	// Adam7 interlaced images are not supported by decode_png.
+	bool interlaced = false;
+};
+
+// Returns true if the bytes start with the PNG signature.
+bool is_png(const uint8_t* bytes, size_t byte_count) noexcept;
+
+// Reads the header of the PNG image. Throws if the bytes are not a PNG image.
+png_info read_png_info(const uint8_t* bytes, size_t byte_count);
+
+// Inflates the zlib stream into dst which has room for dst_byte_count bytes.
+// Returns the number of written bytes. Throws if the stream is corrupted or does not fit dst.
+// The adler32 checksum is not verified.
+size_t inflate_zlib(const uint8_t* bytes, size_t byte_count, uint8_t* dst, size_t dst_byte_count);
+
+// Decodes the PNG image straight into dst which must have room for size.x * size.y * channel_count bytes.
+// channel_count is in [1, 4] or 0 which means png_info::channel_count,
+// the channels are converted the way image_2d constructor does. 16-bit samples are reduced to 8 bits.
+// The decoder keeps no state, several images can be decoded concurrently (see decode_images).
+// Image data which is inflated past the last scanline is ignored.
+// Throws if the bytes are not a valid non-interlaced PNG image.
+void decode_png(const uint8_t* bytes, size_t byte_count, uint8_t channel_count, bool flip_vertically, void* dst);
+
+// Decodes the PNG image into a new red_8, rg_8, rgb_8 or rgba_8 image (see decode_png above).
+image_2d decode_png(const uint8_t* bytes, size_t byte_count, uint8_t channel_count = 0,
+	bool flip_vertically = false);
+
+// Maps the file and decodes it (see decode_png).
+image_2d load_png(const std::string& filename, uint8_t channel_count = 0, bool flip_vertically = false);
+
+} // namespace data
+} // namespace cg
+
+#endif // CG_DATA_IMAGE_PNG_H_
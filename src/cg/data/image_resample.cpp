@@ -0,0 +1,240 @@
+#include "cg/data/image_resample.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include <emmintrin.h>
+#include "cg/data/image_convert.h"
+
+
+namespace {
+
+using cg::data::image_2d;
+using cg::data::image_view;
+using cg::data::pixel_format;
+using cg::data::resample_filter;
+
+// Number of rows which are processed by one task.
+constexpr size_t row_grain_size = 16;
+
+constexpr double pi = 3.14159265358979323846;
+
+// Mitchell-Netravali parameters.
+constexpr double mitchell_b = 1.0 / 3.0;
+constexpr double mitchell_c = 1.0 / 3.0;
+
+// Returns the radius of the filter in pixels.
+double filter_radius(resample_filter filter) noexcept
+{
+	switch (filter) {
+		default: assert(false); return 0.0;
+		case resample_filter::box:		return 0.5;
+		case resample_filter::mitchell:	return 2.0;
+		case resample_filter::lanczos3:	return 3.0;
+	}
+}
+
+double sinc(double x) noexcept
+{
+	return (std::abs(x) < 1e-9) ? 1.0 : std::sin(pi * x) / (pi * x);
+}
+
+// x is the distance from the pixel's center measured in pixels.
+double mitchell_weight(double x) noexcept
+{
+	constexpr double b = mitchell_b;
+	constexpr double c = mitchell_c;
+
+	x = std::abs(x);
+	if (x < 1.0)
+		return ((12.0 - 9.0 * b - 6.0 * c) * x * x * x + (-18.0 + 12.0 * b + 6.0 * c) * x * x + (6.0 - 2.0 * b)) / 6.0;
+
+	if (x < 2.0)
+		return ((-b - 6.0 * c) * x * x * x + (6.0 * b + 30.0 * c) * x * x
+			+ (-12.0 * b - 48.0 * c) * x + (8.0 * b + 24.0 * c)) / 6.0;
+
+	return 0.0;
+}
+
+double lanczos3_weight(double x) noexcept
+{
+	return (std::abs(x) < 3.0) ? sinc(x) * sinc(x / 3.0) : 0.0;
+}
+
+// filter_weights describes which source pixels contribute to each destination pixel of a row (column).
+// The i-th destination pixel = sum(weights[i * tap_count + k] * src[first[i] + k]), k in [0, tap_count).
+// Pixels outside the image are clamped to the edge, their weights are added to the edge pixels' ones.
+struct filter_weights final {
+	size_t tap_count = 0;
+	std::vector<uint32_t> first;
+	std::vector<float> weights;
+};
+
+filter_weights make_filter_weights(size_t src_size, size_t dst_size, resample_filter filter)
+{
+	assert(src_size > 0);
+	assert(dst_size > 0);
+
+	const double scale = double(src_size) / dst_size;
+	// the filter is stretched over the source pixels when the image is downscaled.
+	const double filter_scale = std::max(scale, 1.0);
+	const double support = filter_radius(filter) * filter_scale;
+
+	filter_weights fw;
+	fw.tap_count = std::min(size_t(std::ceil(2.0 * support)) + 1, src_size);
+	fw.first.resize(dst_size);
+	fw.weights.resize(dst_size * fw.tap_count, 0.0f);
+
+	std::vector<double> w(fw.tap_count);
+	for (size_t i = 0; i < dst_size; ++i) {
+		const double center = (i + 0.5) * scale;
+
+		// source pixels whose centers are within (center - support, center + support).
+		const ptrdiff_t j_first = ptrdiff_t(std::floor(center - support - 0.5)) + 1;
+		const ptrdiff_t j_last = ptrdiff_t(std::ceil(center + support - 0.5)) - 1;
+		const ptrdiff_t first = std::min(std::max<ptrdiff_t>(j_first, 0), ptrdiff_t(src_size - fw.tap_count));
+		fw.first[i] = uint32_t(first);
+
+		std::fill(w.begin(), w.end(), 0.0);
+		double sum = 0.0;
+		for (ptrdiff_t j = j_first; j <= j_last; ++j) {
+			double v;
+			switch (filter) {
+				case resample_filter::box:
+					v = std::min(j + 1.0, center + support) - std::max(double(j), center - support);
+					v = std::max(v, 0.0);
+					break;
+
+				case resample_filter::mitchell:
+					v = mitchell_weight((j + 0.5 - center) / filter_scale);
+					break;
+
+				default:
+					v = lanczos3_weight((j + 0.5 - center) / filter_scale);
+					break;
+			}
+
+			if (v == 0.0) continue;
+
+			const ptrdiff_t k = std::min(std::max<ptrdiff_t>(j, 0), ptrdiff_t(src_size - 1)) - first;
+			assert(0 <= k && k < ptrdiff_t(fw.tap_count));
+			w[size_t(k)] += v;
+			sum += v;
+		}
+
+		// the center lobe of every filter outweighs the negative ones.
+		assert(sum > 0.0);
+		for (size_t k = 0; k < fw.tap_count; ++k)
+			fw.weights[i * fw.tap_count + k] = float(w[k] / sum);
+	}
+
+	return fw;
+}
+
+// Filters the rows [first_row, last_row) of src horizontally.
+void filter_rows(const float* src, size_t src_width, const filter_weights& fw,
+	float* dst, size_t dst_width, size_t first_row, size_t last_row) noexcept
+{
+	for (size_t y = first_row; y < last_row; ++y) {
+		const float* src_row = src + y * src_width * 4;
+		float* dst_row = dst + y * dst_width * 4;
+		const float* w = fw.weights.data();
+
+		for (size_t x = 0; x < dst_width; ++x, w += fw.tap_count) {
+			const float* s = src_row + fw.first[x] * 4;
+			__m128 acc = _mm_setzero_ps();
+			for (size_t k = 0; k < fw.tap_count; ++k)
+				acc = _mm_add_ps(acc, _mm_mul_ps(_mm_load1_ps(w + k), _mm_loadu_ps(s + k * 4)));
+
+			_mm_storeu_ps(dst_row + x * 4, acc);
+		}
+	}
+}
+
+// Filters the destination rows [first_row, last_row) vertically.
+// Whole source rows are accumulated, so that memory is read sequentially.
+void filter_columns(const float* src, const filter_weights& fw, float* dst, size_t width,
+	size_t first_row, size_t last_row) noexcept
+{
+	const size_t float_count = width * 4;
+
+	for (size_t y = first_row; y < last_row; ++y) {
+		float* dst_row = dst + y * float_count;
+		const float* w = fw.weights.data() + y * fw.tap_count;
+		std::memset(dst_row, 0, float_count * sizeof(float));
+
+		for (size_t k = 0; k < fw.tap_count; ++k) {
+			if (w[k] == 0.0f) continue;
+
+			const float* src_row = src + (fw.first[y] + k) * float_count;
+			const __m128 wk = _mm_load1_ps(w + k);
+			for (size_t i = 0; i < float_count; i += 4) {
+				const __m128 v = _mm_add_ps(_mm_loadu_ps(dst_row + i), _mm_mul_ps(wk, _mm_loadu_ps(src_row + i)));
+				_mm_storeu_ps(dst_row + i, v);
+			}
+		}
+	}
+}
+
+} // namespace
+
+
+namespace cg {
+namespace data {
+
+image_2d resample(const image_view& image, const uint2& size, resample_filter filter, thread_pool& pool)
+{
+	assert(image.data);
+	assert(image.size.x > 0 && image.size.y > 0);
+	assert(image.pixel_format != pixel_format::none);
+	assert(!is_block_compressed(image.pixel_format));
+	assert(size.x > 0 && size.y > 0);
+
+	image_2d pixels(image.size, pixel_format::rgba_32f);
+	convert(image, pixel_format::rgba_32f, pixels.data, pool);
+
+	// horizontal pass: image.size -> (size.x, image.size.y).
+	if (size.x != image.size.x) {
+		const filter_weights fw = make_filter_weights(image.size.x, size.x, filter);
+		image_2d tmp(uint2(size.x, image.size.y), pixel_format::rgba_32f);
+		const float* src = reinterpret_cast<const float*>(pixels.data);
+		float* dst = reinterpret_cast<float*>(tmp.data);
+
+		parallel_for(pool, image.size.y, row_grain_size, [&](size_t first, size_t last) {
+			filter_rows(src, image.size.x, fw, dst, size.x, first, last);
+		});
+
+		pixels = std::move(tmp);
+	}
+
+	// vertical pass: (size.x, image.size.y) -> size.
+	if (size.y != image.size.y) {
+		const filter_weights fw = make_filter_weights(image.size.y, size.y, filter);
+		image_2d tmp(size, pixel_format::rgba_32f);
+		const float* src = reinterpret_cast<const float*>(pixels.data);
+		float* dst = reinterpret_cast<float*>(tmp.data);
+
+		parallel_for(pool, size.y, row_grain_size, [&](size_t first, size_t last) {
+			filter_columns(src, fw, dst, size.x, first, last);
+		});
+
+		pixels = std::move(tmp);
+	}
+
+	if (image.pixel_format == pixel_format::rgba_32f) return pixels;
+
+	image_2d result(size, image.pixel_format);
+	convert(pixels, image.pixel_format, result.data, pool);
+	return result;
+}
+
+image_2d resample(const image_view& image, const uint2& size, resample_filter filter)
+{
+	thread_pool pool;
+	return resample(image, size, filter, pool);
+}
+
+} // namespace data
+} // namespace cg
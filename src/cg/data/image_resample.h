@@ -0,0 +1,39 @@
+#ifndef CG_DATA_IMAGE_RESAMPLE_H_
+#define CG_DATA_IMAGE_RESAMPLE_H_
+
+#include "cg/base/math.h"
+#include "cg/base/thread_pool.h"
+#include "cg/data/image.h"
+
+
+namespace cg {
+namespace data {
+
+// Reconstruction filter which is used to resample an image.
+enum class resample_filter : unsigned char {
+	// Averages the source pixels which are covered by the destination pixel.
+	box,
+
+	// Mitchell-Netravali cubic (B = C = 1/3). Radius of 2 pixels, almost no ringing.
+	mitchell,
+
+	// Lanczos windowed sinc. Radius of 3 pixels, the sharpest one but it rings on hard edges.
+	lanczos3
+};
+
+// Resamples the image to the specified size on the workers of the pool.
+// The filter is separable: a horizontal pass is followed by a vertical one, the passes are skipped
+// if the width (height) does not change. Weights of every destination column (row) are precomputed.
+// When an image is downscaled the filter is widened by the scale factor, so that it does not alias.
+// Pixels are filtered as 4 floats, the result has the pixel format of the source image.
+// Pixels outside the image are clamped to the edge. 8-bit channels are clamped to [0, 1].
+// Block compressed formats are not supported.
+image_2d resample(const image_view& image, const uint2& size, resample_filter filter, thread_pool& pool);
+
+// Resamples the image on a temporary pool of worker threads.
+image_2d resample(const image_view& image, const uint2& size, resample_filter filter);
+
+} // namespace data
+} // namespace cg
+
+#endif // CG_DATA_IMAGE_RESAMPLE_H_
@@ -1,8 +1,10 @@
 #include "cg/data/model_assimp.h"
 
 #include <cassert>
+#include <cstring>
 #include "cg/base/base.h"
 #include "cg/data/file.h"
+#include "cg/data/pack.h"
 
 
 namespace cg {
@@ -12,7 +14,17 @@ const aiScene* load_model(Assimp::Importer& importer, const char* filename, cons
 {
 	ENFORCE(exists(filename), EXCEPTION_MSG("Geometry file ", filename, " does not exist."));
 
-	const aiScene* scene = importer.ReadFile(filename, flags);
+	const aiScene* scene = nullptr;
+	if (const std::unique_ptr<pack_file> pf = open_from_packs(filename)) {
+		// the extension tells assimp which importer to use.
+		const char* ext = std::strrchr(filename, '.');
+		const auto bytes = pf->bytes();
+		scene = importer.ReadFileFromMemory(bytes.data(), bytes.size(), flags, (ext) ? (ext + 1) : "");
+	}
+	else {
+		scene = importer.ReadFile(filename, flags);
+	}
+
 	if (!scene) {
 		auto exc_msg = EXCEPTION_MSG("Error loading model file ",
 			filename, ".", importer.GetErrorString());
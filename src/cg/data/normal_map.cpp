@@ -0,0 +1,151 @@
+#include "cg/data/normal_map.h"
+
+#include <cassert>
+#include <algorithm>
+#include <vector>
+#include <emmintrin.h>
+#include "cg/data/image_convert.h"
+
+
+namespace {
+
+using cg::data::height_edge;
+using cg::data::height_gradient;
+using cg::data::image_view;
+using cg::data::pixel_format;
+
+// Number of rows which are processed by one task.
+constexpr size_t row_grain_size = 32;
+
+inline size_t edge_index(ptrdiff_t i, size_t count, height_edge edge) noexcept
+{
+	if (edge == height_edge::wrap)
+		return size_t(((i % ptrdiff_t(count)) + ptrdiff_t(count)) % ptrdiff_t(count));
+
+	return size_t(std::min(std::max(i, ptrdiff_t(0)), ptrdiff_t(count) - 1));
+}
+
+// Reads the heights of the row y into dst[1, width], dst[0] & dst[width + 1] are the neighbours of the edge pixels.
+// rgba is a scratch buffer of width float4 pixels.
+void load_heights(const image_view& image, size_t y, height_edge edge, float* rgba, float* dst)
+{
+	const size_t width = image.size.x;
+	const size_t row_byte_count = width * cg::data::byte_count(image.pixel_format);
+	const image_view row(reinterpret_cast<const uint8_t*>(image.data) + y * row_byte_count,
+		uint2(image.size.x, 1), image.pixel_format);
+
+	cg::data::convert(row, pixel_format::rgba_32f, rgba);
+	for (size_t x = 0; x < width; ++x)
+		dst[x + 1] = rgba[x * 4];
+
+	dst[0] = dst[edge_index(-1, width, edge) + 1];
+	dst[width + 1] = dst[edge_index(ptrdiff_t(width), width, edge) + 1];
+}
+
+// Computes the normals of one row from the heights of the rows above, at & below it.
+// The normals are written as float4 pixels: xyz & alpha == 1. If encode is set xyz are mapped to [0, 1].
+void compute_normals(const float* t, const float* m, const float* b, size_t width,
+	float side_weight, float center_weight, float scale, bool encode, float* dst) noexcept
+{
+	const __m128 side = _mm_set1_ps(side_weight);
+	const __m128 center = _mm_set1_ps(center_weight);
+	const __m128 scale_x = _mm_set1_ps(-scale);
+	const __m128 scale_y = _mm_set1_ps(scale);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+
+	// 4 pixels per iteration, the last iteration recomputes some pixels of the previous one.
+	// Rows narrower than 4 pixels are padded by the caller.
+	for (size_t i = 0; i < width; i += 4) {
+		const size_t x = (i + 4 <= width || width < 4) ? i : width - 4;
+
+		const __m128 t0 = _mm_loadu_ps(t + x);
+		const __m128 t1 = _mm_loadu_ps(t + x + 1);
+		const __m128 t2 = _mm_loadu_ps(t + x + 2);
+		const __m128 m0 = _mm_loadu_ps(m + x);
+		const __m128 m2 = _mm_loadu_ps(m + x + 2);
+		const __m128 b0 = _mm_loadu_ps(b + x);
+		const __m128 b1 = _mm_loadu_ps(b + x + 1);
+		const __m128 b2 = _mm_loadu_ps(b + x + 2);
+
+		// d/dx: right column - left column, d/dy: bottom row - top row.
+		const __m128 dx = _mm_add_ps(_mm_mul_ps(side, _mm_add_ps(_mm_sub_ps(t2, t0), _mm_sub_ps(b2, b0))),
+			_mm_mul_ps(center, _mm_sub_ps(m2, m0)));
+		const __m128 dy = _mm_add_ps(_mm_mul_ps(side, _mm_add_ps(_mm_sub_ps(b0, t0), _mm_sub_ps(b2, t2))),
+			_mm_mul_ps(center, _mm_sub_ps(b1, t1)));
+
+		// rows go down the image, Y of the normal goes up.
+		__m128 nx = _mm_mul_ps(dx, scale_x);
+		__m128 ny = _mm_mul_ps(dy, scale_y);
+		__m128 nz = one;
+		const __m128 inv_len = _mm_div_ps(one, _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), one)));
+		nx = _mm_mul_ps(nx, inv_len);
+		ny = _mm_mul_ps(ny, inv_len);
+		nz = inv_len;
+
+		if (encode) {
+			nx = _mm_add_ps(_mm_mul_ps(nx, half), half);
+			ny = _mm_add_ps(_mm_mul_ps(ny, half), half);
+			nz = _mm_add_ps(_mm_mul_ps(nz, half), half);
+		}
+
+		__m128 alpha = one;
+		_MM_TRANSPOSE4_PS(nx, ny, nz, alpha);
+		_mm_storeu_ps(dst + x * 4, nx);
+		_mm_storeu_ps(dst + x * 4 + 4, ny);
+		_mm_storeu_ps(dst + x * 4 + 8, nz);
+		_mm_storeu_ps(dst + x * 4 + 12, alpha);
+	}
+}
+
+} // namespace
+
+
+namespace cg {
+namespace data {
+
+image_2d normal_map_from_height(const image_view& height_map, float strength, height_gradient gradient,
+	height_edge edge, pixel_format fmt, thread_pool& pool)
+{
+	assert(height_map.data);
+	assert(height_map.size.x > 0 && height_map.size.y > 0);
+	assert(height_map.pixel_format != pixel_format::none);
+	assert(!is_block_compressed(height_map.pixel_format));
+	assert(fmt != pixel_format::none);
+	assert(!is_block_compressed(fmt));
+
+	// the weights are normalized: a unit slope (h(x) = x) makes dx == 1.
+	const float side_weight = (gradient == height_gradient::sobel) ? 1.0f : 3.0f;
+	const float center_weight = (gradient == height_gradient::sobel) ? 2.0f : 10.0f;
+	const float scale = strength / (2.0f * (2.0f * side_weight + center_weight));
+	const bool encode = !is_float_format(fmt);
+
+	const uint2 size = height_map.size;
+	const size_t dst_row_byte_count = size.x * byte_count(fmt);
+	image_2d normal_map(size, fmt);
+
+	parallel_for(pool, size.y, row_grain_size, [&](size_t first, size_t last) {
+		// heights of the rows [first - 1, last], the vectorized loop needs at least 4 + 2 heights.
+		const size_t stride = std::max<size_t>(size.x, 4) + 2;
+		std::vector<float> heights((last - first + 2) * stride, 0.0f);
+		std::vector<float> rgba(std::max<size_t>(size.x, 4) * 4);
+
+		for (size_t i = 0; i < last - first + 2; ++i) {
+			const size_t y = edge_index(ptrdiff_t(first + i) - 1, size.y, edge);
+			load_heights(height_map, y, edge, rgba.data(), heights.data() + i * stride);
+		}
+
+		for (size_t y = first; y < last; ++y) {
+			const float* m = heights.data() + (y - first + 1) * stride;
+			compute_normals(m - stride, m, m + stride, size.x, side_weight, center_weight, scale, encode, rgba.data());
+
+			const image_view row(rgba.data(), uint2(size.x, 1), pixel_format::rgba_32f);
+			convert(row, fmt, reinterpret_cast<uint8_t*>(normal_map.data) + y * dst_row_byte_count);
+		}
+	});
+
+	return normal_map;
+}
+
+} // namespace data
+} // namespace cg
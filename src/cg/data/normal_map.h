@@ -0,0 +1,41 @@
+#ifndef CG_DATA_NORMAL_MAP_H_
+#define CG_DATA_NORMAL_MAP_H_
+
+#include "cg/base/thread_pool.h"
+#include "cg/data/image.h"
+
+
+namespace cg {
+namespace data {
+
+// Gradient operator which is used to compute the slopes of a height map.
+enum class height_gradient : unsigned char {
+	// 3x3 Sobel operator: 1 2 1 weights.
+	sobel,
+
+	// 3x3 Scharr operator: 3 10 3 weights. More rotationally symmetric than Sobel.
+	scharr
+};
+
+// Determines the neighbours of the edge pixels.
+enum class height_edge : unsigned char {
+	// The edge pixels are repeated.
+	clamp,
+
+	// The image is tiled, the opposite edge continues it.
+	wrap
+};
+
+// Builds a tangent-space normal map from the height map.
+// Heights are read from the first channel of the image (8-bit channels are mapped to [0, 1]).
+// strength scales the slopes: a height difference of 1 / strength between adjacent pixels makes a 45 degree slope.
+// X of the normals points to the right, Y to the top row of the image, Z out of the surface.
+// Normals of the 8-bit formats are encoded as xyz * 0.5 + 0.5, float formats store xyz as they are.
+// Two channel formats store xy only, alpha is 1. Rows are split between the workers of the pool.
+image_2d normal_map_from_height(const image_view& height_map, float strength, height_gradient gradient,
+	height_edge edge, pixel_format fmt, thread_pool& pool);
+
+} // namespace data
+} // namespace cg
+
+#endif // CG_DATA_NORMAL_MAP_H_
@@ -0,0 +1,496 @@
+#include "cg/data/pack.h"
+
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include "cg/base/base.h"
+
+
+namespace {
+
+using cg::data::pack;
+using cg::data::pack_entry;
+
+// ----- lz -----
+// lz is a byte oriented LZ77 format: a sequence of (literals, match) pairs.
+// Each pair starts with a token: the high 4 bits are the literal count, the low 4 bits are
+// the match length minus lz_min_match. 15 means that the count continues in the following bytes,
+// each byte is added to the count until a byte that is not equal to 255.
+// The token is followed by the literals, a 2 byte little endian match offset and the match length bytes.
+// The last pair consists of literals only.
+
+constexpr size_t lz_min_match = 4;
+constexpr size_t lz_max_offset = std::numeric_limits<uint16_t>::max();
+constexpr size_t lz_hash_bits = 16;
+
+inline uint32_t load_u32(const unsigned char* p) noexcept
+{
+	uint32_t v;
+	std::memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+inline size_t lz_hash(uint32_t v) noexcept
+{
+	return size_t((v * 2654435761u) >> (32 - lz_hash_bits));
+}
+
+void lz_write_count(std::vector<unsigned char>& out, size_t count)
+{
+	for (; count >= 255; count -= 255)
+		out.push_back(255);
+
+	out.push_back(static_cast<unsigned char>(count));
+}
+
+void lz_write_sequence(std::vector<unsigned char>& out, const unsigned char* literals,
+	size_t literal_count, size_t offset, size_t match_length)
+{
+	const size_t ml = (match_length) ? (match_length - lz_min_match) : 0;
+	const unsigned char token = static_cast<unsigned char>((std::min<size_t>(literal_count, 15) << 4)
+		| std::min<size_t>(ml, 15));
+
+	out.push_back(token);
+	if (literal_count >= 15) lz_write_count(out, literal_count - 15);
+	out.insert(out.end(), literals, literals + literal_count);
+
+	if (match_length == 0) return;
+
+	out.push_back(static_cast<unsigned char>(offset & 0xff));
+	out.push_back(static_cast<unsigned char>(offset >> 8));
+	if (ml >= 15) lz_write_count(out, ml - 15);
+}
+
+std::vector<unsigned char> lz_compress(const unsigned char* src, size_t byte_count)
+{
+	std::vector<unsigned char> out;
+	out.reserve(byte_count + byte_count / 255 + 16);
+
+	// positions + 1 of the recently seen 4 byte sequences, 0 means empty.
+	std::vector<size_t> table(size_t(1) << lz_hash_bits, 0);
+	size_t anchor = 0;
+	size_t i = 0;
+
+	while (i + lz_min_match <= byte_count) {
+		const uint32_t seq = load_u32(src + i);
+		const size_t h = lz_hash(seq);
+		const size_t candidate = table[h];
+		table[h] = i + 1;
+
+		if (candidate == 0 || (i - (candidate - 1)) > lz_max_offset || load_u32(src + candidate - 1) != seq) {
+			++i;
+			continue;
+		}
+
+		const size_t match = candidate - 1;
+		size_t length = lz_min_match;
+		while ((i + length < byte_count) && (src[match + length] == src[i + length]))
+			++length;
+
+		lz_write_sequence(out, src + anchor, i - anchor, i - match, length);
+		i += length;
+		anchor = i;
+	}
+
+	lz_write_sequence(out, src + anchor, byte_count - anchor, 0, 0);
+	return out;
+}
+
+// Returns false if the input is malformed.
+bool lz_read_count(const unsigned char*& in, const unsigned char* in_end, size_t& count) noexcept
+{
+	unsigned char b;
+	do {
+		if (in == in_end) return false;
+		b = *in++;
+		count += b;
+	} while (b == 255);
+
+	return true;
+}
+
+// Returns false if the input is malformed or does not decompress into exactly byte_count bytes.
+bool lz_decompress(const unsigned char* src, size_t stored_byte_count, unsigned char* dest, size_t byte_count) noexcept
+{
+	const unsigned char* in = src;
+	const unsigned char* in_end = src + stored_byte_count;
+	unsigned char* out = dest;
+	unsigned char* out_end = dest + byte_count;
+
+	while (in < in_end) {
+		const unsigned char token = *in++;
+
+		size_t literal_count = token >> 4;
+		if (literal_count == 15 && !lz_read_count(in, in_end, literal_count)) return false;
+		if (size_t(in_end - in) < literal_count || size_t(out_end - out) < literal_count) return false;
+
+		std::memcpy(out, in, literal_count);
+		in += literal_count;
+		out += literal_count;
+
+		// the last sequence does not have a match.
+		if (in == in_end) break;
+
+		if (in_end - in < 2) return false;
+		const size_t offset = size_t(in[0]) | (size_t(in[1]) << 8);
+		in += 2;
+
+		size_t length = token & 0x0f;
+		if (length == 15 && !lz_read_count(in, in_end, length)) return false;
+		length += lz_min_match;
+
+		if (offset == 0 || size_t(out - dest) < offset || size_t(out_end - out) < length) return false;
+
+		const unsigned char* match = out - offset;
+		if (offset >= length) {
+			std::memcpy(out, match, length);
+			out += length;
+		}
+		else {
+			// overlapping match repeats the last offset bytes.
+			for (size_t k = 0; k < length; ++k)
+				*out++ = *match++;
+		}
+	}
+
+	return (out == out_end);
+}
+
+// ----- mounted packs -----
+
+struct mounted_pack final {
+	std::string mount_point;
+	pack file;
+};
+
+std::shared_mutex mounted_packs_mutex;
+std::vector<std::unique_ptr<mounted_pack>> mounted_packs;
+
+// Looks filename up in the mounted packs. mounted_packs_mutex must be locked by the caller.
+const pack_entry* find_in_mounted_packs(const char* filename, const pack** owner)
+{
+	assert(filename);
+	if (mounted_packs.empty()) return nullptr;
+
+	const std::string path = cg::data::normalize_pack_path(filename);
+
+	for (auto it = mounted_packs.crbegin(); it != mounted_packs.crend(); ++it) {
+		const mounted_pack& mp = **it;
+		if (path.compare(0, mp.mount_point.size(), mp.mount_point) != 0) continue;
+
+		const std::string_view p = std::string_view(path).substr(mp.mount_point.size());
+		const pack_entry* entry = mp.file.find_normalized(p);
+		if (entry) {
+			if (owner) *owner = &mp.file;
+			return entry;
+		}
+	}
+
+	return nullptr;
+}
+
+} // namespace
+
+
+namespace cg {
+namespace data {
+
+// ----- pack -----
+
+pack::pack(const std::string& filename)
+	: pack(filename.c_str())
+{}
+
+pack::pack(const char* filename)
+	: file_(filename)
+{
+	const size_t file_byte_count = file_.byte_count();
+	ENFORCE(file_byte_count >= sizeof(pack_header), "Invalid pack file: ", filename);
+
+	const pack_header* header = reinterpret_cast<const pack_header*>(file_.data());
+	ENFORCE(header->magic == pack_header::magic_value, "Invalid pack file: ", filename);
+	ENFORCE(header->version == pack_header::version_value, "Unsupported pack version: ", filename);
+
+	const uint64_t index_byte_count = uint64_t(header->entry_count) * sizeof(pack_entry);
+	ENFORCE(header->index_offset <= file_byte_count
+		&& index_byte_count <= file_byte_count - header->index_offset
+		&& header->paths_offset <= file_byte_count
+		&& header->paths_byte_count <= file_byte_count - header->paths_offset,
+		"Corrupted pack file: ", filename);
+
+	entries_ = reinterpret_cast<const pack_entry*>(file_.data() + header->index_offset);
+	entry_count_ = header->entry_count;
+	paths_ = reinterpret_cast<const char*>(file_.data() + header->paths_offset);
+
+	for (size_t i = 0; i < entry_count_; ++i) {
+		const pack_entry& e = entries_[i];
+		ENFORCE(e.offset <= file_byte_count
+			&& e.stored_byte_count <= file_byte_count - e.offset
+			&& e.path_offset <= header->paths_byte_count
+			&& e.path_byte_count <= header->paths_byte_count - e.path_offset
+			&& (e.compression == pack_compression::none || e.compression == pack_compression::lz),
+			"Corrupted pack file: ", filename);
+	}
+}
+
+pack::pack(pack&& p) noexcept
+	: file_(std::move(p.file_)),
+	entries_(p.entries_),
+	entry_count_(p.entry_count_),
+	paths_(p.paths_)
+{
+	p.entries_ = nullptr;
+	p.entry_count_ = 0;
+	p.paths_ = nullptr;
+}
+
+pack& pack::operator=(pack&& p) noexcept
+{
+	if (this == &p) return *this;
+
+	file_ = std::move(p.file_);
+	entries_ = p.entries_;
+	entry_count_ = p.entry_count_;
+	paths_ = p.paths_;
+
+	p.entries_ = nullptr;
+	p.entry_count_ = 0;
+	p.paths_ = nullptr;
+
+	return *this;
+}
+
+const pack_entry* pack::find(std::string_view path) const
+{
+	return find_normalized(normalize_pack_path(path));
+}
+
+const pack_entry* pack::find_normalized(std::string_view path) const noexcept
+{
+	const uint64_t hash = pack_path_hash(path);
+	const pack_entry* last = entries_ + entry_count_;
+	const pack_entry* it = std::lower_bound(entries_, last, hash,
+		[](const pack_entry& e, uint64_t h) { return e.path_hash < h; });
+
+	for (; it != last && it->path_hash == hash; ++it) {
+		if (this->path(*it) == path) return it;
+	}
+
+	return nullptr;
+}
+
+std::string_view pack::path(const pack_entry& entry) const noexcept
+{
+	return std::string_view(paths_ + entry.path_offset, entry.path_byte_count);
+}
+
+pack_file pack::read(const pack_entry& entry) const
+{
+	const std::basic_string_view<unsigned char> stored = stored_bytes(entry);
+	if (entry.compression == pack_compression::none)
+		return pack_file(stored);
+
+	std::vector<unsigned char> storage(size_t(entry.byte_count));
+	const bool res = lz_decompress(stored.data(), stored.size(), storage.data(), storage.size());
+	ENFORCE(res, "Corrupted pack entry ", path(entry), " in ", filename());
+
+	return pack_file(std::move(storage));
+}
+
+// ----- pack_writer -----
+
+pack_writer::pack_writer(const std::string& filename, size_t payload_alignment)
+	: pack_writer(filename.c_str(), payload_alignment)
+{}
+
+#pragma warning(push)
+#pragma warning(disable:4996)
+pack_writer::pack_writer(const char* filename, size_t payload_alignment)
+	: filename_(filename),
+	payload_alignment_(payload_alignment)
+{
+	assert(payload_alignment > 0);
+	assert((payload_alignment & (payload_alignment - 1)) == 0);
+
+	handle_ = std::fopen(filename, "wb");
+	ENFORCE(handle_, "Failed to create pack file: ", filename);
+
+	// the header is written by finish().
+	const pack_header header = {};
+	write(&header, sizeof(header));
+}
+#pragma warning(pop)
+
+pack_writer::~pack_writer() noexcept
+{
+	if (handle_) std::fclose(handle_);
+}
+
+void pack_writer::add(std::string_view path, const void* data, size_t byte_count, bool compress)
+{
+	assert(handle_);
+	assert(data || byte_count == 0);
+
+	const std::string normalized_path = normalize_pack_path(path);
+	ENFORCE(!normalized_path.empty(), "Pack entry path must not be empty.");
+
+	const unsigned char* payload = reinterpret_cast<const unsigned char*>(data);
+	size_t stored_byte_count = byte_count;
+	pack_compression compression = pack_compression::none;
+	std::vector<unsigned char> compressed;
+
+	if (compress && byte_count > 0) {
+		compressed = lz_compress(payload, byte_count);
+
+		// compression must save at least 1/8 of the size, otherwise it is not worth decompressing.
+		if (compressed.size() < byte_count - byte_count / 8) {
+			payload = compressed.data();
+			stored_byte_count = compressed.size();
+			compression = pack_compression::lz;
+		}
+	}
+
+	const uint64_t aligned_offset = (offset_ + payload_alignment_ - 1) & ~uint64_t(payload_alignment_ - 1);
+	if (aligned_offset > offset_) {
+		static const unsigned char zeros[256] = {};
+		while (offset_ < aligned_offset)
+			write(zeros, size_t(std::min<uint64_t>(aligned_offset - offset_, sizeof(zeros))));
+	}
+
+	pack_entry entry = {};
+	entry.path_hash = pack_path_hash(normalized_path);
+	entry.path_offset = paths_.size();
+	entry.offset = offset_;
+	entry.stored_byte_count = stored_byte_count;
+	entry.byte_count = byte_count;
+	entry.path_byte_count = uint32_t(normalized_path.size());
+	entry.compression = compression;
+
+	if (stored_byte_count > 0) write(payload, stored_byte_count);
+	entries_.push_back(entry);
+	paths_.append(normalized_path);
+}
+
+void pack_writer::finish()
+{
+	assert(handle_);
+
+	// stable sort keeps entries with equal hashes in the order they were added.
+	std::stable_sort(entries_.begin(), entries_.end(),
+		[](const pack_entry& l, const pack_entry& r) { return l.path_hash < r.path_hash; });
+
+	for (size_t i = 1; i < entries_.size(); ++i) {
+		const pack_entry& l = entries_[i - 1];
+		const pack_entry& r = entries_[i];
+		if (l.path_hash != r.path_hash) continue;
+
+		// entries with equal hashes are adjacent, a duplicate might be a few entries back.
+		for (size_t j = i; j > 0 && entries_[j - 1].path_hash == r.path_hash; --j) {
+			const pack_entry& e = entries_[j - 1];
+			ENFORCE(paths_.compare(size_t(e.path_offset), e.path_byte_count,
+				paths_, size_t(r.path_offset), r.path_byte_count) != 0,
+				"Pack ", filename_, " contains duplicate entry: ", paths_.substr(size_t(r.path_offset), r.path_byte_count));
+		}
+	}
+
+	pack_header header = {};
+	header.magic = pack_header::magic_value;
+	header.version = pack_header::version_value;
+	header.entry_count = uint32_t(entries_.size());
+	header.payload_alignment = uint32_t(payload_alignment_);
+
+	// pack_entry contains 8 byte fields, the index is aligned accordingly.
+	const uint64_t aligned_offset = (offset_ + 7) & ~uint64_t(7);
+	if (aligned_offset > offset_) {
+		const unsigned char zeros[8] = {};
+		write(zeros, size_t(aligned_offset - offset_));
+	}
+
+	header.index_offset = offset_;
+	if (!entries_.empty()) write(entries_.data(), entries_.size() * sizeof(pack_entry));
+
+	header.paths_offset = offset_;
+	header.paths_byte_count = paths_.size();
+	if (!paths_.empty()) write(paths_.data(), paths_.size());
+
+	ENFORCE(std::fseek(handle_, 0, SEEK_SET) == 0, "Pack file write error: ", filename_);
+	ENFORCE(std::fwrite(&header, sizeof(header), 1, handle_) == 1, "Pack file write error: ", filename_);
+
+	const int res = std::fclose(handle_);
+	handle_ = nullptr;
+	ENFORCE(res == 0, "Pack file write error: ", filename_);
+}
+
+void pack_writer::write(const void* data, size_t byte_count)
+{
+	const size_t res = std::fwrite(data, 1, byte_count, handle_);
+	ENFORCE(res == byte_count, "Pack file write error: ", filename_);
+	offset_ += byte_count;
+}
+
+// ----- funcs -----
+
+uint64_t pack_path_hash(std::string_view normalized_path) noexcept
+{
+	// FNV-1a
+	uint64_t hash = 14695981039346656037ull;
+	for (char ch : normalized_path) {
+		hash ^= static_cast<unsigned char>(ch);
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+std::string normalize_pack_path(std::string_view path)
+{
+	std::string str(path);
+	for (char& ch : str) {
+		if (ch == '\\') ch = '/';
+		else if ('A' <= ch && ch <= 'Z') ch = ch - 'A' + 'a';
+	}
+
+	while (str.compare(0, 2, "./") == 0)
+		str.erase(0, 2);
+
+	return str;
+}
+
+void mount_pack(const std::string& filename, const std::string& mount_point)
+{
+	auto mp = std::make_unique<mounted_pack>();
+	mp->mount_point = normalize_pack_path(mount_point);
+	mp->file = pack(filename);
+
+	std::unique_lock<std::shared_mutex> lock(mounted_packs_mutex);
+	mounted_packs.push_back(std::move(mp));
+}
+
+bool exists_in_packs(const char* filename)
+{
+	std::shared_lock<std::shared_mutex> lock(mounted_packs_mutex);
+	return (find_in_mounted_packs(filename, nullptr) != nullptr);
+}
+
+std::unique_ptr<pack_file> open_from_packs(const char* filename)
+{
+	std::shared_lock<std::shared_mutex> lock(mounted_packs_mutex);
+
+	const pack* owner = nullptr;
+	const pack_entry* entry = find_in_mounted_packs(filename, &owner);
+	if (!entry) return nullptr;
+
+	return std::make_unique<pack_file>(owner->read(*entry));
+}
+
+void unmount_packs() noexcept
+{
+	std::unique_lock<std::shared_mutex> lock(mounted_packs_mutex);
+	mounted_packs.clear();
+}
+
+} // namespace data
+} // namespace cg
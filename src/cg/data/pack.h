@@ -0,0 +1,236 @@
+#ifndef CG_DATA_PACK_H_
+#define CG_DATA_PACK_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "cg/data/file.h"
+
+
+namespace cg {
+namespace data {
+
+// Pack is a single file which stores many asset files.
+// Layout:
+// -	pack_header.
+// -	Payloads of all the entries. Each payload starts at a multiple of pack_header::payload_alignment.
+// -	Index: pack_header::entry_count pack_entry structs sorted by path_hash.
+// -	Paths: all the entry paths, not null terminated.
+// Paths are relative to the packed directory and normalized (see normalize_pack_path).
+
+enum class pack_compression : uint32_t {
+	none = 0,
+	lz = 1
+};
+
+struct pack_header final {
+	static constexpr uint32_t magic_value = 0x4b504743; // "CGPK"
+	static constexpr uint32_t version_value = 1;
+
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entry_count;
+	uint32_t payload_alignment;
+	uint64_t index_offset;
+	uint64_t paths_offset;
+	uint64_t paths_byte_count;
+	uint64_t reserved[3];
+};
+
+struct pack_entry final {
+	uint64_t path_hash;
+	uint64_t path_offset;
+	uint64_t offset;
+	uint64_t stored_byte_count;
+	uint64_t byte_count;
+	uint32_t path_byte_count;
+	pack_compression compression;
+};
+
+static_assert(sizeof(pack_header) == 64, "pack_header must not contain padding.");
+static_assert(sizeof(pack_entry) == 48, "pack_entry must not contain padding.");
+
+// pack_file is the content of a file which has been read from a pack.
+// Uncompressed entries are not copied, bytes() points directly into the mapped pack.
+// Compressed entries are decompressed into a buffer owned by the pack_file.
+class pack_file final {
+public:
+
+	explicit pack_file(std::basic_string_view<unsigned char> bytes) noexcept
+		: bytes_(bytes)
+	{}
+
+	explicit pack_file(std::vector<unsigned char>&& storage) noexcept
+		: storage_(std::move(storage)),
+		bytes_(storage_.data(), storage_.size())
+	{}
+
+	pack_file(const pack_file&) = delete;
+
+	pack_file(pack_file&&) noexcept = default;
+
+
+	pack_file& operator=(const pack_file&) = delete;
+
+	pack_file& operator=(pack_file&&) noexcept = default;
+
+
+	std::basic_string_view<unsigned char> bytes() const noexcept
+	{
+		return bytes_;
+	}
+
+	std::string_view text() const noexcept
+	{
+		return std::string_view(reinterpret_cast<const char*>(bytes_.data()), bytes_.size());
+	}
+
+private:
+	std::vector<unsigned char> storage_;
+	std::basic_string_view<unsigned char> bytes_;
+};
+
+// pack maps a pack file into memory and provides access to its entries.
+// The index is not parsed or copied, lookups binary search the mapped index.
+class pack final {
+public:
+
+	pack() noexcept = default;
+
+	explicit pack(const std::string& filename);
+
+	explicit pack(const char* filename);
+
+	pack(const pack&) = delete;
+
+	pack(pack&& p) noexcept;
+
+
+	pack& operator=(const pack&) = delete;
+
+	pack& operator=(pack&& p) noexcept;
+
+
+	// Returns the number of files in the pack.
+	size_t entry_count() const noexcept
+	{
+		return entry_count_;
+	}
+
+	// Returns all the entries sorted by path_hash.
+	const pack_entry* entries() const noexcept
+	{
+		return entries_;
+	}
+
+	// Returns the name of the pack file.
+	const std::string& filename() const noexcept
+	{
+		return file_.filename();
+	}
+
+	// Returns the entry of the specified file or nullptr if the pack does not contain the file.
+	// path is normalized before the lookup.
+	const pack_entry* find(std::string_view path) const;
+
+	// Returns the entry of the specified file or nullptr if the pack does not contain the file.
+	// path must be normalized already.
+	const pack_entry* find_normalized(std::string_view path) const noexcept;
+
+	// Returns the path of the entry.
+	std::string_view path(const pack_entry& entry) const noexcept;
+
+	// Returns the content of the entry. Compressed entries are decompressed.
+	pack_file read(const pack_entry& entry) const;
+
+	// Returns the payload of the entry as it is stored in the pack.
+	std::basic_string_view<unsigned char> stored_bytes(const pack_entry& entry) const noexcept
+	{
+		return std::basic_string_view<unsigned char>(file_.data() + entry.offset, size_t(entry.stored_byte_count));
+	}
+
+private:
+	Mapped_file file_;
+	const pack_entry* entries_ = nullptr;
+	size_t entry_count_ = 0;
+	const char* paths_ = nullptr;
+};
+
+// pack_writer creates a pack file. Payloads are written as soon as they are added,
+// the index is written by finish(). The pack is not valid until finish() has been called.
+class pack_writer final {
+public:
+
+	explicit pack_writer(const std::string& filename, size_t payload_alignment = 64);
+
+	explicit pack_writer(const char* filename, size_t payload_alignment = 64);
+
+	pack_writer(const pack_writer&) = delete;
+
+	pack_writer(pack_writer&&) = delete;
+
+	~pack_writer() noexcept;
+
+
+	pack_writer& operator=(const pack_writer&) = delete;
+
+	pack_writer& operator=(pack_writer&&) = delete;
+
+
+	// Appends the file's content to the pack.
+	// If compress is true the content is compressed, compressed payload is kept only
+	// if it is noticeably smaller than the original content.
+	void add(std::string_view path, const void* data, size_t byte_count, bool compress);
+
+	// Writes the index and closes the file.
+	void finish();
+
+	// Returns the number of files that have been added.
+	size_t entry_count() const noexcept
+	{
+		return entries_.size();
+	}
+
+private:
+	void write(const void* data, size_t byte_count);
+
+	std::string filename_;
+	FILE* handle_ = nullptr;
+	size_t payload_alignment_;
+	uint64_t offset_ = 0;
+	std::vector<pack_entry> entries_;
+	std::string paths_;
+};
+
+// Returns the hash of the normalized path.
+uint64_t pack_path_hash(std::string_view normalized_path) noexcept;
+
+// Converts all the back slashes to forward slashes and all the ascii letters to lower case.
+// Leading "./" is removed.
+std::string normalize_pack_path(std::string_view path);
+
+// Mounts the specified pack. While the pack is mounted Mapped_file, File, exists, load_text,
+// image_2d & load_model look files up in the pack before they touch the file system.
+// Paths that start with mount_point are looked up in the pack with mount_point removed,
+// for example: mount_pack("../../data/data.cgpack", "../../data/").
+// Packs which are mounted later take precedence.
+void mount_pack(const std::string& filename, const std::string& mount_point);
+
+// Returns true if the specified file is stored in one of the mounted packs.
+bool exists_in_packs(const char* filename);
+
+// Returns the content of the specified file if it is stored in one of the mounted packs,
+// otherwise returns nullptr.
+std::unique_ptr<pack_file> open_from_packs(const char* filename);
+
+// Unmounts all the packs. pack_file objects which point into the packs become invalid.
+// Must not be called while other threads load files.
+void unmount_packs() noexcept;
+
+} // namespace data
+} // namespace cg
+
+#endif // CG_DATA_PACK_H_
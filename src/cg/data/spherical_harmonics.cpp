@@ -0,0 +1,213 @@
+#include "cg/data/spherical_harmonics.h"
+
+#include <cassert>
+#include <cmath>
+#include <mutex>
+#include <vector>
+#include "cg/data/image_convert.h"
+
+
+namespace {
+
+using cg::data::cube_face;
+using cg::data::image_view;
+using cg::data::pixel_format;
+using cg::data::sh9;
+
+// Number of rows which are processed by one task.
+constexpr size_t row_grain_size = 16;
+
+constexpr double pi_d = 3.14159265358979323846;
+
+// Weighted sums of one task. Doubles keep the sums of millions of texels precise.
+struct sh9_sum final {
+	double coefficients[sh9::coefficient_count][3] = {};
+	double weight = 0.0;
+
+	sh9_sum& operator+=(const sh9_sum& sum) noexcept
+	{
+		for (size_t i = 0; i < sh9::coefficient_count; ++i) {
+			coefficients[i][0] += sum.coefficients[i][0];
+			coefficients[i][1] += sum.coefficients[i][1];
+			coefficients[i][2] += sum.coefficients[i][2];
+		}
+
+		weight += sum.weight;
+		return *this;
+	}
+};
+
+// Computes the basis functions in the normalized direction (x, y, z).
+inline void sh9_basis(float x, float y, float z, float* basis) noexcept
+{
+	basis[0] = 0.282095f;
+	basis[1] = 0.488603f * y;
+	basis[2] = 0.488603f * z;
+	basis[3] = 0.488603f * x;
+	basis[4] = 1.092548f * x * y;
+	basis[5] = 1.092548f * y * z;
+	basis[6] = 0.315392f * (3.0f * z * z - 1.0f);
+	basis[7] = 1.092548f * x * z;
+	basis[8] = 0.546274f * (x * x - y * y);
+}
+
+// Adds the rgb of the texel which is seen in the normalized direction (x, y, z).
+inline void accumulate(float x, float y, float z, const float* rgb, float weight, sh9_sum& sum) noexcept
+{
+	float basis[sh9::coefficient_count];
+	sh9_basis(x, y, z, basis);
+
+	for (size_t i = 0; i < sh9::coefficient_count; ++i) {
+		const double w = double(basis[i]) * weight;
+		sum.coefficients[i][0] += w * rgb[0];
+		sum.coefficients[i][1] += w * rgb[1];
+		sum.coefficients[i][2] += w * rgb[2];
+	}
+
+	sum.weight += weight;
+}
+
+// Reads the row y of the image as rgba_32f pixels.
+void load_row(const image_view& image, size_t y, float* dst)
+{
+	const size_t row_byte_count = image.size.x * cg::data::byte_count(image.pixel_format);
+	const image_view row(reinterpret_cast<const uint8_t*>(image.data) + y * row_byte_count,
+		uint2(image.size.x, 1), image.pixel_format);
+
+	cg::data::convert(row, pixel_format::rgba_32f, dst);
+}
+
+// The weights sum up to the area of the unit sphere (4 pi), the sum is normalized to reduce the discretization error.
+sh9 normalize_sum(const sh9_sum& sum) noexcept
+{
+	assert(sum.weight > 0.0);
+	const double scale = 4.0 * pi_d / sum.weight;
+
+	sh9 sh;
+	for (size_t i = 0; i < sh9::coefficient_count; ++i) {
+		sh.coefficients[i] = float3(float(sum.coefficients[i][0] * scale),
+			float(sum.coefficients[i][1] * scale),
+			float(sum.coefficients[i][2] * scale));
+	}
+
+	return sh;
+}
+
+} // namespace
+
+
+namespace cg {
+namespace data {
+
+float3 evaluate_sh9(const sh9& sh, const float3& direction) noexcept
+{
+	float basis[sh9::coefficient_count];
+	sh9_basis(direction.x, direction.y, direction.z, basis);
+
+	float3 v = float3::zero;
+	for (size_t i = 0; i < sh9::coefficient_count; ++i)
+		v += basis[i] * sh.coefficients[i];
+
+	return v;
+}
+
+sh9 irradiance_sh9(const sh9& radiance) noexcept
+{
+	// the clamped cosine lobe per band: pi, 2 pi / 3, pi / 4.
+	constexpr float band_scales[3] = { float(pi_d), float(2.0 * pi_d / 3.0), float(pi_d / 4.0) };
+
+	sh9 irradiance;
+	irradiance.coefficients[0] = band_scales[0] * radiance.coefficients[0];
+	for (size_t i = 1; i < 4; ++i)
+		irradiance.coefficients[i] = band_scales[1] * radiance.coefficients[i];
+	for (size_t i = 4; i < sh9::coefficient_count; ++i)
+		irradiance.coefficients[i] = band_scales[2] * radiance.coefficients[i];
+
+	return irradiance;
+}
+
+sh9 project_sh9(const image_cube& cube, thread_pool& pool)
+{
+	assert(cube.side_size() > 0);
+	assert(!is_block_compressed(cube.format()));
+
+	const uint32_t side_size = cube.side_size();
+	const image_view faces = cube.faces();
+	const float inv_side_size = 1.0f / side_size;
+	std::mutex mutex;
+	sh9_sum total;
+
+	parallel_for(pool, size_t(side_size) * cube_face_count, row_grain_size, [&](size_t first, size_t last) {
+		std::vector<float> rgba(side_size * 4);
+		sh9_sum sum;
+
+		for (size_t r = first; r < last; ++r) {
+			const cube_face face = cube_face(r / side_size);
+			const float v = (r % side_size + 0.5f) * inv_side_size;
+			load_row(faces, r, rgba.data());
+
+			for (uint32_t x = 0; x < side_size; ++x) {
+				const float3 d = cube_direction(face, (x + 0.5f) * inv_side_size, v);
+				const float len_sq = d.x * d.x + d.y * d.y + d.z * d.z;
+				const float inv_len = 1.0f / std::sqrt(len_sq);
+				// the solid angle of a texel is proportional to 1 / (1 + u^2 + v^2)^(3/2) == inv_len^3.
+				const float weight = inv_len * inv_len * inv_len;
+
+				accumulate(d.x * inv_len, d.y * inv_len, d.z * inv_len, rgba.data() + x * 4, weight, sum);
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		total += sum;
+	});
+
+	return normalize_sum(total);
+}
+
+sh9 project_sh9_equirect(const image_view& panorama, thread_pool& pool)
+{
+	assert(panorama.data);
+	assert(panorama.size.x > 0 && panorama.size.y > 0);
+	assert(!is_block_compressed(panorama.pixel_format));
+
+	const uint2 size = panorama.size;
+	std::mutex mutex;
+	sh9_sum total;
+
+	// the longitude of every column is the same for all rows.
+	std::vector<float> cos_phi(size.x);
+	std::vector<float> sin_phi(size.x);
+	for (size_t x = 0; x < size.x; ++x) {
+		const double phi = ((x + 0.5) / size.x - 0.5) * 2.0 * pi_d;
+		cos_phi[x] = float(std::cos(phi));
+		sin_phi[x] = float(std::sin(phi));
+	}
+
+	parallel_for(pool, size.y, row_grain_size, [&](size_t first, size_t last) {
+		std::vector<float> rgba(size.x * 4);
+		sh9_sum sum;
+
+		for (size_t y = first; y < last; ++y) {
+			// theta is the angle between the direction & +Y, the top row is +Y.
+			const double theta = (y + 0.5) / size.y * pi_d;
+			const float cos_theta = float(std::cos(theta));
+			const float sin_theta = float(std::sin(theta));
+			// the solid angle of a texel is proportional to sin(theta).
+			const float weight = sin_theta;
+			load_row(panorama, y, rgba.data());
+
+			for (size_t x = 0; x < size.x; ++x) {
+				accumulate(sin_theta * cos_phi[x], cos_theta, sin_theta * sin_phi[x],
+					rgba.data() + x * 4, weight, sum);
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		total += sum;
+	});
+
+	return normalize_sum(total);
+}
+
+} // namespace data
+} // namespace cg
@@ -0,0 +1,39 @@
+#ifndef CG_DATA_SPHERICAL_HARMONICS_H_
+#define CG_DATA_SPHERICAL_HARMONICS_H_
+
+#include "cg/base/math.h"
+#include "cg/base/thread_pool.h"
+#include "cg/data/image.h"
+#include "cg/data/image_cube.h"
+
+
+namespace cg {
+namespace data {
+
+// sh9 stores the first 3 bands (9 coefficients) of the real spherical harmonics per color channel.
+// The coefficients are ordered as l = 0; l = 1, m = -1, 0, 1; l = 2, m = -2, ..., 2.
+struct sh9 final {
+	static constexpr size_t coefficient_count = 9;
+
+	float3 coefficients[coefficient_count];
+};
+
+// Evaluates the function represented by sh in the specified direction. direction must be normalized.
+float3 evaluate_sh9(const sh9& sh, const float3& direction) noexcept;
+
+// Convolves the radiance with the clamped cosine lobe (Ramamoorthi & Hanrahan).
+// Evaluation of the result in the direction n gives the irradiance of a surface which normal is n.
+sh9 irradiance_sh9(const sh9& radiance) noexcept;
+
+// Projects the radiance of the cube onto sh9. Texels are weighted by the solid angles they subtend.
+// The rgb channels are projected, alpha is ignored. Rows of the faces are split between the workers of the pool.
+sh9 project_sh9(const image_cube& cube, thread_pool& pool);
+
+// Projects the radiance of the equirectangular panorama onto sh9.
+// The panorama has the same layout as equirect_to_cube expects.
+sh9 project_sh9_equirect(const image_view& panorama, thread_pool& pool);
+
+} // namespace data
+} // namespace cg
+
+#endif // CG_DATA_SPHERICAL_HARMONICS_H_
@@ -0,0 +1,190 @@
+#include "cg/data/summed_area_table.h"
+
+#include <cassert>
+#include <algorithm>
+#include <emmintrin.h>
+#include "cg/data/image_convert.h"
+
+
+namespace {
+
+// Number of rows which are summed by one task.
+constexpr size_t row_grain_size = 16;
+
+// Number of doubles of a row which are summed by one task of the column pass.
+constexpr size_t column_grain_size = 512;
+
+// Computes the prefix sums of the rows [first, last) of the rgba_32f pixels.
+// table has (width + 1) x (height + 1) sums, the first column of each row is zero.
+void sum_rows(const float* pixels, size_t width, bool squared, double* table, size_t first, size_t last) noexcept
+{
+	const size_t row_size = (width + 1) * 4;
+
+	for (size_t y = first; y < last; ++y) {
+		const float* p = pixels + y * width * 4;
+		double* t = table + (y + 1) * row_size;
+		__m128d lo = _mm_setzero_pd();
+		__m128d hi = _mm_setzero_pd();
+		_mm_storeu_pd(t, lo);
+		_mm_storeu_pd(t + 2, hi);
+
+		for (size_t x = 0; x < width; ++x, p += 4) {
+			__m128 v = _mm_loadu_ps(p);
+			if (squared) v = _mm_mul_ps(v, v);
+
+			lo = _mm_add_pd(lo, _mm_cvtps_pd(v));
+			hi = _mm_add_pd(hi, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+			_mm_storeu_pd(t + (x + 1) * 4, lo);
+			_mm_storeu_pd(t + (x + 1) * 4 + 2, hi);
+		}
+	}
+}
+
+// Accumulates the row sums down the columns [first, last) (in doubles).
+// Rows are processed top to bottom, every step adds a contiguous range of the previous row.
+void sum_columns(double* table, size_t row_size, size_t height, size_t first, size_t last) noexcept
+{
+	for (size_t y = 2; y <= height; ++y) {
+		const double* prev = table + (y - 1) * row_size;
+		double* row = table + y * row_size;
+		for (size_t i = first; i < last; i += 2)
+			_mm_storeu_pd(row + i, _mm_add_pd(_mm_loadu_pd(row + i), _mm_loadu_pd(prev + i)));
+	}
+}
+
+void build_table(const float* pixels, const uint2& size, bool squared, std::vector<double>& table,
+	cg::thread_pool& pool)
+{
+	const size_t row_size = (size.x + 1) * 4;
+	table.assign(row_size * (size.y + 1), 0.0);
+
+	cg::parallel_for(pool, size.y, row_grain_size, [&](size_t first, size_t last) {
+		sum_rows(pixels, size.x, squared, table.data(), first, last);
+	});
+
+	// row_size & column_grain_size are even, so are the ranges.
+	cg::parallel_for(pool, row_size, column_grain_size, [&](size_t first, size_t last) {
+		sum_columns(table.data(), row_size, size.y, first, last);
+	});
+}
+
+} // namespace
+
+
+namespace cg {
+namespace data {
+
+summed_area_table::summed_area_table(const image_view& image, thread_pool& pool, bool store_squares)
+	: size_(image.size)
+{
+	assert(image.data);
+	assert(image.size.x > 0 && image.size.y > 0);
+	assert(image.pixel_format != pixel_format::none);
+	assert(!is_block_compressed(image.pixel_format));
+
+	image_2d pixels(image.size, pixel_format::rgba_32f);
+	convert(image, pixel_format::rgba_32f, pixels.data, pool);
+
+	const float* p = reinterpret_cast<const float*>(pixels.data);
+	build_table(p, size_, false, sums_, pool);
+	if (store_squares)
+		build_table(p, size_, true, squares_, pool);
+}
+
+void summed_area_table::rect_sum(const std::vector<double>& table, const uint2& p0, const uint2& p1,
+	double* sum) const noexcept
+{
+	const size_t row_size = (size_.x + 1) * 4;
+	const double* t00 = table.data() + p0.y * row_size + p0.x * 4;
+	const double* t01 = table.data() + p0.y * row_size + p1.x * 4;
+	const double* t10 = table.data() + p1.y * row_size + p0.x * 4;
+	const double* t11 = table.data() + p1.y * row_size + p1.x * 4;
+
+	for (size_t i = 0; i < 4; i += 2) {
+		const __m128d s = _mm_add_pd(_mm_sub_pd(_mm_loadu_pd(t11 + i), _mm_loadu_pd(t01 + i)),
+			_mm_sub_pd(_mm_loadu_pd(t00 + i), _mm_loadu_pd(t10 + i)));
+		_mm_storeu_pd(sum + i, s);
+	}
+}
+
+float4 summed_area_table::sum(const uint2& p0, const uint2& p1) const noexcept
+{
+	assert(p0.x < size_.x && p0.y < size_.y);
+
+	const uint2 end(std::min(p1.x, size_.x - 1) + 1, std::min(p1.y, size_.y - 1) + 1);
+	assert(p0.x < end.x && p0.y < end.y);
+
+	double s[4];
+	rect_sum(sums_, p0, end, s);
+	return float4(float(s[0]), float(s[1]), float(s[2]), float(s[3]));
+}
+
+float4 summed_area_table::mean(const uint2& p0, const uint2& p1) const noexcept
+{
+	assert(p0.x < size_.x && p0.y < size_.y);
+
+	const uint2 end(std::min(p1.x, size_.x - 1) + 1, std::min(p1.y, size_.y - 1) + 1);
+	assert(p0.x < end.x && p0.y < end.y);
+
+	double s[4];
+	rect_sum(sums_, p0, end, s);
+	const double count = double(end.x - p0.x) * double(end.y - p0.y);
+	return float4(float(s[0] / count), float(s[1] / count), float(s[2] / count), float(s[3] / count));
+}
+
+float4 summed_area_table::variance(const uint2& p0, const uint2& p1) const noexcept
+{
+	assert(has_squares());
+	assert(p0.x < size_.x && p0.y < size_.y);
+
+	const uint2 end(std::min(p1.x, size_.x - 1) + 1, std::min(p1.y, size_.y - 1) + 1);
+	assert(p0.x < end.x && p0.y < end.y);
+
+	double s[4];
+	double sq[4];
+	rect_sum(sums_, p0, end, s);
+	rect_sum(squares_, p0, end, sq);
+	const double count = double(end.x - p0.x) * double(end.y - p0.y);
+
+	// E[x^2] - E[x]^2 may get slightly negative due to rounding.
+	float v[4];
+	for (size_t i = 0; i < 4; ++i) {
+		const double m = s[i] / count;
+		v[i] = float(std::max(sq[i] / count - m * m, 0.0));
+	}
+
+	return float4(v[0], v[1], v[2], v[3]);
+}
+
+float4 summed_area_table::box_mean(const uint2& p, size_t radius) const noexcept
+{
+	const uint32_t r = uint32_t(std::min<size_t>(radius, std::max(size_.x, size_.y)));
+	const uint2 p0((p.x > r) ? (p.x - r) : 0, (p.y > r) ? (p.y - r) : 0);
+	const uint2 p1(p.x + r, p.y + r);
+	return mean(p0, p1);
+}
+
+image_2d summed_area_table::box_filter(size_t radius, pixel_format fmt, thread_pool& pool) const
+{
+	assert(fmt != pixel_format::none);
+	assert(!is_block_compressed(fmt));
+
+	image_2d pixels(size_, pixel_format::rgba_32f);
+	float4* p = reinterpret_cast<float4*>(pixels.data);
+
+	parallel_for(pool, size_.y, row_grain_size, [&](size_t first, size_t last) {
+		for (uint32_t y = uint32_t(first); y < last; ++y) {
+			for (uint32_t x = 0; x < size_.x; ++x)
+				p[y * size_.x + x] = box_mean(uint2(x, y), radius);
+		}
+	});
+
+	if (fmt == pixel_format::rgba_32f) return pixels;
+
+	image_2d image(size_, fmt);
+	convert(pixels, fmt, image.data, pool);
+	return image;
+}
+
+} // namespace data
+} // namespace cg
@@ -0,0 +1,79 @@
+#ifndef CG_DATA_SUMMED_AREA_TABLE_H_
+#define CG_DATA_SUMMED_AREA_TABLE_H_
+
+#include <vector>
+#include "cg/base/math.h"
+#include "cg/base/thread_pool.h"
+#include "cg/data/image.h"
+
+
+namespace cg {
+namespace data {
+
+// summed_area_table stores for each pixel the sum of all the pixels above & to the left of it (inclusive).
+// The sum of any rectangle costs 4 lookups, so box filters of any radius have constant cost.
+// Pixels are summed as 4 channels (missing channels are filled as convert does), sums are doubles:
+// float sums of large images lose the precision the differences require.
+class summed_area_table final {
+public:
+
+	summed_area_table() noexcept = default;
+
+	// Builds the table of the image on the workers of the pool.
+	// If store_squares is set the sums of the squared pixels are stored too, variance requires them.
+	summed_area_table(const image_view& image, thread_pool& pool, bool store_squares = false);
+
+	summed_area_table(const summed_area_table&) = delete;
+
+	summed_area_table(summed_area_table&&) noexcept = default;
+
+
+	summed_area_table& operator=(const summed_area_table&) = delete;
+
+	summed_area_table& operator=(summed_area_table&&) noexcept = default;
+
+
+	// Size of the source image.
+	const uint2& size() const noexcept
+	{
+		return size_;
+	}
+
+	// Returns true if the sums of the squared pixels are stored.
+	bool has_squares() const noexcept
+	{
+		return !squares_.empty();
+	}
+
+	// Returns the sum of the pixels in the rectangle [p0, p1] (inclusive). p1 is clamped to the image.
+	float4 sum(const uint2& p0, const uint2& p1) const noexcept;
+
+	// Returns the average of the pixels in the rectangle [p0, p1] (inclusive). p1 is clamped to the image.
+	float4 mean(const uint2& p0, const uint2& p1) const noexcept;
+
+	// Returns the variance of the pixels in the rectangle [p0, p1] (inclusive). p1 is clamped to the image.
+	// Requires has_squares().
+	float4 variance(const uint2& p0, const uint2& p1) const noexcept;
+
+	// Returns the average of the (2 * radius + 1) x (2 * radius + 1) pixels around p.
+	// Near the edges only the pixels inside the image are averaged.
+	float4 box_mean(const uint2& p, size_t radius) const noexcept;
+
+	// Returns the image of box_mean of every pixel in the specified format.
+	image_2d box_filter(size_t radius, pixel_format fmt, thread_pool& pool) const;
+
+private:
+
+	// Sums of the rectangle [p0, p1), the corners are within [0, size].
+	void rect_sum(const std::vector<double>& table, const uint2& p0, const uint2& p1, double* sum) const noexcept;
+
+	// (size.x + 1) x (size.y + 1) sums of 4 channels. The first row & column are zeros.
+	std::vector<double> sums_;
+	std::vector<double> squares_;
+	uint2 size_;
+};
+
+} // namespace data
+} // namespace cg
+
+#endif // CG_DATA_SUMMED_AREA_TABLE_H_
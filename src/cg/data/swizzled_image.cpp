@@ -0,0 +1,399 @@
+#include "cg/data/swizzled_image.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <emmintrin.h>
+#include "cg/data/image_convert.h"
+
+
+namespace {
+
+using cg::data::image_2d;
+using cg::data::image_view;
+using cg::data::pixel_format;
+using cg::data::sampler_filter;
+using cg::data::sampler_wrap;
+using cg::data::swizzled_image;
+
+constexpr uint32_t tile_size = swizzled_image::tile_size;
+constexpr size_t tile_pixel_count = tile_size * tile_size;
+
+// Number of tile rows which are swizzled by one task.
+constexpr size_t tile_row_grain_size = 4;
+
+// Spreads the 3 low bits of v: b2 b1 b0 -> b2 0 b1 0 b0.
+inline uint32_t spread_bits(uint32_t v) noexcept
+{
+	return (v & 1) | ((v & 2) << 1) | ((v & 4) << 2);
+}
+
+// Returns the offset of the pixel within its tile: the bits of x & y are interleaved (y2 x2 y1 x1 y0 x0).
+inline uint32_t morton_offset(uint32_t x, uint32_t y) noexcept
+{
+	return spread_bits(x & (tile_size - 1)) | (spread_bits(y & (tile_size - 1)) << 1);
+}
+
+// Returns the offset of the pixel (x, y) from the level's first tile in pixels.
+inline size_t pixel_offset(uint32_t x, uint32_t y, uint32_t tile_count_x) noexcept
+{
+	const size_t tile = size_t(y / tile_size) * tile_count_x + x / tile_size;
+	return tile * tile_pixel_count + morton_offset(x, y);
+}
+
+// Maps the pixel coordinate c into [0, size - 1]. NaN is mapped to 0.
+inline uint32_t wrap_coord(float c, uint32_t size, sampler_wrap wrap) noexcept
+{
+	const float s = float(size);
+	if (wrap == sampler_wrap::repeat)
+		c -= std::floor(c / s) * s;
+
+	// the comparisons are ordered as _mm_max_ps & _mm_min_ps do it.
+	c = (c > 0.0f) ? c : 0.0f;
+	c = (c < s - 1.0f) ? c : (s - 1.0f);
+	return uint32_t(c);
+}
+
+// Interpolates 4 pixels: p00 & p10 are the top ones, fx & fy are the fractions of the coordinates.
+inline __m128 bilerp(const float* p00, const float* p10, const float* p01, const float* p11,
+	float fx, float fy) noexcept
+{
+	const __m128 x = _mm_set1_ps(fx);
+	const __m128 v00 = _mm_loadu_ps(p00);
+	const __m128 v01 = _mm_loadu_ps(p01);
+	const __m128 top = _mm_add_ps(v00, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(p10), v00), x));
+	const __m128 bottom = _mm_add_ps(v01, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(p11), v01), x));
+	return _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), _mm_set1_ps(fy)));
+}
+
+// ----- SSE2 -----
+
+// Rounds 4 floats towards negative infinity. The values must fit int32.
+inline __m128 floor_ps(__m128 v) noexcept
+{
+	const __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+	return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, v), _mm_set1_ps(1.0f)));
+}
+
+// 4 lanes of wrap_coord. The result is still float.
+inline __m128 wrap_coord(__m128 c, float size, sampler_wrap wrap) noexcept
+{
+	const __m128 s = _mm_set1_ps(size);
+	if (wrap == sampler_wrap::repeat)
+		c = _mm_sub_ps(c, _mm_mul_ps(floor_ps(_mm_div_ps(c, s)), s));
+
+	c = _mm_max_ps(c, _mm_setzero_ps());
+	return _mm_min_ps(c, _mm_set1_ps(size - 1.0f));
+}
+
+// SSE2 has no _mm_mullo_epi32, the even & odd lanes are multiplied separately.
+inline __m128i mullo_epi32(__m128i a, __m128i b) noexcept
+{
+	const __m128i even = _mm_mul_epu32(a, b);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+		_mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+inline __m128i spread_bits(__m128i v) noexcept
+{
+	const __m128i b0 = _mm_and_si128(v, _mm_set1_epi32(1));
+	const __m128i b1 = _mm_slli_epi32(_mm_and_si128(v, _mm_set1_epi32(2)), 1);
+	const __m128i b2 = _mm_slli_epi32(_mm_and_si128(v, _mm_set1_epi32(4)), 2);
+	return _mm_or_si128(b0, _mm_or_si128(b1, b2));
+}
+
+// 4 lanes of pixel_offset, x & y are wrapped pixel coordinates. Offsets must fit uint32.
+inline void pixel_offset(__m128 x, __m128 y, uint32_t tile_count_x, uint32_t* offsets) noexcept
+{
+	const __m128i xi = _mm_cvttps_epi32(x);
+	const __m128i yi = _mm_cvttps_epi32(y);
+	const __m128i tile = _mm_add_epi32(_mm_srli_epi32(xi, 3),
+		mullo_epi32(_mm_srli_epi32(yi, 3), _mm_set1_epi32(int(tile_count_x))));
+	const __m128i morton = _mm_or_si128(spread_bits(xi), _mm_slli_epi32(spread_bits(yi), 1));
+	const __m128i offset = _mm_or_si128(_mm_slli_epi32(tile, 6), morton);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(offsets), offset);
+}
+
+static_assert(tile_size == 8, "spread_bits & pixel_offset (SSE2) expect 8x8 tiles.");
+
+// Copies the pixels of the tile rows [first, last) from the rgba_32f image into dst.
+// Pixels of the partial tiles which are outside the image repeat the edge pixels.
+void swizzle_tile_rows(const float* src, const uint2& size, uint32_t tile_count_x, float* dst,
+	size_t first, size_t last) noexcept
+{
+	for (size_t ty = first; ty < last; ++ty) {
+		for (uint32_t tx = 0; tx < tile_count_x; ++tx) {
+			float* tile = dst + (ty * tile_count_x + tx) * tile_pixel_count * 4;
+
+			for (uint32_t py = 0; py < tile_size; ++py) {
+				const uint32_t y = std::min(uint32_t(ty) * tile_size + py, size.y - 1);
+				for (uint32_t px = 0; px < tile_size; ++px) {
+					const uint32_t x = std::min(tx * tile_size + px, size.x - 1);
+					std::memcpy(tile + morton_offset(px, py) * 4, src + (size_t(y) * size.x + x) * 4, 4 * sizeof(float));
+				}
+			}
+		}
+	}
+}
+
+} // namespace
+
+
+namespace cg {
+namespace data {
+
+// ----- swizzled_image -----
+
+swizzled_image::swizzled_image(const image_view& image, thread_pool& pool)
+{
+	init(&image, 1, 1, pool);
+}
+
+swizzled_image::swizzled_image(const image_mip_chain& mip_chain, thread_pool& pool)
+{
+	std::vector<image_view> images;
+	for (size_t l = 0; l < mip_chain.level_count(); ++l)
+		images.push_back(mip_chain.level(l));
+
+	init(images.data(), 1, images.size(), pool);
+}
+
+swizzled_image::swizzled_image(const image_cube& cube, thread_pool& pool)
+{
+	image_view images[cube_face_count];
+	for (size_t f = 0; f < cube_face_count; ++f)
+		images[f] = cube.face(cube_face(f));
+
+	init(images, cube_face_count, 1, pool);
+}
+
+swizzled_image::swizzled_image(const texture_data& tex_data, thread_pool& pool)
+{
+	std::vector<image_view> images;
+	for (size_t f = 0; f < tex_data.face_count(); ++f) {
+		for (size_t l = 0; l < tex_data.level_count(); ++l)
+			images.push_back(tex_data.level(l, f));
+	}
+
+	init(images.data(), tex_data.face_count(), tex_data.level_count(), pool);
+}
+
+void swizzled_image::init(const image_view* images, size_t face_count, size_t level_count, thread_pool& pool)
+{
+	assert(images);
+	assert(face_count == 1 || face_count == cube_face_count);
+	assert(level_count > 0);
+
+	level_count_ = level_count;
+	face_count_ = face_count;
+	levels_.resize(face_count * level_count);
+
+	size_t pixel_count = 0;
+	for (size_t i = 0; i < levels_.size(); ++i) {
+		const image_view& image = images[i];
+		assert(image.data);
+		assert(image.size.x > 0 && image.size.y > 0);
+		assert(image.pixel_format != pixel_format::none);
+		assert(!is_block_compressed(image.pixel_format));
+
+		const uint2 tile_count((image.size.x + tile_size - 1) / tile_size, (image.size.y + tile_size - 1) / tile_size);
+		levels_[i] = { pixel_count, image.size, tile_count.x };
+		pixel_count += size_t(tile_count.x) * tile_count.y * tile_pixel_count;
+	}
+
+	pixels_.resize(pixel_count * 4);
+
+	image_2d tmp;
+	for (size_t i = 0; i < levels_.size(); ++i) {
+		const level_desc& level = levels_[i];
+		const float* src = reinterpret_cast<const float*>(images[i].data);
+
+		if (images[i].pixel_format != pixel_format::rgba_32f) {
+			if (tmp.size.x * tmp.size.y < square(level.size))
+				tmp = image_2d(level.size, pixel_format::rgba_32f);
+
+			convert(images[i], pixel_format::rgba_32f, tmp.data, pool);
+			src = reinterpret_cast<const float*>(tmp.data);
+		}
+
+		const size_t tile_count_y = (level.size.y + tile_size - 1) / tile_size;
+		float* dst = pixels_.data() + level.offset * 4;
+		parallel_for(pool, tile_count_y, tile_row_grain_size, [&](size_t first, size_t last) {
+			swizzle_tile_rows(src, level.size, level.tile_count_x, dst, first, last);
+		});
+	}
+}
+
+float4 swizzled_image::texel(const uint2& p, size_t level, size_t face) const noexcept
+{
+	const level_desc& l = level_at(level, face);
+	assert(p.x < l.size.x && p.y < l.size.y);
+
+	const float* v = pixels_.data() + (l.offset + pixel_offset(p.x, p.y, l.tile_count_x)) * 4;
+	return float4(v[0], v[1], v[2], v[3]);
+}
+
+float4 swizzled_image::sample(const sampler_desc& desc, const float2& uv, float lod) const noexcept
+{
+	return sample_face(desc, uv, lod, 0);
+}
+
+float4 swizzled_image::sample(const sampler_desc& desc, const float3& direction, float lod) const noexcept
+{
+	assert(is_cube());
+
+	float2 uv;
+	const cube_face face = cube_face_uv(direction, uv);
+	const sampler_desc face_desc(desc.filter, sampler_wrap::clamp);
+	return sample_face(face_desc, uv, lod, size_t(face));
+}
+
+void swizzled_image::sample(const sampler_desc& desc, const float2* uv, size_t count, float4* dst,
+	float lod) const noexcept
+{
+	assert(level_count_ > 0);
+	assert(count == 0 || (uv && dst));
+
+	const float max_lod = float(level_count_ - 1);
+	lod = std::min(std::max(lod, 0.0f), max_lod);
+
+	const size_t l0 = (desc.filter == sampler_filter::trilinear) ? size_t(lod) : size_t(lod + 0.5f);
+	const size_t l1 = std::min(l0 + 1, level_count_ - 1);
+	const float t = lod - float(l0);
+	const bool blend_levels = (desc.filter == sampler_filter::trilinear) && (l0 != l1) && (t > 0.0f);
+
+	alignas(16) float p0[16];
+	alignas(16) float p1[16];
+	float2 uv4[4];
+
+	for (size_t i = 0; i < count; i += 4) {
+		const size_t n = std::min<size_t>(4, count - i);
+		// the last batch repeats the last coordinate.
+		for (size_t j = 0; j < 4; ++j)
+			uv4[j] = uv[i + std::min(j, n - 1)];
+
+		sample_level_x4(desc, levels_[l0], uv4, p0);
+		if (blend_levels) {
+			sample_level_x4(desc, levels_[l1], uv4, p1);
+			const __m128 tv = _mm_set1_ps(t);
+			for (size_t j = 0; j < 16; j += 4) {
+				const __m128 a = _mm_load_ps(p0 + j);
+				_mm_store_ps(p0 + j, _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(p1 + j), a), tv)));
+			}
+		}
+
+		for (size_t j = 0; j < n; ++j)
+			dst[i + j] = float4(p0[j * 4], p0[j * 4 + 1], p0[j * 4 + 2], p0[j * 4 + 3]);
+	}
+}
+
+float4 swizzled_image::sample_face(const sampler_desc& desc, const float2& uv, float lod, size_t face) const noexcept
+{
+	const float max_lod = float(level_count_ - 1);
+	lod = std::min(std::max(lod, 0.0f), max_lod);
+
+	alignas(16) float p0[4];
+	if (desc.filter != sampler_filter::trilinear) {
+		sample_level(desc, level_at(size_t(lod + 0.5f), face), uv, p0);
+		return float4(p0[0], p0[1], p0[2], p0[3]);
+	}
+
+	const size_t l0 = size_t(lod);
+	const size_t l1 = std::min(l0 + 1, level_count_ - 1);
+	const float t = lod - float(l0);
+	sample_level(desc, level_at(l0, face), uv, p0);
+	if (l0 == l1 || t == 0.0f) return float4(p0[0], p0[1], p0[2], p0[3]);
+
+	alignas(16) float p1[4];
+	sample_level(desc, level_at(l1, face), uv, p1);
+	const __m128 a = _mm_load_ps(p0);
+	_mm_store_ps(p0, _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(p1), a), _mm_set1_ps(t))));
+	return float4(p0[0], p0[1], p0[2], p0[3]);
+}
+
+void swizzled_image::sample_level(const sampler_desc& desc, const level_desc& level, const float2& uv,
+	float* dst) const noexcept
+{
+	const float* pixels = pixels_.data() + level.offset * 4;
+	const float x = uv.x * float(level.size.x);
+	const float y = uv.y * float(level.size.y);
+
+	if (desc.filter == sampler_filter::nearest) {
+		const uint32_t xi = wrap_coord(std::floor(x), level.size.x, desc.wrap_u);
+		const uint32_t yi = wrap_coord(std::floor(y), level.size.y, desc.wrap_v);
+		std::memcpy(dst, pixels + pixel_offset(xi, yi, level.tile_count_x) * 4, 4 * sizeof(float));
+		return;
+	}
+
+	// the centers of the 4 pixels surround (x, y).
+	const float x0 = std::floor(x - 0.5f);
+	const float y0 = std::floor(y - 0.5f);
+	const uint32_t x0i = wrap_coord(x0, level.size.x, desc.wrap_u);
+	const uint32_t x1i = wrap_coord(x0 + 1.0f, level.size.x, desc.wrap_u);
+	const uint32_t y0i = wrap_coord(y0, level.size.y, desc.wrap_v);
+	const uint32_t y1i = wrap_coord(y0 + 1.0f, level.size.y, desc.wrap_v);
+	const uint32_t tx = level.tile_count_x;
+
+	const __m128 v = bilerp(
+		pixels + pixel_offset(x0i, y0i, tx) * 4, pixels + pixel_offset(x1i, y0i, tx) * 4,
+		pixels + pixel_offset(x0i, y1i, tx) * 4, pixels + pixel_offset(x1i, y1i, tx) * 4,
+		(x - 0.5f) - x0, (y - 0.5f) - y0);
+	_mm_storeu_ps(dst, v);
+}
+
+void swizzled_image::sample_level_x4(const sampler_desc& desc, const level_desc& level, const float2* uv,
+	float* dst) const noexcept
+{
+	const float* pixels = pixels_.data() + level.offset * 4;
+	const float w = float(level.size.x);
+	const float h = float(level.size.y);
+	const __m128 x = _mm_mul_ps(_mm_setr_ps(uv[0].x, uv[1].x, uv[2].x, uv[3].x), _mm_set1_ps(w));
+	const __m128 y = _mm_mul_ps(_mm_setr_ps(uv[0].y, uv[1].y, uv[2].y, uv[3].y), _mm_set1_ps(h));
+
+	if (desc.filter == sampler_filter::nearest) {
+		alignas(16) uint32_t offsets[4];
+		pixel_offset(wrap_coord(floor_ps(x), w, desc.wrap_u), wrap_coord(floor_ps(y), h, desc.wrap_v),
+			level.tile_count_x, offsets);
+
+		for (size_t j = 0; j < 4; ++j)
+			std::memcpy(dst + j * 4, pixels + size_t(offsets[j]) * 4, 4 * sizeof(float));
+
+		return;
+	}
+
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 xc = _mm_sub_ps(x, half);
+	const __m128 yc = _mm_sub_ps(y, half);
+	const __m128 x0 = floor_ps(xc);
+	const __m128 y0 = floor_ps(yc);
+	const __m128 x0w = wrap_coord(x0, w, desc.wrap_u);
+	const __m128 x1w = wrap_coord(_mm_add_ps(x0, one), w, desc.wrap_u);
+	const __m128 y0w = wrap_coord(y0, h, desc.wrap_v);
+	const __m128 y1w = wrap_coord(_mm_add_ps(y0, one), h, desc.wrap_v);
+
+	alignas(16) uint32_t o00[4];
+	alignas(16) uint32_t o10[4];
+	alignas(16) uint32_t o01[4];
+	alignas(16) uint32_t o11[4];
+	alignas(16) float fx[4];
+	alignas(16) float fy[4];
+	pixel_offset(x0w, y0w, level.tile_count_x, o00);
+	pixel_offset(x1w, y0w, level.tile_count_x, o10);
+	pixel_offset(x0w, y1w, level.tile_count_x, o01);
+	pixel_offset(x1w, y1w, level.tile_count_x, o11);
+	_mm_store_ps(fx, _mm_sub_ps(xc, x0));
+	_mm_store_ps(fy, _mm_sub_ps(yc, y0));
+
+	for (size_t j = 0; j < 4; ++j) {
+		const __m128 v = bilerp(
+			pixels + size_t(o00[j]) * 4, pixels + size_t(o10[j]) * 4,
+			pixels + size_t(o01[j]) * 4, pixels + size_t(o11[j]) * 4,
+			fx[j], fy[j]);
+		_mm_storeu_ps(dst + j * 4, v);
+	}
+}
+
+} // namespace data
+} // namespace cg
@@ -0,0 +1,170 @@
+#ifndef CG_DATA_SWIZZLED_IMAGE_H_
+#define CG_DATA_SWIZZLED_IMAGE_H_
+
+#include <cassert>
+#include <vector>
+#include "cg/base/math.h"
+#include "cg/base/thread_pool.h"
+#include "cg/data/image.h"
+#include "cg/data/image_cube.h"
+#include "cg/data/image_mip_chain.h"
+#include "cg/data/texture_data.h"
+
+
+namespace cg {
+namespace data {
+
+// Texture filtering of swizzled_image::sample.
+enum class sampler_filter : unsigned char {
+	// The nearest pixel of the mip level which is the nearest to lod (GL_NEAREST_MIPMAP_NEAREST).
+	nearest,
+
+	// 4 pixels of the mip level which is the nearest to lod are interpolated (GL_LINEAR_MIPMAP_NEAREST).
+	bilinear,
+
+	// Bilinear samples of the 2 mip levels around lod are interpolated (GL_LINEAR_MIPMAP_LINEAR).
+	trilinear
+};
+
+// Texture coordinates outside [0, 1] are clamped (GL_CLAMP_TO_EDGE) or wrapped (GL_REPEAT).
+enum class sampler_wrap : unsigned char {
+	clamp,
+	repeat
+};
+
+// CPU counterpart of cg::rnd::opengl::Sampler_desc.
+struct sampler_desc final {
+
+	sampler_desc() noexcept = default;
+
+	sampler_desc(sampler_filter filter, sampler_wrap wrap) noexcept
+		: filter(filter), wrap_u(wrap), wrap_v(wrap)
+	{}
+
+	sampler_desc(sampler_filter filter, sampler_wrap wrap_u, sampler_wrap wrap_v) noexcept
+		: filter(filter), wrap_u(wrap_u), wrap_v(wrap_v)
+	{}
+
+
+	sampler_filter filter = sampler_filter::bilinear;
+
+	sampler_wrap wrap_u = sampler_wrap::clamp;
+
+	sampler_wrap wrap_v = sampler_wrap::clamp;
+};
+
+// swizzled_image stores the mip levels of an image or of the faces of a cube map as rgba_32f pixels
+// which are laid out for random 2D access: a level is split into tile_size x tile_size tiles
+// (row-major, the last column & row are padded), the pixels of a tile are stored in Morton order.
+// Neighbouring pixels of both rows & columns are close in memory, a bilinear footprint usually
+// touches one or two cache lines instead of two rows of the image.
+// Source pixels are converted as convert does. Block compressed formats are not supported.
+// The image is immutable, it can be sampled concurrently.
+class swizzled_image final {
+public:
+
+	// Side of a tile in pixels.
+	static constexpr uint32_t tile_size = 8;
+
+	swizzled_image() noexcept = default;
+
+	// Swizzles the image (a single level) on the workers of the pool.
+	swizzled_image(const image_view& image, thread_pool& pool);
+
+	// Swizzles all the levels of the mip chain on the workers of the pool.
+	swizzled_image(const image_mip_chain& mip_chain, thread_pool& pool);
+
+	// Swizzles the faces of the cube map (a single level) on the workers of the pool.
+	swizzled_image(const image_cube& cube, thread_pool& pool);
+
+	// Swizzles all the mip levels & faces of the texture on the workers of the pool.
+	swizzled_image(const texture_data& tex_data, thread_pool& pool);
+
+	swizzled_image(const swizzled_image&) = delete;
+
+	swizzled_image(swizzled_image&&) noexcept = default;
+
+
+	swizzled_image& operator=(const swizzled_image&) = delete;
+
+	swizzled_image& operator=(swizzled_image&&) noexcept = default;
+
+
+	// Returns 6 for cube maps & 1 otherwise. The faces are ordered as cube_face.
+	size_t face_count() const noexcept
+	{
+		return face_count_;
+	}
+
+	bool is_cube() const noexcept
+	{
+		return face_count_ == cube_face_count;
+	}
+
+	size_t level_count() const noexcept
+	{
+		return level_count_;
+	}
+
+	// Size of the mip level in pixels.
+	const uint2& size(size_t level = 0) const noexcept
+	{
+		assert(level < level_count_);
+		return levels_[level].size;
+	}
+
+	// Returns the pixel p of the mip level of the face. p must be within the level.
+	float4 texel(const uint2& p, size_t level = 0, size_t face = 0) const noexcept;
+
+	// Samples the image (or the first face) at the texture coordinates uv, (0, 0) is the first pixel's corner.
+	// lod selects the mip level(s), it is clamped to [0, level_count() - 1].
+	float4 sample(const sampler_desc& desc, const float2& uv, float lod = 0.0f) const noexcept;
+
+	// Samples the cube map in the direction (see cube_face_uv). The direction must not be zero.
+	// The face is sampled with clamped coordinates, filtering does not cross the edges of the faces.
+	float4 sample(const sampler_desc& desc, const float3& direction, float lod = 0.0f) const noexcept;
+
+	// Samples the image (or the first face) at count texture coordinates, writes the samples into dst.
+	// 4 coordinates are processed at once: their pixel addresses are computed with SSE2.
+	// The result is equal to count calls of sample(desc, uv[i], lod).
+	void sample(const sampler_desc& desc, const float2* uv, size_t count, float4* dst, float lod = 0.0f) const noexcept;
+
+private:
+
+	struct level_desc final {
+		// Offset of the first tile in pixels.
+		size_t offset;
+		uint2 size;
+		uint32_t tile_count_x;
+	};
+
+	// Allocates & fills the levels. images are ordered as face * level_count + level.
+	void init(const image_view* images, size_t face_count, size_t level_count, thread_pool& pool);
+
+	const level_desc& level_at(size_t level, size_t face) const noexcept
+	{
+		assert(level < level_count_);
+		assert(face < face_count_);
+		return levels_[face * level_count_ + level];
+	}
+
+	// Samples one mip level, the result is written into dst (4 floats).
+	void sample_level(const sampler_desc& desc, const level_desc& level, const float2& uv, float* dst) const noexcept;
+
+	// Samples one mip level at 4 texture coordinates, dst receives 4 pixels (16 floats).
+	void sample_level_x4(const sampler_desc& desc, const level_desc& level, const float2* uv, float* dst) const noexcept;
+
+	// Samples the mip level(s) of the face which lod selects.
+	float4 sample_face(const sampler_desc& desc, const float2& uv, float lod, size_t face) const noexcept;
+
+	// 4 floats per pixel, face * level_count_ + level is the index of a level.
+	std::vector<float> pixels_;
+	std::vector<level_desc> levels_;
+	size_t level_count_ = 0;
+	size_t face_count_ = 0;
+};
+
+} // namespace data
+} // namespace cg
+
+#endif // CG_DATA_SWIZZLED_IMAGE_H_
@@ -0,0 +1,225 @@
+#include "cg/data/texture_atlas.h"
+
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include "cg/base/base.h"
+#include "cg/data/image_convert.h"
+
+
+namespace {
+
+using cg::data::image_2d;
+using cg::data::image_view;
+using cg::data::pixel_format;
+
+// Copies the image to the page at position & repeats its edge pixels padding times on every side.
+// The image has the pixel format of the page.
+void blit_padded(const image_view& image, image_2d& page, const uint2& position, uint32_t padding)
+{
+	const size_t pixel_byte_count = cg::data::byte_count(page.pixel_format);
+	const size_t src_row_byte_count = image.size.x * pixel_byte_count;
+	const size_t dst_row_byte_count = page.size.x * pixel_byte_count;
+	const uint8_t* src = reinterpret_cast<const uint8_t*>(image.data);
+	uint8_t* dst = reinterpret_cast<uint8_t*>(page.data);
+
+	for (int64_t y = -int64_t(padding); y < int64_t(image.size.y + padding); ++y) {
+		const int64_t src_y = std::min<int64_t>(std::max<int64_t>(y, 0), image.size.y - 1);
+		const uint8_t* src_row = src + src_y * src_row_byte_count;
+		uint8_t* dst_row = dst + (position.y + y) * dst_row_byte_count + position.x * pixel_byte_count;
+
+		std::memcpy(dst_row, src_row, src_row_byte_count);
+		for (size_t i = 1; i <= padding; ++i) {
+			std::memcpy(dst_row - i * pixel_byte_count, src_row, pixel_byte_count);
+			std::memcpy(dst_row + src_row_byte_count + (i - 1) * pixel_byte_count,
+				src_row + src_row_byte_count - pixel_byte_count, pixel_byte_count);
+		}
+	}
+}
+
+} // namespace
+
+
+namespace cg {
+namespace data {
+
+// ----- max_rects_packer -----
+
+max_rects_packer::max_rects_packer(const uint2& bin_size)
+	: bin_size_(bin_size)
+{
+	assert(bin_size.x > 0 && bin_size.y > 0);
+	free_rects_.push_back(rect{ 0, 0, bin_size.x, bin_size.y });
+}
+
+float max_rects_packer::occupancy() const noexcept
+{
+	if (bin_size_.x == 0 || bin_size_.y == 0) return 0.0f;
+	return float(double(used_area_) / (double(bin_size_.x) * bin_size_.y));
+}
+
+bool max_rects_packer::insert(const uint2& size, uint2& position)
+{
+	assert(size.x > 0 && size.y > 0);
+
+	// best short side fit, ties are broken by the long side.
+	const rect* best = nullptr;
+	uint32_t best_short_side = std::numeric_limits<uint32_t>::max();
+	uint32_t best_long_side = std::numeric_limits<uint32_t>::max();
+
+	for (const rect& r : free_rects_) {
+		if (r.width < size.x || r.height < size.y) continue;
+
+		const uint32_t leftover_x = r.width - size.x;
+		const uint32_t leftover_y = r.height - size.y;
+		const uint32_t short_side = std::min(leftover_x, leftover_y);
+		const uint32_t long_side = std::max(leftover_x, leftover_y);
+
+		if (short_side < best_short_side || (short_side == best_short_side && long_side < best_long_side)) {
+			best = &r;
+			best_short_side = short_side;
+			best_long_side = long_side;
+		}
+	}
+
+	if (!best) return false;
+
+	const rect used = { best->x, best->y, size.x, size.y };
+	split_free_rects(used);
+	prune_free_rects();
+
+	used_area_ += uint64_t(size.x) * size.y;
+	position = uint2(used.x, used.y);
+	return true;
+}
+
+void max_rects_packer::split_free_rects(const rect& used)
+{
+	const size_t count = free_rects_.size();
+	for (size_t i = 0; i < count; ++i) {
+		const rect r = free_rects_[i];
+		const bool intersects = (used.x < r.x + r.width) && (r.x < used.x + used.width)
+			&& (used.y < r.y + r.height) && (r.y < used.y + used.height);
+		if (!intersects) continue;
+
+		// the parts of r to the left, right, top & bottom of the used rectangle.
+		if (used.x > r.x)
+			free_rects_.push_back(rect{ r.x, r.y, used.x - r.x, r.height });
+		if (used.x + used.width < r.x + r.width)
+			free_rects_.push_back(rect{ used.x + used.width, r.y, r.x + r.width - used.x - used.width, r.height });
+		if (used.y > r.y)
+			free_rects_.push_back(rect{ r.x, r.y, r.width, used.y - r.y });
+		if (used.y + used.height < r.y + r.height)
+			free_rects_.push_back(rect{ r.x, used.y + used.height, r.width, r.y + r.height - used.y - used.height });
+
+		// the width of a rectangle which is not free any more.
+		free_rects_[i].width = 0;
+	}
+
+	free_rects_.erase(std::remove_if(free_rects_.begin(), free_rects_.end(),
+		[](const rect& r) { return r.width == 0; }), free_rects_.end());
+}
+
+void max_rects_packer::prune_free_rects()
+{
+	auto contains = [](const rect& a, const rect& b) {
+		return (a.x <= b.x) && (a.y <= b.y)
+			&& (b.x + b.width <= a.x + a.width) && (b.y + b.height <= a.y + a.height);
+	};
+
+	for (size_t i = 0; i < free_rects_.size(); ++i) {
+		if (free_rects_[i].width == 0) continue;
+
+		for (size_t j = i + 1; j < free_rects_.size(); ++j) {
+			if (free_rects_[j].width == 0) continue;
+
+			if (contains(free_rects_[i], free_rects_[j])) {
+				free_rects_[j].width = 0;
+			}
+			else if (contains(free_rects_[j], free_rects_[i])) {
+				free_rects_[i].width = 0;
+				break;
+			}
+		}
+	}
+
+	free_rects_.erase(std::remove_if(free_rects_.begin(), free_rects_.end(),
+		[](const rect& r) { return r.width == 0; }), free_rects_.end());
+}
+
+// ----- funcs -----
+
+texture_atlas pack_atlas(const std::vector<image_view>& images, pixel_format fmt, const atlas_desc& desc)
+{
+	assert(fmt != pixel_format::none);
+	assert(!is_block_compressed(fmt));
+	assert(desc.page_size.x > 0 && desc.page_size.y > 0);
+
+	texture_atlas atlas;
+	atlas.entries.resize(images.size());
+	if (images.empty()) return atlas;
+
+	// large images first, small ones fill the gaps.
+	std::vector<size_t> order(images.size());
+	std::iota(order.begin(), order.end(), size_t(0));
+	std::stable_sort(order.begin(), order.end(), [&images](size_t l, size_t r) {
+		const uint2& ls = images[l].size;
+		const uint2& rs = images[r].size;
+		const uint32_t l_max = std::max(ls.x, ls.y);
+		const uint32_t r_max = std::max(rs.x, rs.y);
+		return (l_max != r_max) ? (l_max > r_max) : (uint64_t(ls.x) * ls.y > uint64_t(rs.x) * rs.y);
+	});
+
+	std::vector<max_rects_packer> packers;
+	const float2 page_size(float(desc.page_size.x), float(desc.page_size.y));
+
+	for (size_t index : order) {
+		const image_view& image = images[index];
+		assert(image.data);
+		assert(!is_block_compressed(image.pixel_format));
+
+		const uint2 padded_size(image.size.x + 2 * desc.padding, image.size.y + 2 * desc.padding);
+		ENFORCE(padded_size.x <= desc.page_size.x && padded_size.y <= desc.page_size.y,
+			"An image of ", image.size.x, 'x', image.size.y, " does not fit an atlas page of ",
+			desc.page_size.x, 'x', desc.page_size.y, '.');
+
+		// the first page which has room, a new one otherwise.
+		uint2 padded_position;
+		size_t page = 0;
+		for (; page < packers.size(); ++page) {
+			if (packers[page].insert(padded_size, padded_position)) break;
+		}
+
+		if (page == packers.size()) {
+			packers.emplace_back(desc.page_size);
+			packers.back().insert(padded_size, padded_position);
+
+			image_2d page_image(desc.page_size, fmt);
+			std::memset(page_image.data, 0, byte_count(page_image));
+			atlas.pages.push_back(std::move(page_image));
+		}
+
+		const uint2 position(padded_position.x + desc.padding, padded_position.y + desc.padding);
+		if (image.pixel_format == fmt) {
+			blit_padded(image, atlas.pages[page], position, desc.padding);
+		}
+		else {
+			const image_2d converted = convert(image, fmt);
+			blit_padded(converted, atlas.pages[page], position, desc.padding);
+		}
+
+		atlas_entry& entry = atlas.entries[index];
+		entry.page = uint32_t(page);
+		entry.position = position;
+		entry.size = image.size;
+		entry.uv_scale = float2(image.size.x / page_size.x, image.size.y / page_size.y);
+		entry.uv_offset = float2(position.x / page_size.x, position.y / page_size.y);
+	}
+
+	return atlas;
+}
+
+} // namespace data
+} // namespace cg
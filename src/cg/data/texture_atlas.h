@@ -0,0 +1,100 @@
+#ifndef CG_DATA_TEXTURE_ATLAS_H_
+#define CG_DATA_TEXTURE_ATLAS_H_
+
+#include <vector>
+#include "cg/base/math.h"
+#include "cg/data/image.h"
+
+
+namespace cg {
+namespace data {
+
+// max_rects_packer places rectangles into a bin of fixed size (MaxRects, Jukka Jylanki 2010).
+// The free space is kept as a list of maximal free rectangles which may overlap,
+// a rectangle is placed into the free one which leaves the shortest side (best short side fit).
+class max_rects_packer final {
+public:
+
+	max_rects_packer() noexcept = default;
+
+	explicit max_rects_packer(const uint2& bin_size);
+
+
+	// Size of the bin in pixels.
+	const uint2& bin_size() const noexcept
+	{
+		return bin_size_;
+	}
+
+	// The ratio of the used area to the area of the bin.
+	float occupancy() const noexcept;
+
+	// Places a rectangle of the specified size, writes its top left corner to position.
+	// Returns false if there is no room for the rectangle, the packer is not changed then.
+	bool insert(const uint2& size, uint2& position);
+
+private:
+
+	struct rect final {
+		uint32_t x;
+		uint32_t y;
+		uint32_t width;
+		uint32_t height;
+	};
+
+	// Splits the free rectangles which intersect the used one.
+	void split_free_rects(const rect& used);
+
+	// Removes the free rectangles which are contained in other free rectangles.
+	void prune_free_rects();
+
+	uint2 bin_size_;
+	std::vector<rect> free_rects_;
+	uint64_t used_area_ = 0;
+};
+
+// Parameters of pack_atlas.
+struct atlas_desc final {
+	// The size of every page of the atlas.
+	uint2 page_size = uint2(1024, 1024);
+
+	// The number of pixels which surround every image, the edge pixels of the image are repeated.
+	// 1 is enough for bilinear filtering of the top level, every mip level halves the padding.
+	uint32_t padding = 2;
+};
+
+// The location of an image within the atlas.
+// uv of the image is mapped to the atlas as uv * uv_scale + uv_offset.
+struct atlas_entry final {
+	// The index of the page which holds the image.
+	uint32_t page = 0;
+
+	// The top left pixel of the image (not of its padding).
+	uint2 position;
+
+	// The size of the image in pixels.
+	uint2 size;
+
+	float2 uv_scale;
+
+	float2 uv_offset;
+};
+
+// texture_atlas is a set of pages which the images have been merged into.
+struct texture_atlas final {
+	std::vector<image_2d> pages;
+
+	// Entries of the images in the order they have been passed to pack_atlas.
+	std::vector<atlas_entry> entries;
+};
+
+// Merges the images into as few pages as possible. The images are placed from the largest to the smallest,
+// they are converted to fmt which must not be block compressed. The pixels which are not covered are zeros.
+// Images which are sampled with the repeat wrap mode have to stay separate textures.
+// Throws if an image with its padding does not fit a page.
+texture_atlas pack_atlas(const std::vector<image_view>& images, pixel_format fmt, const atlas_desc& desc = atlas_desc());
+
+} // namespace data
+} // namespace cg
+
+#endif // CG_DATA_TEXTURE_ATLAS_H_
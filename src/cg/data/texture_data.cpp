@@ -0,0 +1,366 @@
+#include "cg/data/texture_data.h"
+
+#include <cstring>
+#include <algorithm>
+#include <exception>
+#include "cg/base/base.h"
+#include "cg/data/image_mip_chain.h"
+
+
+namespace {
+
+using cg::data::pixel_format;
+
+// ----- dds -----
+
+constexpr uint8_t dds_magic[4] = { 'D', 'D', 'S', ' ' };
+constexpr size_t dds_header_byte_count = 128;
+constexpr size_t dds_dx10_header_byte_count = 20;
+
+// DDS_HEADER::dwFlags & DDS_HEADER::dwCaps2
+constexpr uint32_t ddsd_mipmap_count = 0x20000;
+constexpr uint32_t ddsd_depth = 0x800000;
+constexpr uint32_t ddscaps2_cubemap = 0x200;
+constexpr uint32_t ddscaps2_cubemap_all_faces = 0xfc00;
+constexpr uint32_t ddscaps2_volume = 0x200000;
+
+// DDS_PIXELFORMAT::dwFlags
+constexpr uint32_t ddpf_alpha_pixels = 0x1;
+constexpr uint32_t ddpf_fourcc = 0x4;
+constexpr uint32_t ddpf_rgb = 0x40;
+constexpr uint32_t ddpf_luminance = 0x20000;
+
+// DDS_HEADER_DXT10
+constexpr uint32_t dx10_resource_dimension_texture_2d = 3;
+constexpr uint32_t dx10_misc_texture_cube = 0x4;
+
+// ----- ktx2 -----
+
+constexpr uint8_t ktx2_identifier[12] = { 0xab, 'K', 'T', 'X', ' ', '2', '0', 0xbb, '\r', '\n', 0x1a, '\n' };
+constexpr size_t ktx2_header_byte_count = 80;
+constexpr size_t ktx2_level_index_entry_byte_count = 24;
+
+
+constexpr uint32_t make_fourcc(char a, char b, char c, char d) noexcept
+{
+	return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24);
+}
+
+inline uint32_t read_u32_le(const uint8_t* p) noexcept
+{
+	return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+inline uint64_t read_u64_le(const uint8_t* p) noexcept
+{
+	return uint64_t(read_u32_le(p)) | (uint64_t(read_u32_le(p + 4)) << 32);
+}
+
+// Returns the pixel format of the DXGI_FORMAT, none if the format is not supported.
+pixel_format dxgi_format_to_pixel_format(uint32_t dxgi_format, bool& srgb) noexcept
+{
+	srgb = false;
+
+	switch (dxgi_format) {
+		default: return pixel_format::none;
+		case 2: return pixel_format::rgba_32f;			// R32G32B32A32_FLOAT
+		case 6: return pixel_format::rgb_32f;			// R32G32B32_FLOAT
+		case 10: return pixel_format::rgba_16f;			// R16G16B16A16_FLOAT
+		case 16: return pixel_format::rg_32f;			// R32G32_FLOAT
+		case 28: return pixel_format::rgba_8;			// R8G8B8A8_UNORM
+		case 29: srgb = true; return pixel_format::rgba_8;	// R8G8B8A8_UNORM_SRGB
+		case 34: return pixel_format::rg_16f;			// R16G16_FLOAT
+		case 49: return pixel_format::rg_8;				// R8G8_UNORM
+		case 61: return pixel_format::red_8;			// R8_UNORM
+		case 71: return pixel_format::bc1;				// BC1_UNORM
+		case 72: srgb = true; return pixel_format::bc1;	// BC1_UNORM_SRGB
+		case 77: return pixel_format::bc3;				// BC3_UNORM
+		case 78: srgb = true; return pixel_format::bc3;	// BC3_UNORM_SRGB
+		case 80: return pixel_format::bc4;				// BC4_UNORM
+		case 83: return pixel_format::bc5;				// BC5_UNORM
+	}
+}
+
+// Returns the pixel format of the DDS_PIXELFORMAT of a file which has no DX10 header,
+// none if the format is not supported.
+pixel_format dds_pixel_format_to_pixel_format(const uint8_t* ddspf) noexcept
+{
+	const uint32_t flags = read_u32_le(ddspf + 4);
+	const uint32_t fourcc = read_u32_le(ddspf + 8);
+	const uint32_t bit_count = read_u32_le(ddspf + 12);
+	const uint32_t r_mask = read_u32_le(ddspf + 16);
+	const uint32_t g_mask = read_u32_le(ddspf + 20);
+	const uint32_t b_mask = read_u32_le(ddspf + 24);
+	const uint32_t a_mask = read_u32_le(ddspf + 28);
+
+	if (flags & ddpf_fourcc) {
+		switch (fourcc) {
+			default: return pixel_format::none;
+			case make_fourcc('D', 'X', 'T', '1'): return pixel_format::bc1;
+			case make_fourcc('D', 'X', 'T', '5'): return pixel_format::bc3;
+			case make_fourcc('A', 'T', 'I', '1'): return pixel_format::bc4;
+			case make_fourcc('B', 'C', '4', 'U'): return pixel_format::bc4;
+			case make_fourcc('A', 'T', 'I', '2'): return pixel_format::bc5;
+			case make_fourcc('B', 'C', '5', 'U'): return pixel_format::bc5;
+			// D3DFORMAT values are stored as fourcc.
+			case 112: return pixel_format::rg_16f;		// D3DFMT_G16R16F
+			case 113: return pixel_format::rgba_16f;	// D3DFMT_A16B16G16R16F
+			case 115: return pixel_format::rg_32f;		// D3DFMT_G32R32F
+			case 116: return pixel_format::rgba_32f;	// D3DFMT_A32B32G32R32F
+		}
+	}
+
+	// only the layouts which match the byte order of pixel_format, bgr(a) would have to be swizzled.
+	if ((flags & ddpf_rgb) && bit_count == 32 && r_mask == 0xff && g_mask == 0xff00 && b_mask == 0xff0000
+		&& (a_mask == 0xff000000 || !(flags & ddpf_alpha_pixels)))
+		return pixel_format::rgba_8;
+
+	if ((flags & ddpf_rgb) && bit_count == 24 && r_mask == 0xff && g_mask == 0xff00 && b_mask == 0xff0000)
+		return pixel_format::rgb_8;
+
+	if ((flags & ddpf_luminance) && bit_count == 8 && r_mask == 0xff && !(flags & ddpf_alpha_pixels))
+		return pixel_format::red_8;
+
+	if ((flags & ddpf_luminance) && bit_count == 16 && r_mask == 0xff && a_mask == 0xff00)
+		return pixel_format::rg_8;
+
+	return pixel_format::none;
+}
+
+// Returns the pixel format of the VkFormat, none if the format is not supported.
+pixel_format vk_format_to_pixel_format(uint32_t vk_format, bool& srgb) noexcept
+{
+	srgb = false;
+
+	switch (vk_format) {
+		default: return pixel_format::none;
+		case 9: return pixel_format::red_8;				// R8_UNORM
+		case 15: srgb = true; return pixel_format::red_8;	// R8_SRGB
+		case 16: return pixel_format::rg_8;				// R8G8_UNORM
+		case 22: srgb = true; return pixel_format::rg_8;	// R8G8_SRGB
+		case 23: return pixel_format::rgb_8;			// R8G8B8_UNORM
+		case 29: srgb = true; return pixel_format::rgb_8;	// R8G8B8_SRGB
+		case 37: return pixel_format::rgba_8;			// R8G8B8A8_UNORM
+		case 43: srgb = true; return pixel_format::rgba_8;	// R8G8B8A8_SRGB
+		case 83: return pixel_format::rg_16f;			// R16G16_SFLOAT
+		case 90: return pixel_format::rgb_16f;			// R16G16B16_SFLOAT
+		case 97: return pixel_format::rgba_16f;			// R16G16B16A16_SFLOAT
+		case 103: return pixel_format::rg_32f;			// R32G32_SFLOAT
+		case 106: return pixel_format::rgb_32f;			// R32G32B32_SFLOAT
+		case 109: return pixel_format::rgba_32f;		// R32G32B32A32_SFLOAT
+		case 131: return pixel_format::bc1;				// BC1_RGB_UNORM_BLOCK
+		case 132: srgb = true; return pixel_format::bc1;	// BC1_RGB_SRGB_BLOCK
+		case 133: return pixel_format::bc1;				// BC1_RGBA_UNORM_BLOCK
+		case 134: srgb = true; return pixel_format::bc1;	// BC1_RGBA_SRGB_BLOCK
+		case 137: return pixel_format::bc3;				// BC3_UNORM_BLOCK
+		case 138: srgb = true; return pixel_format::bc3;	// BC3_SRGB_BLOCK
+		case 139: return pixel_format::bc4;				// BC4_UNORM_BLOCK
+		case 141: return pixel_format::bc5;				// BC5_UNORM_BLOCK
+	}
+}
+
+// Returns the size of the mip level of an image of the specified size.
+inline uint2 mip_level_size(const uint2& size, size_t level) noexcept
+{
+	return uint2(std::max(size.x >> level, 1u), std::max(size.y >> level, 1u));
+}
+
+} // namespace
+
+
+namespace cg {
+namespace data {
+
+// ----- texture_data -----
+
+texture_data::texture_data(const char* filename)
+{
+	assert(filename && std::strlen(filename));
+
+	try {
+		file_.open(filename);
+		parse();
+	}
+	catch (...) {
+		std::throw_with_nested(std::runtime_error(EXCEPTION_MSG("Loading ", filename, " texture error.")));
+	}
+}
+
+texture_data::texture_data(const std::string& filename)
+	: texture_data(filename.c_str())
+{}
+
+texture_data::texture_data(Mapped_file&& file)
+	: file_(std::move(file))
+{
+	assert(file_.is_open());
+	parse();
+}
+
+image_view texture_data::level(size_t level, size_t face) const noexcept
+{
+	const texture_subresource& sr = subresource(level, face);
+	return image_view(file_.data() + sr.offset, sr.size, pixel_format_);
+}
+
+size_t texture_data::row_byte_count(size_t level) const noexcept
+{
+	assert(level < level_count_);
+
+	const uint2 level_size = subresources_[level].size;
+	if (is_block_compressed(pixel_format_))
+		return size_t((level_size.x + 3) / 4) * block_byte_count(pixel_format_);
+
+	return level_size.x * byte_count(pixel_format_);
+}
+
+texture_subresource texture_data::make_subresource(size_t offset, size_t level) const
+{
+	texture_subresource sr;
+	sr.offset = offset;
+	sr.size = mip_level_size(size_, level);
+	sr.byte_count = byte_count(sr.size, pixel_format_);
+
+	ENFORCE(offset <= file_.byte_count() && sr.byte_count <= file_.byte_count() - offset,
+		"Texture file error. The pixels of the mip level ", level, " are out of the file.");
+
+	return sr;
+}
+
+void texture_data::parse()
+{
+	const uint8_t* bytes = file_.data();
+	const size_t byte_count = file_.byte_count();
+
+	if (is_dds(bytes, byte_count))
+		parse_dds();
+	else if (is_ktx2(bytes, byte_count))
+		parse_ktx2();
+	else
+		throw std::runtime_error(EXCEPTION_MSG("Texture file error. The file is neither DDS nor KTX2."));
+}
+
+void texture_data::parse_dds()
+{
+	const uint8_t* bytes = file_.data();
+	const size_t file_byte_count = file_.byte_count();
+	ENFORCE(file_byte_count >= dds_header_byte_count, "DDS file error. The header is truncated.");
+	ENFORCE(read_u32_le(bytes + 4) == 124 && read_u32_le(bytes + 76) == 32, "DDS file error. Invalid header size.");
+
+	const uint32_t flags = read_u32_le(bytes + 8);
+	const uint32_t height = read_u32_le(bytes + 12);
+	const uint32_t width = read_u32_le(bytes + 16);
+	const uint32_t mip_count = read_u32_le(bytes + 28);
+	const uint32_t caps2 = read_u32_le(bytes + 112);
+	const uint32_t fourcc = read_u32_le(bytes + 84);
+
+	ENFORCE(width > 0 && height > 0, "DDS file error. Invalid size ", width, 'x', height, '.');
+	ENFORCE(!(flags & ddsd_depth) && !(caps2 & ddscaps2_volume), "DDS file error. Volume textures are not supported.");
+
+	size_t data_offset = dds_header_byte_count;
+	bool cube = (caps2 & ddscaps2_cubemap) != 0;
+
+	if ((read_u32_le(bytes + 80) & ddpf_fourcc) && fourcc == make_fourcc('D', 'X', '1', '0')) {
+		ENFORCE(file_byte_count >= dds_header_byte_count + dds_dx10_header_byte_count,
+			"DDS file error. The DX10 header is truncated.");
+
+		const uint8_t* dx10 = bytes + dds_header_byte_count;
+		const uint32_t dxgi_format = read_u32_le(dx10);
+		pixel_format_ = dxgi_format_to_pixel_format(dxgi_format, srgb_);
+		ENFORCE(pixel_format_ != pixel_format::none, "DDS file error. Unsupported DXGI format ", dxgi_format, '.');
+		ENFORCE(read_u32_le(dx10 + 4) == dx10_resource_dimension_texture_2d,
+			"DDS file error. Only 2D textures are supported.");
+		ENFORCE(read_u32_le(dx10 + 12) == 1, "DDS file error. Texture arrays are not supported.");
+
+		cube = (read_u32_le(dx10 + 8) & dx10_misc_texture_cube) != 0;
+		data_offset += dds_dx10_header_byte_count;
+	}
+	else {
+		pixel_format_ = dds_pixel_format_to_pixel_format(bytes + 76);
+		ENFORCE(pixel_format_ != pixel_format::none, "DDS file error. Unsupported pixel format.");
+		ENFORCE(!cube || (caps2 & ddscaps2_cubemap_all_faces) == ddscaps2_cubemap_all_faces,
+			"DDS file error. Cube maps without some of the faces are not supported.");
+	}
+
+	ENFORCE(!cube || width == height, "DDS file error. The faces of a cube map must be square.");
+
+	size_ = uint2(width, height);
+	level_count_ = ((flags & ddsd_mipmap_count) && mip_count > 0) ? mip_count : 1;
+	face_count_ = (cube) ? 6 : 1;
+	ENFORCE(level_count_ <= mip_level_count(size_), "DDS file error. Invalid mip level count ", level_count_, '.');
+
+	// the mip chains of the faces follow each other.
+	subresources_.reserve(face_count_ * level_count_);
+	size_t offset = data_offset;
+	for (size_t f = 0; f < face_count_; ++f) {
+		for (size_t l = 0; l < level_count_; ++l) {
+			subresources_.push_back(make_subresource(offset, l));
+			offset += subresources_.back().byte_count;
+		}
+	}
+}
+
+void texture_data::parse_ktx2()
+{
+	const uint8_t* bytes = file_.data();
+	const size_t file_byte_count = file_.byte_count();
+	ENFORCE(file_byte_count >= ktx2_header_byte_count, "KTX2 file error. The header is truncated.");
+
+	const uint32_t vk_format = read_u32_le(bytes + 12);
+	const uint32_t width = read_u32_le(bytes + 20);
+	const uint32_t height = read_u32_le(bytes + 24);
+	const uint32_t depth = read_u32_le(bytes + 28);
+	const uint32_t layer_count = read_u32_le(bytes + 32);
+	const uint32_t face_count = read_u32_le(bytes + 36);
+	const uint32_t level_count = read_u32_le(bytes + 40);
+	const uint32_t supercompression_scheme = read_u32_le(bytes + 44);
+
+	pixel_format_ = vk_format_to_pixel_format(vk_format, srgb_);
+	ENFORCE(pixel_format_ != pixel_format::none, "KTX2 file error. Unsupported VkFormat ", vk_format, '.');
+	ENFORCE(supercompression_scheme == 0, "KTX2 file error. Supercompressed files are not supported.");
+	ENFORCE(width > 0 && height > 0, "KTX2 file error. Invalid size ", width, 'x', height, '.');
+	ENFORCE(depth == 0, "KTX2 file error. Volume textures are not supported.");
+	ENFORCE(layer_count == 0, "KTX2 file error. Texture arrays are not supported.");
+	ENFORCE(face_count == 1 || face_count == 6, "KTX2 file error. Invalid face count ", face_count, '.');
+	ENFORCE(face_count == 1 || width == height, "KTX2 file error. The faces of a cube map must be square.");
+
+	size_ = uint2(width, height);
+	// 0 means that the mip levels are to be generated by the application.
+	level_count_ = std::max<size_t>(level_count, 1);
+	face_count_ = face_count;
+	ENFORCE(level_count_ <= mip_level_count(size_), "KTX2 file error. Invalid mip level count ", level_count, '.');
+
+	const size_t level_index_byte_count = level_count_ * ktx2_level_index_entry_byte_count;
+	ENFORCE(file_byte_count - ktx2_header_byte_count >= level_index_byte_count,
+		"KTX2 file error. The level index is truncated.");
+
+	// the faces of a mip level follow each other, the levels are placed anywhere.
+	subresources_.resize(face_count_ * level_count_);
+	for (size_t l = 0; l < level_count_; ++l) {
+		const uint8_t* entry = bytes + ktx2_header_byte_count + l * ktx2_level_index_entry_byte_count;
+		const uint64_t level_offset = read_u64_le(entry);
+		const uint64_t level_byte_count = read_u64_le(entry + 8);
+		const size_t image_byte_count = byte_count(mip_level_size(size_, l), pixel_format_);
+		ENFORCE(face_count_ * image_byte_count <= level_byte_count, "KTX2 file error. The mip level ", l, " is truncated.");
+
+		for (size_t f = 0; f < face_count_; ++f)
+			subresources_[f * level_count_ + l] = make_subresource(size_t(level_offset) + f * image_byte_count, l);
+	}
+}
+
+// ----- funcs -----
+
+bool is_dds(const uint8_t* bytes, size_t byte_count) noexcept
+{
+	return (bytes) && (byte_count >= sizeof(dds_magic))
+		&& (std::memcmp(bytes, dds_magic, sizeof(dds_magic)) == 0);
+}
+
+bool is_ktx2(const uint8_t* bytes, size_t byte_count) noexcept
+{
+	return (bytes) && (byte_count >= sizeof(ktx2_identifier))
+		&& (std::memcmp(bytes, ktx2_identifier, sizeof(ktx2_identifier)) == 0);
+}
+
+} // namespace data
+} // namespace cg
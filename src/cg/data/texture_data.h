@@ -0,0 +1,136 @@
+#ifndef CG_DATA_TEXTURE_DATA_H_
+#define CG_DATA_TEXTURE_DATA_H_
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "cg/base/math.h"
+#include "cg/data/file.h"
+#include "cg/data/image.h"
+
+
+namespace cg {
+namespace data {
+
+// Location of one image of a texture file: a mip level of the texture or of one of its cube faces.
+struct texture_subresource final {
+	// Offset of the first pixel (or 4x4 block) from the beginning of the file.
+	size_t offset = 0;
+
+	size_t byte_count = 0;
+
+	// Size of the image in pixels.
+	uint2 size;
+};
+
+// texture_data maps a DDS or KTX2 file and describes the images it stores:
+// the mip chain of a 2D texture or the mip chains of the 6 faces of a cube map.
+// The pixels are used as they are mapped, block compressed levels are not decoded,
+// so they can be uploaded straight to a GPU texture.
+// Supported formats: bc1, bc3, bc4, bc5 & the uncompressed formats which have a pixel_format counterpart.
+// Texture arrays, volume textures & supercompressed KTX2 files are not supported.
+class texture_data final {
+public:
+
+	texture_data() noexcept = default;
+
+	// Maps & parses the file, the file can be stored in a mounted pack (see Mapped_file).
+	// The container is recognized by its signature. Throws if the file is not a supported DDS or KTX2 file.
+	explicit texture_data(const char* filename);
+
+	explicit texture_data(const std::string& filename);
+
+	// Parses the mapped file & takes its ownership.
+	explicit texture_data(Mapped_file&& file);
+
+	texture_data(const texture_data&) = delete;
+
+	texture_data(texture_data&&) noexcept = default;
+
+
+	texture_data& operator=(const texture_data&) = delete;
+
+	texture_data& operator=(texture_data&&) noexcept = default;
+
+
+	// Returns 6 for cube maps & 1 otherwise. The faces are ordered as cube_face (see image_cube.h).
+	size_t face_count() const noexcept
+	{
+		return face_count_;
+	}
+
+	// Pixel format of all the images.
+	pixel_format format() const noexcept
+	{
+		return pixel_format_;
+	}
+
+	bool is_cube() const noexcept
+	{
+		return face_count_ == 6;
+	}
+
+	// Returns true if the color channels are sRGB encoded (*_SRGB formats of the file).
+	bool is_srgb() const noexcept
+	{
+		return srgb_;
+	}
+
+	// Returns the pixels of the mip level of the face.
+	image_view level(size_t level, size_t face = 0) const noexcept;
+
+	size_t level_count() const noexcept
+	{
+		return level_count_;
+	}
+
+	// Returns the number of bytes of a row of pixels or 4x4 blocks of the mip level, e.g. D3D11 row pitch.
+	size_t row_byte_count(size_t level) const noexcept;
+
+	// Size of the top mip level in pixels.
+	uint2 size() const noexcept
+	{
+		return size_;
+	}
+
+	// Returns the location of the mip level of the face within the file.
+	const texture_subresource& subresource(size_t level, size_t face = 0) const noexcept
+	{
+		assert(level < level_count_);
+		assert(face < face_count_);
+		return subresources_[face * level_count_ + level];
+	}
+
+private:
+
+	// Parses the DDS or KTX2 file_.
+	void parse();
+
+	void parse_dds();
+
+	void parse_ktx2();
+
+	// Returns the subresource of the mip level which starts at offset. Throws if it is out of the file.
+	texture_subresource make_subresource(size_t offset, size_t level) const;
+
+	Mapped_file file_;
+	// face * level_count_ + level is the index of a subresource.
+	std::vector<texture_subresource> subresources_;
+	uint2 size_;
+	size_t level_count_ = 0;
+	size_t face_count_ = 0;
+	pixel_format pixel_format_ = pixel_format::none;
+	bool srgb_ = false;
+};
+
+// Returns true if the bytes start with the DDS signature.
+bool is_dds(const uint8_t* bytes, size_t byte_count) noexcept;
+
+// Returns true if the bytes start with the KTX2 identifier.
+bool is_ktx2(const uint8_t* bytes, size_t byte_count) noexcept;
+
+} // namespace data
+} // namespace cg
+
+#endif // CG_DATA_TEXTURE_DATA_H_
@@ -0,0 +1,147 @@
+#include "cg/data/tiled_image.h"
+
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include "cg/base/base.h"
+
+
+namespace cg {
+namespace data {
+
+tiled_image::tiled_image(const std::string& filename, uint32_t tile_size, size_t budget_byte_count)
+	: file_(map_cgimg(filename)),
+	tile_size_(tile_size),
+	budget_byte_count_(budget_byte_count)
+{
+	assert(tile_size > 0);
+
+	ENFORCE(file_.is_mapped(), "Failed to open .cgimg file: ", filename);
+
+	const image_view& view = file_.view();
+	ENFORCE(!is_block_compressed(view.pixel_format),
+		"Block compressed images can not be tiled. ", filename, ' ', view.pixel_format);
+
+	size_ = view.size;
+	pixel_format_ = view.pixel_format;
+	tile_count_ = uint2((size_.x + tile_size - 1) / tile_size, (size_.y + tile_size - 1) / tile_size);
+}
+
+std::shared_ptr<const image_2d> tiled_image::tile(const uint2& index)
+{
+	assert(index.x < tile_count_.x && index.y < tile_count_.y);
+
+	const size_t key = size_t(index.y) * tile_count_.x + index.x;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = tiles_.find(key);
+		if (it != tiles_.end()) {
+			lru_.splice(lru_.begin(), lru_, it->second);
+			return it->second->image;
+		}
+	}
+
+	// the pixels are copied without the lock, concurrent requests of other tiles are not blocked.
+	auto image = std::make_shared<const image_2d>(load_tile(index));
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = tiles_.find(key);
+	if (it != tiles_.end()) {
+		// another thread has loaded the same tile.
+		lru_.splice(lru_.begin(), lru_, it->second);
+		return it->second->image;
+	}
+
+	lru_.push_front({ key, image });
+	tiles_.emplace(key, lru_.begin());
+	resident_byte_count_ += byte_count(*image);
+	evict_tiles();
+
+	return image;
+}
+
+image_2d tiled_image::load_tile(const uint2& index) const
+{
+	const uint2 origin(index.x * tile_size_, index.y * tile_size_);
+	const uint2 tile_size(std::min(tile_size_, size_.x - origin.x), std::min(tile_size_, size_.y - origin.y));
+	const size_t pixel_byte_count = byte_count(pixel_format_);
+	const size_t src_row_byte_count = size_.x * pixel_byte_count;
+	const size_t dst_row_byte_count = tile_size.x * pixel_byte_count;
+
+	image_2d image(tile_size, pixel_format_);
+	const unsigned char* src = reinterpret_cast<const unsigned char*>(file_.view().data)
+		+ origin.y * src_row_byte_count + origin.x * pixel_byte_count;
+	unsigned char* dst = reinterpret_cast<unsigned char*>(image.data);
+
+	for (uint32_t y = 0; y < tile_size.y; ++y, src += src_row_byte_count, dst += dst_row_byte_count)
+		std::memcpy(dst, src, dst_row_byte_count);
+
+	return image;
+}
+
+void tiled_image::evict_tiles()
+{
+	while (resident_byte_count_ > budget_byte_count_ && lru_.size() > 1) {
+		const tile_entry& entry = lru_.back();
+		resident_byte_count_ -= byte_count(*entry.image);
+		tiles_.erase(entry.index);
+		lru_.pop_back();
+	}
+}
+
+void tiled_image::read_region(const uint2& offset, const uint2& size, void* dst)
+{
+	assert(dst);
+	assert(offset.x + size.x <= size_.x && offset.y + size.y <= size_.y);
+
+	if (size.x == 0 || size.y == 0) return;
+
+	const size_t pixel_byte_count = byte_count(pixel_format_);
+	const size_t dst_row_byte_count = size.x * pixel_byte_count;
+	const uint2 first_tile(offset.x / tile_size_, offset.y / tile_size_);
+	const uint2 last_tile((offset.x + size.x - 1) / tile_size_, (offset.y + size.y - 1) / tile_size_);
+
+	for (uint32_t ty = first_tile.y; ty <= last_tile.y; ++ty) {
+		for (uint32_t tx = first_tile.x; tx <= last_tile.x; ++tx) {
+			const std::shared_ptr<const image_2d> t = tile(uint2(tx, ty));
+			const uint2 tile_origin(tx * tile_size_, ty * tile_size_);
+
+			// intersection of the tile & the region in image coordinates.
+			const uint2 p0(std::max(offset.x, tile_origin.x), std::max(offset.y, tile_origin.y));
+			const uint2 p1(std::min(offset.x + size.x, tile_origin.x + t->size.x),
+				std::min(offset.y + size.y, tile_origin.y + t->size.y));
+			const size_t row_byte_count = (p1.x - p0.x) * pixel_byte_count;
+
+			for (uint32_t y = p0.y; y < p1.y; ++y) {
+				const unsigned char* s = reinterpret_cast<const unsigned char*>(t->data)
+					+ ((y - tile_origin.y) * t->size.x + (p0.x - tile_origin.x)) * pixel_byte_count;
+				unsigned char* d = reinterpret_cast<unsigned char*>(dst)
+					+ (y - offset.y) * dst_row_byte_count + (p0.x - offset.x) * pixel_byte_count;
+				std::memcpy(d, s, row_byte_count);
+			}
+		}
+	}
+}
+
+image_2d tiled_image::read_region(const uint2& offset, const uint2& size)
+{
+	image_2d image(size, pixel_format_);
+	read_region(offset, size, image.data);
+	return image;
+}
+
+size_t tiled_image::resident_byte_count() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return resident_byte_count_;
+}
+
+size_t tiled_image::resident_tile_count() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return lru_.size();
+}
+
+} // namespace data
+} // namespace cg
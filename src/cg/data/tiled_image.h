@@ -0,0 +1,118 @@
+#ifndef CG_DATA_TILED_IMAGE_H_
+#define CG_DATA_TILED_IMAGE_H_
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "cg/base/math.h"
+#include "cg/data/image.h"
+#include "cg/data/image_disk_cache.h"
+
+
+namespace cg {
+namespace data {
+
+// tiled_image gives access to rectangular regions of a large image stored in a .cgimg file
+// (see load_image_cached & write_cgimg). The file is mapped, only the pages of the requested
+// regions are read from disk. The image is split into tile_size x tile_size tiles
+// (the last column & row may be smaller), the recently used tiles are kept in memory
+// until their total size exceeds the budget. The least recently used tiles are evicted first.
+// Memory usage scales with the working set, not with the image resolution.
+// All the methods are thread safe.
+class tiled_image final {
+public:
+
+	static constexpr uint32_t default_tile_size = 256;
+
+	static constexpr size_t default_budget_byte_count = 64 * 1024 * 1024;
+
+	tiled_image() noexcept = default;
+
+	// Opens the .cgimg file. Throws if the file does not exist or is not a valid .cgimg file.
+	// Block compressed images are not supported.
+	explicit tiled_image(const std::string& filename, uint32_t tile_size = default_tile_size,
+		size_t budget_byte_count = default_budget_byte_count);
+
+	tiled_image(const tiled_image&) = delete;
+
+	tiled_image(tiled_image&&) = delete;
+
+
+	tiled_image& operator=(const tiled_image&) = delete;
+
+	tiled_image& operator=(tiled_image&&) = delete;
+
+
+	// Size of the whole image in pixels.
+	const uint2& size() const noexcept
+	{
+		return size_;
+	}
+
+	pixel_format format() const noexcept
+	{
+		return pixel_format_;
+	}
+
+	uint32_t tile_size() const noexcept
+	{
+		return tile_size_;
+	}
+
+	// Number of tile columns & rows.
+	const uint2& tile_count() const noexcept
+	{
+		return tile_count_;
+	}
+
+	// Returns the tile at the specified column & row, loads it if it is not resident.
+	// The tile stays valid while the pointer is held even if it is evicted from the cache.
+	std::shared_ptr<const image_2d> tile(const uint2& index);
+
+	// Copies the pixels of the region [offset, offset + size) into dst (tightly packed rows).
+	// dst must point to byte_count(size, format()) bytes. The region must be within the image.
+	void read_region(const uint2& offset, const uint2& size, void* dst);
+
+	// Returns the pixels of the region [offset, offset + size). The region must be within the image.
+	image_2d read_region(const uint2& offset, const uint2& size);
+
+	// Returns the total size of the resident tiles in bytes.
+	size_t resident_byte_count() const;
+
+	// Returns the number of resident tiles.
+	size_t resident_tile_count() const;
+
+private:
+
+	struct tile_entry final {
+		size_t index;
+		std::shared_ptr<const image_2d> image;
+	};
+
+	// Copies the pixels of the tile from the mapped file.
+	image_2d load_tile(const uint2& index) const;
+
+	// Evicts the least recently used tiles until the resident tiles fit the budget.
+	// The most recently used tile is never evicted. mutex_ must be locked.
+	void evict_tiles();
+
+	cached_image file_;
+	uint2 size_;
+	uint2 tile_count_;
+	uint32_t tile_size_ = 0;
+	pixel_format pixel_format_ = pixel_format::none;
+	size_t budget_byte_count_ = 0;
+
+	mutable std::mutex mutex_;
+	// The most recently used tile is the first one.
+	std::list<tile_entry> lru_;
+	std::unordered_map<size_t, std::list<tile_entry>::iterator> tiles_;
+	size_t resident_byte_count_ = 0;
+};
+
+} // namespace data
+} // namespace cg
+
+#endif // CG_DATA_TILED_IMAGE_H_
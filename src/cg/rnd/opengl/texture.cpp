@@ -204,6 +204,27 @@ Texture_2d_immut::Texture_2d_immut(GLenum internal_format, GLuint mipmap_level_c
 	write(*this, 0, uint2::zero, image);
 }
 
+Texture_2d_immut::Texture_2d_immut(GLenum internal_format, const Sampler_desc& sampler_desc,
+	const cg::data::image_mip_chain& mip_chain) noexcept
+	: Texture_2d_immut(internal_format, GLuint(mip_chain.level_count()), sampler_desc, mip_chain.level(0).size)
+{
+	assert(mip_chain.format() != pixel_format::none);
+
+	for (size_t i = 0; i < mip_chain.level_count(); ++i)
+		write(*this, GLint(i), uint2::zero, mip_chain.level(i));
+}
+
+Texture_2d_immut::Texture_2d_immut(GLenum internal_format, const Sampler_desc& sampler_desc,
+	const cg::data::texture_data& tex_data) noexcept
+	: Texture_2d_immut(internal_format, GLuint(tex_data.level_count()), sampler_desc, tex_data.size())
+{
+	assert(tex_data.format() != pixel_format::none);
+	assert(!tex_data.is_cube());
+
+	for (size_t i = 0; i < tex_data.level_count(); ++i)
+		write(*this, GLint(i), uint2::zero, tex_data.level(i));
+}
+
 Texture_2d_immut::Texture_2d_immut(Texture_2d_immut&& tex) noexcept :
 	_id(tex._id),
 	_internal_format(tex._internal_format),
@@ -340,16 +361,23 @@ bool is_valid_texture_internal_format(GLenum value) noexcept
 	return (value == GL_R8)
 		|| (value == GL_R32F)
 		|| (value == GL_RG8)
+		|| (value == GL_RG16F)
 		|| (value == GL_RG32F)
 		|| (value == GL_RGB8)
+		|| (value == GL_RGB16F)
 		|| (value == GL_RGB32F)
 		|| (value == GL_RGBA8)
+		|| (value == GL_RGBA16F)
 		|| (value == GL_RGBA32F)
 		|| (value == GL_DEPTH_COMPONENT24)
 		|| (value == GL_DEPTH24_STENCIL8)
 		|| (value == GL_DEPTH32F_STENCIL8)
 		|| (value == GL_DEPTH_COMPONENT32)
-		|| (value == GL_DEPTH_COMPONENT32F);
+		|| (value == GL_DEPTH_COMPONENT32F)
+		|| (value == GL_COMPRESSED_RGB_S3TC_DXT1_EXT)
+		|| (value == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+		|| (value == GL_COMPRESSED_RED_RGTC1)
+		|| (value == GL_COMPRESSED_RG_RGTC2);
 }
 
 bool is_valid_texture_buffer_internal_format(GLenum value) noexcept
@@ -414,6 +442,18 @@ bool is_valid_texture_wrap_mode(GLenum value) noexcept
 		|| (value == GL_MIRROR_CLAMP_TO_EDGE);
 }
 
+GLenum compressed_texture_internal_format(pixel_format fmt) noexcept
+{
+	switch (fmt) {
+		default: return GL_NONE;
+
+		case pixel_format::bc1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		case pixel_format::bc3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		case pixel_format::bc4: return GL_COMPRESSED_RED_RGTC1;
+		case pixel_format::bc5: return GL_COMPRESSED_RG_RGTC2;
+	}
+}
+
 GLenum texture_sub_image_format(pixel_format fmt) noexcept
 {
 	switch (fmt) {
@@ -424,6 +464,12 @@ GLenum texture_sub_image_format(pixel_format fmt) noexcept
 		case pixel_format::rg_8: return GL_RG;
 		case pixel_format::rgb_8: return GL_RGB;
 		case pixel_format::rgba_8: return GL_RGBA;
+		case pixel_format::rgb_32f: return GL_RGB;
+		case pixel_format::rgba_32f: return GL_RGBA;
+		case pixel_format::rgb_16f: return GL_RGB;
+		case pixel_format::rgba_16f: return GL_RGBA;
+		case pixel_format::rg_32f: return GL_RG;
+		case pixel_format::rg_16f: return GL_RG;
 	}
 }
 
@@ -435,10 +481,13 @@ GLenum texture_sub_image_format(GLenum internal_format) noexcept
 		case GL_R8:					return GL_RED;
 		case GL_R32F:				return GL_RED;
 		case GL_RG8:				return GL_RG;
+		case GL_RG16F:				return GL_RG;
 		case GL_RG32F:				return GL_RG;
 		case GL_RGB8:				return GL_RGB;
+		case GL_RGB16F:				return GL_RGB;
 		case GL_RGB32F:				return GL_RGB;
 		case GL_RGBA8:				return GL_RGBA;
+		case GL_RGBA16F:			return GL_RGBA;
 		case GL_RGBA32F:			return GL_RGBA;
 		case GL_DEPTH_COMPONENT24:	return GL_DEPTH_COMPONENT;
 		case GL_DEPTH_COMPONENT32:	return GL_DEPTH_COMPONENT;
@@ -458,6 +507,12 @@ GLenum texture_sub_image_type(pixel_format fmt) noexcept
 		case pixel_format::rg_8: return GL_UNSIGNED_BYTE;
 		case pixel_format::rgb_8: return GL_UNSIGNED_BYTE;
 		case pixel_format::rgba_8: return GL_UNSIGNED_BYTE;
+		case pixel_format::rgb_32f: return GL_FLOAT;
+		case pixel_format::rgba_32f: return GL_FLOAT;
+		case pixel_format::rgb_16f: return GL_HALF_FLOAT;
+		case pixel_format::rgba_16f: return GL_HALF_FLOAT;
+		case pixel_format::rg_32f: return GL_FLOAT;
+		case pixel_format::rg_16f: return GL_HALF_FLOAT;
 	}
 }
 
@@ -469,10 +524,13 @@ GLenum texture_sub_image_type(GLenum internal_format) noexcept
 		case GL_R8:					return GL_UNSIGNED_BYTE;
 		case GL_R32F:				return GL_FLOAT;
 		case GL_RG8:				return GL_UNSIGNED_BYTE;
+		case GL_RG16F:				return GL_HALF_FLOAT;
 		case GL_RG32F:				return GL_FLOAT;
 		case GL_RGB8:				return GL_UNSIGNED_BYTE;
+		case GL_RGB16F:				return GL_HALF_FLOAT;
 		case GL_RGB32F:				return GL_FLOAT;
 		case GL_RGBA8:				return GL_UNSIGNED_BYTE;
+		case GL_RGBA16F:			return GL_HALF_FLOAT;
 		case GL_RGBA32F:			return GL_FLOAT;
 		case GL_DEPTH_COMPONENT24:	return GL_UNSIGNED_INT;
 		case GL_DEPTH_COMPONENT32:	return GL_UNSIGNED_INT;
@@ -483,7 +541,7 @@ GLenum texture_sub_image_type(GLenum internal_format) noexcept
 }
 
 void write(const Texture_2d_i& texture, GLint mipmap_level, const uint2& offset, 
-	const cg::data::image_2d& image) noexcept
+	const cg::data::image_view& image) noexcept
 {
 	assert(texture.id() != Blank::texture_id);
 	assert(mipmap_level < texture.mipmap_level_count());
@@ -494,11 +552,24 @@ void write(const Texture_2d_i& texture, GLint mipmap_level, const uint2& offset,
 
 	if (image.size == uint2::zero) return;
 
+	if (is_block_compressed(image.pixel_format)) {
+		assert(texture.internal_format() == compressed_texture_internal_format(image.pixel_format));
+		glCompressedTextureSubImage2D(texture.id(), mipmap_level, offset.x, offset.y,
+			image.size.x, image.size.y, texture.internal_format(), GLsizei(byte_count(image)), image.data);
+		return;
+	}
+
+	// rows are tightly packed, e.g. rgb_8 rows of small mipmaps are not 4-byte aligned.
+	const bool unaligned_rows = (image.size.x * byte_count(image.pixel_format)) % 4 != 0;
+	if (unaligned_rows) glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
 	glTextureSubImage2D(texture.id(), mipmap_level, offset.x, offset.y,
 		image.size.x, image.size.y,
 		texture_sub_image_format(image.pixel_format),
 		texture_sub_image_type(image.pixel_format),
 		image.data);
+
+	if (unaligned_rows) glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 }
 
 void write(const Texture_3d_i& texture, GLint mipmap_level, const uint3& offset, 
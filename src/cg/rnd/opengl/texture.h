@@ -4,11 +4,21 @@
 #include <ostream>
 #include <utility>
 #include "cg/data/image.h"
+#include "cg/data/image_mip_chain.h"
+#include "cg/data/texture_data.h"
 #include "cg/base/math.h"
 #include "cg/rnd/opengl/buffer.h"
 #include "cg/rnd/opengl/opengl_def.h"
 #include "cg/rnd/opengl/opengl_utility.h"
 
+// EXT_texture_compression_s3tc is not a part of the core profile, it is supported by all desktop GPUs.
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+	#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT		0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+	#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT	0x83F3
+#endif
+
 
 namespace cg {
 namespace rnd {
@@ -170,6 +180,15 @@ public:
 	Texture_2d_immut(GLenum internal_format, GLuint mipmap_level_count,
 		const Sampler_desc& sampler_desc, const cg::data::image_2d& image) noexcept;
 
+	// Creates a texture which has as many mipmaps as the chain has levels and writes all the levels.
+	Texture_2d_immut(GLenum internal_format, const Sampler_desc& sampler_desc,
+		const cg::data::image_mip_chain& mip_chain) noexcept;
+
+	// Creates a texture which has as many mipmaps as the file has levels and writes the mapped levels as they are.
+	// tex_data must not be a cube map.
+	Texture_2d_immut(GLenum internal_format, const Sampler_desc& sampler_desc,
+		const cg::data::texture_data& tex_data) noexcept;
+
 	Texture_2d_immut(const Texture_2d_immut&) = delete;
 
 	Texture_2d_immut(Texture_2d_immut&& tex) noexcept;
@@ -425,6 +444,10 @@ bool is_valid_texture_min_filter(GLenum value) noexcept;
 // Validates sampler/texture WRAP_{S/T/R} parameter value.
 bool is_valid_texture_wrap_mode(GLenum value) noexcept;
 
+// Returns the compressed internal format which stores blocks of the specified bc* format.
+// Returns GL_NONE if fmt is not block compressed.
+GLenum compressed_texture_internal_format(cg::data::pixel_format fmt) noexcept;
+
 // Infers an appropriate format value for the glTexImage/glTexSubImage/glTextureSubImage call 
 // based on the specified image format.
 // Returns GL_NONE if fmt value eqauls to pixel_format::none.
@@ -445,8 +468,10 @@ GLenum texture_sub_image_type(cg::data::pixel_format fmt) noexcept;
 // Returns GL_NONE if internal_format value is not a valid value.
 GLenum texture_sub_image_type(GLenum internal_format) noexcept;
 
+// Writes the pixels into the specified mipmap level of the texture.
+// Block compressed images require the texture to have the matching compressed internal format.
 void write(const Texture_2d_i& texture, GLint mipmap_level, const uint2& offset, 
-	const cg::data::image_2d& image) noexcept;
+	const cg::data::image_view& image) noexcept;
 
 void write(const Texture_3d_i& texture, GLint mipmap_level, const uint3& offset,
 	const cg::data::image_2d& image) noexcept;
@@ -8,6 +8,7 @@
 #include <string>
 #include <type_traits>
 #include "cg/base/base.h"
+#include "cg/data/image_cache.h"
 #include "assimp/Importer.hpp"
 #include "assimp/postprocess.h"
 
@@ -262,8 +263,10 @@ void Bob_lamp_md5_model::init_images()
 		"../../data/models/bob_lamp/bob_body.png"
 	};
 
+	// the body image is used by two meshes, the cache decodes it once.
+	cg::data::image_cache cache;
 	for (size_t i = 0; i < std::extent<decltype(image_filenames)>::value; ++i) {
-		_mesh_draw_params[i].diffuse_rgb_image = cg::data::image_2d(image_filenames[i], 4, true);
+		_mesh_draw_params[i].diffuse_rgb_image = cache.get(image_filenames[i], 4, true);
 	}
 }
 
@@ -35,7 +35,8 @@ struct Bone final {
 struct Mesh_draw_params final {
 	Mesh_draw_params() noexcept = default;
 
-	cg::data::image_2d diffuse_rgb_image;
+	// Meshes which use the same image share it.
+	std::shared_ptr<const cg::data::image_2d> diffuse_rgb_image;
 	size_t index_count = 0;
 	size_t index_offset = 0;
 	size_t base_vertex = 0;
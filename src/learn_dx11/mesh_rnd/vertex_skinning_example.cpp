@@ -112,7 +112,7 @@ void Vertex_skinning_example::init_draw_indexed_params(
 		_draw_indexed_params[i].index_offset = mesh_draw_params[i].index_offset;
 		_draw_indexed_params[i].base_vertex = mesh_draw_params[i].base_vertex;
 
-		const auto& image = mesh_draw_params[i].diffuse_rgb_image;
+		const auto& image = *mesh_draw_params[i].diffuse_rgb_image;
 
 		D3D11_TEXTURE2D_DESC tex_desc = {};
 		tex_desc.Width = image.size.x;
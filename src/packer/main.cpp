@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "cg/base/base.h"
+#include "cg/data/file.h"
+#include "cg/data/pack.h"
+
+namespace fs = std::filesystem;
+
+
+namespace {
+
+// Payloads of these files are compressed already, packer does not try to compress them.
+constexpr std::array<const char*, 6> compressed_extensions = {
+	".dds", ".jpeg", ".jpg", ".ktx", ".ktx2", ".png"
+};
+
+bool is_compressed(const fs::path& path)
+{
+	const std::string ext = cg::data::normalize_pack_path(path.extension().string());
+	return std::any_of(compressed_extensions.cbegin(), compressed_extensions.cend(),
+		[&ext](const char* e) { return ext == e; });
+}
+
+// Returns all the files of the directory (and its sub-directories) except pack files
+// and .cgimg caches, which are rebuilt from their sources on every machine.
+// Paths are relative to the directory and sorted, so that the pack is read sequentially
+// by the techniques which load files of one directory at a time.
+std::vector<fs::path> list_files(const fs::path& dir)
+{
+	std::vector<fs::path> files;
+	for (const fs::directory_entry& e : fs::recursive_directory_iterator(dir)) {
+		if (!e.is_regular_file()) continue;
+		if (e.path().extension() == ".cgpack") continue;
+		if (e.path().extension() == ".cgimg") continue;
+
+		files.push_back(fs::relative(e.path(), dir));
+	}
+
+	std::sort(files.begin(), files.end());
+	return files;
+}
+
+void print_usage()
+{
+	std::cout << "Builds a pack from all the files of the directory." << std::endl;
+	std::cout << "usage: packer <data directory> <pack filename> [--no-compression]" << std::endl;
+	std::cout << "example: packer ../../data ../../data/data.cgpack" << std::endl;
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+	using cg::data::Mapped_file;
+	using cg::data::pack_writer;
+
+	if (argc < 3 || argc > 4) {
+		print_usage();
+		return 1;
+	}
+
+	const fs::path dir = argv[1];
+	const std::string pack_filename = argv[2];
+	const bool compress = (argc < 4) || (std::string(argv[3]) != "--no-compression");
+
+	try {
+		ENFORCE(fs::is_directory(dir), "The specified data directory '", argv[1], "' does not exist.");
+
+		const std::vector<fs::path> files = list_files(dir);
+		pack_writer writer(pack_filename);
+		uint64_t byte_count = 0;
+
+		for (const fs::path& p : files) {
+			const Mapped_file file((dir / p).string());
+			writer.add(p.generic_string(), file.data(), file.byte_count(), compress && !is_compressed(p));
+			byte_count += file.byte_count();
+		}
+
+		writer.finish();
+
+		std::cout << "Packed " << files.size() << " files (" << byte_count << " bytes) into "
+			<< pack_filename << " (" << fs::file_size(pack_filename) << " bytes)." << std::endl;
+	}
+	catch (std::exception& exc) {
+		std::cerr << "Exception:" << std::endl << cg::exception_message(exc) << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
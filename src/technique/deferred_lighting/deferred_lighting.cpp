@@ -5,12 +5,18 @@
 #include <type_traits>
 #include <utility>
 #include "cg/base/base.h"
+#include "cg/base/thread_pool.h"
+#include "cg/data/asset_loader.h"
 #include "cg/data/image.h"
+#include "cg/data/image_cache.h"
+#include "cg/data/image_mip_chain.h"
 #include "cg/data/model.h"
 #include "cg/data/shader.h"
 
 
-using cg::data::image_2d;
+using cg::data::image_mip_chain;
+using cg::data::mip_content;
+using cg::data::mip_filter;
 using cg::data::vertex_attribs;
 using namespace cg;
 using namespace cg::rnd::opengl;
@@ -82,60 +88,100 @@ Material_library::Material_library()
 	Sampler_desc nearest_repeat(GL_NEAREST, GL_NEAREST, GL_REPEAT);
 	Sampler_desc bilinear_clamp_to_edge(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE);
 	Sampler_desc bilinear_repeat(GL_LINEAR, GL_LINEAR, GL_REPEAT);
+	Sampler_desc trilinear_clamp_to_edge(GL_LINEAR, GL_LINEAR_MIPMAP_LINEAR, GL_CLAMP_TO_EDGE);
+	Sampler_desc trilinear_repeat(GL_LINEAR, GL_LINEAR_MIPMAP_LINEAR, GL_REPEAT);
 
 
-	image_2d material_default_normal_map("../../data/common_data/material-default-normal-map.png");
-	image_2d specular_intensity_0_18_image("../../data/common_data/material-specular-intensity-0.18f.png");
-	image_2d specular_intensity_1_00_image("../../data/common_data/material-specular-intensity-1.00f.png");
+	// all the images are decoded concurrently, each texture is created as soon as its images are ready.
+	// Materials request the common images by name, the cache decodes every file once.
+	cg::data::image_cache cache;
+	cg::data::asset_loader loader;
+	auto load = [&cache, &loader](const char* filename) {
+		return loader.load_image(cache, filename);
+	};
+
+	const char* default_normal_map_filename = "../../data/common_data/material-default-normal-map.png";
+	const char* specular_intensity_0_18_filename = "../../data/common_data/material-specular-intensity-0.18f.png";
+	const char* specular_intensity_1_00_filename = "../../data/common_data/material-specular-intensity-1.00f.png";
+
+	auto default_diffuse_rgb_image_f = load("../../data/common_data/material-default-diffuse-rgb.png");
+	auto default_normal_map_image_f = load(default_normal_map_filename);
+	auto default_specular_image_f = load(specular_intensity_1_00_filename);
+	auto bricks_diffuse_rgb_image_f = load("../../data/bricks-red-diffuse-rgb.png");
+	auto bricks_normal_map_image_f = load("../../data/bricks-red-normal-map.png");
+	auto bricks_specular_image_f = load("../../data/bricks-red-specular-intensity.png");
+	auto chess_board_diffuse_rgb_image_f = load("../../data/chess-board-diffuse-rgb.png");
+	auto chess_board_normal_map_image_f = load(default_normal_map_filename);
+	auto chess_board_specular_image_f = load(specular_intensity_0_18_filename);
+	auto teapot_diffuse_rgb_image_f = load("../../data/teapot-diffuse-rgb.png");
+	auto teapot_normal_map_image_f = load("../../data/teapot-normal-map.png");
+	auto teapot_specular_image_f = load(specular_intensity_1_00_filename);
+	auto wooden_box_diffuse_rgb_image_f = load("../../data/wooden-box-diffuse-rgb.png");
+	auto wooden_box_normal_map_image_f = load("../../data/wooden-box-normal-map.png");
+	auto wooden_box_specular_image_f = load("../../data/wooden-box-specular-intensity.png");
+
+	// filtered textures get full mip chains, minified surfaces do not sample the top level.
+	cg::thread_pool mip_pool;
 
 	{ // default material
-		image_2d diffuse_rgb_image("../../data/common_data/material-default-diffuse-rgb.png");
+		auto diffuse_rgb_image = default_diffuse_rgb_image_f.get();
+		auto normal_map_image = default_normal_map_image_f.get();
+		auto specular_image = default_specular_image_f.get();
 
 		_default_material.smoothness = 10.0f;
-		_default_material.tex_diffuse_rgb = Texture_2d_immut(GL_RGB8, 1, nearest_clamp_to_edge, diffuse_rgb_image);
-		_default_material.tex_normal_map = Texture_2d_immut(GL_RGB8, 1, nearest_clamp_to_edge, material_default_normal_map);
-		_default_material.tex_specular_intensity = Texture_2d_immut(GL_R8, 1, nearest_clamp_to_edge, specular_intensity_1_00_image);
+		_default_material.tex_diffuse_rgb = Texture_2d_immut(GL_RGB8, 1, nearest_clamp_to_edge, *diffuse_rgb_image);
+		_default_material.tex_normal_map = Texture_2d_immut(GL_RGB8, 1, nearest_clamp_to_edge, *normal_map_image);
+		_default_material.tex_specular_intensity = Texture_2d_immut(GL_R8, 1, nearest_clamp_to_edge, *specular_image);
 	}
 
 	{ // brick wall
-		image_2d diffuse_rgb_image("../../data/bricks-red-diffuse-rgb.png");
-		image_2d normal_map_image("../../data/bricks-red-normal-map.png");
-		image_2d specular_image("../../data/bricks-red-specular-intensity.png");
+		auto diffuse_rgb_image = bricks_diffuse_rgb_image_f.get();
+		auto normal_map_image = bricks_normal_map_image_f.get();
+		auto specular_image = bricks_specular_image_f.get();
 
 		_brick_wall_material.smoothness = 5.0f;
-		_brick_wall_material.tex_diffuse_rgb = Texture_2d_immut(GL_RGB8, 1, bilinear_clamp_to_edge, diffuse_rgb_image);
-		_brick_wall_material.tex_normal_map = Texture_2d_immut(GL_RGB8, 1, nearest_clamp_to_edge, normal_map_image);
-		_brick_wall_material.tex_specular_intensity = Texture_2d_immut(GL_R8, 1, bilinear_clamp_to_edge, specular_image);
+		_brick_wall_material.tex_diffuse_rgb = Texture_2d_immut(GL_RGB8, trilinear_clamp_to_edge,
+			image_mip_chain(*diffuse_rgb_image, mip_filter::kaiser, mip_content::srgb_color, mip_pool));
+		_brick_wall_material.tex_normal_map = Texture_2d_immut(GL_RGB8, 1, nearest_clamp_to_edge, *normal_map_image);
+		_brick_wall_material.tex_specular_intensity = Texture_2d_immut(GL_R8, trilinear_clamp_to_edge,
+			image_mip_chain(*specular_image, mip_filter::box, mip_content::linear, mip_pool));
 	}
 
 	{ // chess board
-		image_2d diffuse_rgb_image("../../data/chess-board-diffuse-rgb.png");
+		auto diffuse_rgb_image = chess_board_diffuse_rgb_image_f.get();
+		auto normal_map_image = chess_board_normal_map_image_f.get();
+		auto specular_image = chess_board_specular_image_f.get();
 
 		_chess_board_material.smoothness = 1.0f;
-		_chess_board_material.tex_diffuse_rgb = Texture_2d_immut(GL_RGB8, 1, bilinear_repeat, diffuse_rgb_image);
-		_chess_board_material.tex_normal_map = Texture_2d_immut(GL_RGB8, 1, nearest_repeat, material_default_normal_map);
-		_chess_board_material.tex_specular_intensity = Texture_2d_immut(GL_R8, 1, bilinear_repeat, specular_intensity_0_18_image);
+		_chess_board_material.tex_diffuse_rgb = Texture_2d_immut(GL_RGB8, trilinear_repeat,
+			image_mip_chain(*diffuse_rgb_image, mip_filter::kaiser, mip_content::srgb_color, mip_pool));
+		_chess_board_material.tex_normal_map = Texture_2d_immut(GL_RGB8, 1, nearest_repeat, *normal_map_image);
+		_chess_board_material.tex_specular_intensity = Texture_2d_immut(GL_R8, 1, bilinear_repeat, *specular_image);
 	}
 
 	{ // teapot material
-		image_2d diffuse_rgb_image("../../data/teapot-diffuse-rgb.png");
-		image_2d normal_map_image("../../data/teapot-normal-map.png");
+		auto diffuse_rgb_image = teapot_diffuse_rgb_image_f.get();
+		auto normal_map_image = teapot_normal_map_image_f.get();
+		auto specular_image = teapot_specular_image_f.get();
 
 		_teapot_material.smoothness = 10.0f;
-		_teapot_material.tex_diffuse_rgb = Texture_2d_immut(GL_RGB8, 1, nearest_clamp_to_edge, diffuse_rgb_image);
-		_teapot_material.tex_normal_map = Texture_2d_immut(GL_RGB8, 1, bilinear_clamp_to_edge, normal_map_image);
-		_teapot_material.tex_specular_intensity = Texture_2d_immut(GL_R8, 1, nearest_clamp_to_edge, specular_intensity_1_00_image);
+		_teapot_material.tex_diffuse_rgb = Texture_2d_immut(GL_RGB8, 1, nearest_clamp_to_edge, *diffuse_rgb_image);
+		_teapot_material.tex_normal_map = Texture_2d_immut(GL_RGB8, trilinear_clamp_to_edge,
+			image_mip_chain(*normal_map_image, mip_filter::box, mip_content::normal_map, mip_pool));
+		_teapot_material.tex_specular_intensity = Texture_2d_immut(GL_R8, 1, nearest_clamp_to_edge, *specular_image);
 	}
 
 	{ // wooden box
-		image_2d diffuse_rgb_image("../../data/wooden-box-diffuse-rgb.png");
-		image_2d normal_map_image("../../data/wooden-box-normal-map.png");
-		image_2d specular_image("../../data/wooden-box-specular-intensity.png");
+		auto diffuse_rgb_image = wooden_box_diffuse_rgb_image_f.get();
+		auto normal_map_image = wooden_box_normal_map_image_f.get();
+		auto specular_image = wooden_box_specular_image_f.get();
 
 		_wooden_box_material.smoothness = 4.0f;
-		_wooden_box_material.tex_diffuse_rgb = Texture_2d_immut(GL_RGB8, 1, bilinear_clamp_to_edge, diffuse_rgb_image);
-		_wooden_box_material.tex_normal_map = Texture_2d_immut(GL_RGB8, 1, nearest_clamp_to_edge, normal_map_image);
-		_wooden_box_material.tex_specular_intensity = Texture_2d_immut(GL_R8, 1, bilinear_clamp_to_edge, specular_image);
+		_wooden_box_material.tex_diffuse_rgb = Texture_2d_immut(GL_RGB8, trilinear_clamp_to_edge,
+			image_mip_chain(*diffuse_rgb_image, mip_filter::kaiser, mip_content::srgb_color, mip_pool));
+		_wooden_box_material.tex_normal_map = Texture_2d_immut(GL_RGB8, 1, nearest_clamp_to_edge, *normal_map_image);
+		_wooden_box_material.tex_specular_intensity = Texture_2d_immut(GL_R8, trilinear_clamp_to_edge,
+			image_mip_chain(*specular_image, mip_filter::box, mip_content::linear, mip_pool));
 	}
 }
 
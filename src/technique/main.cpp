@@ -4,6 +4,8 @@
 #include <windows.h>
 #include "cg/base/base.h"
 #include "cg/base/math.h"
+#include "cg/data/file.h"
+#include "cg/data/pack.h"
 #include "cg/sys/app.h"
 #include "technique/deferred_lighting/deferred_lighting.h"
 #include "technique/fur_simulation/fur_simulation_opengl.h"
@@ -41,6 +43,10 @@ int main(int argc, char* argv[])
 	app_desc.viewport_size = uint2(960, 540);
 
 	try {
+		// assets are read from the pack if it has been built by the packer tool.
+		if (cg::data::exists("../../data/data.cgpack"))
+			cg::data::mount_pack("../../data/data.cgpack", "../../data/");
+
 		Application app(app_desc);
 		auto report = app.run_dx11_example<pbr::pbr>();
 		//auto report = app.run_dx11_example<parallax_occlusion_mapping::parallax_occlusion_mapping>();
@@ -1,5 +1,6 @@
 #include "technique/parallax_occlusion_mapping/parallax_occlusion_mapping.h"
 
+#include <vector>
 #include "cg/data/image.h"
 #include "cg/data/model.h"
 
@@ -41,9 +42,15 @@ Material::Material(ID3D11Device* device, float tex_coord_step_scale, float min_s
 	assert(height_map_filename);
 	assert(normal_map_height);
 
+	const std::vector<image_2d> images = decode_images({
+		{ diffuse_rgb_filename, 4, true },
+		{ height_map_filename, 1, true },
+		{ normal_map_height, 4, true }
+	});
+
 	// diffuse rgb
 	{
-		image_2d image(diffuse_rgb_filename, 4, true);
+		const image_2d& image = images[0];
 
 		D3D11_TEXTURE2D_DESC diffuse_desc = {};
 		diffuse_desc.Width = image.size.x;
@@ -67,7 +74,7 @@ Material::Material(ID3D11Device* device, float tex_coord_step_scale, float min_s
 
 	// height map
 	{
-		image_2d image(height_map_filename, 1, true);
+		const image_2d& image = images[1];
 
 		D3D11_TEXTURE2D_DESC displ_desc = {};
 		displ_desc.Width = image.size.x;
@@ -91,7 +98,7 @@ Material::Material(ID3D11Device* device, float tex_coord_step_scale, float min_s
 
 	// normal map
 	{
-		image_2d image(normal_map_height, 4, true);
+		const image_2d& image = images[2];
 
 		D3D11_TEXTURE2D_DESC normal_desc = {};
 		normal_desc.Width = image.size.x;
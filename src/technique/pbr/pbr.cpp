@@ -1,48 +1,20 @@
 #include "technique/pbr/pbr.h"
 
 #include <type_traits>
+#include "cg/base/thread_pool.h"
+#include "cg/data/ibl.h"
+#include "cg/data/image_cube.h"
 #include "cg/data/model.h"
 
 using namespace cg::data;
 
 
-namespace {
-
-com_ptr<ID3D11Texture2D> load_envmap(ID3D11Device* device, const char* filename)
-{
-	const image_2d hdr_image(filename, 4);
-	com_ptr<ID3D11Texture2D> tex_envmap;
-
-	D3D11_TEXTURE2D_DESC envmap_desc = {};
-	envmap_desc.Width = hdr_image.size.x;
-	envmap_desc.Height = hdr_image.size.y;
-	envmap_desc.MipLevels = 1;
-	envmap_desc.ArraySize = 1;
-	envmap_desc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-	envmap_desc.SampleDesc.Count = 1;
-	envmap_desc.SampleDesc.Quality = 0;
-	envmap_desc.Usage = D3D11_USAGE_IMMUTABLE;
-	envmap_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-	D3D11_SUBRESOURCE_DATA env_map_data = {};
-	env_map_data.pSysMem = hdr_image.data;
-	env_map_data.SysMemPitch = UINT(hdr_image.size.x * byte_count(hdr_image.pixel_format));
-	
-	HRESULT hr = device->CreateTexture2D(&envmap_desc, &env_map_data, &tex_envmap.ptr);
-	assert(hr == S_OK);
-
-	return tex_envmap;
-}
-
-} // namespace
-
-
 namespace pbr {
 
 // ----- cube_envmap_pass -----
 
 cube_envmap_pass::cube_envmap_pass(ID3D11Device* device, ID3D11DeviceContext* device_ctx, ID3D11Debug* debug,
-	const char* envmap_filename, size_t cube_side_size, size_t irradiance_side_size,
-	size_t reflection_size_size)
+	const char* envmap_filename, size_t cube_side_size, size_t reflection_size_size)
 	: device_(device),
 	device_ctx_(device_ctx),
 	debug_(debug)
@@ -52,7 +24,6 @@ cube_envmap_pass::cube_envmap_pass(ID3D11Device* device, ID3D11DeviceContext* de
 	assert(debug);
 	assert(envmap_filename);
 	assert(cube_side_size > 0);
-	assert(irradiance_side_size > 0);
 	assert(reflection_size_size >= 32);
 
 	D3D11_TEXTURE2D_DESC tex_desc = {};
@@ -63,7 +34,7 @@ cube_envmap_pass::cube_envmap_pass(ID3D11Device* device, ID3D11DeviceContext* de
 	tex_desc.SampleDesc.Count = 1;
 	tex_desc.SampleDesc.Quality = 0;
 	tex_desc.Usage = D3D11_USAGE_DEFAULT;
-	tex_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+	tex_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
 	tex_desc.MiscFlags = D3D11_RESOURCE_MISC_TEXTURECUBE;
 	
 	// cube envmap
@@ -72,13 +43,6 @@ cube_envmap_pass::cube_envmap_pass(ID3D11Device* device, ID3D11DeviceContext* de
 	hr = device->CreateShaderResourceView(tex_cube_envmap_, nullptr, &tex_cube_envmap_srv_.ptr);
 	assert(hr == S_OK);
 	
-	// irradiance map
-	tex_desc.Width = tex_desc.Height = UINT(irradiance_side_size);
-	hr = device->CreateTexture2D(&tex_desc, nullptr, &tex_irradiance_map_.ptr);
-	assert(hr == S_OK);
-	hr = device->CreateShaderResourceView(tex_irradiance_map_, nullptr, &tex_irradiance_map_srv_.ptr);
-	assert(hr == S_OK);
-
 	// reflection map
 	tex_desc.Width = tex_desc.Height = UINT(reflection_size_size);
 	tex_desc.MipLevels = UINT(cube_envmap_pass::reflection_mip_level_count);
@@ -98,238 +62,77 @@ cube_envmap_pass::cube_envmap_pass(ID3D11Device* device, ID3D11DeviceContext* de
 	D3D11_DEPTH_STENCIL_DESC depth_stencil_desc = {};
 	hr = device_->CreateDepthStencilState(&depth_stencil_desc, &depth_stencil_state.ptr);
 	device_ctx_->OMSetDepthStencilState(depth_stencil_state, 0);
-	init_brdf_maps();
-	init_cube_maps(envmap_filename, cube_side_size, irradiance_side_size, reflection_size_size);
+
+	cg::thread_pool pool;
+	init_brdf_maps(pool);
+	init_cube_maps(pool, envmap_filename, cube_side_size, reflection_size_size);
 }
 
-void cube_envmap_pass::init_brdf_maps()
+void cube_envmap_pass::init_brdf_maps(cg::thread_pool& pool)
 {
+	// the split sum lookup table is computed on the cpu once & cached next to the shaders.
+	const cached_image lut = load_brdf_lut_cached("../../data/pbr/brdf_lut.cgimg", uint2(brdf_map_size, brdf_map_size),
+		brdf_map_sample_count, pixel_format::rg_16f, pool);
+
 	D3D11_TEXTURE2D_DESC tex_desc = {};
-	tex_desc.Width = tex_desc.Height = 1024;
+	tex_desc.Width = tex_desc.Height = brdf_map_size;
 	tex_desc.MipLevels = 1;
 	tex_desc.ArraySize = 1;
-	tex_desc.Format = DXGI_FORMAT_R32G32_FLOAT;
+	tex_desc.Format = DXGI_FORMAT_R16G16_FLOAT;
 	tex_desc.SampleDesc.Count = 1;
 	tex_desc.SampleDesc.Quality = 0;
-	tex_desc.Usage = D3D11_USAGE_DEFAULT;
-	tex_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+	tex_desc.Usage = D3D11_USAGE_IMMUTABLE;
+	tex_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
 
-	HRESULT hr = device_->CreateTexture2D(&tex_desc, nullptr, &tex_brdf_map_.ptr);
-	assert(hr == S_OK);
-	hr = device_->CreateShaderResourceView(tex_brdf_map_, nullptr, &tex_brdf_map_srv_.ptr);
-	assert(hr == S_OK);
-	com_ptr<ID3D11RenderTargetView> tex_brdf_map_rtv;
-	hr = device_->CreateRenderTargetView(tex_brdf_map_, nullptr, &tex_brdf_map_rtv.ptr);
-	assert(hr == S_OK);
-
-	// shader
-	auto shader_desc = cg::rnd::dx11::load_hlsl_shader_set_desc("../../data/pbr/gen_brdf_map.hlsl");
-	shader_desc.vertex_shader_entry_point = "vs_main";
-	shader_desc.pixel_shader_entry_point = "ps_main";
-	hlsl_shader shader = hlsl_shader(device_, shader_desc);
+	D3D11_SUBRESOURCE_DATA data = {};
+	data.pSysMem = lut.view().data;
+	data.SysMemPitch = UINT(brdf_map_size * byte_count(lut.view().pixel_format));
 
-	// render a quat and populate the brdf map:
-	//
-	device_ctx_->IASetInputLayout(nullptr);
-	device_ctx_->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
-	device_ctx_->IASetVertexBuffers(0, 0, nullptr, nullptr, nullptr);
-	device_ctx_->IASetIndexBuffer(nullptr, DXGI_FORMAT_R32_UINT, 0);
-	// rasterizer state
-	com_ptr<ID3D11RasterizerState> rastr_state;
-	D3D11_RASTERIZER_DESC rastr_desc = {};
-	rastr_desc.FillMode = D3D11_FILL_SOLID;
-	rastr_desc.CullMode = D3D11_CULL_BACK;
-	rastr_desc.FrontCounterClockwise = true;
-	hr = device_->CreateRasterizerState(&rastr_desc, &rastr_state.ptr);
+	HRESULT hr = device_->CreateTexture2D(&tex_desc, &data, &tex_brdf_map_.ptr);
 	assert(hr == S_OK);
-	device_ctx_->RSSetState(rastr_state);
-	// viewport
-	D3D11_VIEWPORT viewport;
-	viewport.TopLeftX = 0;
-	viewport.TopLeftY = 0;
-	viewport.Width = viewport.Height = float(tex_desc.Width);
-	viewport.MinDepth = 0.0f;
-	viewport.MaxDepth = 1.0f;
-	device_ctx_->RSSetViewports(1, &viewport);
-
-	device_ctx_->VSSetShader(shader.vertex_shader, nullptr, 0);
-	device_ctx_->VSSetConstantBuffers(0, 0, nullptr);
-	device_ctx_->PSSetShader(shader.pixel_shader, nullptr, 0);
-	device_ctx_->PSSetShaderResources(0, 0, nullptr);
-	device_ctx_->OMSetRenderTargets(1, &tex_brdf_map_rtv.ptr, nullptr);
-	hr = debug_->ValidateContext(device_ctx_);
+	hr = device_->CreateShaderResourceView(tex_brdf_map_, nullptr, &tex_brdf_map_srv_.ptr);
 	assert(hr == S_OK);
-
-	device_ctx_->Draw(4, 0);
-	device_ctx_->Flush();
 }
 
-void cube_envmap_pass::init_cube_maps(const char* envmap_filename, size_t cube_side_size, size_t irradiance_side_size,
-	size_t reflection_size_size)
+void cube_envmap_pass::init_cube_maps(cg::thread_pool& pool, const char* envmap_filename,
+	size_t cube_side_size, size_t reflection_size_size)
 {
-	// load an epirectengular hdr image:
-	//
-	com_ptr<ID3D11Texture2D> tex_envmap = load_envmap(device_, envmap_filename);
-	com_ptr<ID3D11ShaderResourceView> tex_envmap_srv;
-	HRESULT hr = device_->CreateShaderResourceView(tex_envmap, nullptr, &tex_envmap_srv.ptr);
-	assert(hr == S_OK);
-
-	// init pipeline state:
-	//
-	// input assembler
-	device_ctx_->IASetInputLayout(nullptr);
-	device_ctx_->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
-	device_ctx_->IASetVertexBuffers(0, 0, nullptr, nullptr, nullptr);
-	device_ctx_->IASetIndexBuffer(nullptr, DXGI_FORMAT_R32_UINT, 0);
-	// rasterizer
-	device_ctx_->RSSetState(rasterizer_state_);
-
-	constexpr size_t face_count = 6;
-	const float4x4 view_matrices[face_count] = {
-		view_matrix(float3::zero,	float3(1.0f, 0.0f, 0.0f),	-float3::unit_y),
-		view_matrix(float3::zero,	float3(-1.0f, 0.0f, 0.0f),	-float3::unit_y),
-		view_matrix(float3::zero,	float3(0.0f, -1.0f, 0.0f),	-float3::unit_z),
-		view_matrix(float3::zero,	float3(0.0f, 1.0f, 0.0f),	float3::unit_z),
-		view_matrix(float3::zero,	float3(0.0f, 0.0f, 1.0f),	-float3::unit_y),
-		view_matrix(float3::zero,	float3(0.0f, 0.0f, -1.0f),	-float3::unit_y)
-	};
-
-	// generate tex_cube_envmap_:
+	// project an epirectengular hdr image onto tex_cube_envmap_:
+	// the faces are cached next to the image, so only the first launch pays for decoding & projection.
 	//
 	{
-		D3D11_VIEWPORT viewport;
-		viewport.TopLeftX = 0;
-		viewport.TopLeftY = 0;
-		viewport.Width = viewport.Height = float(cube_side_size);
-		viewport.MinDepth = 0.0f;
-		viewport.MaxDepth = 1.0f;
-		device_ctx_->RSSetViewports(1, &viewport);
-
-		// shader
-		auto shader_desc = cg::rnd::dx11::load_hlsl_shader_set_desc("../../data/pbr/gen_cube_envmap.hlsl");
-		shader_desc.vertex_shader_entry_point = "vs_main";
-		shader_desc.pixel_shader_entry_point = "ps_main";
-		hlsl_shader shader = hlsl_shader(device_, shader_desc);
-		device_ctx_->VSSetShader(shader.vertex_shader, nullptr, 0);
-		device_ctx_->VSSetConstantBuffers(0, 1, &constant_buffer_.ptr);
-		device_ctx_->PSSetShader(shader.pixel_shader, nullptr, 0);
-		device_ctx_->PSSetShaderResources(0, 1, &tex_envmap_srv.ptr);
-		device_ctx_->PSSetSamplers(0, 1, &sampler_state_.ptr);
-
-		for (size_t i = 0; i < face_count; ++i) {
-			// render target view
-			com_ptr<ID3D11RenderTargetView> rtv;
-			D3D11_RENDER_TARGET_VIEW_DESC rtv_desc = {};
-			rtv_desc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-			rtv_desc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2DARRAY;
-			rtv_desc.Texture2DArray.FirstArraySlice = UINT(i);
-			rtv_desc.Texture2DArray.ArraySize = 1;
-			HRESULT hr = device_->CreateRenderTargetView(tex_cube_envmap_, &rtv_desc, &rtv.ptr);
-			assert(hr == S_OK);
-
-			device_ctx_->OMSetRenderTargets(1, &rtv.ptr, nullptr);
-			hr = debug_->ValidateContext(device_ctx_);
-			assert(hr == S_OK);
-			const float4x4 proj_view_matrix = view_matrices[i];
-			device_ctx_->UpdateSubresource(constant_buffer_, 0, nullptr, &proj_view_matrix.m00, 0, 0);
-			device_ctx_->Draw(cube_envmap_pass::cube_index_count, 0);
-			device_ctx_->Flush();
-		}
-	}
+		const image_cube cube = load_cube_cached(envmap_filename, uint32_t(cube_side_size), pixel_format::rgba_32f, pool);
+		const UINT row_pitch = UINT(cube_side_size * byte_count(cube.format()));
 
-	device_ctx_->OMSetRenderTargets(0, nullptr, nullptr);
-	// generate tex_irradiance_map_:
-	//
-	{
-		D3D11_VIEWPORT viewport;
-		viewport.TopLeftX = 0;
-		viewport.TopLeftY = 0;
-		viewport.Width = viewport.Height = float(irradiance_side_size);
-		viewport.MinDepth = 0.0f;
-		viewport.MaxDepth = 1.0f;
-		device_ctx_->RSSetViewports(1, &viewport);
-
-		// shader
-		auto shader_desc = cg::rnd::dx11::load_hlsl_shader_set_desc("../../data/pbr/gen_irradiance_map.hlsl");
-		shader_desc.vertex_shader_entry_point = "vs_main";
-		shader_desc.pixel_shader_entry_point = "ps_main";
-		hlsl_shader shader = hlsl_shader(device_, shader_desc);
-		device_ctx_->VSSetShader(shader.vertex_shader, nullptr, 0);
-		device_ctx_->VSSetConstantBuffers(0, 1, &constant_buffer_.ptr);
-		device_ctx_->PSSetShader(shader.pixel_shader, nullptr, 0);
-		device_ctx_->PSSetShaderResources(0, 1, &tex_cube_envmap_srv_.ptr);
-		device_ctx_->PSSetSamplers(0, 1, &sampler_state_.ptr);
-
-		for (size_t i = 0; i < face_count; ++i) {
-			// render target view
-			com_ptr<ID3D11RenderTargetView> rtv;
-			D3D11_RENDER_TARGET_VIEW_DESC rtv_desc = {};
-			rtv_desc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-			rtv_desc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2DARRAY;
-			rtv_desc.Texture2DArray.FirstArraySlice = UINT(i);
-			rtv_desc.Texture2DArray.ArraySize = 1;
-			HRESULT hr = device_->CreateRenderTargetView(tex_irradiance_map_, &rtv_desc, &rtv.ptr);
-			assert(hr == S_OK);
-
-			device_ctx_->OMSetRenderTargets(1, &rtv.ptr, nullptr);
-			hr = debug_->ValidateContext(device_ctx_);
-			assert(hr == S_OK);
-			const float4x4 proj_view_matrix = view_matrices[i];
-			device_ctx_->UpdateSubresource(constant_buffer_, 0, nullptr, &proj_view_matrix.m00, 0, 0);
-			device_ctx_->Draw(cube_envmap_pass::cube_index_count, 0);
-			device_ctx_->Flush();
+		for (size_t i = 0; i < cube_face_count; ++i) {
+			const image_view face = cube.face(cube_face(i));
+			device_ctx_->UpdateSubresource(tex_cube_envmap_, D3D11CalcSubresource(0, UINT(i), 1),
+				nullptr, face.data, row_pitch, 0);
 		}
+
+		// irradiance: 27 floats instead of a cube map & a convolution pass.
+		irradiance_sh_ = irradiance_sh9(project_sh9(cube, pool));
 	}
 
-	// generate tex_reflection_map:
+	// prefilter tex_cube_envmap_ for the reflection map levels:
+	// the levels are cached next to the image too, the cache is keyed by the bake params.
 	//
 	{
-		com_ptr<ID3D11Buffer> ps_constant_buffer = cg::rnd::dx11::constant_buffer(device_, sizeof(float4));
-
-		// shader
-		auto shader_desc = cg::rnd::dx11::load_hlsl_shader_set_desc("../../data/pbr/gen_reflection_map.hlsl");
-		shader_desc.vertex_shader_entry_point = "vs_main";
-		shader_desc.pixel_shader_entry_point = "ps_main";
-		hlsl_shader shader = hlsl_shader(device_, shader_desc);
-		device_ctx_->VSSetShader(shader.vertex_shader, nullptr, 0);
-		device_ctx_->VSSetConstantBuffers(0, 1, &constant_buffer_.ptr);
-		device_ctx_->PSSetShader(shader.pixel_shader, nullptr, 0);
-		device_ctx_->PSSetConstantBuffers(0, 1, &ps_constant_buffer.ptr);
-		device_ctx_->PSSetShaderResources(0, 1, &tex_cube_envmap_srv_.ptr);
-		device_ctx_->PSSetSamplers(0, 1, &sampler_state_.ptr);
-
-		for (size_t mip = 0; mip < cube_envmap_pass::reflection_mip_level_count; ++mip) {
-			const float mip_side_size = reflection_size_size * std::pow(0.5f, mip);
-			
-			D3D11_VIEWPORT viewport;
-			viewport.TopLeftX = 0;
-			viewport.TopLeftY = 0;
-			viewport.Width = viewport.Height = mip_side_size;
-			viewport.MinDepth = 0.0f;
-			viewport.MaxDepth = 1.0f;
-			device_ctx_->RSSetViewports(1, &viewport);
-
-			const float roughness = float(mip) / (cube_envmap_pass::reflection_mip_level_count - 1);
-			device_ctx_->UpdateSubresource(ps_constant_buffer, 0, nullptr, &roughness, 0, 0);
-			for (size_t i = 0; i < face_count; ++i) {
-				// render target view
-				com_ptr<ID3D11RenderTargetView> rtv;
-				D3D11_RENDER_TARGET_VIEW_DESC rtv_desc = {};
-				rtv_desc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-				rtv_desc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2DARRAY;
-				rtv_desc.Texture2DArray.MipSlice = UINT(mip);
-				rtv_desc.Texture2DArray.FirstArraySlice = UINT(i);
-				rtv_desc.Texture2DArray.ArraySize = 1;
-				HRESULT hr = device_->CreateRenderTargetView(tex_reflection_map_, &rtv_desc, &rtv.ptr);
-				assert(hr == S_OK);
-
-				device_ctx_->OMSetRenderTargets(1, &rtv.ptr, nullptr);
-				hr = debug_->ValidateContext(device_ctx_);
-				assert(hr == S_OK);
-				const float4x4 proj_view_matrix = view_matrices[i];
-				device_ctx_->UpdateSubresource(constant_buffer_, 0, nullptr, &proj_view_matrix.m00, 0, 0);
-				device_ctx_->Draw(cube_envmap_pass::cube_index_count, 0);
-				device_ctx_->Flush();
+		ggx_prefilter_desc desc;
+		desc.side_size = uint32_t(reflection_size_size);
+		desc.mip_level_count = uint32_t(cube_envmap_pass::reflection_mip_level_count);
+		desc.sample_count = 1024;
+
+		const std::vector<image_cube> levels = load_prefiltered_cached(envmap_filename,
+			uint32_t(cube_side_size), desc, pixel_format::rgba_32f, pool);
+
+		for (size_t mip = 0; mip < levels.size(); ++mip) {
+			const UINT row_pitch = UINT(levels[mip].side_size() * byte_count(levels[mip].format()));
+
+			for (size_t i = 0; i < cube_face_count; ++i) {
+				const UINT subresource = D3D11CalcSubresource(UINT(mip), UINT(i), UINT(levels.size()));
+				device_ctx_->UpdateSubresource(tex_reflection_map_, subresource,
+					nullptr, levels[mip].face(cube_face(i)).data, row_pitch, 0);
 			}
 		}
 	}
@@ -386,7 +189,6 @@ void cube_envmap_pass::render_envmap(const float4x4& projection_view_matrix)
 	device_ctx_->VSSetConstantBuffers(0, 1, &constant_buffer_.ptr);
 	device_ctx_->PSSetShader(shader_.pixel_shader, nullptr, 0);
 	device_ctx_->PSSetShaderResources(0, 1, &tex_cube_envmap_srv_.ptr);
-	//device_ctx_->PSSetShaderResources(0, 1, &tex_irradiance_map_srv_.ptr);
 	//device_ctx_->PSSetShaderResources(0, 1, &tex_reflection_map_srv_.ptr);
 	//device_ctx_->PSSetSamplers(0, 1, &sampler_state_.ptr);
 	
@@ -405,7 +207,7 @@ pbr::pbr(const cg::sys::app_context& app_ctx, cg::rnd::rhi_context_i& rhi_ctx)
 	debug_(this->rhi_ctx_.debug()),
 	device_ctx_(this->rhi_ctx_.device_ctx()),
 	curr_viewpoint_(float3(0.0f, 0, 17.0f), float3::zero, float3::unit_y),
-	cube_envmap_pass_(device_, device_ctx_, debug_, "../../data/hdr/winter_forest/WinterForest_Ref.hdr", 512, 32, 128)
+	cube_envmap_pass_(device_, device_ctx_, debug_, "../../data/hdr/winter_forest/WinterForest_Ref.hdr", 512, 128)
 {
 	update_projection_matrix();
 	model_position_ = float3::zero;
@@ -414,13 +216,25 @@ pbr::pbr(const cg::sys::app_context& app_ctx, cg::rnd::rhi_context_i& rhi_ctx)
 	model_scale_ = float3(4.0f);
 
 	cb_vertex_shader_ = constant_buffer(device_, sizeof(float) * pbr::cb_vertex_shader_component_count);
-	//cb_pixel_shader_ = constant_buffer(device_, sizeof(float) * parallax_occlusion_mapping::cb_pixel_shader_component_count);
+	init_cb_pixel_shader();
 
 	init_shader();
 	init_geometry();
 	init_pipeline_state();
 }
 
+void pbr::init_cb_pixel_shader()
+{
+	// float4 per coefficient: hlsl arrays align elements to 16 bytes.
+	const sh9& irradiance_sh = cube_envmap_pass_.irradiance_sh();
+	float4 data[sh9::coefficient_count];
+	for (size_t i = 0; i < sh9::coefficient_count; ++i)
+		data[i] = float4(irradiance_sh.coefficients[i], 0.0f);
+
+	cb_pixel_shader_ = constant_buffer(device_, sizeof(data));
+	device_ctx_->UpdateSubresource(cb_pixel_shader_, 0, nullptr, data, 0, 0);
+}
+
 void pbr::init_geometry()
 {
 	//auto model = load_model<vertex_attribs::p_n_tc_ts>("../../data/models/bunny.obj");
@@ -570,12 +384,12 @@ void pbr::render(float interpolation_factor)
 	device_ctx_->VSSetShader(shader_.vertex_shader, nullptr, 0);
 	device_ctx_->VSSetConstantBuffers(0, 1, &cb_vertex_shader_.ptr);
 	device_ctx_->PSSetShader(shader_.pixel_shader, nullptr, 0);
-	ID3D11ShaderResourceView* srv_list[3] = {
-		cube_envmap_pass_.tex_irradiance_map_srv(),
+	device_ctx_->PSSetConstantBuffers(0, 1, &cb_pixel_shader_.ptr);
+	ID3D11ShaderResourceView* srv_list[2] = {
 		cube_envmap_pass_.tex_reflection_map_srv(),
 		cube_envmap_pass_.tex_brdf_map_srv()
 	};
-	device_ctx_->PSSetShaderResources(0, 3, srv_list);
+	device_ctx_->PSSetShaderResources(0, 2, srv_list);
 	device_ctx_->PSSetSamplers(0, 1, &sampler_state_.ptr);
 	HRESULT hr = debug_->ValidateContext(device_ctx_);
 	assert(hr == S_OK);
@@ -1,6 +1,7 @@
 #ifndef TECHNIQUE_PBR_PBR_H_
 #define TECHNIQUE_PBR_PBR_H_
 
+#include "cg/data/spherical_harmonics.h"
 #include "cg/rnd/dx11/dx11.h"
 #include "cg/sys/app.h"
 
@@ -16,8 +17,7 @@ public:
 
 
 	cube_envmap_pass(ID3D11Device* device, ID3D11DeviceContext* device_ctx, ID3D11Debug* debug_,
-		const char* envmap_filename, size_t cube_side_size, size_t irradiance_side_size,
-		size_t reflection_size_size);
+		const char* envmap_filename, size_t cube_side_size, size_t reflection_size_size);
 
 	cube_envmap_pass(cube_envmap_pass&&) = delete;
 	cube_envmap_pass& operator=(cube_envmap_pass&&) = delete;
@@ -33,9 +33,10 @@ public:
 		return tex_cube_envmap_srv_;
 	}
 
-	ID3D11ShaderResourceView* tex_irradiance_map_srv() const noexcept
+	// Irradiance of the envmap: the radiance projected onto sh9 & convolved with the clamped cosine.
+	const cg::data::sh9& irradiance_sh() const noexcept
 	{
-		return tex_irradiance_map_srv_;
+		return irradiance_sh_;
 	}
 
 	ID3D11ShaderResourceView* tex_reflection_map_srv() const noexcept
@@ -48,14 +49,18 @@ public:
 private:
 
 	static constexpr UINT cube_index_count = 14;
+	static constexpr uint32_t brdf_map_size = 256;
+	static constexpr uint32_t brdf_map_sample_count = 1024;
 
 
-	void init_brdf_maps();
+	// Loads the split sum brdf lookup table into tex_brdf_map_ (see cg::data::brdf_lut).
+	void init_brdf_maps(cg::thread_pool& pool);
 
 	// Loads an epirectengular hdr image and projects in onto tex_cube_envmap_.
-	// Convolutes tex_cube_envmap_ and stores the result in tex_irradiance_map_
-	void init_cube_maps(const char* envmap_filename, size_t cube_side_size, size_t irradiance_side_size,
-		size_t reflection_size_size);
+	// Projects tex_cube_envmap_ onto sh9 and stores the irradiance in irradiance_sh_.
+	// Loads the GGX prefiltered levels of tex_cube_envmap_ into tex_reflection_map_.
+	void init_cube_maps(cg::thread_pool& pool, const char* envmap_filename,
+		size_t cube_side_size, size_t reflection_size_size);
 
 	void init_pipeline_state();
 
@@ -67,8 +72,7 @@ private:
 	//
 	com_ptr<ID3D11Texture2D> tex_cube_envmap_;
 	com_ptr<ID3D11ShaderResourceView> tex_cube_envmap_srv_;
-	com_ptr<ID3D11Texture2D> tex_irradiance_map_;
-	com_ptr<ID3D11ShaderResourceView> tex_irradiance_map_srv_;
+	cg::data::sh9 irradiance_sh_;
 	com_ptr<ID3D11Texture2D> tex_reflection_map_;
 	com_ptr<ID3D11ShaderResourceView> tex_reflection_map_srv_;
 	com_ptr<ID3D11Texture2D> tex_brdf_map_;
@@ -111,6 +115,8 @@ private:
 
 	static constexpr size_t cb_vertex_shader_component_count = 4 * 16 + 2 * 4;
 
+	void init_cb_pixel_shader();
+
 	void init_geometry();
 
 	void init_pipeline_state();
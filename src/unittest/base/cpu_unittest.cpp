@@ -0,0 +1,25 @@
+#include "cg/base/cpu.h"
+
+#include "CppUnitTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace unittest {
+
+TEST_CLASS(cg_base_cpu_Funcs) {
+public:
+
+	TEST_METHOD(get_cpu_features)
+	{
+		const cg::cpu_features& f = cg::get_cpu_features();
+
+		// features are queried once.
+		Assert::IsTrue(&f == &cg::get_cpu_features());
+
+		// f16c instructions are VEX encoded.
+		Assert::IsTrue(!f.f16c || f.avx);
+	}
+};
+
+} // namespace unittest
@@ -0,0 +1,77 @@
+#include "cg/base/half.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "CppUnitTest.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace unittest {
+
+TEST_CLASS(cg_base_half_Funcs) {
+public:
+
+	TEST_METHOD(float_to_half)
+	{
+		using cg::float_to_half;
+
+		Assert::AreEqual<uint16_t>(0x0000, float_to_half(0.0f));
+		Assert::AreEqual<uint16_t>(0x8000, float_to_half(-0.0f));
+		Assert::AreEqual<uint16_t>(0x3c00, float_to_half(1.0f));
+		Assert::AreEqual<uint16_t>(0xc000, float_to_half(-2.0f));
+		Assert::AreEqual<uint16_t>(0x3555, float_to_half(1.0f / 3.0f));
+		Assert::AreEqual<uint16_t>(0x7bff, float_to_half(65504.0f));
+		Assert::AreEqual<uint16_t>(0x7c00, float_to_half(65520.0f));
+		Assert::AreEqual<uint16_t>(0x7c00, float_to_half(std::numeric_limits<float>::infinity()));
+		Assert::AreEqual<uint16_t>(0xfc00, float_to_half(-std::numeric_limits<float>::infinity()));
+		Assert::AreEqual<uint16_t>(0x0001, float_to_half(5.9604645e-8f));
+		Assert::AreEqual<uint16_t>(0x0000, float_to_half(1e-8f));
+
+		const uint16_t nan = float_to_half(std::numeric_limits<float>::quiet_NaN());
+		Assert::IsTrue((nan & 0x7c00) == 0x7c00 && (nan & 0x03ff) != 0);
+
+		// round to nearest even: 1 + 2^-11 is halfway between 1 and 1 + 2^-10.
+		Assert::AreEqual<uint16_t>(0x3c00, float_to_half(1.0f + 1.0f / 2048.0f));
+		Assert::AreEqual<uint16_t>(0x3c02, float_to_half(1.0f + 3.0f / 2048.0f));
+	}
+
+	TEST_METHOD(half_to_float)
+	{
+		using cg::half_to_float;
+
+		Assert::AreEqual(0.0f, half_to_float(0x0000));
+		Assert::AreEqual(1.0f, half_to_float(0x3c00));
+		Assert::AreEqual(-2.0f, half_to_float(0xc000));
+		Assert::AreEqual(65504.0f, half_to_float(0x7bff));
+		Assert::AreEqual(5.9604645e-8f, half_to_float(0x0001));
+		Assert::IsTrue(std::isinf(half_to_float(0x7c00)));
+		Assert::IsTrue(std::isnan(half_to_float(0x7e00)));
+	}
+
+	TEST_METHOD(arrays)
+	{
+		// all the halves except NaNs survive the round trip.
+		// Odd count checks the tails of vectorized loops.
+		std::vector<uint16_t> halves;
+		for (uint32_t h = 0; h <= 0xffff; ++h) {
+			const bool is_nan = ((h & 0x7c00) == 0x7c00) && ((h & 0x03ff) != 0);
+			if (!is_nan) halves.push_back(uint16_t(h));
+		}
+		halves.push_back(0x3c00);
+		Assert::IsTrue(halves.size() % 8 != 0);
+
+		std::vector<float> floats(halves.size());
+		std::vector<uint16_t> actual(halves.size());
+		cg::half_to_float(halves.data(), floats.data(), halves.size());
+		cg::float_to_half(floats.data(), actual.data(), floats.size());
+		Assert::IsTrue(halves == actual);
+
+		for (size_t i = 0; i < halves.size(); ++i)
+			Assert::AreEqual(cg::half_to_float(halves[i]), floats[i]);
+	}
+};
+
+} // namespace unittest
@@ -0,0 +1,121 @@
+#include "cg/base/thread_pool.h"
+
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <vector>
+#include "CppUnitTest.h"
+
+using cg::task_priority;
+using cg::thread_pool;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace unittest {
+
+TEST_CLASS(cg_base_thread_pool_thread_pool) {
+public:
+
+	TEST_METHOD(ctors)
+	{
+		thread_pool p0;
+		Assert::AreEqual(cg::hardware_thread_count(), p0.thread_count());
+
+		thread_pool p1(3);
+		Assert::AreEqual<size_t>(3, p1.thread_count());
+	}
+
+	TEST_METHOD(enqueue)
+	{
+		thread_pool pool(4);
+
+		std::vector<std::future<int>> futures;
+		for (int i = 0; i < 64; ++i)
+			futures.push_back(pool.enqueue(task_priority::normal, [i] { return i * i; }));
+
+		for (int i = 0; i < 64; ++i)
+			Assert::AreEqual(i * i, futures[i].get());
+
+		auto f = pool.enqueue(task_priority::high, []() -> int { throw std::runtime_error("error"); });
+		Assert::ExpectException<std::runtime_error>([&f] { f.get(); });
+	}
+
+	TEST_METHOD(priorities)
+	{
+		std::vector<int> order;
+		std::promise<void> gate;
+		std::shared_future<void> gate_future = gate.get_future().share();
+
+		{
+			thread_pool pool(1);
+			// blocks the only worker until all the tasks are enqueued.
+			pool.run(task_priority::normal, [gate_future] { gate_future.wait(); });
+			pool.run(task_priority::low, [&order] { order.push_back(0); });
+			pool.run(task_priority::normal, [&order] { order.push_back(1); });
+			pool.run(task_priority::high, [&order] { order.push_back(2); });
+			pool.run(task_priority::normal, [&order] { order.push_back(3); });
+			gate.set_value();
+		} // the destructor waits for all the tasks
+
+		const std::vector<int> expected_order = { 2, 1, 3, 0 };
+		Assert::IsTrue(expected_order == order);
+	}
+
+	TEST_METHOD(dtor_completes_tasks)
+	{
+		std::atomic<int> counter = 0;
+
+		{
+			thread_pool pool(2);
+			for (int i = 0; i < 100; ++i)
+				pool.run(task_priority::low, [&counter] { ++counter; });
+		}
+
+		Assert::AreEqual(100, counter.load());
+	}
+};
+
+TEST_CLASS(cg_base_thread_pool_Funcs) {
+public:
+
+	TEST_METHOD(parallel_for)
+	{
+		using cg::parallel_for;
+
+		thread_pool pool(3);
+
+		// each element is visited exactly once.
+		std::vector<std::atomic<int>> visits(1001);
+		for (auto& v : visits) v = 0;
+		parallel_for(pool, visits.size(), 16, [&visits](size_t first, size_t last) {
+			Assert::IsTrue(first < last && last - first <= 16);
+			for (size_t i = first; i < last; ++i) ++visits[i];
+		});
+
+		for (const auto& v : visits)
+			Assert::AreEqual(1, v.load());
+
+		// empty range & zero grain size.
+		std::atomic<int> call_count = 0;
+		parallel_for(pool, 0, 4, [&call_count](size_t, size_t) { ++call_count; });
+		Assert::AreEqual(0, call_count.load());
+		parallel_for(pool, 3, 0, [&call_count](size_t, size_t) { ++call_count; });
+		Assert::AreEqual(3, call_count.load());
+
+		// nested calls do not deadlock.
+		std::atomic<int> counter = 0;
+		parallel_for(pool, 8, 1, [&pool, &counter](size_t, size_t) {
+			parallel_for(pool, 8, 1, [&counter](size_t, size_t) { ++counter; });
+		});
+		Assert::AreEqual(64, counter.load());
+
+		// exceptions are rethrown.
+		Assert::ExpectException<std::runtime_error>([&pool] {
+			parallel_for(pool, 100, 1, [](size_t first, size_t) {
+				if (first == 50) throw std::runtime_error("error");
+			});
+		});
+	}
+};
+
+} // namespace unittest
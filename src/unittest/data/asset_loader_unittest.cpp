@@ -0,0 +1,86 @@
+#include "cg/data/asset_loader.h"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "unittest/data/common_file.h"
+
+using cg::data::asset_loader;
+using cg::task_priority;
+
+
+namespace unittest {
+
+TEST_CLASS(cg_data_asset_loader_asset_loader) {
+public:
+
+	TEST_METHOD(load_futures)
+	{
+		asset_loader loader(2);
+
+		auto text_f = loader.load_text(Filenames::ascii_multiline);
+		auto prog_f = loader.load_glsl_program_desc("test-program", Filenames::not_real_glsl_program_name,
+			task_priority::high);
+		auto unknown_f = loader.load_text("unknown-file");
+
+		Assert::AreEqual(std::string("123\nabc\n\nlast_line"), text_f.get());
+
+		auto prog_desc = prog_f.get();
+		Assert::AreEqual(std::string("test-program"), prog_desc.name);
+		Assert::IsTrue(prog_desc.has_vertex_shader());
+		Assert::IsTrue(prog_desc.has_fragment_shader());
+
+		Assert::ExpectException<std::runtime_error>([&unknown_f] { unknown_f.get(); });
+	}
+
+	TEST_METHOD(load_image_cached)
+	{
+		cg::data::image_cache cache;
+		asset_loader loader(2);
+
+		auto image_0_f = loader.load_image(cache, Filenames::png_rgba_3x2, 4);
+		auto image_1_f = loader.load_image(cache, Filenames::png_rgba_3x2, 4, false, task_priority::high);
+
+		const auto image = image_0_f.get();
+		Assert::IsTrue(image->size == uint2(3, 2));
+		Assert::IsTrue(image == image_1_f.get());
+		Assert::AreEqual<size_t>(1, cache.resident_image_count());
+	}
+
+	TEST_METHOD(load_callbacks)
+	{
+		asset_loader loader(2);
+		Assert::AreEqual<size_t>(0, loader.dispatch_callbacks());
+
+		std::string text0;
+		std::string text1;
+		loader.load_text(Filenames::ascii_single_line, task_priority::normal,
+			[&text0](std::string&& t) { text0 = std::move(t); });
+		loader.load_text(Filenames::ascii_multiline, task_priority::normal,
+			[&text1](std::string&& t) { text1 = std::move(t); });
+
+		// callbacks are not invoked until they are dispatched.
+		Assert::IsTrue(text0.empty());
+		Assert::IsTrue(text1.empty());
+		Assert::AreEqual<size_t>(2, loader.pending_callback_count());
+
+		loader.dispatch_callbacks_wait_all();
+		Assert::AreEqual<size_t>(0, loader.pending_callback_count());
+		Assert::AreEqual(std::string("abc123"), text0);
+		Assert::AreEqual(std::string("123\nabc\n\nlast_line"), text1);
+	}
+
+	TEST_METHOD(load_callbacks_failure)
+	{
+		asset_loader loader(1);
+
+		bool invoked = false;
+		loader.load_text("unknown-file", task_priority::normal, [&invoked](std::string&&) { invoked = true; });
+
+		Assert::ExpectException<std::runtime_error>([&loader] { loader.dispatch_callbacks_wait_all(); });
+		Assert::IsFalse(invoked);
+		Assert::AreEqual<size_t>(0, loader.pending_callback_count());
+	}
+};
+
+} // namespace unittest
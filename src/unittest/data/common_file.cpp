@@ -4,7 +4,11 @@ namespace unittest {
 
 const std::string Filenames::ascii_multiline("../../data/unittest/ascii_multiline");
 const std::string Filenames::ascii_single_line("../../data/unittest/ascii_single_line");
+const std::string Filenames::dds_bc1_mips_8x4("../../data/unittest/dds_bc1_mips_8x4.dds");
+const std::string Filenames::dds_rgba8_srgb_cube_4x4("../../data/unittest/dds_rgba8_srgb_cube_4x4.dds");
 const std::string Filenames::empty_file("../../data/unittest/empty_file");
+const std::string Filenames::ktx2_bc5_cube_8x8("../../data/unittest/ktx2_bc5_cube_8x8.ktx2");
+const std::string Filenames::ktx2_rgb8_mips_3x2("../../data/unittest/ktx2_rgb8_mips_3x2.ktx2");
 const std::string Filenames::not_real_glsl_program_name("../../data/unittest/not_real");
 const std::string Filenames::not_real_glsl_single_vertex_program_name("../../data/unittest/not_real_single_vertex_shader");
 const std::string Filenames::not_real_code_hlsl("../../data/unittest/not_real_code.hlsl");
@@ -12,6 +16,13 @@ const std::string Filenames::not_real_compute_glsl("../../data/unittest/not_real
 const std::string Filenames::not_real_vertex_glsl("../../data/unittest/not_real.vertex.glsl");
 const std::string Filenames::not_real_single_vertex_glsl("../../data/unittest/not_real_single_vertex_shader.vertex.glsl");
 const std::string Filenames::not_real_fragment_glsl("../../data/unittest/not_real.fragment.glsl");
+const std::string Filenames::png_gray_alpha_16bit_5x4("../../data/unittest/png_gray_alpha_16bit_5x4.png");
+const std::string Filenames::png_gray_trns_2bit_9x3("../../data/unittest/png_gray_trns_2bit_9x3.png");
+const std::string Filenames::png_palette_trns_4bit_7x3("../../data/unittest/png_palette_trns_4bit_7x3.png");
+const std::string Filenames::png_rgb_filters_33x10("../../data/unittest/png_rgb_filters_33x10.png");
+const std::string Filenames::png_rgb_trailing_data_4x3("../../data/unittest/png_rgb_trailing_data_4x3.png");
+const std::string Filenames::png_rgba_3x2("../../data/unittest/png_rgba_3x2.png");
+const std::string Filenames::png_rgba_filters_17x10("../../data/unittest/png_rgba_filters_17x10.png");
 const std::string Filenames::tga_gayscale_r_compressed_rect_3x2("../../data/unittest/tga_gayscale_r_compressed_rect_3x2.tga");
 const std::string Filenames::tga_grayscale_r_square_2x2("../../data/unittest/tga_grayscale_r_square_2x2.tga");
 const std::string Filenames::tga_true_color_rgb_compressed_rect_3x2("../../data/unittest/tga_true_color_rgb_compressed_rect_3x2.tga");
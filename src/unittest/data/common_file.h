@@ -15,7 +15,11 @@ public:
 	static const std::string ascii_multiline;
 	// abc123
 	static const std::string ascii_single_line;
+	static const std::string dds_bc1_mips_8x4;
+	static const std::string dds_rgba8_srgb_cube_4x4;
 	static const std::string empty_file;
+	static const std::string ktx2_bc5_cube_8x8;
+	static const std::string ktx2_rgb8_mips_3x2;
 	static const std::string not_real_glsl_program_name;
 	static const std::string not_real_glsl_single_vertex_program_name;
 	static const std::string not_real_code_hlsl;
@@ -23,6 +27,16 @@ public:
 	static const std::string not_real_vertex_glsl;
 	static const std::string not_real_single_vertex_glsl;
 	static const std::string not_real_fragment_glsl;
+	static const std::string png_gray_alpha_16bit_5x4;
+	static const std::string png_gray_trns_2bit_9x3;
+	static const std::string png_palette_trns_4bit_7x3;
+	static const std::string png_rgb_filters_33x10;
+	// 4x3 rgb, the image data is followed by 2 more scanlines.
+	static const std::string png_rgb_trailing_data_4x3;
+	// 3x2 rgba: (255, 0, 0, 255), (0, 255, 0, 255), (0, 0, 255, 255)
+	//           (10, 20, 30, 40), (50, 60, 70, 80), (90, 100, 110, 120)
+	static const std::string png_rgba_3x2;
+	static const std::string png_rgba_filters_17x10;
 	static const std::string tga_gayscale_r_compressed_rect_3x2;
 	static const std::string tga_grayscale_r_square_2x2;
 	static const std::string tga_true_color_rgb_compressed_rect_3x2;
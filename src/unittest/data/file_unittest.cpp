@@ -9,8 +9,10 @@
 #include "unittest/data/common_file.h"
 
 using cg::data::By_line_iterator;
+using cg::data::By_line_view_iterator;
 using cg::data::File;
 using cg::data::File_seek_origin;
+using cg::data::Mapped_file;
 
 
 namespace unittest {
@@ -142,6 +144,88 @@ TEST_CLASS(cg_data_file_File) {
 	}
 };
 
+TEST_CLASS(cg_data_file_Mapped_file) {
+public:
+
+	TEST_METHOD(ctors)
+	{
+		Mapped_file fe;
+		Assert::IsTrue(fe.filename().empty());
+		Assert::IsFalse(fe.is_open());
+		Assert::IsNull(fe.data());
+		Assert::AreEqual<size_t>(0, fe.byte_count());
+
+		Assert::ExpectException<std::runtime_error>([] { Mapped_file f("unknown-file"); });
+
+		// empty file is opened but nothing is mapped.
+		Mapped_file f0(Filenames::empty_file);
+		Assert::AreEqual(Filenames::empty_file, f0.filename());
+		Assert::IsTrue(f0.is_open());
+		Assert::IsNull(f0.data());
+		Assert::IsTrue(f0.text().empty());
+
+		Mapped_file f1(Filenames::ascii_single_line);
+		Assert::AreEqual(Filenames::ascii_single_line, f1.filename());
+		Assert::IsTrue(f1.is_open());
+		Assert::IsNotNull(f1.data());
+		Assert::AreEqual<size_t>(6, f1.byte_count());
+
+		Mapped_file fm = std::move(f1);
+		Assert::AreEqual(Filenames::ascii_single_line, fm.filename());
+		Assert::IsTrue(fm.is_open());
+		Assert::AreEqual<size_t>(6, fm.byte_count());
+		// f1 is empty
+		Assert::IsTrue(f1.filename().empty());
+		Assert::IsFalse(f1.is_open());
+		Assert::IsNull(f1.data());
+		Assert::AreEqual<size_t>(0, f1.byte_count());
+	}
+
+	TEST_METHOD(move_assignment)
+	{
+		Mapped_file f0(Filenames::ascii_single_line);
+		Mapped_file f1(Filenames::ascii_multiline);
+
+		f1 = std::move(f0);
+		Assert::AreEqual(Filenames::ascii_single_line, f1.filename());
+		Assert::IsTrue(f1.is_open());
+		Assert::AreEqual<size_t>(6, f1.byte_count());
+		// f0 is empty
+		Assert::IsTrue(f0.filename().empty());
+		Assert::IsFalse(f0.is_open());
+		Assert::IsNull(f0.data());
+	}
+
+	TEST_METHOD(open_close)
+	{
+		Mapped_file f;
+		f.close(); // does not throw
+
+		Assert::ExpectException<std::runtime_error>([&] { f.open("unknown-file"); });
+		Assert::IsTrue(f.filename().empty());
+		Assert::IsFalse(f.is_open());
+
+		f.open(Filenames::ascii_single_line);
+		Assert::AreEqual(Filenames::ascii_single_line, f.filename());
+		Assert::IsTrue(f.is_open());
+
+		f.close();
+		Assert::IsTrue(f.filename().empty());
+		Assert::IsFalse(f.is_open());
+		Assert::IsNull(f.data());
+		Assert::AreEqual<size_t>(0, f.byte_count());
+	}
+
+	TEST_METHOD(text_and_bytes)
+	{
+		Mapped_file f(Filenames::ascii_multiline);
+		Assert::IsTrue(f.text() == "123\nabc\n\nlast_line");
+		Assert::AreEqual(f.byte_count(), f.bytes().size());
+		Assert::AreEqual<unsigned char>('1', f.bytes()[0]);
+		Assert::AreEqual<unsigned char>('e', f.bytes().back());
+	}
+};
+
 TEST_CLASS(cg_data_file_By_line_iterator) {
 public:
 
@@ -243,6 +327,56 @@ public:
 	}
 };
 
+TEST_CLASS(cg_data_file_By_line_view_iterator) {
+public:
+
+	TEST_METHOD(ctors_and_end_iterator)
+	{
+		By_line_view_iterator it0;
+		Assert::IsTrue(it0 == By_line_view_iterator::end);
+
+		// empty text has one empty line
+		By_line_view_iterator it1("");
+		Assert::IsTrue(it1 != By_line_view_iterator::end);
+		Assert::IsTrue(it1->empty());
+		++it1;
+		Assert::IsTrue(it1 == By_line_view_iterator::end);
+
+		By_line_view_iterator it2("abc123");
+		Assert::IsTrue(*it2 == "abc123");
+		++it2;
+		Assert::IsTrue(it2 == By_line_view_iterator::end);
+	}
+
+	TEST_METHOD(iterate)
+	{
+		{ // \n and \r\n line terminators
+			const std::string_view expected_lines[] = { "123", "abc", "", "last_line" };
+			By_line_view_iterator it("123\r\nabc\n\r\nlast_line");
+			for (size_t i = 0; it != By_line_view_iterator::end; ++it, ++i)
+				Assert::IsTrue(expected_lines[i] == *it);
+		}
+
+		{ // lines longer than a simd register
+			const std::string line0(37, 'a');
+			const std::string line1(16, 'b');
+			const std::string text = line0 + "\n" + line1 + "\n";
+			By_line_view_iterator it(text);
+			Assert::IsTrue(*it++ == line0);
+			Assert::IsTrue(*it++ == line1);
+			Assert::IsTrue(it->empty());
+			++it;
+			Assert::IsTrue(it == By_line_view_iterator::end);
+		}
+
+		{ // lines point into the text
+			cg::data::Mapped_file f(Filenames::ascii_multiline);
+			By_line_view_iterator it(f.text());
+			Assert::IsTrue(it->data() == f.text().data());
+		}
+	}
+};
+
 TEST_CLASS(cg_data_file_Funcs) {
 public:
 
@@ -276,6 +410,26 @@ public:
 			Assert::AreEqual("123\nabc\n\nlast_line", text.c_str());
 		}
 	}
+
+	TEST_METHOD(load_text_view)
+	{
+		using cg::data::load_text_view;
+
+		{ // empty file
+			Mapped_file f = load_text_view(Filenames::empty_file);
+			Assert::IsTrue(f.text().empty());
+		}
+
+		{ // single line file
+			Mapped_file f = load_text_view(Filenames::ascii_single_line);
+			Assert::IsTrue(f.text() == "abc123");
+		}
+
+		{ // multiline file
+			Mapped_file f = load_text_view(Filenames::ascii_multiline);
+			Assert::IsTrue(f.text() == "123\nabc\n\nlast_line");
+		}
+	}
 };
 
 } // namespace unittest
@@ -0,0 +1,241 @@
+#include "cg/data/ibl.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "cg/base/math.h"
+#include "cg/data/file.h"
+#include "cg/data/image_convert.h"
+#include "unittest/data/common_file.h"
+
+using cg::data::cached_image;
+using cg::data::cube_face;
+using cg::data::cube_face_count;
+using cg::data::ggx_prefilter_desc;
+using cg::data::image_cube;
+using cg::data::pixel_format;
+
+
+namespace {
+
+// Fills every face of the rgba_32f cube with the specified value.
+image_cube make_cube(uint32_t side_size, const float (&face_values)[cube_face_count])
+{
+	image_cube cube(side_size, pixel_format::rgba_32f);
+	for (size_t f = 0; f < cube_face_count; ++f) {
+		float* p = reinterpret_cast<float*>(cube.face_data(cube_face(f)));
+		for (size_t i = 0; i < side_size * side_size; ++i) {
+			p[i * 4 + 0] = p[i * 4 + 1] = p[i * 4 + 2] = face_values[f];
+			p[i * 4 + 3] = 1.0f;
+		}
+	}
+
+	return cube;
+}
+
+// Returns the red channel of the center texel of the face.
+float center(const image_cube& cube, cube_face face)
+{
+	const uint32_t s = cube.side_size();
+	return reinterpret_cast<const float*>(cube.face(face).data)[((s / 2) * s + s / 2) * 4];
+}
+
+#pragma warning(push)
+#pragma warning(disable:4996)
+void copy_file(const std::string& src, const std::string& dst)
+{
+	const std::string content = cg::data::load_text(src);
+
+	FILE* handle = std::fopen(dst.c_str(), "wb");
+	std::fwrite(content.data(), 1, content.size(), handle);
+	std::fclose(handle);
+}
+#pragma warning(pop)
+
+} // namespace
+
+
+namespace unittest {
+
+TEST_CLASS(cg_data_ibl_Funcs) {
+public:
+
+	TEST_METHOD(brdf_lut)
+	{
+		cg::thread_pool pool(3);
+		const uint2 size(16, 64);
+		const cg::data::image_2d lut = cg::data::brdf_lut(size, 256, pixel_format::rg_32f, pool);
+		Assert::IsTrue(lut.pixel_format == pixel_format::rg_32f);
+		Assert::IsTrue(lut.size == size);
+
+		const float2* p = reinterpret_cast<const float2*>(lut.data);
+		for (uint32_t y = 0; y < size.y; ++y) {
+			for (uint32_t x = 0; x < size.x; ++x) {
+				const float2 v = p[y * size.x + x];
+				Assert::IsTrue(v.x >= 0.0f && v.y >= 0.0f);
+				Assert::IsTrue(v.x + v.y <= 1.0f + 1e-2f);
+			}
+		}
+
+		// the smoothest row is nearly a mirror: scale == 1 - Fc, bias == Fc, Fc == (1 - cos_v)^5.
+		// The most grazing columns are masked by the microfacets anyway.
+		for (uint32_t x = 2; x < size.x; ++x) {
+			const float fc = std::pow(1.0f - (x + 0.5f) / size.x, 5.0f);
+			Assert::AreEqual(1.0f - fc, p[x].x, 0.05f);
+			Assert::AreEqual(fc, p[x].y, 0.05f);
+		}
+
+		// rough surfaces reflect less energy at grazing angles.
+		const float2 smooth = p[0];
+		const float2 rough = p[(size.y - 1) * size.x];
+		Assert::IsTrue(rough.x + rough.y < smooth.x + smooth.y);
+
+		// half floats hold the same table.
+		const cg::data::image_2d lut_h = cg::data::brdf_lut(size, 256, pixel_format::rg_16f, pool);
+		const cg::data::image_2d lut_f = cg::data::convert(lut_h, pixel_format::rg_32f);
+		const float2* ph = reinterpret_cast<const float2*>(lut_f.data);
+		for (size_t i = 0; i < size.x * size.y; ++i) {
+			Assert::AreEqual(p[i].x, ph[i].x, 1e-3f);
+			Assert::AreEqual(p[i].y, ph[i].y, 1e-3f);
+		}
+	}
+
+	TEST_METHOD(load_brdf_lut_cached)
+	{
+		cg::thread_pool pool(2);
+		const std::string filename = "ibl_unittest_brdf_lut.cgimg";
+		const uint2 size(8, 4);
+
+		{
+			const cached_image expected = cg::data::load_brdf_lut_cached(filename, size, 64,
+				pixel_format::rg_16f, pool);
+			Assert::IsFalse(expected.is_mapped());
+			Assert::IsTrue(cg::data::exists(filename));
+
+			// the second load maps the table.
+			const cached_image actual = cg::data::load_brdf_lut_cached(filename, size, 64,
+				pixel_format::rg_16f, pool);
+			Assert::IsTrue(actual.is_mapped());
+			Assert::IsTrue(actual.view().size == size);
+			Assert::AreEqual(0, std::memcmp(expected.view().data, actual.view().data, byte_count(expected.view())));
+		}
+
+		// other params overwrite the cache.
+		const cached_image other = cg::data::load_brdf_lut_cached(filename, uint2(4, 4), 64,
+			pixel_format::rg_32f, pool);
+		Assert::IsFalse(other.is_mapped());
+		Assert::IsTrue(other.view().pixel_format == pixel_format::rg_32f);
+		Assert::IsTrue(other.view().size == uint2(4, 4));
+		Assert::IsTrue(cg::data::map_cgimg(filename).view().size == uint2(4, 4));
+
+		std::remove(filename.c_str());
+	}
+
+	TEST_METHOD(prefilter_ggx_constant)
+	{
+		cg::thread_pool pool(2);
+		const float values[cube_face_count] = { 2, 2, 2, 2, 2, 2 };
+		const image_cube envmap = make_cube(8, values);
+
+		ggx_prefilter_desc desc;
+		desc.side_size = 8;
+		desc.mip_level_count = 4;
+		desc.sample_count = 64;
+		const std::vector<image_cube> levels = cg::data::prefilter_ggx(envmap, desc, pool);
+
+		Assert::AreEqual<size_t>(4, levels.size());
+		for (uint32_t i = 0; i < 4; ++i) {
+			Assert::AreEqual<uint32_t>(8 >> i, levels[i].side_size());
+			Assert::IsTrue(levels[i].format() == pixel_format::rgba_32f);
+
+			const float* p = reinterpret_cast<const float*>(levels[i].faces().data);
+			for (size_t j = 0; j < square(levels[i].side_size()) * cube_face_count * 4; ++j)
+				Assert::AreEqual((j % 4 == 3) ? 1.0f : 2.0f, p[j], 1e-5f);
+		}
+	}
+
+	TEST_METHOD(prefilter_ggx_roughness)
+	{
+		cg::thread_pool pool(3);
+		// only the +Y face is lit.
+		const float values[cube_face_count] = { 0, 0, 1, 0, 0, 0 };
+		const image_cube envmap = make_cube(16, values);
+
+		ggx_prefilter_desc desc;
+		desc.side_size = 16;
+		desc.mip_level_count = 3;
+		desc.sample_count = 256;
+		const std::vector<image_cube> levels = cg::data::prefilter_ggx(envmap, desc, pool);
+
+		// the mirror level reproduces the envmap.
+		Assert::AreEqual(0, std::memcmp(envmap.faces().data, levels[0].faces().data, byte_count(envmap.faces())));
+
+		// rougher levels spread the light of +Y over the neighbour faces.
+		Assert::IsTrue(center(levels[1], cube_face::positive_y) < 1.0f);
+		Assert::IsTrue(center(levels[2], cube_face::positive_y) < center(levels[1], cube_face::positive_y));
+		Assert::IsTrue(center(levels[2], cube_face::positive_x) > 0.0f);
+		Assert::AreEqual(center(levels[2], cube_face::positive_x), center(levels[2], cube_face::negative_z), 0.02f);
+		Assert::AreEqual(0.0f, center(levels[2], cube_face::negative_y));
+	}
+
+	TEST_METHOD(load_prefiltered_cached)
+	{
+		cg::thread_pool pool(2);
+		const std::string filename = "ibl_unittest.png";
+		copy_file(Filenames::png_rgba_3x2, filename);
+
+		ggx_prefilter_desc desc;
+		desc.side_size = 4;
+		desc.mip_level_count = 2;
+		desc.sample_count = 16;
+		const std::string level_filenames[2] = { filename + ".ggx4_0.cgimg", filename + ".ggx4_1.cgimg" };
+
+		const std::vector<image_cube> expected = cg::data::load_prefiltered_cached(filename, 8, desc,
+			pixel_format::rgba_16f, pool);
+		Assert::AreEqual<size_t>(2, expected.size());
+		Assert::IsTrue(cg::data::exists(level_filenames[0]));
+		Assert::IsTrue(cg::data::exists(level_filenames[1]));
+		Assert::IsTrue(cg::data::exists(filename + ".cube8.cgimg"));
+
+		// the second load maps the cached levels.
+		std::remove((filename + ".cube8.cgimg").c_str());
+		{
+			const std::vector<image_cube> actual = cg::data::load_prefiltered_cached(filename, 8, desc,
+				pixel_format::rgba_16f, pool);
+			Assert::IsFalse(cg::data::exists(filename + ".cube8.cgimg"));
+			for (size_t i = 0; i < 2; ++i) {
+				Assert::IsTrue(actual[i].is_mapped());
+				Assert::IsTrue(actual[i].format() == pixel_format::rgba_16f);
+				Assert::AreEqual(expected[i].side_size(), actual[i].side_size());
+				Assert::AreEqual(0, std::memcmp(expected[i].faces().data, actual[i].faces().data,
+					byte_count(expected[i].faces())));
+			}
+		}
+
+		// a missing level is the only one which is prefiltered.
+		std::remove(level_filenames[1].c_str());
+		{
+			const std::vector<image_cube> actual = cg::data::load_prefiltered_cached(filename, 8, desc,
+				pixel_format::rgba_16f, pool);
+			Assert::IsTrue(actual[0].is_mapped());
+			Assert::IsFalse(actual[1].is_mapped());
+			Assert::AreEqual(0, std::memcmp(expected[1].faces().data, actual[1].faces().data,
+				byte_count(expected[1].faces())));
+			Assert::IsTrue(cg::data::exists(level_filenames[1]));
+		}
+
+		// other params have their own cache.
+		desc.sample_count = 32;
+		cg::data::load_prefiltered_cached(filename, 8, desc, pixel_format::rgba_16f, pool);
+		Assert::IsTrue(cg::data::exists(filename + ".cube8.cgimg"));
+
+		std::remove(level_filenames[0].c_str());
+		std::remove(level_filenames[1].c_str());
+		std::remove((filename + ".cube8.cgimg").c_str());
+		std::remove(filename.c_str());
+	}
+};
+
+} // namespace unittest
@@ -0,0 +1,208 @@
+#include "cg/data/image_bc.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "cg/base/math.h"
+#include "cg/base/thread_pool.h"
+#include "CppUnitTest.h"
+
+using cg::data::encode_bc;
+using cg::data::image_mip_chain;
+using cg::data::image_view;
+using cg::data::pixel_format;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace {
+
+// Decodes rgb of a bc1 block into 16 rgba_8 pixels (alpha is not touched).
+void decode_bc1_block(const uint8_t* src, uint8_t* pixels)
+{
+	uint16_t c[2];
+	std::memcpy(c, src, 4);
+
+	int palette[4][3];
+	for (int i = 0; i < 2; ++i) {
+		const int r = (c[i] >> 11) & 31;
+		const int g = (c[i] >> 5) & 63;
+		const int b = c[i] & 31;
+		palette[i][0] = (r << 3) | (r >> 2);
+		palette[i][1] = (g << 2) | (g >> 4);
+		palette[i][2] = (b << 3) | (b >> 2);
+	}
+
+	for (int ch = 0; ch < 3; ++ch) {
+		palette[2][ch] = (2 * palette[0][ch] + palette[1][ch]) / 3;
+		palette[3][ch] = (palette[0][ch] + 2 * palette[1][ch]) / 3;
+	}
+
+	uint32_t indices;
+	std::memcpy(&indices, src + 4, 4);
+	for (int i = 0; i < 16; ++i) {
+		const int idx = (indices >> (2 * i)) & 3;
+		for (int ch = 0; ch < 3; ++ch)
+			pixels[i * 4 + ch] = uint8_t(palette[idx][ch]);
+	}
+}
+
+// Decodes a bc4 block into the c-th channel of 16 rgba_8 pixels.
+void decode_bc4_block(const uint8_t* src, size_t c, uint8_t* pixels)
+{
+	int palette[8] = { src[0], src[1] };
+	for (int i = 2; i < 8; ++i) {
+		palette[i] = (src[0] > src[1])
+			? ((8 - i) * src[0] + (i - 1) * src[1]) / 7
+			: ((i < 6) ? ((6 - i) * src[0] + (i - 1) * src[1]) / 5 : ((i == 6) ? 0 : 255));
+	}
+
+	uint64_t indices = 0;
+	for (int i = 0; i < 6; ++i)
+		indices |= uint64_t(src[2 + i]) << (8 * i);
+
+	for (int i = 0; i < 16; ++i)
+		pixels[i * 4 + c] = uint8_t(palette[(indices >> (3 * i)) & 7]);
+}
+
+// Returns the max abs difference of the first channel_count channels of 16 rgba_8 pixels.
+int max_error(const uint8_t* expected, const uint8_t* actual, size_t channel_count)
+{
+	int err = 0;
+	for (size_t i = 0; i < 16; ++i) {
+		for (size_t c = 0; c < channel_count; ++c)
+			err = std::max(err, std::abs(int(expected[i * 4 + c]) - int(actual[i * 4 + c])));
+	}
+
+	return err;
+}
+
+} // namespace
+
+
+namespace unittest {
+
+TEST_CLASS(cg_data_image_bc_Funcs) {
+public:
+
+	TEST_METHOD(encode_bc1)
+	{
+		cg::thread_pool pool(2);
+
+		// solid color.
+		std::vector<uint8_t> solid(16 * 3);
+		for (size_t i = 0; i < 16; ++i) {
+			solid[i * 3 + 0] = 255;
+			solid[i * 3 + 1] = 0;
+			solid[i * 3 + 2] = 0;
+		}
+
+		uint8_t block[8];
+		encode_bc(image_view(solid.data(), uint2(4, 4), pixel_format::rgb_8), pixel_format::bc1, block, pool);
+		uint16_t c0;
+		uint16_t c1;
+		uint32_t indices;
+		std::memcpy(&c0, block, 2);
+		std::memcpy(&c1, block + 2, 2);
+		std::memcpy(&indices, block + 4, 4);
+		Assert::AreEqual<int>(0xf800, c0);
+		Assert::AreEqual<int>(0xf800, c1);
+		Assert::AreEqual<uint32_t>(0, indices);
+
+		// gradient
+		uint8_t pixels[64];
+		for (size_t i = 0; i < 16; ++i) {
+			pixels[i * 4 + 0] = uint8_t(i * 16);
+			pixels[i * 4 + 1] = uint8_t(255 - i * 16);
+			pixels[i * 4 + 2] = uint8_t(64 + i * 8);
+			pixels[i * 4 + 3] = 255;
+		}
+
+		encode_bc(image_view(pixels, uint2(4, 4), pixel_format::rgba_8), pixel_format::bc1, block, pool);
+		uint8_t decoded[64] = {};
+		decode_bc1_block(block, decoded);
+		// 4 palette colors span the 240 wide ramp, red & green are anti-correlated.
+		Assert::IsTrue(max_error(pixels, decoded, 3) <= 40);
+	}
+
+	TEST_METHOD(encode_bc3)
+	{
+		cg::thread_pool pool(2);
+
+		uint8_t pixels[64];
+		for (size_t i = 0; i < 16; ++i) {
+			pixels[i * 4 + 0] = 100;
+			pixels[i * 4 + 1] = 150;
+			pixels[i * 4 + 2] = 200;
+			pixels[i * 4 + 3] = (i % 2 == 0) ? 0 : 255;
+		}
+
+		uint8_t block[16];
+		encode_bc(image_view(pixels, uint2(4, 4), pixel_format::rgba_8), pixel_format::bc3, block, pool);
+		uint8_t decoded[64] = {};
+		decode_bc4_block(block, 3, decoded);
+		decode_bc1_block(block + 8, decoded);
+		Assert::IsTrue(max_error(pixels, decoded, 4) <= 4);
+	}
+
+	TEST_METHOD(encode_bc4_bc5)
+	{
+		cg::thread_pool pool(2);
+
+		// values which are a part of the 8 value palette are encoded exactly.
+		uint8_t pixels[64] = {};
+		for (size_t i = 0; i < 16; ++i) {
+			pixels[i * 4 + 0] = uint8_t(35 + (i % 8) * 15);
+			pixels[i * 4 + 1] = uint8_t((i < 8) ? 0 : 255);
+		}
+
+		uint8_t block[16];
+		uint8_t decoded[64] = {};
+		encode_bc(image_view(pixels, uint2(4, 4), pixel_format::rgba_8), pixel_format::bc4, block, pool);
+		decode_bc4_block(block, 0, decoded);
+		Assert::AreEqual(0, max_error(pixels, decoded, 1));
+
+		encode_bc(image_view(pixels, uint2(4, 4), pixel_format::rgba_8), pixel_format::bc5, block, pool);
+		std::memset(decoded, 0, sizeof(decoded));
+		decode_bc4_block(block, 0, decoded);
+		decode_bc4_block(block + 8, 1, decoded);
+		Assert::AreEqual(0, max_error(pixels, decoded, 2));
+
+		// float sources are clamped.
+		const float f[12] = { -1.0f, 0.0f, 0.0f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 2.0f, 0.0f, 0.0f };
+		encode_bc(image_view(f, uint2(4, 1), pixel_format::rgb_32f), pixel_format::bc4, block, pool);
+		Assert::AreEqual<int>(255, block[0]);
+		Assert::AreEqual<int>(0, block[1]);
+	}
+
+	TEST_METHOD(encode_bc_image)
+	{
+		cg::thread_pool pool(3);
+
+		// partial blocks.
+		std::vector<uint8_t> pixels(13 * 7, 77);
+		const image_view image(pixels.data(), uint2(13, 7), pixel_format::red_8);
+		const image_mip_chain c0 = encode_bc(image, pixel_format::bc4, pool);
+		Assert::AreEqual<size_t>(1, c0.level_count());
+		Assert::IsTrue(c0.format() == pixel_format::bc4);
+		Assert::IsTrue(c0.level(0).size == uint2(13, 7));
+		Assert::AreEqual<size_t>(4 * 2 * 8, byte_count(c0.level(0)));
+
+		const uint8_t* blocks = reinterpret_cast<const uint8_t*>(c0.level(0).data);
+		for (size_t i = 0; i < 8; ++i) {
+			Assert::AreEqual<int>(77, blocks[i * 8]);
+			Assert::AreEqual<int>(77, blocks[i * 8 + 1]);
+		}
+
+		// mip chain
+		const image_mip_chain mips(image, cg::data::mip_filter::box, cg::data::mip_content::linear, pool);
+		const image_mip_chain c1 = encode_bc(mips, pixel_format::bc4, pool);
+		Assert::AreEqual(mips.level_count(), c1.level_count());
+		for (size_t i = 0; i < c1.level_count(); ++i) {
+			Assert::IsTrue(mips.level(i).size == c1.level(i).size);
+			Assert::AreEqual<int>(77, *reinterpret_cast<const uint8_t*>(c1.level(i).data));
+		}
+	}
+};
+
+} // namespace unittest
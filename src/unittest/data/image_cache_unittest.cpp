@@ -0,0 +1,100 @@
+#include "cg/data/image_cache.h"
+
+#include <future>
+#include <memory>
+#include <vector>
+#include "cg/base/thread_pool.h"
+#include "unittest/data/common_file.h"
+
+using cg::data::image_2d;
+using cg::data::image_cache;
+
+
+namespace unittest {
+
+TEST_CLASS(cg_data_image_cache_image_cache) {
+public:
+
+	TEST_METHOD(get)
+	{
+		image_cache cache;
+		Assert::AreEqual<size_t>(0, cache.resident_image_count());
+
+		const auto image = cache.get(Filenames::png_rgba_3x2, 4);
+		Assert::IsTrue(image->size == uint2(3, 2));
+		Assert::AreEqual<size_t>(1, cache.resident_image_count());
+		Assert::AreEqual<size_t>(24, cache.resident_byte_count());
+
+		// the same key shares the image, other params are other images.
+		Assert::IsTrue(image == cache.get(Filenames::png_rgba_3x2, 4));
+		const auto flipped = cache.get(Filenames::png_rgba_3x2, 4, true);
+		const auto rgb = cache.get(Filenames::png_rgba_3x2, 3);
+		Assert::IsTrue(image != flipped);
+		Assert::IsTrue(image != rgb);
+		Assert::AreEqual<size_t>(3, cache.resident_image_count());
+		Assert::AreEqual<size_t>(24 + 24 + 18, cache.resident_byte_count());
+
+		// the images are held by the users.
+		cache.clear();
+		Assert::AreEqual<size_t>(0, cache.resident_image_count());
+		Assert::AreEqual<size_t>(0, cache.resident_byte_count());
+		Assert::IsTrue(image == cache.get(Filenames::png_rgba_3x2, 4));
+		Assert::AreEqual<size_t>(1, cache.resident_image_count());
+	}
+
+	TEST_METHOD(get_budget)
+	{
+		// room for one rgba image.
+		image_cache cache(30);
+
+		std::weak_ptr<const image_2d> weak_rgba = cache.get(Filenames::png_rgba_3x2, 4);
+		const auto flipped = cache.get(Filenames::png_rgba_3x2, 4, true);
+		Assert::AreEqual<size_t>(1, cache.resident_image_count());
+		Assert::AreEqual<size_t>(24, cache.resident_byte_count());
+		// nobody holds the evicted image.
+		Assert::IsTrue(weak_rgba.expired());
+
+		// the evicted image which is held by a user comes back without decoding.
+		const auto rgb = cache.get(Filenames::png_rgba_3x2, 3);
+		Assert::AreEqual<size_t>(1, cache.resident_image_count());
+		Assert::IsTrue(flipped == cache.get(Filenames::png_rgba_3x2, 4, true));
+		Assert::AreEqual<size_t>(1, cache.resident_image_count());
+		Assert::AreEqual<size_t>(24, cache.resident_byte_count());
+
+		// the most recently used image stays resident even if it exceeds the budget.
+		image_cache small_cache(1);
+		small_cache.get(Filenames::png_rgba_3x2, 4);
+		Assert::AreEqual<size_t>(1, small_cache.resident_image_count());
+	}
+
+	TEST_METHOD(get_concurrently)
+	{
+		image_cache cache;
+		cg::thread_pool pool(4);
+
+		std::vector<std::future<std::shared_ptr<const image_2d>>> futures;
+		for (size_t i = 0; i < 16; ++i) {
+			futures.push_back(pool.enqueue(cg::task_priority::normal, [&cache] {
+				return cache.get(Filenames::png_rgba_3x2, 4);
+			}));
+		}
+
+		const auto image = futures[0].get();
+		for (size_t i = 1; i < futures.size(); ++i)
+			Assert::IsTrue(image == futures[i].get());
+
+		Assert::AreEqual<size_t>(1, cache.resident_image_count());
+	}
+
+	TEST_METHOD(get_invalid)
+	{
+		image_cache cache;
+
+		Assert::ExpectException<std::exception>([&] { cache.get("unknown_image.png"); });
+		// failures are not cached.
+		Assert::ExpectException<std::exception>([&] { cache.get("unknown_image.png"); });
+		Assert::AreEqual<size_t>(0, cache.resident_image_count());
+	}
+};
+
+} // namespace unittest
@@ -0,0 +1,174 @@
+#include "cg/data/image_convert.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "cg/base/math.h"
+#include "CppUnitTest.h"
+
+using cg::data::convert;
+using cg::data::image_2d;
+using cg::data::image_view;
+using cg::data::pixel_format;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace unittest {
+
+TEST_CLASS(cg_data_image_convert_Funcs) {
+public:
+
+	TEST_METHOD(convert_8bit)
+	{
+		// 37 pixels: vectorized part & tail.
+		const uint2 size(37, 2);
+		std::vector<uint8_t> rgb(square(size) * 3);
+		for (size_t i = 0; i < rgb.size(); ++i) rgb[i] = uint8_t(i * 7);
+
+		const image_2d rgba = convert(image_view(rgb.data(), size, pixel_format::rgb_8), pixel_format::rgba_8);
+		Assert::IsTrue(rgba.size == size);
+		Assert::IsTrue(rgba.pixel_format == pixel_format::rgba_8);
+
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(rgba.data);
+		for (size_t i = 0; i < square(size); ++i) {
+			Assert::AreEqual(rgb[i * 3 + 0], p[i * 4 + 0]);
+			Assert::AreEqual(rgb[i * 3 + 1], p[i * 4 + 1]);
+			Assert::AreEqual(rgb[i * 3 + 2], p[i * 4 + 2]);
+			Assert::AreEqual<uint8_t>(255, p[i * 4 + 3]);
+		}
+
+		const image_2d rgb_back = convert(rgba, pixel_format::rgb_8);
+		Assert::AreEqual(0, std::memcmp(rgb.data(), rgb_back.data, rgb.size()));
+
+		// red_8 is expanded into grayscale.
+		std::vector<uint8_t> red(square(size));
+		for (size_t i = 0; i < red.size(); ++i) red[i] = uint8_t(i);
+
+		const image_2d gray_rgba = convert(image_view(red.data(), size, pixel_format::red_8), pixel_format::rgba_8);
+		const image_2d gray_rgb = convert(image_view(red.data(), size, pixel_format::red_8), pixel_format::rgb_8);
+		const uint8_t* p4 = reinterpret_cast<const uint8_t*>(gray_rgba.data);
+		const uint8_t* p3 = reinterpret_cast<const uint8_t*>(gray_rgb.data);
+		for (size_t i = 0; i < red.size(); ++i) {
+			Assert::IsTrue(p4[i * 4] == red[i] && p4[i * 4 + 1] == red[i] && p4[i * 4 + 2] == red[i]);
+			Assert::AreEqual<uint8_t>(255, p4[i * 4 + 3]);
+			Assert::IsTrue(p3[i * 3] == red[i] && p3[i * 3 + 1] == red[i] && p3[i * 3 + 2] == red[i]);
+		}
+
+		// rg_8 -> rgba_8
+		const uint8_t rg[4] = { 1, 2, 3, 4 };
+		const image_2d rg_rgba = convert(image_view(rg, uint2(2, 1), pixel_format::rg_8), pixel_format::rgba_8);
+		const uint8_t expected[8] = { 1, 2, 0, 255, 3, 4, 0, 255 };
+		Assert::AreEqual(0, std::memcmp(expected, rg_rgba.data, sizeof(expected)));
+	}
+
+	TEST_METHOD(convert_float)
+	{
+		// values are clamped & rounded.
+		const size_t count = 5;
+		std::vector<float> f(count * 4);
+		for (size_t i = 0; i < count; ++i) {
+			f[i * 4 + 0] = -1.0f;
+			f[i * 4 + 1] = 0.5f;
+			f[i * 4 + 2] = 1.0f;
+			f[i * 4 + 3] = 3.0f;
+		}
+
+		const image_2d rgba = convert(image_view(f.data(), uint2(count, 1), pixel_format::rgba_32f), pixel_format::rgba_8);
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(rgba.data);
+		for (size_t i = 0; i < count; ++i) {
+			Assert::AreEqual<uint8_t>(0, p[i * 4 + 0]);
+			Assert::AreEqual<uint8_t>(128, p[i * 4 + 1]);
+			Assert::AreEqual<uint8_t>(255, p[i * 4 + 2]);
+			Assert::AreEqual<uint8_t>(255, p[i * 4 + 3]);
+		}
+
+		const image_2d red = convert(image_view(f.data(), uint2(count, 1), pixel_format::rgba_32f), pixel_format::red_8);
+		Assert::AreEqual<uint8_t>(0, *reinterpret_cast<const uint8_t*>(red.data));
+
+		// 8-bit -> float
+		std::vector<uint8_t> rgb(7 * 3);
+		for (size_t i = 0; i < rgb.size(); ++i) rgb[i] = uint8_t(i * 12);
+
+		const image_2d rgb_f = convert(image_view(rgb.data(), uint2(7, 1), pixel_format::rgb_8), pixel_format::rgb_32f);
+		const float* v = reinterpret_cast<const float*>(rgb_f.data);
+		for (size_t i = 0; i < rgb.size(); ++i)
+			Assert::AreEqual(rgb[i] / 255.0f, v[i], 1e-6f);
+
+		const image_2d rgb_back = convert(rgb_f, pixel_format::rgb_8);
+		Assert::AreEqual(0, std::memcmp(rgb.data(), rgb_back.data, rgb.size()));
+
+		// float -> float
+		const image_2d rgba_f = convert(rgb_f, pixel_format::rgba_32f);
+		const float* v4 = reinterpret_cast<const float*>(rgba_f.data);
+		Assert::AreEqual(v[3], v4[4]);
+		Assert::AreEqual(1.0f, v4[3]);
+	}
+
+	TEST_METHOD(convert_half_float)
+	{
+		// 7 pixels: vectorized part & tail.
+		const size_t count = 7;
+		std::vector<float> f(count * 3);
+		for (size_t i = 0; i < f.size(); ++i) f[i] = float(i) * 0.25f - 1.0f;
+
+		const image_2d rgb_h = convert(image_view(f.data(), uint2(count, 1), pixel_format::rgb_32f), pixel_format::rgb_16f);
+		Assert::IsTrue(rgb_h.pixel_format == pixel_format::rgb_16f);
+
+		// the values are exactly representable as halves.
+		const image_2d rgb_f = convert(rgb_h, pixel_format::rgb_32f);
+		Assert::AreEqual(0, std::memcmp(f.data(), rgb_f.data, f.size() * sizeof(float)));
+
+		// half -> float of a different channel count & half -> 8-bit go through the generic path.
+		const image_2d rgba_f = convert(rgb_h, pixel_format::rgba_32f);
+		const float* v4 = reinterpret_cast<const float*>(rgba_f.data);
+		Assert::AreEqual(f[3], v4[4]);
+		Assert::AreEqual(1.0f, v4[3]);
+
+		const image_2d rgb_8 = convert(rgb_h, pixel_format::rgb_8);
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(rgb_8.data);
+		Assert::AreEqual<uint8_t>(0, p[0]);
+		Assert::AreEqual<uint8_t>(64, p[5]);
+		Assert::AreEqual<uint8_t>(255, p[8]);
+
+		// two channel lookup tables.
+		const image_2d rg_h = convert(image_view(f.data(), uint2(count, 1), pixel_format::rg_32f), pixel_format::rg_16f);
+		Assert::IsTrue(rg_h.pixel_format == pixel_format::rg_16f);
+		const image_2d rg_f = convert(rg_h, pixel_format::rg_32f);
+		Assert::AreEqual(0, std::memcmp(f.data(), rg_f.data, count * 2 * sizeof(float)));
+	}
+
+	TEST_METHOD(convert_flip_vertically)
+	{
+		const uint8_t rgb[18] = {
+			1, 2, 3, 4, 5, 6,
+			7, 8, 9, 10, 11, 12,
+			13, 14, 15, 16, 17, 18
+		};
+		const image_view view(rgb, uint2(2, 3), pixel_format::rgb_8);
+
+		const image_2d rgba = convert(view, pixel_format::rgba_8, true);
+		const uint8_t expected[24] = {
+			13, 14, 15, 255, 16, 17, 18, 255,
+			7, 8, 9, 255, 10, 11, 12, 255,
+			1, 2, 3, 255, 4, 5, 6, 255
+		};
+		Assert::AreEqual(0, std::memcmp(expected, rgba.data, sizeof(expected)));
+
+		// the same format.
+		const image_2d flipped = convert(view, pixel_format::rgb_8, true);
+		const uint8_t expected_rgb[18] = {
+			13, 14, 15, 16, 17, 18,
+			7, 8, 9, 10, 11, 12,
+			1, 2, 3, 4, 5, 6
+		};
+		Assert::AreEqual(0, std::memcmp(expected_rgb, flipped.data, sizeof(expected_rgb)));
+
+		// in place.
+		uint8_t data[18];
+		std::memcpy(data, rgb, sizeof(rgb));
+		convert(image_view(data, uint2(2, 3), pixel_format::rgb_8), pixel_format::rgb_8, data, true);
+		Assert::AreEqual(0, std::memcmp(expected_rgb, data, sizeof(data)));
+	}
+};
+
+} // namespace unittest
@@ -0,0 +1,153 @@
+#include "cg/data/image_cube.h"
+
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include "cg/base/math.h"
+#include "CppUnitTest.h"
+
+using cg::data::cached_image;
+using cg::data::cube_direction;
+using cg::data::cube_face;
+using cg::data::cube_face_count;
+using cg::data::cube_face_uv;
+using cg::data::equirect_to_cube;
+using cg::data::image_2d;
+using cg::data::image_cube;
+using cg::data::image_view;
+using cg::data::pixel_format;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace unittest {
+
+TEST_CLASS(cg_data_image_cube) {
+public:
+
+	TEST_METHOD(ctors)
+	{
+		image_cube c0;
+		Assert::AreEqual<uint32_t>(0, c0.side_size());
+		Assert::IsTrue(c0.format() == pixel_format::none);
+
+		image_cube c1(4, pixel_format::rgb_8);
+		Assert::AreEqual<uint32_t>(4, c1.side_size());
+		Assert::IsTrue(c1.format() == pixel_format::rgb_8);
+		Assert::IsTrue(c1.faces().size == uint2(4, 24));
+
+		// faces follow each other
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(c1.faces().data);
+		for (size_t i = 0; i < cube_face_count; ++i) {
+			const image_view face = c1.face(cube_face(i));
+			Assert::IsTrue(face.size == uint2(4, 4));
+			Assert::IsTrue(face.data == p + i * 4 * 4 * 3);
+			Assert::IsTrue(face.data == c1.face_data(cube_face(i)));
+		}
+
+		// move ctor
+		const void* data = c1.faces().data;
+		image_cube c2 = std::move(c1);
+		Assert::AreEqual<uint32_t>(4, c2.side_size());
+		Assert::IsTrue(c2.faces().data == data);
+
+		// faces of a cached_image
+		cached_image faces(image_2d(uint2(2, 12), pixel_format::red_8));
+		data = faces.view().data;
+		image_cube c3(std::move(faces));
+		Assert::AreEqual<uint32_t>(2, c3.side_size());
+		Assert::IsTrue(c3.format() == pixel_format::red_8);
+		Assert::IsFalse(c3.is_mapped());
+		Assert::IsTrue(c3.faces().data == data);
+		Assert::IsTrue(c3.face(cube_face::negative_z).data == static_cast<const uint8_t*>(data) + 5 * 4);
+	}
+
+	TEST_METHOD(cube_direction_func)
+	{
+		Assert::IsTrue(cube_direction(cube_face::positive_x, 0.5f, 0.5f) == float3(1, 0, 0));
+		Assert::IsTrue(cube_direction(cube_face::negative_x, 0.5f, 0.5f) == float3(-1, 0, 0));
+		Assert::IsTrue(cube_direction(cube_face::positive_y, 0.5f, 0.5f) == float3(0, 1, 0));
+		Assert::IsTrue(cube_direction(cube_face::negative_y, 0.5f, 0.5f) == float3(0, -1, 0));
+		Assert::IsTrue(cube_direction(cube_face::positive_z, 0.5f, 0.5f) == float3(0, 0, 1));
+		Assert::IsTrue(cube_direction(cube_face::negative_z, 0.5f, 0.5f) == float3(0, 0, -1));
+
+		// top left corners
+		Assert::IsTrue(cube_direction(cube_face::positive_x, 0, 0) == float3(1, 1, 1));
+		Assert::IsTrue(cube_direction(cube_face::negative_x, 0, 0) == float3(-1, 1, -1));
+		Assert::IsTrue(cube_direction(cube_face::positive_y, 0, 0) == float3(-1, 1, -1));
+		Assert::IsTrue(cube_direction(cube_face::negative_y, 0, 0) == float3(-1, -1, 1));
+		Assert::IsTrue(cube_direction(cube_face::positive_z, 0, 0) == float3(-1, 1, 1));
+		Assert::IsTrue(cube_direction(cube_face::negative_z, 0, 0) == float3(1, 1, -1));
+	}
+
+	TEST_METHOD(cube_face_uv_func)
+	{
+		for (size_t f = 0; f < cube_face_count; ++f) {
+			for (const float2& uv : { float2(0.5f, 0.5f), float2(0.1f, 0.8f), float2(0.9f, 0.25f) }) {
+				const float3 d = cube_direction(cube_face(f), uv.x, uv.y);
+
+				float2 res;
+				Assert::IsTrue(cube_face(f) == cube_face_uv(d, res));
+				Assert::AreEqual(uv.x, res.x, 1e-6f);
+				Assert::AreEqual(uv.y, res.y, 1e-6f);
+
+				// scale does not matter
+				Assert::IsTrue(cube_face(f) == cube_face_uv(3.0f * d, res));
+				Assert::AreEqual(uv.x, res.x, 1e-6f);
+				Assert::AreEqual(uv.y, res.y, 1e-6f);
+			}
+		}
+	}
+
+	TEST_METHOD(equirect_to_cube_constant)
+	{
+		cg::thread_pool pool(2);
+		const uint2 size(16, 8);
+		const std::vector<uint8_t> pixels(square(size) * 3, 77);
+
+		const image_cube cube = equirect_to_cube(image_view(pixels.data(), size, pixel_format::rgb_8), 7, pool);
+		Assert::AreEqual<uint32_t>(7, cube.side_size());
+		Assert::IsTrue(cube.format() == pixel_format::rgb_8);
+
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(cube.faces().data);
+		for (size_t i = 0; i < 7 * 7 * 6 * 3; ++i)
+			Assert::AreEqual<uint8_t>(77, p[i]);
+	}
+
+	TEST_METHOD(equirect_to_cube_directions)
+	{
+		cg::thread_pool pool(3);
+
+		// red: the quarter of the horizon which is centered at u == 0, 0.25, 0.5 & 0.75.
+		// green: 1 at the top rows, -1 at the bottom rows.
+		const uint2 size(16, 8);
+		std::vector<float> pixels(square(size) * 4);
+		for (size_t y = 0; y < size.y; ++y) {
+			for (size_t x = 0; x < size.x; ++x) {
+				float* p = pixels.data() + (y * size.x + x) * 4;
+				p[0] = float(size_t((x + 0.5f) / 4.0f + 0.5f) % 4);
+				p[1] = (y < 2) ? 1.0f : ((y >= 6) ? -1.0f : 0.0f);
+				p[2] = 0.0f;
+				p[3] = 1.0f;
+			}
+		}
+
+		const image_cube cube = equirect_to_cube(image_view(pixels.data(), size, pixel_format::rgba_32f), 5, pool);
+		auto center = [&cube](cube_face face) {
+			return reinterpret_cast<const float*>(cube.face(face).data) + (2 * 5 + 2) * 4;
+		};
+
+		Assert::AreEqual(2.0f, center(cube_face::positive_x)[0], 1e-5f);
+		Assert::AreEqual(0.0f, center(cube_face::negative_x)[0], 1e-5f);
+		Assert::AreEqual(3.0f, center(cube_face::positive_z)[0], 1e-5f);
+		Assert::AreEqual(1.0f, center(cube_face::negative_z)[0], 1e-5f);
+		Assert::AreEqual(1.0f, center(cube_face::positive_y)[1], 1e-5f);
+		Assert::AreEqual(-1.0f, center(cube_face::negative_y)[1], 1e-5f);
+
+		for (cube_face face : { cube_face::positive_x, cube_face::negative_x, cube_face::positive_z, cube_face::negative_z }) {
+			Assert::AreEqual(0.0f, center(face)[1], 1e-5f);
+			Assert::AreEqual(1.0f, center(face)[3], 1e-5f);
+		}
+	}
+};
+
+} // namespace unittest
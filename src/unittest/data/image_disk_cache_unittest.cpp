@@ -0,0 +1,173 @@
+#include "cg/data/image_disk_cache.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "cg/data/file.h"
+#include "unittest/data/common_file.h"
+
+using cg::data::cached_image;
+using cg::data::cgimg_source;
+using cg::data::image_2d;
+using cg::data::pixel_format;
+
+
+namespace {
+
+const std::string source_filename = "image_disk_cache_unittest.png";
+
+#pragma warning(push)
+#pragma warning(disable:4996)
+// Copies the test image into the working directory, so that .cgimg files are not written into data/.
+void copy_source_image()
+{
+	const std::string content = cg::data::load_text(unittest::Filenames::png_rgba_3x2);
+
+	FILE* handle = std::fopen(source_filename.c_str(), "wb");
+	std::fwrite(content.data(), 1, content.size(), handle);
+	std::fclose(handle);
+}
+
+void overwrite_byte(const std::string& filename, size_t offset, uint8_t value)
+{
+	FILE* handle = std::fopen(filename.c_str(), "r+b");
+	std::fseek(handle, long(offset), SEEK_SET);
+	std::fwrite(&value, 1, 1, handle);
+	std::fclose(handle);
+}
+#pragma warning(pop)
+
+} // namespace
+
+
+namespace unittest {
+
+TEST_CLASS(cg_data_image_disk_cache_Funcs) {
+public:
+
+	TEST_METHOD(cgimg_filename)
+	{
+		using cg::data::cgimg_filename;
+
+		Assert::AreEqual(std::string("a/b.png.0.cgimg"), cgimg_filename("a/b.png", 0, false));
+		Assert::AreEqual(std::string("a/b.hdr.4f.cgimg"), cgimg_filename("a/b.hdr", 4, true));
+		Assert::AreEqual(std::string("a/b.hdr.4fh.cgimg"), cgimg_filename("a/b.hdr", 4, true, true));
+	}
+
+	TEST_METHOD(get_cgimg_source)
+	{
+		using cg::data::get_cgimg_source;
+
+		cgimg_source s0;
+		Assert::IsFalse(get_cgimg_source("unknown-file", 4, false, false, s0));
+
+		cgimg_source s1;
+		cgimg_source s2;
+		cgimg_source s3;
+		Assert::IsTrue(get_cgimg_source(Filenames::png_rgba_3x2, 4, false, false, s1));
+		Assert::IsTrue(get_cgimg_source(Filenames::png_rgba_3x2, 4, true, false, s2));
+		Assert::IsTrue(get_cgimg_source(Filenames::png_rgba_3x2, 3, false, false, s3));
+		Assert::IsTrue(s1.byte_count > 0);
+		Assert::IsTrue(s1.byte_count == s2.byte_count);
+		Assert::IsTrue(s1.write_time == s2.write_time);
+		Assert::IsTrue(s1.hash != s2.hash);
+		Assert::IsTrue(s1.hash != s3.hash);
+	}
+
+	TEST_METHOD(load_image_cached)
+	{
+		using cg::data::cgimg_filename;
+		using cg::data::load_image_cached;
+
+		copy_source_image();
+		const std::string cache_filename = cgimg_filename(source_filename, 4, true);
+		std::remove(cache_filename.c_str());
+
+		const image_2d expected(source_filename, 4, true);
+
+		// the first load decodes the image and writes the cache.
+		{
+			cached_image img = load_image_cached(source_filename, 4, true);
+			Assert::IsFalse(img.is_mapped());
+			Assert::IsTrue(cg::data::exists(cache_filename));
+			Assert::AreEqual(expected.size.x, img.view().size.x);
+			Assert::AreEqual(expected.size.y, img.view().size.y);
+			Assert::IsTrue(expected.pixel_format == img.view().pixel_format);
+			Assert::AreEqual(0, std::memcmp(expected.data, img.view().data, byte_count(expected)));
+		}
+
+		// the second load maps the cache.
+		{
+			cached_image img = load_image_cached(source_filename, 4, true);
+			Assert::IsTrue(img.is_mapped());
+			Assert::AreEqual(expected.size.x, img.view().size.x);
+			Assert::AreEqual(expected.size.y, img.view().size.y);
+			Assert::IsTrue(expected.pixel_format == img.view().pixel_format);
+			Assert::AreEqual(0, std::memcmp(expected.data, img.view().data, byte_count(expected)));
+
+			cached_image moved = std::move(img);
+			Assert::IsTrue(moved.is_mapped());
+			Assert::AreEqual(0, std::memcmp(expected.data, moved.view().data, byte_count(expected)));
+		}
+
+		// the cache of other load params is not used.
+		{
+			cached_image img = load_image_cached(source_filename, 4, false);
+			Assert::IsFalse(img.is_mapped());
+		}
+
+		std::remove(cgimg_filename(source_filename, 4, false).c_str());
+		std::remove(cache_filename.c_str());
+		std::remove(source_filename.c_str());
+	}
+
+	TEST_METHOD(map_cgimg)
+	{
+		using cg::data::map_cgimg;
+		using cg::data::write_cgimg;
+
+		const std::string filename = "image_disk_cache_unittest.cgimg";
+		const uint8_t pixels[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+		const cg::data::image_view view(pixels, uint2(2, 2), pixel_format::rg_8);
+
+		cgimg_source source;
+		source.hash = 1;
+		source.byte_count = 2;
+		source.write_time = 3;
+		write_cgimg(filename, view, source);
+
+		{
+			cached_image img = map_cgimg(filename, source);
+			Assert::IsTrue(img.is_mapped());
+			Assert::IsTrue(img.view().pixel_format == pixel_format::rg_8);
+			Assert::AreEqual(0, std::memcmp(pixels, img.view().data, sizeof(pixels)));
+
+			// the source has been changed.
+			cgimg_source changed_source = source;
+			changed_source.write_time = 4;
+			Assert::IsFalse(map_cgimg(filename, changed_source).is_mapped());
+
+			// any source
+			cached_image any = map_cgimg(filename);
+			Assert::IsTrue(any.is_mapped());
+			Assert::AreEqual<uint64_t>(3, any.header()->source_write_time);
+			Assert::AreEqual(0, std::memcmp(pixels, any.view().data, sizeof(pixels)));
+		}
+
+		// pixel format is out of range.
+		for (uint8_t fmt : { uint8_t(pixel_format::none), uint8_t(uint8_t(pixel_format::rg_16f) + 1), uint8_t(255) }) {
+			overwrite_byte(filename, offsetof(cg::data::cgimg_header, pixel_format), fmt);
+			Assert::IsFalse(map_cgimg(filename).is_mapped());
+		}
+
+		Assert::IsFalse(map_cgimg("unknown-file", source).is_mapped());
+		Assert::IsFalse(map_cgimg(Filenames::ascii_multiline, source).is_mapped());
+		Assert::IsFalse(map_cgimg("unknown-file").is_mapped());
+		Assert::IsFalse(map_cgimg(Filenames::ascii_multiline).is_mapped());
+
+		std::remove(filename.c_str());
+	}
+};
+
+} // namespace unittest
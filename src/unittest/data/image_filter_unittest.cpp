@@ -0,0 +1,150 @@
+#include "cg/data/image_filter.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "cg/base/math.h"
+#include "CppUnitTest.h"
+
+using cg::data::image_2d;
+using cg::data::image_view;
+using cg::data::pixel_format;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace {
+
+// Straightforward 2D convolution with clamped edges. Returns the first channel of the pixel.
+float reference_filter(const std::vector<float>& pixels, const uint2& size, const std::vector<float>& kernel,
+	size_t x, size_t y)
+{
+	const ptrdiff_t radius = ptrdiff_t(kernel.size() / 2);
+	float sum = 0.0f;
+	for (ptrdiff_t ky = -radius; ky <= radius; ++ky) {
+		for (ptrdiff_t kx = -radius; kx <= radius; ++kx) {
+			const ptrdiff_t sx = std::min(std::max(ptrdiff_t(x) + kx, ptrdiff_t(0)), ptrdiff_t(size.x) - 1);
+			const ptrdiff_t sy = std::min(std::max(ptrdiff_t(y) + ky, ptrdiff_t(0)), ptrdiff_t(size.y) - 1);
+			sum += kernel[kx + radius] * kernel[ky + radius] * pixels[(sy * size.x + sx) * 4];
+		}
+	}
+
+	return sum;
+}
+
+} // namespace
+
+
+namespace unittest {
+
+TEST_CLASS(cg_data_image_filter_Funcs) {
+public:
+
+	TEST_METHOD(gaussian_kernel)
+	{
+		using cg::data::gaussian_kernel;
+
+		const std::vector<float> k0 = gaussian_kernel(0, 1.0f);
+		Assert::AreEqual<size_t>(1, k0.size());
+		Assert::AreEqual(1.0f, k0[0]);
+
+		// the weights of gaussian_filter.compute.hlsl
+		const std::vector<float> k3 = gaussian_kernel(3, std::sqrt(2.0f));
+		Assert::AreEqual<size_t>(7, k3.size());
+		Assert::AreEqual(0.285375187f, k3[3], 1e-6f);
+		Assert::AreEqual(0.222250419f, k3[2], 1e-6f);
+		Assert::AreEqual(0.104983664f, k3[1], 1e-6f);
+		Assert::AreEqual(0.030078323f, k3[0], 1e-6f);
+		Assert::AreEqual(k3[0], k3[6]);
+	}
+
+	TEST_METHOD(gaussian_filter)
+	{
+		using cg::data::gaussian_filter;
+		using cg::data::gaussian_kernel;
+
+		cg::thread_pool pool(2);
+		const uint2 size(23, 37);
+		std::vector<float> pixels(square(size) * 4);
+		for (size_t i = 0; i < pixels.size(); ++i)
+			pixels[i] = float((i * 7919) % 101) / 100.0f;
+
+		const image_2d filtered = gaussian_filter(image_view(pixels.data(), size, pixel_format::rgba_32f), 4, 2.0f, pool);
+		Assert::IsTrue(filtered.size == size);
+		Assert::IsTrue(filtered.pixel_format == pixel_format::rgba_32f);
+
+		const std::vector<float> kernel = gaussian_kernel(4, 2.0f);
+		const float* f = reinterpret_cast<const float*>(filtered.data);
+		for (size_t y = 0; y < size.y; y += 3) {
+			for (size_t x = 0; x < size.x; x += 2)
+				Assert::AreEqual(reference_filter(pixels, size, kernel, x, y), f[(y * size.x + x) * 4], 1e-4f);
+		}
+
+		// 8-bit constant image does not change.
+		std::vector<uint8_t> rgb(square(size) * 3, 77);
+		const image_2d filtered_rgb = gaussian_filter(image_view(rgb.data(), size, pixel_format::rgb_8), 5, 3.0f, pool);
+		Assert::IsTrue(filtered_rgb.pixel_format == pixel_format::rgb_8);
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(filtered_rgb.data);
+		for (size_t i = 0; i < rgb.size(); ++i)
+			Assert::AreEqual<uint8_t>(77, p[i]);
+	}
+
+	TEST_METHOD(box_filter)
+	{
+		using cg::data::box_filter;
+
+		cg::thread_pool pool(2);
+		const uint2 size(40, 40);
+		const std::vector<float> box_kernel(5, 1.0f / 5);
+		std::vector<float> pixels(square(size) * 4);
+		for (size_t i = 0; i < pixels.size(); ++i)
+			pixels[i] = float((i * 31) % 17) / 16.0f;
+
+		const image_2d filtered = box_filter(image_view(pixels.data(), size, pixel_format::rgba_32f), 2, pool);
+		const float* f = reinterpret_cast<const float*>(filtered.data);
+		for (size_t y = 0; y < size.y; ++y) {
+			for (size_t x = 0; x < size.x; ++x)
+				Assert::AreEqual(reference_filter(pixels, size, box_kernel, x, y), f[(y * size.x + x) * 4], 1e-4f);
+		}
+
+		// radius 0 copies the image.
+		const image_2d same = box_filter(image_view(pixels.data(), size, pixel_format::rgba_32f), 0, pool);
+		Assert::AreEqual(pixels[123], reinterpret_cast<const float*>(same.data)[123]);
+	}
+
+	TEST_METHOD(bilateral_filter)
+	{
+		using cg::data::bilateral_filter;
+		using cg::data::gaussian_filter;
+
+		cg::thread_pool pool(2);
+
+		// the left half is black, the right one is white.
+		const uint2 size(32, 8);
+		std::vector<uint8_t> pixels(square(size));
+		for (size_t y = 0; y < size.y; ++y) {
+			for (size_t x = 0; x < size.x; ++x)
+				pixels[y * size.x + x] = (x < size.x / 2) ? 0 : 255;
+		}
+
+		const image_view image(pixels.data(), size, pixel_format::red_8);
+		const image_2d bilateral = bilateral_filter(image, 3, 2.0f, 0.1f, pool);
+		const image_2d gaussian = gaussian_filter(image, 3, 2.0f, pool);
+		const uint8_t* b = reinterpret_cast<const uint8_t*>(bilateral.data);
+		const uint8_t* g = reinterpret_cast<const uint8_t*>(gaussian.data);
+
+		// the edge is preserved by the bilateral filter only.
+		const size_t edge = 4 * size.x + size.x / 2;
+		Assert::AreEqual<uint8_t>(0, b[edge - 1]);
+		Assert::AreEqual<uint8_t>(255, b[edge]);
+		Assert::IsTrue(g[edge - 1] > 0);
+		Assert::IsTrue(g[edge] < 255);
+
+		// large range sigma turns bilateral into gaussian.
+		const image_2d wide = bilateral_filter(image, 3, 2.0f, 1000.0f, pool);
+		const uint8_t* w = reinterpret_cast<const uint8_t*>(wide.data);
+		for (size_t i = 0; i < pixels.size(); ++i)
+			Assert::IsTrue(std::abs(int(w[i]) - int(g[i])) <= 1);
+	}
+};
+
+} // namespace unittest
@@ -0,0 +1,201 @@
+#include "cg/data/image_hdr.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "cg/base/half.h"
+#include "cg/base/math.h"
+#include "CppUnitTest.h"
+
+using cg::data::decode_hdr;
+using cg::data::encode_hdr;
+using cg::data::image_2d;
+using cg::data::image_view;
+using cg::data::pixel_format;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace {
+
+// rgb_32f pixels which are exactly representable as rgbe: the channels of a pixel share the exponent,
+// the mantissas have 8 bits.
+// Rows alternate long runs, distinct values & zeros.
+std::vector<float> make_pixels(const uint2& size)
+{
+	std::vector<float> rgb(square(size) * 3, 0.0f);
+	for (size_t y = 0; y < size.y; ++y) {
+		for (size_t x = 0; x < size.x; ++x) {
+			float* p = rgb.data() + (y * size.x + x) * 3;
+
+			if (y % 3 == 0) {
+				p[0] = 1.0f;
+				p[1] = 0.5f;
+				p[2] = 0.25f;
+			}
+			else if (y % 3 == 1) {
+				p[0] = (x % 7 + 1) * 0.125f;
+				p[1] = (x % 5) * 0.125f;
+				p[2] = 0.5f;
+			}
+		}
+	}
+
+	return rgb;
+}
+
+// Appends the header of an image of the specified resolution string.
+std::vector<uint8_t> make_header(const std::string& resolution)
+{
+	const std::string header = "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n" + resolution + "\n";
+	return std::vector<uint8_t>(header.begin(), header.end());
+}
+
+} // namespace
+
+
+namespace unittest {
+
+TEST_CLASS(cg_data_image_hdr_Funcs) {
+public:
+
+	TEST_METHOD(decode_formats)
+	{
+		const uint2 size(12, 3);
+		const std::vector<float> rgb = make_pixels(size);
+		const std::vector<uint8_t> bytes = encode_hdr(image_view(rgb.data(), size, pixel_format::rgb_32f));
+		Assert::IsTrue(cg::data::is_hdr(bytes.data(), bytes.size()));
+
+		const image_2d rgb_f = decode_hdr(bytes.data(), bytes.size(), pixel_format::rgb_32f);
+		Assert::IsTrue(rgb_f.size == size);
+		Assert::IsTrue(rgb_f.pixel_format == pixel_format::rgb_32f);
+		Assert::AreEqual(0, std::memcmp(rgb.data(), rgb_f.data, rgb.size() * sizeof(float)));
+
+		const image_2d rgba_f = decode_hdr(bytes.data(), bytes.size(), pixel_format::rgba_32f);
+		const float* pf = reinterpret_cast<const float*>(rgba_f.data);
+		for (size_t i = 0; i < square(size); ++i) {
+			Assert::AreEqual(rgb[i * 3 + 0], pf[i * 4 + 0]);
+			Assert::AreEqual(rgb[i * 3 + 2], pf[i * 4 + 2]);
+			Assert::AreEqual(1.0f, pf[i * 4 + 3]);
+		}
+
+		const image_2d rgb_h = decode_hdr(bytes.data(), bytes.size(), pixel_format::rgb_16f);
+		Assert::IsTrue(rgb_h.pixel_format == pixel_format::rgb_16f);
+		std::vector<float> unpacked(rgb.size());
+		cg::half_to_float(reinterpret_cast<const uint16_t*>(rgb_h.data), unpacked.data(), unpacked.size());
+		Assert::AreEqual(0, std::memcmp(rgb.data(), unpacked.data(), rgb.size() * sizeof(float)));
+
+		// packed rgbe: 1.0 == 128 * 2^(129 - 136).
+		const image_2d rgbe = decode_hdr(bytes.data(), bytes.size(), pixel_format::rgba_8);
+		const uint8_t* p8 = reinterpret_cast<const uint8_t*>(rgbe.data);
+		Assert::AreEqual<uint8_t>(128, p8[0]);
+		Assert::AreEqual<uint8_t>(64, p8[1]);
+		Assert::AreEqual<uint8_t>(32, p8[2]);
+		Assert::AreEqual<uint8_t>(129, p8[3]);
+		Assert::AreEqual(0, int(p8[size.x * 2 * 4 + 3]));
+	}
+
+	TEST_METHOD(decode_flip_vertically)
+	{
+		const uint2 size(9, 3);
+		const std::vector<float> rgb = make_pixels(size);
+		const std::vector<uint8_t> bytes = encode_hdr(image_view(rgb.data(), size, pixel_format::rgb_32f));
+
+		const image_2d image = decode_hdr(bytes.data(), bytes.size(), pixel_format::rgb_32f, true);
+		const size_t row_byte_count = size.x * 3 * sizeof(float);
+		for (size_t y = 0; y < size.y; ++y) {
+			Assert::AreEqual(0, std::memcmp(reinterpret_cast<const uint8_t*>(rgb.data()) + y * row_byte_count,
+				reinterpret_cast<const uint8_t*>(image.data) + (size.y - 1 - y) * row_byte_count, row_byte_count));
+		}
+
+		// +Y images store the bottom scanline first.
+		std::vector<uint8_t> bottom_up = make_header("+Y 2 +X 1");
+		bottom_up.insert(bottom_up.end(), { 128, 128, 128, 129, 128, 128, 128, 130 });
+		const image_2d bu = decode_hdr(bottom_up.data(), bottom_up.size(), pixel_format::rgb_32f);
+		Assert::AreEqual(2.0f, reinterpret_cast<const float*>(bu.data)[0]);
+		Assert::AreEqual(1.0f, reinterpret_cast<const float*>(bu.data)[3]);
+	}
+
+	TEST_METHOD(decode_scanline_encodings)
+	{
+		// flat: narrow images are never run length encoded.
+		const uint2 narrow(3, 4);
+		const std::vector<float> rgb = make_pixels(narrow);
+		const std::vector<uint8_t> flat = encode_hdr(image_view(rgb.data(), narrow, pixel_format::rgb_32f));
+		Assert::AreEqual(make_header("-Y 4 +X 3").size() + square(narrow) * 4, flat.size());
+		const image_2d flat_image = decode_hdr(flat.data(), flat.size(), pixel_format::rgb_32f);
+		Assert::AreEqual(0, std::memcmp(rgb.data(), flat_image.data, rgb.size() * sizeof(float)));
+
+		// new rle: runs longer than 127 & literals longer than 128 are split.
+		const uint2 wide(300, 6);
+		const std::vector<float> wide_rgb = make_pixels(wide);
+		const std::vector<uint8_t> rle = encode_hdr(image_view(wide_rgb.data(), wide, pixel_format::rgb_32f));
+		Assert::IsTrue(rle.size() < square(wide) * 4);
+		const image_2d rle_image = decode_hdr(rle.data(), rle.size(), pixel_format::rgb_32f);
+		Assert::AreEqual(0, std::memcmp(wide_rgb.data(), rle_image.data, wide_rgb.size() * sizeof(float)));
+
+		// old rle: (1, 1, 1, n) repeats the previous pixel n times.
+		std::vector<uint8_t> old_rle = make_header("-Y 1 +X 5");
+		old_rle.insert(old_rle.end(), { 128, 64, 32, 129, 1, 1, 1, 4 });
+		const image_2d old_image = decode_hdr(old_rle.data(), old_rle.size(), pixel_format::rgb_32f);
+		const float* p = reinterpret_cast<const float*>(old_image.data);
+		for (size_t x = 0; x < 5; ++x) {
+			Assert::AreEqual(1.0f, p[x * 3 + 0]);
+			Assert::AreEqual(0.5f, p[x * 3 + 1]);
+			Assert::AreEqual(0.25f, p[x * 3 + 2]);
+		}
+	}
+
+	TEST_METHOD(decode_invalid)
+	{
+		std::vector<uint8_t> xyze = { '#', '?', 'R', 'G', 'B', 'E', '\n' };
+		const std::string fmt = "FORMAT=32-bit_rle_xyze\n\n-Y 1 +X 1\n";
+		xyze.insert(xyze.end(), fmt.begin(), fmt.end());
+		xyze.insert(xyze.end(), { 1, 2, 3, 4 });
+		Assert::ExpectException<std::runtime_error>([&] {
+			decode_hdr(xyze.data(), xyze.size(), pixel_format::rgb_32f);
+		});
+
+		std::vector<uint8_t> truncated = make_header("-Y 2 +X 1");
+		truncated.insert(truncated.end(), { 128, 128, 128, 129 });
+		Assert::ExpectException<std::runtime_error>([&] {
+			decode_hdr(truncated.data(), truncated.size(), pixel_format::rgb_32f);
+		});
+
+		std::vector<uint8_t> overflow = make_header("-Y 1 +X 8");
+		overflow.insert(overflow.end(), { 2, 2, 0, 8, 128 + 9, 1 });
+		Assert::ExpectException<std::runtime_error>([&] {
+			decode_hdr(overflow.data(), overflow.size(), pixel_format::rgb_32f);
+		});
+
+		const uint8_t png[] = { 0x89, 'P', 'N', 'G' };
+		Assert::IsFalse(cg::data::is_hdr(png, sizeof(png)));
+	}
+
+	TEST_METHOD(write_load)
+	{
+		const std::string filename = "image_hdr_unittest.hdr";
+		const uint2 size(10, 3);
+		const std::vector<float> rgb = make_pixels(size);
+		cg::data::write_hdr(filename, image_view(rgb.data(), size, pixel_format::rgb_32f));
+
+		const image_2d loaded = cg::data::load_hdr(filename, pixel_format::rgb_32f);
+		Assert::AreEqual(0, std::memcmp(rgb.data(), loaded.data, rgb.size() * sizeof(float)));
+
+		// image_2d decodes rgbe files with the same codec.
+		const image_2d image(filename);
+		Assert::IsTrue(image.pixel_format == pixel_format::rgb_32f);
+		Assert::AreEqual(0, std::memcmp(rgb.data(), image.data, rgb.size() * sizeof(float)));
+
+		const image_2d half_image(filename, 4, false, true);
+		Assert::IsTrue(half_image.pixel_format == pixel_format::rgba_16f);
+		Assert::IsTrue(half_image.size == size);
+
+		std::remove(filename.c_str());
+		Assert::ExpectException<std::runtime_error>([&] {
+			cg::data::load_hdr(filename, pixel_format::rgb_32f);
+		});
+	}
+};
+
+} // namespace unittest
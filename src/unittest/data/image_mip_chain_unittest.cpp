@@ -0,0 +1,186 @@
+#include "cg/data/image_mip_chain.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "cg/base/half.h"
+#include "cg/base/math.h"
+#include "cg/base/thread_pool.h"
+#include "CppUnitTest.h"
+
+using cg::data::image_mip_chain;
+using cg::data::image_view;
+using cg::data::mip_content;
+using cg::data::mip_filter;
+using cg::data::pixel_format;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace {
+
+bool near_value(int expected, int actual, int tolerance = 1)
+{
+	return std::abs(expected - actual) <= tolerance;
+}
+
+} // namespace
+
+
+namespace unittest {
+
+TEST_CLASS(cg_data_image_mip_chain_Image_mip_chain) {
+public:
+
+	TEST_METHOD(ctors)
+	{
+		cg::thread_pool pool(2);
+		std::vector<uint8_t> pixels(8 * 4 * 4);
+		for (size_t i = 0; i < pixels.size(); ++i) pixels[i] = uint8_t(i);
+		const image_view image(pixels.data(), uint2(8, 4), pixel_format::rgba_8);
+
+		image_mip_chain c0;
+		Assert::AreEqual<size_t>(0, c0.level_count());
+		Assert::IsTrue(c0.format() == pixel_format::none);
+
+		// the full chain.
+		image_mip_chain c1(image, mip_filter::box, mip_content::linear, pool);
+		Assert::AreEqual<size_t>(4, c1.level_count());
+		Assert::IsTrue(c1.format() == pixel_format::rgba_8);
+		Assert::IsTrue(c1.level(0).size == uint2(8, 4));
+		Assert::IsTrue(c1.level(1).size == uint2(4, 2));
+		Assert::IsTrue(c1.level(2).size == uint2(2, 1));
+		Assert::IsTrue(c1.level(3).size == uint2(1, 1));
+		Assert::IsTrue(c1.level(3).pixel_format == pixel_format::rgba_8);
+		Assert::AreEqual(0, std::memcmp(pixels.data(), c1.level(0).data, pixels.size()));
+
+		// the specified number of levels.
+		image_mip_chain c2(image, mip_filter::kaiser, mip_content::linear, pool, 2);
+		Assert::AreEqual<size_t>(2, c2.level_count());
+		image_mip_chain c3(image, mip_filter::kaiser, mip_content::linear, pool, 100);
+		Assert::AreEqual<size_t>(4, c3.level_count());
+
+		// move
+		image_mip_chain c4 = std::move(c1);
+		Assert::AreEqual<size_t>(4, c4.level_count());
+		Assert::AreEqual(0, std::memcmp(pixels.data(), c4.level(0).data, pixels.size()));
+	}
+
+	TEST_METHOD(box_filter)
+	{
+		cg::thread_pool pool(2);
+
+		// 2x2 blocks are averaged.
+		const uint8_t p0[16] = {
+			0, 10, 20, 30,
+			40, 50, 60, 70,
+			80, 90, 100, 110,
+			120, 130, 140, 150
+		};
+		image_mip_chain c0(image_view(p0, uint2(4, 4), pixel_format::red_8), mip_filter::box, mip_content::linear, pool);
+		const uint8_t* l1 = reinterpret_cast<const uint8_t*>(c0.level(1).data);
+		Assert::AreEqual<int>(25, l1[0]);
+		Assert::AreEqual<int>(45, l1[1]);
+		Assert::AreEqual<int>(105, l1[2]);
+		Assert::AreEqual<int>(125, l1[3]);
+		Assert::AreEqual<int>(75, *reinterpret_cast<const uint8_t*>(c0.level(2).data));
+
+		// odd sizes: 3x1 -> 1x1 covers all the pixels.
+		const float p1[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		image_mip_chain c1(image_view(p1, uint2(3, 1), pixel_format::rgb_32f), mip_filter::box, mip_content::linear, pool);
+		Assert::AreEqual<size_t>(2, c1.level_count());
+		const float* v = reinterpret_cast<const float*>(c1.level(1).data);
+		Assert::AreEqual(4.0f, v[0], 1e-5f);
+		Assert::AreEqual(5.0f, v[1], 1e-5f);
+		Assert::AreEqual(6.0f, v[2], 1e-5f);
+	}
+
+	TEST_METHOD(two_channel_float)
+	{
+		cg::thread_pool pool(2);
+
+		// the pixels are tightly packed, 2 floats each.
+		const float p0[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+		image_mip_chain c0(image_view(p0, uint2(2, 2), pixel_format::rg_32f), mip_filter::box, mip_content::linear, pool);
+		Assert::AreEqual<size_t>(2, c0.level_count());
+		Assert::IsTrue(c0.level(1).pixel_format == pixel_format::rg_32f);
+		const float* v = reinterpret_cast<const float*>(c0.level(1).data);
+		Assert::AreEqual(4.0f, v[0], 1e-5f);
+		Assert::AreEqual(5.0f, v[1], 1e-5f);
+
+		uint16_t p1[8];
+		cg::float_to_half(p0, p1, 8);
+		image_mip_chain c1(image_view(p1, uint2(2, 2), pixel_format::rg_16f), mip_filter::box, mip_content::linear, pool);
+		Assert::IsTrue(c1.level(1).pixel_format == pixel_format::rg_16f);
+		float h[2];
+		cg::half_to_float(reinterpret_cast<const uint16_t*>(c1.level(1).data), h, 2);
+		Assert::AreEqual(4.0f, h[0], 1e-3f);
+		Assert::AreEqual(5.0f, h[1], 1e-3f);
+	}
+
+	TEST_METHOD(kaiser_filter)
+	{
+		cg::thread_pool pool(3);
+
+		// weights are normalized, a constant image stays constant.
+		std::vector<float> pixels(37 * 21 * 4, 0.25f);
+		image_mip_chain c(image_view(pixels.data(), uint2(37, 21), pixel_format::rgba_32f),
+			mip_filter::kaiser, mip_content::linear, pool);
+		Assert::AreEqual<size_t>(6, c.level_count());
+
+		for (size_t l = 1; l < c.level_count(); ++l) {
+			const image_view level = c.level(l);
+			const float* v = reinterpret_cast<const float*>(level.data);
+			for (size_t i = 0; i < square(level.size) * 4; ++i)
+				Assert::AreEqual(0.25f, v[i], 1e-5f);
+		}
+	}
+
+	TEST_METHOD(srgb_color)
+	{
+		cg::thread_pool pool(2);
+
+		// black & white are averaged in linear space: srgb(0.5) = 188. Alpha is linear.
+		const uint8_t pixels[8] = { 0, 0, 0, 0, 255, 255, 255, 255 };
+		image_mip_chain c(image_view(pixels, uint2(2, 1), pixel_format::rgba_8),
+			mip_filter::box, mip_content::srgb_color, pool);
+
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(c.level(1).data);
+		Assert::IsTrue(near_value(188, p[0]));
+		Assert::IsTrue(near_value(188, p[1]));
+		Assert::IsTrue(near_value(188, p[2]));
+		Assert::IsTrue(near_value(128, p[3]));
+	}
+
+	TEST_METHOD(normal_map)
+	{
+		cg::thread_pool pool(2);
+
+		// (1, 0, 0) & (0, 0, 1) -> (0.707, 0, 0.707)
+		const uint8_t pixels[6] = { 255, 128, 128, 128, 128, 255 };
+		image_mip_chain c(image_view(pixels, uint2(2, 1), pixel_format::rgb_8),
+			mip_filter::box, mip_content::normal_map, pool);
+
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(c.level(1).data);
+		Assert::IsTrue(near_value(218, p[0]));
+		Assert::IsTrue(near_value(128, p[1]));
+		Assert::IsTrue(near_value(218, p[2]));
+	}
+};
+
+TEST_CLASS(cg_data_image_mip_chain_Funcs) {
+public:
+
+	TEST_METHOD(mip_level_count)
+	{
+		using cg::data::mip_level_count;
+
+		Assert::AreEqual<size_t>(1, mip_level_count(uint2(1, 1)));
+		Assert::AreEqual<size_t>(3, mip_level_count(uint2(4, 4)));
+		Assert::AreEqual<size_t>(3, mip_level_count(uint2(5, 3)));
+		Assert::AreEqual<size_t>(9, mip_level_count(uint2(256, 1)));
+		Assert::AreEqual<size_t>(11, mip_level_count(uint2(1024, 768)));
+	}
+};
+
+} // namespace unittest
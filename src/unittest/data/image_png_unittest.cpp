@@ -0,0 +1,244 @@
+#include "cg/data/image_png.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "cg/base/math.h"
+#include "cg/data/file.h"
+#include "unittest/data/common_file.h"
+
+using cg::data::decode_png;
+using cg::data::image_2d;
+using cg::data::inflate_zlib;
+using cg::data::load_png;
+using cg::data::Mapped_file;
+using cg::data::pixel_format;
+using cg::data::png_info;
+using cg::data::read_png_info;
+
+
+namespace {
+
+// The pixels of png_rgb_filters_33x10 & png_rgba_filters_17x10, every row has its own filter type.
+// png_rgb_trailing_data_4x3 has the same pixels.
+void make_rgba_pixel(size_t x, size_t y, uint8_t* p)
+{
+	p[0] = uint8_t(x * 7 + y * 3);
+	p[1] = uint8_t(x * y * 5);
+	p[2] = uint8_t(255 - x * 3 - y);
+	p[3] = uint8_t(x * 13 + y * 29);
+}
+
+} // namespace
+
+
+namespace unittest {
+
+TEST_CLASS(cg_data_image_png_Funcs) {
+public:
+
+	TEST_METHOD(decode_bit_depths)
+	{
+		// 16-bit gray & alpha: v = x * 4000 + y * 9000, a = 65535 - x * 1000 - y * 300.
+		const image_2d ga = load_png(Filenames::png_gray_alpha_16bit_5x4);
+		Assert::AreEqual(uint2(5, 4), ga.size);
+		Assert::AreEqual(pixel_format::rg_8, ga.pixel_format);
+
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(ga.data);
+		for (size_t y = 0; y < 4; ++y) {
+			for (size_t x = 0; x < 5; ++x, p += 2) {
+				Assert::AreEqual<uint8_t>(uint8_t(((x * 4000 + y * 9000) & 0xffff) >> 8), p[0]);
+				Assert::AreEqual<uint8_t>(uint8_t((65535 - x * 1000 - y * 300) >> 8), p[1]);
+			}
+		}
+
+		// 2-bit gray, the gray level 1 is transparent: v = (x + y) % 4.
+		const image_2d gray = load_png(Filenames::png_gray_trns_2bit_9x3);
+		Assert::AreEqual(uint2(9, 3), gray.size);
+		Assert::AreEqual(pixel_format::rg_8, gray.pixel_format);
+
+		p = reinterpret_cast<const uint8_t*>(gray.data);
+		for (size_t y = 0; y < 3; ++y) {
+			for (size_t x = 0; x < 9; ++x, p += 2) {
+				const size_t v = (x + y) % 4;
+				Assert::AreEqual<uint8_t>(uint8_t(v * 85), p[0]);
+				Assert::AreEqual<uint8_t>((v == 1) ? 0 : 255, p[1]);
+			}
+		}
+	}
+
+	TEST_METHOD(decode_channel_count)
+	{
+		const Mapped_file file(Filenames::png_rgba_3x2);
+		const std::vector<uint8_t> expected = {
+			255, 0, 0, 255,		0, 255, 0, 255,		0, 0, 255, 255,
+			10, 20, 30, 40,		50, 60, 70, 80,		90, 100, 110, 120
+		};
+
+		// straight into a caller's buffer.
+		std::vector<uint8_t> rgba(24);
+		decode_png(file.data(), file.byte_count(), 0, false, rgba.data());
+		Assert::IsTrue(expected == rgba);
+
+		std::vector<uint8_t> rgb(18);
+		decode_png(file.data(), file.byte_count(), 3, false, rgb.data());
+		for (size_t i = 0; i < 6; ++i)
+			Assert::IsTrue(std::memcmp(expected.data() + i * 4, rgb.data() + i * 3, 3) == 0);
+
+		const image_2d red = decode_png(file.data(), file.byte_count(), 1);
+		Assert::AreEqual(pixel_format::red_8, red.pixel_format);
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(red.data);
+		Assert::AreEqual<uint8_t>((255 * 77) >> 8, p[0]);
+		Assert::AreEqual<uint8_t>((255 * 150) >> 8, p[1]);
+		Assert::AreEqual<uint8_t>((50 * 77 + 60 * 150 + 70 * 29) >> 8, p[4]);
+
+		const image_2d rg = decode_png(file.data(), file.byte_count(), 2, true);
+		Assert::AreEqual(pixel_format::rg_8, rg.pixel_format);
+		p = reinterpret_cast<const uint8_t*>(rg.data);
+		Assert::AreEqual<uint8_t>(40, p[1]);
+		Assert::AreEqual<uint8_t>(255, p[7]);
+	}
+
+	TEST_METHOD(decode_filters)
+	{
+		// dynamic Huffman blocks split into several IDAT chunks.
+		const image_2d rgb = load_png(Filenames::png_rgb_filters_33x10);
+		Assert::AreEqual(uint2(33, 10), rgb.size);
+		Assert::AreEqual(pixel_format::rgb_8, rgb.pixel_format);
+
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(rgb.data);
+		for (size_t y = 0; y < 10; ++y) {
+			for (size_t x = 0; x < 33; ++x, p += 3) {
+				uint8_t expected[4];
+				make_rgba_pixel(x, y, expected);
+				Assert::IsTrue(std::memcmp(expected, p, 3) == 0);
+			}
+		}
+
+		// stored blocks.
+		const image_2d rgba = load_png(Filenames::png_rgba_filters_17x10, 4, true);
+		Assert::AreEqual(uint2(17, 10), rgba.size);
+		Assert::AreEqual(pixel_format::rgba_8, rgba.pixel_format);
+
+		p = reinterpret_cast<const uint8_t*>(rgba.data);
+		for (size_t y = 0; y < 10; ++y) {
+			for (size_t x = 0; x < 17; ++x, p += 4) {
+				uint8_t expected[4];
+				make_rgba_pixel(x, 9 - y, expected);
+				Assert::IsTrue(std::memcmp(expected, p, 4) == 0);
+			}
+		}
+	}
+
+	TEST_METHOD(decode_invalid)
+	{
+		const Mapped_file file(Filenames::png_rgba_3x2);
+		std::vector<uint8_t> bytes(file.data(), file.data() + file.byte_count());
+
+		Assert::ExpectException<std::exception>([&] { decode_png(bytes.data(), 8); });
+		Assert::ExpectException<std::exception>([&] { decode_png(bytes.data(), bytes.size() - 20); });
+
+		// the signature is corrupted.
+		bytes[0] = 'X';
+		Assert::ExpectException<std::exception>([&] { decode_png(bytes.data(), bytes.size()); });
+		Assert::ExpectException<std::exception>([] { load_png("unknown_image.png"); });
+		Assert::ExpectException<std::exception>([] { load_png(Filenames::ascii_single_line); });
+	}
+
+	TEST_METHOD(decode_palette)
+	{
+		// 4-bit indices, the first 3 entries have alpha: index = (x + 2y) % 10.
+		const image_2d image = load_png(Filenames::png_palette_trns_4bit_7x3);
+		Assert::AreEqual(uint2(7, 3), image.size);
+		Assert::AreEqual(pixel_format::rgba_8, image.pixel_format);
+
+		const uint8_t alpha[3] = { 0, 100, 200 };
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(image.data);
+		for (size_t y = 0; y < 3; ++y) {
+			for (size_t x = 0; x < 7; ++x, p += 4) {
+				const size_t i = (x + y * 2) % 10;
+				Assert::AreEqual<uint8_t>(uint8_t(i * 20), p[0]);
+				Assert::AreEqual<uint8_t>(uint8_t(255 - i * 20), p[1]);
+				Assert::AreEqual<uint8_t>(uint8_t(i * 7), p[2]);
+				Assert::AreEqual<uint8_t>((i < 3) ? alpha[i] : 255, p[3]);
+			}
+		}
+	}
+
+	TEST_METHOD(decode_trailing_data)
+	{
+		// the stream inflates to more bytes than the scanlines take.
+		const image_2d rgb = load_png(Filenames::png_rgb_trailing_data_4x3);
+		Assert::AreEqual(uint2(4, 3), rgb.size);
+		Assert::AreEqual(pixel_format::rgb_8, rgb.pixel_format);
+
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(rgb.data);
+		for (size_t y = 0; y < 3; ++y) {
+			for (size_t x = 0; x < 4; ++x, p += 3) {
+				uint8_t expected[4];
+				make_rgba_pixel(x, y, expected);
+				Assert::IsTrue(std::memcmp(expected, p, 3) == 0);
+			}
+		}
+	}
+
+	TEST_METHOD(inflate)
+	{
+		// fixed Huffman codes, the matches overlap the output.
+		const uint8_t fixed[] = {
+			0x78, 0xda, 0x4b, 0x4c, 0x4a, 0x4e, 0x44, 0x46, 0x44, 0x02, 0x00, 0x4a, 0x9f, 0x14, 0xe7
+		};
+		const std::string expected = "abcabcabcabcabc" + std::string(40, 'a');
+		std::vector<uint8_t> dst(64);
+		Assert::AreEqual(expected.size(), inflate_zlib(fixed, sizeof(fixed), dst.data(), dst.size()));
+		Assert::IsTrue(std::memcmp(expected.data(), dst.data(), expected.size()) == 0);
+
+		// the output does not fit.
+		Assert::ExpectException<std::exception>([&] { inflate_zlib(fixed, sizeof(fixed), dst.data(), 54); });
+		Assert::ExpectException<std::exception>([&] { inflate_zlib(fixed, 8, dst.data(), dst.size()); });
+
+		// a single stored block.
+		const uint8_t stored[] = { 0x78, 0x01, 0x01, 0x05, 0x00, 0xfa, 0xff, 'h', 'e', 'l', 'l', 'o' };
+		Assert::AreEqual<size_t>(5, inflate_zlib(stored, sizeof(stored), dst.data(), dst.size()));
+		Assert::IsTrue(std::memcmp("hello", dst.data(), 5) == 0);
+
+		const uint8_t corrupted_length[] = { 0x78, 0x01, 0x01, 0x05, 0x00, 0xfa, 0xfe, 'h', 'e', 'l', 'l', 'o' };
+		Assert::ExpectException<std::exception>([&] {
+			inflate_zlib(corrupted_length, sizeof(corrupted_length), dst.data(), dst.size());
+		});
+
+		const uint8_t corrupted_header[] = { 0x78, 0x02, 0x01, 0x05, 0x00, 0xfa, 0xff, 'h', 'e', 'l', 'l', 'o' };
+		Assert::ExpectException<std::exception>([&] {
+			inflate_zlib(corrupted_header, sizeof(corrupted_header), dst.data(), dst.size());
+		});
+	}
+
+	TEST_METHOD(is_png)
+	{
+		const Mapped_file file(Filenames::png_rgba_3x2);
+		Assert::IsTrue(cg::data::is_png(file.data(), file.byte_count()));
+		Assert::IsFalse(cg::data::is_png(file.data(), 7));
+		Assert::IsFalse(cg::data::is_png(file.data() + 1, file.byte_count() - 1));
+		Assert::IsFalse(cg::data::is_png(nullptr, 0));
+	}
+
+	TEST_METHOD(read_info)
+	{
+		const Mapped_file file(Filenames::png_rgba_3x2);
+		const png_info info = read_png_info(file.data(), file.byte_count());
+		Assert::AreEqual(uint2(3, 2), info.size);
+		Assert::AreEqual<uint8_t>(4, info.channel_count);
+		Assert::AreEqual<uint8_t>(8, info.bit_depth);
+		Assert::IsFalse(info.interlaced);
+
+		// tRNS adds alpha.
+		const Mapped_file palette_file(Filenames::png_palette_trns_4bit_7x3);
+		const png_info palette_info = read_png_info(palette_file.data(), palette_file.byte_count());
+		Assert::AreEqual<uint8_t>(4, palette_info.channel_count);
+		Assert::AreEqual<uint8_t>(4, palette_info.bit_depth);
+
+		Assert::ExpectException<std::exception>([&] { read_png_info(file.data() + 1, file.byte_count() - 1); });
+	}
+};
+
+} // namespace unittest
@@ -0,0 +1,114 @@
+#include "cg/data/image_resample.h"
+
+#include <cstdint>
+#include <vector>
+#include "cg/base/math.h"
+#include "CppUnitTest.h"
+
+using cg::data::image_2d;
+using cg::data::image_view;
+using cg::data::pixel_format;
+using cg::data::resample;
+using cg::data::resample_filter;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace unittest {
+
+TEST_CLASS(cg_data_image_resample_Funcs) {
+public:
+
+	TEST_METHOD(resample_box)
+	{
+		cg::thread_pool pool(2);
+		const uint2 size(8, 6);
+		std::vector<float> pixels(square(size) * 4);
+		for (size_t i = 0; i < pixels.size(); ++i)
+			pixels[i] = float((i * 7919) % 101) / 100.0f;
+
+		// 2x2 blocks are averaged.
+		const image_2d half = resample(image_view(pixels.data(), size, pixel_format::rgba_32f),
+			uint2(4, 3), resample_filter::box, pool);
+		Assert::IsTrue(half.size == uint2(4, 3));
+		Assert::IsTrue(half.pixel_format == pixel_format::rgba_32f);
+
+		const float* p = reinterpret_cast<const float*>(half.data);
+		for (size_t y = 0; y < 3; ++y) {
+			for (size_t x = 0; x < 4; ++x) {
+				for (size_t c = 0; c < 4; ++c) {
+					const size_t i = ((2 * y) * size.x + 2 * x) * 4 + c;
+					const float expected = (pixels[i] + pixels[i + 4] + pixels[i + size.x * 4] + pixels[i + size.x * 4 + 4]) / 4.0f;
+					Assert::AreEqual(expected, p[(y * 4 + x) * 4 + c], 1e-5f);
+				}
+			}
+		}
+
+		// a row is averaged into one pixel.
+		const image_2d column = resample(image_view(pixels.data(), size, pixel_format::rgba_32f),
+			uint2(1, 6), resample_filter::box, pool);
+		p = reinterpret_cast<const float*>(column.data);
+		float sum = 0.0f;
+		for (size_t x = 0; x < size.x; ++x)
+			sum += pixels[x * 4];
+
+		Assert::AreEqual(sum / size.x, p[0], 1e-5f);
+	}
+
+	TEST_METHOD(resample_constant)
+	{
+		cg::thread_pool pool(3);
+		const uint2 size(13, 7);
+		std::vector<uint8_t> pixels(square(size) * 3);
+		for (size_t i = 0; i < pixels.size(); i += 3) {
+			pixels[i] = 10;
+			pixels[i + 1] = 128;
+			pixels[i + 2] = 250;
+		}
+
+		// normalized weights keep a constant image the same whatever the filter & the scale are.
+		const image_view image(pixels.data(), size, pixel_format::rgb_8);
+		const uint2 sizes[] = { uint2(4, 3), uint2(16, 16), uint2(13, 29), uint2(1, 1) };
+		const resample_filter filters[] = { resample_filter::box, resample_filter::mitchell, resample_filter::lanczos3 };
+
+		for (const uint2& s : sizes) {
+			for (resample_filter f : filters) {
+				const image_2d r = resample(image, s, f, pool);
+				Assert::IsTrue(r.size == s);
+				Assert::IsTrue(r.pixel_format == pixel_format::rgb_8);
+
+				const uint8_t* p = reinterpret_cast<const uint8_t*>(r.data);
+				for (size_t i = 0; i < square(s) * 3; i += 3) {
+					Assert::AreEqual<uint8_t>(10, p[i]);
+					Assert::AreEqual<uint8_t>(128, p[i + 1]);
+					Assert::AreEqual<uint8_t>(250, p[i + 2]);
+				}
+			}
+		}
+	}
+
+	TEST_METHOD(resample_lanczos3)
+	{
+		const uint2 size(9, 5);
+		std::vector<float> pixels(square(size) * 4);
+		for (size_t i = 0; i < pixels.size(); ++i)
+			pixels[i] = float((i * 31) % 17);
+
+		const image_view image(pixels.data(), size, pixel_format::rgba_32f);
+
+		// the same size is a copy.
+		const image_2d same = resample(image, size, resample_filter::lanczos3);
+		const float* p = reinterpret_cast<const float*>(same.data);
+		for (size_t i = 0; i < pixels.size(); ++i)
+			Assert::AreEqual(pixels[i], p[i]);
+
+		// upscaling 3x: sinc is 0 at the integer distances, the centers of the source pixels are kept.
+		const image_2d up = resample(image, uint2(27, 5), resample_filter::lanczos3);
+		p = reinterpret_cast<const float*>(up.data);
+		for (size_t y = 0; y < size.y; ++y) {
+			for (size_t x = 0; x < size.x; ++x)
+				Assert::AreEqual(pixels[(y * size.x + x) * 4], p[(y * 27 + x * 3 + 1) * 4], 1e-4f);
+		}
+	}
+};
+
+} // namespace unittest
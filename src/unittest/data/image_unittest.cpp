@@ -1,15 +1,20 @@
 #include "cg/data/image.h"
 
 #include <cstdint>
+#include <cstring>
 #include <algorithm>
 #include <array>
 #include <iterator>
 #include <type_traits>
 #include <utility>
+#include <vector>
 #include "cg/base/math.h"
+#include "cg/base/thread_pool.h"
 #include "unittest/data/common_file.h"
 #include "CppUnitTest.h"
 
+using cg::data::image_2d;
+using cg::data::image_request;
 using cg::data::pixel_format;
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -27,6 +32,54 @@ namespace unittest {
 TEST_CLASS(cg_data_image_Image_2d) {
 public:
 
+	TEST_METHOD(ctor)
+	{
+		Assert::ExpectException<std::runtime_error>([] { image_2d img("unknown-file"); });
+		Assert::ExpectException<std::runtime_error>([] { image_2d img(Filenames::ascii_single_line); });
+
+		image_2d img(Filenames::png_rgba_3x2);
+		Assert::AreEqual(uint2(3, 2), img.size);
+		Assert::AreEqual(pixel_format::rgba_8, img.pixel_format);
+
+		const std::array<uint8_t, 24> expected = {
+			255, 0, 0, 255,		0, 255, 0, 255,		0, 0, 255, 255,
+			10, 20, 30, 40,		50, 60, 70, 80,		90, 100, 110, 120
+		};
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(img.data);
+		Assert::IsTrue(std::equal(expected.cbegin(), expected.cend(), p));
+
+		image_2d img_rgb(Filenames::png_rgba_3x2, 3);
+		Assert::AreEqual(uint2(3, 2), img_rgb.size);
+		Assert::AreEqual(pixel_format::rgb_8, img_rgb.pixel_format);
+		p = reinterpret_cast<const uint8_t*>(img_rgb.data);
+		Assert::AreEqual<uint8_t>(0, p[3]);
+		Assert::AreEqual<uint8_t>(255, p[4]);
+		Assert::AreEqual<uint8_t>(10, p[9]);
+	}
+
+	TEST_METHOD(ctor_size_pixel_format)
+	{
+		image_2d img(uint2(3, 2), pixel_format::rgb_32f);
+		Assert::IsNotNull(img.data);
+		Assert::AreEqual(uint2(3, 2), img.size);
+		Assert::AreEqual(pixel_format::rgb_32f, img.pixel_format);
+
+		// the pixels are writable.
+		std::memset(img.data, 0, byte_count(img));
+	}
+
+	TEST_METHOD(ctor_flip_vertically)
+	{
+		image_2d img(Filenames::png_rgba_3x2, 4, true);
+		Assert::AreEqual(uint2(3, 2), img.size);
+
+		const std::array<uint8_t, 24> expected = {
+			10, 20, 30, 40,		50, 60, 70, 80,		90, 100, 110, 120,
+			255, 0, 0, 255,		0, 255, 0, 255,		0, 0, 255, 255
+		};
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(img.data);
+		Assert::IsTrue(std::equal(expected.cbegin(), expected.cend(), p));
+	}
 };
 
 TEST_CLASS(cg_data_image_pixel_format) {
@@ -39,10 +92,37 @@ public:
 		Assert::AreEqual<size_t>(0, byte_count(pixel_format::none));
 		Assert::AreEqual(3 * sizeof(float), byte_count(pixel_format::rgb_32f));
 		Assert::AreEqual(4 * sizeof(float), byte_count(pixel_format::rgba_32f));
+		Assert::AreEqual(3 * sizeof(uint16_t), byte_count(pixel_format::rgb_16f));
+		Assert::AreEqual(4 * sizeof(uint16_t), byte_count(pixel_format::rgba_16f));
+		Assert::AreEqual(2 * sizeof(float), byte_count(pixel_format::rg_32f));
+		Assert::AreEqual(2 * sizeof(uint16_t), byte_count(pixel_format::rg_16f));
 		Assert::AreEqual<size_t>(1, byte_count(pixel_format::red_8));
 		Assert::AreEqual<size_t>(2, byte_count(pixel_format::rg_8));
 		Assert::AreEqual<size_t>(3, byte_count(pixel_format::rgb_8));
 		Assert::AreEqual<size_t>(4, byte_count(pixel_format::rgba_8));
+		Assert::AreEqual<size_t>(0, byte_count(pixel_format::bc1));
+
+		Assert::AreEqual<size_t>(5 * 3 * 3, byte_count(uint2(5, 3), pixel_format::rgb_8));
+		Assert::AreEqual<size_t>(2 * 1 * 8, byte_count(uint2(5, 3), pixel_format::bc1));
+		Assert::AreEqual<size_t>(2 * 1 * 16, byte_count(uint2(5, 3), pixel_format::bc3));
+		Assert::AreEqual<size_t>(1 * 8, byte_count(uint2(1, 1), pixel_format::bc4));
+		Assert::AreEqual<size_t>(4 * 16, byte_count(uint2(8, 8), pixel_format::bc5));
+	}
+
+	TEST_METHOD(block_byte_count)
+	{
+		using cg::data::block_byte_count;
+		using cg::data::is_block_compressed;
+
+		Assert::AreEqual<size_t>(0, block_byte_count(pixel_format::none));
+		Assert::AreEqual<size_t>(0, block_byte_count(pixel_format::rgba_8));
+		Assert::AreEqual<size_t>(8, block_byte_count(pixel_format::bc1));
+		Assert::AreEqual<size_t>(16, block_byte_count(pixel_format::bc3));
+		Assert::AreEqual<size_t>(8, block_byte_count(pixel_format::bc4));
+		Assert::AreEqual<size_t>(16, block_byte_count(pixel_format::bc5));
+
+		Assert::IsFalse(is_block_compressed(pixel_format::rgb_32f));
+		Assert::IsTrue(is_block_compressed(pixel_format::bc3));
 	}
 
 	TEST_METHOD(channel_count)
@@ -56,6 +136,70 @@ public:
 		Assert::AreEqual<size_t>(2, channel_count(pixel_format::rg_8));
 		Assert::AreEqual<size_t>(3, channel_count(pixel_format::rgb_8));
 		Assert::AreEqual<size_t>(4, channel_count(pixel_format::rgba_8));
+		Assert::AreEqual<size_t>(3, channel_count(pixel_format::bc1));
+		Assert::AreEqual<size_t>(4, channel_count(pixel_format::bc3));
+		Assert::AreEqual<size_t>(1, channel_count(pixel_format::bc4));
+		Assert::AreEqual<size_t>(2, channel_count(pixel_format::bc5));
+		Assert::AreEqual<size_t>(3, channel_count(pixel_format::rgb_16f));
+		Assert::AreEqual<size_t>(4, channel_count(pixel_format::rgba_16f));
+		Assert::AreEqual<size_t>(2, channel_count(pixel_format::rg_32f));
+		Assert::AreEqual<size_t>(2, channel_count(pixel_format::rg_16f));
+	}
+};
+
+TEST_CLASS(cg_data_image_Funcs) {
+public:
+
+	TEST_METHOD(flip_vertically)
+	{
+		using cg::data::flip_vertically;
+
+		// rows longer than 16 bytes & a middle row.
+		std::vector<uint8_t> pixels(7 * 3 * 3);
+		for (size_t i = 0; i < pixels.size(); ++i) pixels[i] = uint8_t(i);
+
+		std::vector<uint8_t> expected(pixels.size());
+		std::copy(pixels.begin() + 42, pixels.end(), expected.begin());
+		std::copy(pixels.begin() + 21, pixels.begin() + 42, expected.begin() + 21);
+		std::copy(pixels.begin(), pixels.begin() + 21, expected.begin() + 42);
+
+		flip_vertically(pixels.data(), uint2(7, 3), pixel_format::rgb_8);
+		Assert::IsTrue(expected == pixels);
+	}
+
+	TEST_METHOD(decode_images)
+	{
+		using cg::data::decode_images;
+
+		Assert::IsTrue(decode_images(std::vector<image_request>()).empty());
+
+		const std::vector<image_request> requests = {
+			{ Filenames::png_rgba_3x2, 4, false },
+			{ Filenames::png_rgba_3x2, 1, false },
+			{ Filenames::png_rgba_3x2, 4, true },
+			{ Filenames::png_rgba_3x2, 3, true },
+		};
+
+		cg::thread_pool pool(2);
+		const std::vector<image_2d> images = decode_images(requests, pool);
+		Assert::AreEqual(requests.size(), images.size());
+
+		for (size_t i = 0; i < images.size(); ++i) {
+			const image_2d expected(requests[i].filename, requests[i].channel_count, requests[i].flip_vertically);
+			Assert::AreEqual(expected.size, images[i].size);
+			Assert::AreEqual(expected.pixel_format, images[i].pixel_format);
+			Assert::AreEqual(0, std::memcmp(expected.data, images[i].data, byte_count(expected)));
+		}
+
+		Assert::AreEqual(pixel_format::red_8, images[1].pixel_format);
+		Assert::AreEqual<uint8_t>(10, reinterpret_cast<const uint8_t*>(images[2].data)[0]);
+
+		// one failed request fails the whole batch.
+		const std::vector<image_request> failed_requests = {
+			{ Filenames::png_rgba_3x2 },
+			{ "unknown-file" },
+		};
+		Assert::ExpectException<std::runtime_error>([&] { decode_images(failed_requests, pool); });
 	}
 };
 
@@ -0,0 +1,130 @@
+#include "cg/data/normal_map.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "cg/base/math.h"
+#include "CppUnitTest.h"
+
+using cg::data::height_edge;
+using cg::data::height_gradient;
+using cg::data::image_2d;
+using cg::data::image_view;
+using cg::data::normal_map_from_height;
+using cg::data::pixel_format;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace {
+
+// Replicates the heights into rgb_32f pixels.
+std::vector<float> to_rgb(const std::vector<float>& heights)
+{
+	std::vector<float> rgb(heights.size() * 3);
+	for (size_t i = 0; i < heights.size(); ++i)
+		rgb[i * 3] = rgb[i * 3 + 1] = rgb[i * 3 + 2] = heights[i];
+
+	return rgb;
+}
+
+} // namespace
+
+
+namespace unittest {
+
+TEST_CLASS(cg_data_normal_map_Funcs) {
+public:
+
+	TEST_METHOD(flat_height_map)
+	{
+		cg::thread_pool pool(2);
+		const uint2 size(13, 9);
+		const std::vector<uint8_t> heights(square(size), 100);
+
+		const image_2d nm = normal_map_from_height(image_view(heights.data(), size, pixel_format::red_8),
+			5.0f, height_gradient::sobel, height_edge::clamp, pixel_format::rgb_8, pool);
+		Assert::IsTrue(nm.size == size);
+		Assert::IsTrue(nm.pixel_format == pixel_format::rgb_8);
+
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(nm.data);
+		for (size_t i = 0; i < square(size); ++i) {
+			Assert::AreEqual<uint8_t>(128, p[i * 3 + 0]);
+			Assert::AreEqual<uint8_t>(128, p[i * 3 + 1]);
+			Assert::AreEqual<uint8_t>(255, p[i * 3 + 2]);
+		}
+	}
+
+	TEST_METHOD(slopes)
+	{
+		cg::thread_pool pool(2);
+
+		// h(x, y) = 0.1 * x: 45 degree slope with strength 10.
+		const uint2 size(11, 6);
+		std::vector<float> heights(square(size));
+		for (size_t y = 0; y < size.y; ++y)
+			for (size_t x = 0; x < size.x; ++x) heights[y * size.x + x] = 0.1f * x;
+
+		const float k = 1.0f / std::sqrt(2.0f);
+		for (height_gradient gradient : { height_gradient::sobel, height_gradient::scharr }) {
+			const image_2d nm = normal_map_from_height(image_view(to_rgb(heights).data(), size, pixel_format::rgb_32f),
+				10.0f, gradient, height_edge::clamp, pixel_format::rgba_32f, pool);
+			const float* n = reinterpret_cast<const float*>(nm.data);
+
+			// interior pixels
+			for (size_t y = 0; y < size.y; ++y) {
+				for (size_t x = 1; x + 1 < size.x; ++x) {
+					const float* v = n + (y * size.x + x) * 4;
+					Assert::AreEqual(-k, v[0], 1e-5f);
+					Assert::AreEqual(0.0f, v[1], 1e-5f);
+					Assert::AreEqual(k, v[2], 1e-5f);
+					Assert::AreEqual(1.0f, v[3]);
+				}
+			}
+		}
+
+		// heights increase toward the bottom row: the normal leans to the top of the image.
+		std::vector<float> heights_y(square(size));
+		for (size_t y = 0; y < size.y; ++y)
+			for (size_t x = 0; x < size.x; ++x) heights_y[y * size.x + x] = 0.1f * y;
+
+		const image_2d nm = normal_map_from_height(image_view(to_rgb(heights_y).data(), size, pixel_format::rgb_32f),
+			10.0f, height_gradient::sobel, height_edge::clamp, pixel_format::rgb_32f, pool);
+		const float* v = reinterpret_cast<const float*>(nm.data) + (2 * size.x + 5) * 3;
+		Assert::AreEqual(0.0f, v[0], 1e-5f);
+		Assert::AreEqual(k, v[1], 1e-5f);
+		Assert::AreEqual(k, v[2], 1e-5f);
+	}
+
+	TEST_METHOD(edges)
+	{
+		cg::thread_pool pool(2);
+
+		// periodic heights: wrapped edges have the same slope as the interior.
+		const uint2 size(8, 3);
+		std::vector<float> heights(square(size));
+		for (size_t y = 0; y < size.y; ++y)
+			for (size_t x = 0; x < size.x; ++x) heights[y * size.x + x] = (x % 2 == 0) ? 0.0f : 0.5f;
+
+		// (h(x + 1) - h(x - 1)) is zero everywhere for wrap but not on the edges for clamp.
+		const image_2d wrapped = normal_map_from_height(image_view(to_rgb(heights).data(), size, pixel_format::rgb_32f),
+			1.0f, height_gradient::scharr, height_edge::wrap, pixel_format::rgb_32f, pool);
+		const image_2d clamped = normal_map_from_height(image_view(to_rgb(heights).data(), size, pixel_format::rgb_32f),
+			1.0f, height_gradient::scharr, height_edge::clamp, pixel_format::rgb_32f, pool);
+		const float* w = reinterpret_cast<const float*>(wrapped.data);
+		const float* c = reinterpret_cast<const float*>(clamped.data);
+		for (size_t i = 0; i < square(size); ++i)
+			Assert::AreEqual(1.0f, w[i * 3 + 2], 1e-6f);
+
+		Assert::IsTrue(c[2] < 1.0f);
+		Assert::AreEqual(1.0f, c[3 * 3 + 2], 1e-6f);
+
+		// narrow images
+		const uint8_t narrow[2] = { 0, 255 };
+		const image_2d nm = normal_map_from_height(image_view(narrow, uint2(2, 1), pixel_format::red_8),
+			1.0f, height_gradient::sobel, height_edge::clamp, pixel_format::rg_8, pool);
+		Assert::IsTrue(nm.size == uint2(2, 1));
+		Assert::IsTrue(reinterpret_cast<const uint8_t*>(nm.data)[0] < 128);
+	}
+};
+
+} // namespace unittest
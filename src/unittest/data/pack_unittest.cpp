@@ -0,0 +1,209 @@
+#include "cg/data/pack.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "cg/base/base.h"
+#include "cg/data/file.h"
+#include "unittest/data/common_file.h"
+
+using cg::data::By_line_iterator;
+using cg::data::File;
+using cg::data::Mapped_file;
+using cg::data::pack;
+using cg::data::pack_compression;
+using cg::data::pack_entry;
+using cg::data::pack_writer;
+
+
+namespace {
+
+const char* pack_filename = "pack_unittest.cgpack";
+
+// 64 Kb of repetitive text, lz compresses it well.
+std::string make_compressible_text()
+{
+	std::string str;
+	for (size_t i = 0; str.size() < cg::kilobytes(64); ++i)
+		str.append("line ").append(std::to_string(i % 100)).append("\r\n");
+
+	return str;
+}
+
+// Bytes that lz is not able to compress.
+std::vector<unsigned char> make_random_bytes(size_t count)
+{
+	std::vector<unsigned char> bytes(count);
+	uint32_t state = 2463534242u;
+	for (unsigned char& b : bytes) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		b = static_cast<unsigned char>(state);
+	}
+
+	return bytes;
+}
+
+void write_test_pack(const std::string& text, const std::vector<unsigned char>& bytes)
+{
+	const std::string single_line = "abc123";
+
+	pack_writer writer(pack_filename);
+	writer.add("dir\\Text.txt", text.data(), text.size(), true);
+	writer.add("bytes.bin", bytes.data(), bytes.size(), true);
+	writer.add("./single_line.txt", single_line.data(), single_line.size(), false);
+	writer.add("empty", nullptr, 0, true);
+	writer.finish();
+}
+
+} // namespace
+
+
+namespace unittest {
+
+TEST_CLASS(cg_data_pack_pack) {
+
+	TEST_METHOD(normalize_pack_path)
+	{
+		using cg::data::normalize_pack_path;
+
+		Assert::AreEqual(std::string("../../data/a.png"), normalize_pack_path("../../data/a.png"));
+		Assert::AreEqual(std::string("dir/sub/file.txt"), normalize_pack_path("./Dir\\Sub/FILE.txt"));
+		Assert::AreEqual(std::string(), normalize_pack_path(""));
+	}
+
+	TEST_METHOD(write_read)
+	{
+		const std::string text = make_compressible_text();
+		const std::vector<unsigned char> bytes = make_random_bytes(10000);
+		write_test_pack(text, bytes);
+
+		{
+			pack p(pack_filename);
+			Assert::AreEqual<size_t>(4, p.entry_count());
+
+			for (size_t i = 1; i < p.entry_count(); ++i)
+				Assert::IsTrue(p.entries()[i - 1].path_hash <= p.entries()[i].path_hash);
+
+			// compressed text
+			const pack_entry* e = p.find("DIR/text.txt");
+			Assert::IsNotNull(e);
+			Assert::IsTrue(e == p.find("dir\\text.txt"));
+			Assert::IsTrue(p.path(*e) == "dir/text.txt");
+			Assert::IsTrue(e->compression == pack_compression::lz);
+			Assert::IsTrue(e->stored_byte_count < e->byte_count);
+			Assert::IsTrue(p.read(*e).text() == text);
+
+			// random bytes are stored uncompressed and are not copied on read.
+			e = p.find("bytes.bin");
+			Assert::IsNotNull(e);
+			Assert::IsTrue(e->compression == pack_compression::none);
+			Assert::AreEqual<uint64_t>(0, e->offset % 64);
+			Assert::IsTrue(p.read(*e).bytes().data() == p.stored_bytes(*e).data());
+			Assert::IsTrue(p.read(*e).bytes() == std::basic_string_view<unsigned char>(bytes.data(), bytes.size()));
+
+			e = p.find("single_line.txt");
+			Assert::IsNotNull(e);
+			Assert::IsTrue(p.read(*e).text() == "abc123");
+
+			e = p.find("empty");
+			Assert::IsNotNull(e);
+			Assert::IsTrue(p.read(*e).bytes().empty());
+
+			Assert::IsNull(p.find("unknown-file"));
+			Assert::IsNull(p.find("text.txt"));
+		}
+
+		std::remove(pack_filename);
+	}
+
+	TEST_METHOD(write_duplicate_entry)
+	{
+		Assert::ExpectException<std::runtime_error>([] {
+			pack_writer writer(pack_filename);
+			writer.add("a.txt", "a", 1, false);
+			writer.add("A.txt", "b", 1, false);
+			writer.finish();
+		});
+
+		std::remove(pack_filename);
+	}
+
+	TEST_METHOD(invalid_pack)
+	{
+		Assert::ExpectException<std::runtime_error>([] { pack p(Filenames::empty_file); });
+		Assert::ExpectException<std::runtime_error>([] { pack p(Filenames::ascii_multiline); });
+	}
+};
+
+TEST_CLASS(cg_data_pack_Funcs) {
+
+	TEST_METHOD(mount_pack)
+	{
+		using cg::data::exists;
+		using cg::data::load_text;
+
+		const std::string text = make_compressible_text();
+		const std::vector<unsigned char> bytes = make_random_bytes(10000);
+		write_test_pack(text, bytes);
+
+		cg::data::mount_pack(pack_filename, "virtual/Data/");
+
+		Assert::IsTrue(cg::data::exists_in_packs("virtual/data/dir/text.txt"));
+		Assert::IsTrue(exists("virtual/data/dir/text.txt"));
+		Assert::IsTrue(exists("virtual\\data\\single_line.txt"));
+		Assert::IsFalse(exists("virtual/data/unknown-file"));
+		Assert::IsFalse(exists("dir/text.txt"));
+		// files which are not in the pack are still found on the disk.
+		Assert::IsTrue(exists(Filenames::ascii_single_line));
+
+		Assert::AreEqual(text, load_text("virtual/data/dir/text.txt"));
+		Assert::AreEqual(std::string("abc123"), load_text("virtual/data/single_line.txt"));
+		Assert::AreEqual(std::string("abc123"), load_text(Filenames::ascii_single_line));
+
+		{
+			Mapped_file mf("virtual/data/bytes.bin");
+			Assert::IsTrue(mf.is_open());
+			Assert::IsTrue(mf.bytes() == std::basic_string_view<unsigned char>(bytes.data(), bytes.size()));
+
+			Mapped_file me("virtual/data/empty");
+			Assert::IsTrue(me.is_open());
+			Assert::AreEqual<size_t>(0, me.byte_count());
+		}
+
+		{
+			File f("virtual/data/single_line.txt");
+			Assert::IsTrue(f.is_open());
+
+			char buffer[8] = {};
+			Assert::IsTrue(f.read_byte(buffer));
+			Assert::AreEqual('a', buffer[0]);
+			Assert::AreEqual<size_t>(5, f.read_bytes(buffer, 8));
+			Assert::IsTrue(f.eof());
+			Assert::IsTrue(std::string(buffer, 5) == "bc123");
+
+			f.seek(3, cg::data::File_seek_origin::file_start);
+			Assert::IsFalse(f.eof());
+			Assert::IsTrue(f.read_byte(buffer));
+			Assert::AreEqual('1', buffer[0]);
+		}
+
+		{
+			size_t line_count = 0;
+			for (By_line_iterator it("virtual/data/dir/text.txt"); it != By_line_iterator::end; ++it) {
+				if (line_count < 100) Assert::AreEqual("line " + std::to_string(line_count), *it);
+				++line_count;
+			}
+
+			Assert::IsTrue(line_count > 100);
+		}
+
+		cg::data::unmount_packs();
+		Assert::IsFalse(exists("virtual/data/dir/text.txt"));
+
+		std::remove(pack_filename);
+	}
+};
+
+} // namespace unittest
@@ -0,0 +1,127 @@
+#include "cg/data/spherical_harmonics.h"
+
+#include <cmath>
+#include <vector>
+#include "cg/base/math.h"
+#include "CppUnitTest.h"
+
+using cg::data::cube_direction;
+using cg::data::cube_face;
+using cg::data::cube_face_count;
+using cg::data::image_cube;
+using cg::data::image_view;
+using cg::data::pixel_format;
+using cg::data::sh9;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace {
+
+constexpr float pi_f = 3.14159265f;
+
+// Fills the cube with the radiance func(direction) in all the channels.
+template<typename Func>
+image_cube make_cube(uint32_t side_size, Func func)
+{
+	image_cube cube(side_size, pixel_format::rgb_32f);
+	for (size_t f = 0; f < cube_face_count; ++f) {
+		float* p = reinterpret_cast<float*>(cube.face_data(cube_face(f)));
+
+		for (uint32_t y = 0; y < side_size; ++y) {
+			for (uint32_t x = 0; x < side_size; ++x) {
+				const float3 d = cube_direction(cube_face(f), (x + 0.5f) / side_size, (y + 0.5f) / side_size);
+				const float v = func(d / std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z));
+				p[(y * side_size + x) * 3 + 0] = p[(y * side_size + x) * 3 + 1] = p[(y * side_size + x) * 3 + 2] = v;
+			}
+		}
+	}
+
+	return cube;
+}
+
+// Fills the rgb_32f panorama with the radiance func(direction) in all the channels.
+template<typename Func>
+std::vector<float> make_panorama(const uint2& size, Func func)
+{
+	std::vector<float> pixels(square(size) * 3);
+	for (size_t y = 0; y < size.y; ++y) {
+		const float theta = (y + 0.5f) / size.y * pi_f;
+
+		for (size_t x = 0; x < size.x; ++x) {
+			const float phi = ((x + 0.5f) / size.x - 0.5f) * 2.0f * pi_f;
+			const float3 d(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+			pixels[(y * size.x + x) * 3 + 0] = pixels[(y * size.x + x) * 3 + 1] = pixels[(y * size.x + x) * 3 + 2] = func(d);
+		}
+	}
+
+	return pixels;
+}
+
+} // namespace
+
+
+namespace unittest {
+
+TEST_CLASS(cg_data_spherical_harmonics_Funcs) {
+public:
+
+	TEST_METHOD(constant_radiance)
+	{
+		cg::thread_pool pool(2);
+		auto one = [](const float3&) { return 1.0f; };
+
+		const image_cube cube = make_cube(16, one);
+		const std::vector<float> panorama = make_panorama(uint2(64, 32), one);
+		const sh9 sh_cube = cg::data::project_sh9(cube, pool);
+		const sh9 sh_panorama = cg::data::project_sh9_equirect(
+			image_view(panorama.data(), uint2(64, 32), pixel_format::rgb_32f), pool);
+
+		for (const sh9& sh : { sh_cube, sh_panorama }) {
+			Assert::AreEqual(4.0f * pi_f * 0.282095f, sh.coefficients[0].x, 1e-3f);
+			Assert::AreEqual(4.0f * pi_f * 0.282095f, sh.coefficients[0].z, 1e-3f);
+			for (size_t i = 1; i < sh9::coefficient_count; ++i)
+				Assert::AreEqual(0.0f, sh.coefficients[i].y, 5e-3f);
+
+			// a surface lit by the unit radiance from all the directions receives pi irradiance.
+			const sh9 irradiance = cg::data::irradiance_sh9(sh);
+			Assert::AreEqual(pi_f, cg::data::evaluate_sh9(irradiance, float3::unit_y).x, 5e-3f);
+			Assert::AreEqual(pi_f, cg::data::evaluate_sh9(irradiance, -float3::unit_z).y, 5e-3f);
+		}
+	}
+
+	TEST_METHOD(linear_radiance)
+	{
+		cg::thread_pool pool(3);
+		// L(d) == d.y is exactly represented by the 1st band.
+		auto up = [](const float3& d) { return d.y; };
+
+		const image_cube cube = make_cube(32, up);
+		const std::vector<float> panorama = make_panorama(uint2(128, 64), up);
+		const sh9 sh_cube = cg::data::project_sh9(cube, pool);
+		const sh9 sh_panorama = cg::data::project_sh9_equirect(
+			image_view(panorama.data(), uint2(128, 64), pixel_format::rgb_32f), pool);
+
+		for (const sh9& sh : { sh_cube, sh_panorama }) {
+			Assert::AreEqual(0.0f, sh.coefficients[0].x, 1e-3f);
+			Assert::AreEqual(0.488603f * 4.0f * pi_f / 3.0f, sh.coefficients[1].x, 2e-3f);
+			Assert::AreEqual(0.0f, sh.coefficients[2].x, 1e-3f);
+			Assert::AreEqual(0.0f, sh.coefficients[3].x, 1e-3f);
+
+			Assert::AreEqual(1.0f, cg::data::evaluate_sh9(sh, float3::unit_y).x, 2e-3f);
+
+			// E(n) = 2 pi / 3 * n.y
+			const sh9 irradiance = cg::data::irradiance_sh9(sh);
+			Assert::AreEqual(2.0f * pi_f / 3.0f, cg::data::evaluate_sh9(irradiance, float3::unit_y).z, 5e-3f);
+			Assert::AreEqual(0.0f, cg::data::evaluate_sh9(irradiance, float3::unit_x).z, 5e-3f);
+		}
+
+		// the cube projected from the panorama has the same sh.
+		const image_cube projected = cg::data::equirect_to_cube(
+			image_view(panorama.data(), uint2(128, 64), pixel_format::rgb_32f), 32, pool);
+		const sh9 sh_projected = cg::data::project_sh9(projected, pool);
+		for (size_t i = 0; i < sh9::coefficient_count; ++i)
+			Assert::AreEqual(sh_cube.coefficients[i].x, sh_projected.coefficients[i].x, 1e-2f);
+	}
+};
+
+} // namespace unittest
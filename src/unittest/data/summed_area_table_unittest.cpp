@@ -0,0 +1,113 @@
+#include "cg/data/summed_area_table.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "cg/base/math.h"
+#include "CppUnitTest.h"
+
+using cg::data::image_2d;
+using cg::data::image_view;
+using cg::data::pixel_format;
+using cg::data::summed_area_table;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace unittest {
+
+TEST_CLASS(cg_data_summed_area_table) {
+public:
+
+	TEST_METHOD(ctors)
+	{
+		summed_area_table t0;
+		Assert::IsTrue(t0.size() == uint2::zero);
+		Assert::IsFalse(t0.has_squares());
+
+		cg::thread_pool pool(2);
+		const uint8_t pixels[6] = { 1, 2, 3, 4, 5, 6 };
+		summed_area_table t1(image_view(pixels, uint2(3, 2), pixel_format::red_8), pool, true);
+		Assert::IsTrue(t1.size() == uint2(3, 2));
+		Assert::IsTrue(t1.has_squares());
+
+		// move
+		summed_area_table t2 = std::move(t1);
+		Assert::IsTrue(t2.size() == uint2(3, 2));
+		Assert::IsTrue(t2.has_squares());
+	}
+
+	TEST_METHOD(sum_mean_variance)
+	{
+		cg::thread_pool pool(2);
+		const uint2 size(150, 70);
+		std::vector<float> pixels(square(size) * 4);
+		for (size_t i = 0; i < pixels.size(); ++i)
+			pixels[i] = float((i * 7919) % 257) / 256.0f;
+
+		const summed_area_table sat(image_view(pixels.data(), size, pixel_format::rgba_32f), pool, true);
+
+		const auto check = [&](const uint2& p0, const uint2& p1) {
+			double sum = 0.0;
+			double sum_sq = 0.0;
+			for (size_t y = p0.y; y <= p1.y; ++y) {
+				for (size_t x = p0.x; x <= p1.x; ++x) {
+					const double v = pixels[(y * size.x + x) * 4 + 1];
+					sum += v;
+					sum_sq += v * v;
+				}
+			}
+
+			const double count = double(p1.x - p0.x + 1) * (p1.y - p0.y + 1);
+			const double mean = sum / count;
+			Assert::AreEqual(float(sum), sat.sum(p0, p1).y, 1e-2f);
+			Assert::AreEqual(float(mean), sat.mean(p0, p1).y, 1e-5f);
+			Assert::AreEqual(float(sum_sq / count - mean * mean), sat.variance(p0, p1).y, 1e-5f);
+		};
+
+		check(uint2(0, 0), uint2(0, 0));
+		check(uint2(0, 0), uint2(149, 69));
+		check(uint2(3, 5), uint2(40, 9));
+		check(uint2(149, 69), uint2(149, 69));
+		check(uint2(70, 0), uint2(70, 69));
+
+		// p1 is clamped.
+		Assert::IsTrue(sat.sum(uint2(10, 10), uint2(1000, 1000)) == sat.sum(uint2(10, 10), uint2(149, 69)));
+
+		// constant rect
+		const uint8_t gray[16] = { 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9 };
+		const summed_area_table sat_gray(image_view(gray, uint2(4, 4), pixel_format::red_8), pool, true);
+		Assert::AreEqual(16 * 9 / 255.0f, sat_gray.sum(uint2(0, 0), uint2(3, 3)).x, 1e-5f);
+		Assert::AreEqual(9 / 255.0f, sat_gray.mean(uint2(1, 1), uint2(2, 3)).z, 1e-6f);
+		Assert::AreEqual(0.0f, sat_gray.variance(uint2(1, 1), uint2(2, 3)).x, 1e-6f);
+	}
+
+	TEST_METHOD(box_filter)
+	{
+		cg::thread_pool pool(2);
+		const uint2 size(9, 7);
+		std::vector<uint8_t> pixels(square(size));
+		for (size_t i = 0; i < pixels.size(); ++i)
+			pixels[i] = uint8_t(i * 3);
+
+		const summed_area_table sat(image_view(pixels.data(), size, pixel_format::red_8), pool);
+
+		// the edge pixel averages the pixels within the image only.
+		const float expected = (pixels[0] + pixels[1] + pixels[size.x] + pixels[size.x + 1]) / (4 * 255.0f);
+		Assert::AreEqual(expected, sat.box_mean(uint2(0, 0), 1).x, 1e-6f);
+
+		// huge radius averages the whole image.
+		Assert::IsTrue(approx_equal(sat.mean(uint2(0, 0), size - uint2(1, 1)), sat.box_mean(uint2(4, 3), 1000)));
+
+		const image_2d filtered = sat.box_filter(2, pixel_format::rgba_32f, pool);
+		Assert::IsTrue(filtered.size == size);
+		Assert::IsTrue(filtered.pixel_format == pixel_format::rgba_32f);
+		const float4* f = reinterpret_cast<const float4*>(filtered.data);
+		Assert::IsTrue(f[3 * size.x + 4] == sat.mean(uint2(2, 1), uint2(6, 5)));
+
+		const image_2d filtered_8 = sat.box_filter(0, pixel_format::red_8, pool);
+		Assert::IsTrue(filtered_8.pixel_format == pixel_format::red_8);
+		Assert::AreEqual(0, std::memcmp(pixels.data(), filtered_8.data, pixels.size()));
+	}
+};
+
+} // namespace unittest
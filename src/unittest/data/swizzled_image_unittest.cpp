@@ -0,0 +1,245 @@
+#include "cg/data/swizzled_image.h"
+
+#include <cmath>
+#include <vector>
+#include "cg/base/math.h"
+#include "unittest/data/common_file.h"
+
+using cg::data::image_cube;
+using cg::data::image_mip_chain;
+using cg::data::image_view;
+using cg::data::mip_content;
+using cg::data::mip_filter;
+using cg::data::pixel_format;
+using cg::data::sampler_desc;
+using cg::data::sampler_filter;
+using cg::data::sampler_wrap;
+using cg::data::swizzled_image;
+using cg::data::texture_data;
+
+
+namespace {
+
+// rgba_32f pixels, every channel has its own pattern.
+std::vector<float> make_pixels(const uint2& size)
+{
+	std::vector<float> pixels(square(size) * 4);
+	for (size_t y = 0; y < size.y; ++y) {
+		for (size_t x = 0; x < size.x; ++x) {
+			float* p = pixels.data() + (y * size.x + x) * 4;
+			p[0] = float(x);
+			p[1] = float(y);
+			p[2] = float((x * 7 + y * 13) % 17);
+			p[3] = 1.0f;
+		}
+	}
+
+	return pixels;
+}
+
+// Straightforward bilinear sampling of the row-major pixels. Returns the third channel.
+float reference_bilinear(const std::vector<float>& pixels, const uint2& size, sampler_wrap wrap, const float2& uv)
+{
+	const auto fetch = [&](float x, float y) {
+		const float w = float(size.x);
+		const float h = float(size.y);
+		if (wrap == sampler_wrap::repeat) {
+			x -= std::floor(x / w) * w;
+			y -= std::floor(y / h) * h;
+		}
+
+		x = std::min(std::max(x, 0.0f), w - 1.0f);
+		y = std::min(std::max(y, 0.0f), h - 1.0f);
+		return pixels[(size_t(y) * size.x + size_t(x)) * 4 + 2];
+	};
+
+	const float x = uv.x * size.x - 0.5f;
+	const float y = uv.y * size.y - 0.5f;
+	const float x0 = std::floor(x);
+	const float y0 = std::floor(y);
+	const float fx = x - x0;
+	const float fy = y - y0;
+	const float top = fetch(x0, y0) * (1.0f - fx) + fetch(x0 + 1.0f, y0) * fx;
+	const float bottom = fetch(x0, y0 + 1.0f) * (1.0f - fx) + fetch(x0 + 1.0f, y0 + 1.0f) * fx;
+	return top * (1.0f - fy) + bottom * fy;
+}
+
+} // namespace
+
+
+namespace unittest {
+
+TEST_CLASS(cg_data_swizzled_image_swizzled_image) {
+public:
+
+	TEST_METHOD(ctor_texel)
+	{
+		cg::thread_pool pool(2);
+		const uint2 size(19, 10);
+		const std::vector<float> pixels = make_pixels(size);
+
+		const swizzled_image image(image_view(pixels.data(), size, pixel_format::rgba_32f), pool);
+		Assert::AreEqual<size_t>(1, image.level_count());
+		Assert::AreEqual<size_t>(1, image.face_count());
+		Assert::IsFalse(image.is_cube());
+		Assert::IsTrue(image.size() == size);
+
+		for (uint32_t y = 0; y < size.y; ++y) {
+			for (uint32_t x = 0; x < size.x; ++x) {
+				const float4 t = image.texel(uint2(x, y));
+				Assert::AreEqual(float(x), t.x);
+				Assert::AreEqual(float(y), t.y);
+				Assert::AreEqual(pixels[(y * size.x + x) * 4 + 2], t.z);
+			}
+		}
+
+		// 8-bit pixels are converted.
+		const uint8_t red[] = { 0, 51, 255, 102 };
+		const swizzled_image red_image(image_view(red, uint2(2, 2), pixel_format::red_8), pool);
+		Assert::AreEqual(0.2f, red_image.texel(uint2(1, 0)).x, 1e-6f);
+		Assert::AreEqual(0.2f, red_image.texel(uint2(1, 0)).z, 1e-6f);
+		Assert::AreEqual(1.0f, red_image.texel(uint2(0, 1)).w);
+	}
+
+	TEST_METHOD(ctor_cube)
+	{
+		cg::thread_pool pool(2);
+		image_cube cube(4, pixel_format::red_8);
+		for (size_t f = 0; f < cg::data::cube_face_count; ++f) {
+			uint8_t* p = reinterpret_cast<uint8_t*>(cube.face_data(cg::data::cube_face(f)));
+			for (size_t i = 0; i < 16; ++i)
+				p[i] = uint8_t(f * 40 + i);
+		}
+
+		const swizzled_image image(cube, pool);
+		Assert::IsTrue(image.is_cube());
+		Assert::AreEqual<size_t>(6, image.face_count());
+		Assert::AreEqual(float(2 * 40 + 6) / 255.0f, image.texel(uint2(2, 1), 0, 2).x, 1e-6f);
+
+		// the centers of the faces.
+		const sampler_desc desc(sampler_filter::nearest, sampler_wrap::repeat);
+		Assert::AreEqual(float(0 * 40 + 10) / 255.0f, image.sample(desc, float3(1.0f, 0.0f, 0.0f)).x, 1e-6f);
+		Assert::AreEqual(float(3 * 40 + 10) / 255.0f, image.sample(desc, float3(0.0f, -2.0f, 0.0f)).x, 1e-6f);
+		Assert::AreEqual(float(5 * 40 + 10) / 255.0f, image.sample(desc, float3(0.0f, 0.0f, -0.5f)).x, 1e-6f);
+
+		// filtering does not cross the faces' edges: (-1, 1, 1) is the top left corner of +Z.
+		const sampler_desc bilinear(sampler_filter::bilinear, sampler_wrap::repeat);
+		Assert::AreEqual(float(4 * 40) / 255.0f, image.sample(bilinear, float3(-0.999f, 0.999f, 1.0f)).x, 1e-6f);
+	}
+
+	TEST_METHOD(ctor_texture_data)
+	{
+		// (level * 11 + i) % 256 is the i-th byte of the mip level.
+		cg::thread_pool pool(2);
+		const swizzled_image image(texture_data(Filenames::ktx2_rgb8_mips_3x2), pool);
+		Assert::AreEqual<size_t>(2, image.level_count());
+		Assert::IsTrue(image.size(0) == uint2(3, 2));
+		Assert::IsTrue(image.size(1) == uint2(1, 1));
+
+		const float4 t = image.texel(uint2(1, 1));
+		Assert::AreEqual(12.0f / 255.0f, t.x, 1e-6f);
+		Assert::AreEqual(14.0f / 255.0f, t.z, 1e-6f);
+		Assert::AreEqual(1.0f, t.w);
+		Assert::AreEqual(12.0f / 255.0f, image.texel(uint2(0, 0), 1).y, 1e-6f);
+	}
+
+	TEST_METHOD(sample)
+	{
+		cg::thread_pool pool(2);
+		const uint2 size(13, 9);
+		const std::vector<float> pixels = make_pixels(size);
+		const swizzled_image image(image_view(pixels.data(), size, pixel_format::rgba_32f), pool);
+
+		// nearest.
+		const sampler_desc nearest(sampler_filter::nearest, sampler_wrap::clamp);
+		Assert::AreEqual(3.0f, image.sample(nearest, float2(3.9f / 13.0f, 0.5f)).x);
+		Assert::AreEqual(0.0f, image.sample(nearest, float2(-0.5f, -0.5f)).x);
+		Assert::AreEqual(12.0f, image.sample(nearest, float2(1.5f, 0.5f)).x);
+		Assert::AreEqual(8.0f, image.sample(nearest, float2(0.5f, 7.0f)).y);
+
+		const sampler_desc nearest_repeat(sampler_filter::nearest, sampler_wrap::repeat, sampler_wrap::clamp);
+		Assert::AreEqual(12.0f, image.sample(nearest_repeat, float2(-0.5f / 13.0f, 0.5f)).x);
+		Assert::AreEqual(1.0f, image.sample(nearest_repeat, float2(2.0f + 1.5f / 13.0f, 0.5f)).x);
+		Assert::AreEqual(8.0f, image.sample(nearest_repeat, float2(0.5f, 7.0f)).y);
+
+		// bilinear.
+		const float2 uvs[] = {
+			float2(0.5f, 0.5f), float2(0.0f, 0.0f), float2(1.0f, 1.0f), float2(0.31f, 0.77f),
+			float2(-0.2f, 1.4f), float2(3.03f, -2.61f), float2(0.99f, 0.01f)
+		};
+
+		for (sampler_wrap wrap : { sampler_wrap::clamp, sampler_wrap::repeat }) {
+			const sampler_desc desc(sampler_filter::bilinear, wrap);
+			for (const float2& uv : uvs)
+				Assert::AreEqual(reference_bilinear(pixels, size, wrap, uv), image.sample(desc, uv).z, 1e-4f);
+		}
+	}
+
+	TEST_METHOD(sample_gather)
+	{
+		cg::thread_pool pool(2);
+		const uint2 size(37, 21);
+		const std::vector<float> pixels = make_pixels(size);
+		const image_mip_chain mip_chain(image_view(pixels.data(), size, pixel_format::rgba_32f),
+			mip_filter::box, mip_content::linear, pool);
+		const swizzled_image image(mip_chain, pool);
+
+		// 13 is not a multiple of 4, the last batch is partial.
+		std::vector<float2> uv(13);
+		for (size_t i = 0; i < uv.size(); ++i)
+			uv[i] = float2(float(i * 37 % 23) / 9.0f - 0.7f, float(i * 11 % 19) / 7.0f - 1.1f);
+
+		for (sampler_filter filter : { sampler_filter::nearest, sampler_filter::bilinear, sampler_filter::trilinear }) {
+			for (sampler_wrap wrap : { sampler_wrap::clamp, sampler_wrap::repeat }) {
+				for (float lod : { 0.0f, 0.4f, 1.5f, 2.75f, 9.0f }) {
+					const sampler_desc desc(filter, wrap);
+					std::vector<float4> dst(uv.size() + 1, float4(-1.0f));
+					image.sample(desc, uv.data(), uv.size(), dst.data(), lod);
+
+					for (size_t i = 0; i < uv.size(); ++i) {
+						const float4 expected = image.sample(desc, uv[i], lod);
+						Assert::AreEqual(expected.x, dst[i].x, 1e-5f);
+						Assert::AreEqual(expected.y, dst[i].y, 1e-5f);
+						Assert::AreEqual(expected.z, dst[i].z, 1e-5f);
+						Assert::AreEqual(expected.w, dst[i].w, 1e-5f);
+					}
+
+					// dst[13] is not written.
+					Assert::AreEqual(-1.0f, dst.back().x);
+				}
+			}
+		}
+	}
+
+	TEST_METHOD(sample_mip_levels)
+	{
+		cg::thread_pool pool(2);
+		const uint2 size(16, 8);
+		const std::vector<float> pixels = make_pixels(size);
+		const image_mip_chain mip_chain(image_view(pixels.data(), size, pixel_format::rgba_32f),
+			mip_filter::box, mip_content::linear, pool);
+		const swizzled_image image(mip_chain, pool);
+		Assert::AreEqual(mip_chain.level_count(), image.level_count());
+		Assert::IsTrue(image.size(1) == uint2(8, 4));
+		Assert::IsTrue(image.size(4) == uint2(1, 1));
+
+		// the average of the red channel of the whole image.
+		const sampler_desc bilinear(sampler_filter::bilinear, sampler_wrap::clamp);
+		Assert::AreEqual(7.5f, image.sample(bilinear, float2(0.3f, 0.6f), 4.0f).x, 1e-4f);
+		Assert::AreEqual(7.5f, image.sample(bilinear, float2(0.3f, 0.6f), 100.0f).x, 1e-4f);
+
+		// nearest & bilinear take the nearest level, trilinear interpolates.
+		const float2 uv(0.4f, 0.3f);
+		const float4 l1 = image.sample(bilinear, uv, 1.0f);
+		const float4 l2 = image.sample(bilinear, uv, 2.0f);
+		Assert::AreEqual(l1.x, image.sample(bilinear, uv, 1.4f).x);
+		Assert::AreEqual(l2.x, image.sample(bilinear, uv, 1.6f).x);
+
+		const sampler_desc trilinear(sampler_filter::trilinear, sampler_wrap::clamp);
+		Assert::AreEqual(l1.x, image.sample(trilinear, uv, 1.0f).x);
+		Assert::AreEqual(l1.x * 0.75f + l2.x * 0.25f, image.sample(trilinear, uv, 1.25f).x, 1e-4f);
+		Assert::AreEqual(l1.y * 0.5f + l2.y * 0.5f, image.sample(trilinear, uv, 1.5f).y, 1e-4f);
+	}
+};
+
+} // namespace unittest
@@ -0,0 +1,176 @@
+#include "cg/data/texture_atlas.h"
+
+#include <cstdint>
+#include <vector>
+#include "cg/base/math.h"
+#include "CppUnitTest.h"
+
+using cg::data::atlas_desc;
+using cg::data::atlas_entry;
+using cg::data::image_view;
+using cg::data::max_rects_packer;
+using cg::data::pixel_format;
+using cg::data::texture_atlas;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace {
+
+bool overlap(const uint2& p0, const uint2& s0, const uint2& p1, const uint2& s1) noexcept
+{
+	return (p0.x < p1.x + s1.x) && (p1.x < p0.x + s0.x) && (p0.y < p1.y + s1.y) && (p1.y < p0.y + s0.y);
+}
+
+// Returns the red_8 pixel of the page.
+uint8_t pixel(const texture_atlas& atlas, uint32_t page, uint32_t x, uint32_t y)
+{
+	const cg::data::image_2d& image = atlas.pages[page];
+	return reinterpret_cast<const uint8_t*>(image.data)[y * image.size.x + x];
+}
+
+} // namespace
+
+
+namespace unittest {
+
+TEST_CLASS(cg_data_texture_atlas_max_rects_packer) {
+public:
+
+	TEST_METHOD(insert)
+	{
+		max_rects_packer packer(uint2(8, 8));
+		Assert::AreEqual(0.0f, packer.occupancy());
+
+		const uint2 sizes[] = { uint2(4, 4), uint2(4, 4), uint2(8, 2), uint2(2, 2), uint2(2, 2) };
+		std::vector<uint2> positions;
+		for (const uint2& size : sizes) {
+			uint2 position;
+			Assert::IsTrue(packer.insert(size, position));
+			Assert::IsTrue(position.x + size.x <= 8 && position.y + size.y <= 8);
+
+			for (size_t i = 0; i < positions.size(); ++i)
+				Assert::IsFalse(overlap(position, size, positions[i], sizes[i]));
+
+			positions.push_back(position);
+		}
+
+		// 16 + 16 + 16 + 4 + 4 of 64.
+		Assert::AreEqual(56.0f / 64.0f, packer.occupancy());
+
+		// the small squares share a row, 4x2 pixels are left.
+		uint2 position;
+		Assert::IsFalse(packer.insert(uint2(4, 4), position));
+		Assert::IsTrue(packer.insert(uint2(4, 2), position));
+		Assert::IsFalse(packer.insert(uint2(1, 1), position));
+		Assert::AreEqual(1.0f, packer.occupancy());
+	}
+
+	TEST_METHOD(insert_many)
+	{
+		max_rects_packer packer(uint2(64, 64));
+		std::vector<uint2> positions;
+
+		// 64 squares of 8x8 fill the bin exactly.
+		for (size_t i = 0; i < 64; ++i) {
+			uint2 position;
+			Assert::IsTrue(packer.insert(uint2(8, 8), position));
+
+			for (size_t j = 0; j < positions.size(); ++j)
+				Assert::IsFalse(overlap(position, uint2(8, 8), positions[j], uint2(8, 8)));
+
+			positions.push_back(position);
+		}
+
+		Assert::AreEqual(1.0f, packer.occupancy());
+	}
+};
+
+TEST_CLASS(cg_data_texture_atlas_Funcs) {
+public:
+
+	TEST_METHOD(pack_atlas)
+	{
+		// 1x1 solid colours & a 2x3 image.
+		const uint8_t solid_0[] = { 10 };
+		const uint8_t solid_1[] = { 20 };
+		const uint8_t image_2x3[] = { 1, 2, 3, 4, 5, 6 };
+		const std::vector<image_view> images = {
+			image_view(solid_0, uint2(1, 1), pixel_format::red_8),
+			image_view(image_2x3, uint2(2, 3), pixel_format::red_8),
+			image_view(solid_1, uint2(1, 1), pixel_format::red_8),
+		};
+
+		atlas_desc desc;
+		desc.page_size = uint2(16, 16);
+		desc.padding = 1;
+		const texture_atlas atlas = cg::data::pack_atlas(images, pixel_format::red_8, desc);
+		Assert::AreEqual<size_t>(1, atlas.pages.size());
+		Assert::AreEqual<size_t>(3, atlas.entries.size());
+		Assert::IsTrue(atlas.pages[0].size == uint2(16, 16));
+
+		// the padded images do not overlap.
+		for (size_t i = 0; i < 3; ++i) {
+			const atlas_entry& ei = atlas.entries[i];
+			Assert::IsTrue(ei.size == images[i].size);
+			Assert::IsTrue(ei.position.x >= 1 && ei.position.y >= 1);
+
+			for (size_t j = i + 1; j < 3; ++j) {
+				const atlas_entry& ej = atlas.entries[j];
+				Assert::IsFalse(overlap(uint2(ei.position.x - 1, ei.position.y - 1), uint2(ei.size.x + 2, ei.size.y + 2),
+					uint2(ej.position.x - 1, ej.position.y - 1), uint2(ej.size.x + 2, ej.size.y + 2)));
+			}
+		}
+
+		// uv transforms.
+		const atlas_entry& e = atlas.entries[1];
+		Assert::AreEqual(2.0f / 16, e.uv_scale.x);
+		Assert::AreEqual(3.0f / 16, e.uv_scale.y);
+		Assert::AreEqual(e.position.x / 16.0f, e.uv_offset.x);
+		Assert::AreEqual(e.position.y / 16.0f, e.uv_offset.y);
+
+		// pixels & the repeated edges.
+		const uint32_t x = e.position.x;
+		const uint32_t y = e.position.y;
+		Assert::AreEqual<uint8_t>(1, pixel(atlas, 0, x, y));
+		Assert::AreEqual<uint8_t>(6, pixel(atlas, 0, x + 1, y + 2));
+		Assert::AreEqual<uint8_t>(1, pixel(atlas, 0, x - 1, y - 1));
+		Assert::AreEqual<uint8_t>(2, pixel(atlas, 0, x + 2, y - 1));
+		Assert::AreEqual<uint8_t>(5, pixel(atlas, 0, x - 1, y + 3));
+		Assert::AreEqual<uint8_t>(4, pixel(atlas, 0, x + 2, y + 1));
+
+		const atlas_entry& s = atlas.entries[2];
+		for (uint32_t dy = 0; dy < 3; ++dy) {
+			for (uint32_t dx = 0; dx < 3; ++dx)
+				Assert::AreEqual<uint8_t>(20, pixel(atlas, 0, s.position.x - 1 + dx, s.position.y - 1 + dy));
+		}
+	}
+
+	TEST_METHOD(pack_atlas_pages)
+	{
+		std::vector<float> rgb(3 * 3 * 3, 0.5f);
+		const std::vector<image_view> images(5, image_view(rgb.data(), uint2(3, 3), pixel_format::rgb_32f));
+
+		// a page holds 4 padded images.
+		atlas_desc desc;
+		desc.page_size = uint2(8, 8);
+		desc.padding = 0;
+		const texture_atlas atlas = cg::data::pack_atlas(images, pixel_format::rgb_8, desc);
+		Assert::AreEqual<size_t>(2, atlas.pages.size());
+		Assert::IsTrue(atlas.pages[1].pixel_format == pixel_format::rgb_8);
+		Assert::AreEqual(1u, atlas.entries[4].page);
+
+		// converted pixels.
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(atlas.pages[1].data);
+		const uint2 pos = atlas.entries[4].position;
+		Assert::AreEqual<uint8_t>(128, p[(pos.y * 8 + pos.x) * 3]);
+
+		desc.padding = 3;
+		Assert::ExpectException<std::runtime_error>([&] {
+			cg::data::pack_atlas(images, pixel_format::rgb_8, desc);
+		});
+
+		Assert::IsTrue(cg::data::pack_atlas({}, pixel_format::rgb_8, desc).pages.empty());
+	}
+};
+
+} // namespace unittest
@@ -0,0 +1,152 @@
+#include "cg/data/texture_data.h"
+
+#include <string>
+#include "cg/base/math.h"
+#include "cg/data/file.h"
+#include "unittest/data/common_file.h"
+
+using cg::data::image_view;
+using cg::data::Mapped_file;
+using cg::data::pixel_format;
+using cg::data::texture_data;
+
+
+namespace {
+
+// The test files store (face * 37 + level * 11 + i) % 256 as the i-th byte of the mip level of the face.
+bool check_level(const texture_data& tex_data, size_t level, size_t face)
+{
+	const image_view view = tex_data.level(level, face);
+	const uint8_t* p = reinterpret_cast<const uint8_t*>(view.data);
+
+	for (size_t i = 0; i < byte_count(view); ++i) {
+		if (p[i] != uint8_t(face * 37 + level * 11 + i)) return false;
+	}
+
+	return true;
+}
+
+} // namespace
+
+
+namespace unittest {
+
+TEST_CLASS(cg_data_texture_data_texture_data) {
+public:
+
+	TEST_METHOD(ctor_dds)
+	{
+		Assert::ExpectException<std::exception>([] { texture_data t("unknown_texture.dds"); });
+		Assert::ExpectException<std::exception>([] { texture_data t(Filenames::png_rgba_3x2); });
+
+		// legacy header, DXT1.
+		const texture_data bc1(Filenames::dds_bc1_mips_8x4);
+		Assert::AreEqual(pixel_format::bc1, bc1.format());
+		Assert::AreEqual(uint2(8, 4), bc1.size());
+		Assert::AreEqual<size_t>(4, bc1.level_count());
+		Assert::AreEqual<size_t>(1, bc1.face_count());
+		Assert::IsFalse(bc1.is_cube());
+		Assert::IsFalse(bc1.is_srgb());
+
+		Assert::AreEqual(uint2(8, 4), bc1.level(0).size);
+		Assert::AreEqual(uint2(4, 2), bc1.level(1).size);
+		Assert::AreEqual(uint2(2, 1), bc1.level(2).size);
+		Assert::AreEqual(uint2(1, 1), bc1.level(3).size);
+		Assert::AreEqual<size_t>(128, bc1.subresource(0).offset);
+		Assert::AreEqual<size_t>(16, bc1.subresource(0).byte_count);
+		Assert::AreEqual<size_t>(144, bc1.subresource(1).offset);
+		Assert::AreEqual<size_t>(8, bc1.subresource(3).byte_count);
+		Assert::AreEqual<size_t>(16, bc1.row_byte_count(0));
+		Assert::AreEqual<size_t>(8, bc1.row_byte_count(2));
+		for (size_t l = 0; l < 4; ++l)
+			Assert::IsTrue(check_level(bc1, l, 0));
+
+		// DX10 header, sRGB cube map.
+		const texture_data cube(Filenames::dds_rgba8_srgb_cube_4x4);
+		Assert::AreEqual(pixel_format::rgba_8, cube.format());
+		Assert::AreEqual(uint2(4, 4), cube.size());
+		Assert::AreEqual<size_t>(3, cube.level_count());
+		Assert::AreEqual<size_t>(6, cube.face_count());
+		Assert::IsTrue(cube.is_cube());
+		Assert::IsTrue(cube.is_srgb());
+		Assert::AreEqual<size_t>(16, cube.row_byte_count(0));
+		Assert::AreEqual<size_t>(4, cube.row_byte_count(2));
+
+		// the mip chains of the faces follow each other.
+		Assert::AreEqual<size_t>(148, cube.subresource(0, 0).offset);
+		Assert::AreEqual<size_t>(148 + 84, cube.subresource(0, 1).offset);
+		Assert::AreEqual<size_t>(148 + 84 + 64, cube.subresource(1, 1).offset);
+		for (size_t f = 0; f < 6; ++f) {
+			for (size_t l = 0; l < 3; ++l)
+				Assert::IsTrue(check_level(cube, l, f));
+		}
+	}
+
+	TEST_METHOD(ctor_ktx2)
+	{
+		const texture_data rgb(Filenames::ktx2_rgb8_mips_3x2);
+		Assert::AreEqual(pixel_format::rgb_8, rgb.format());
+		Assert::AreEqual(uint2(3, 2), rgb.size());
+		Assert::AreEqual<size_t>(2, rgb.level_count());
+		Assert::AreEqual<size_t>(1, rgb.face_count());
+		Assert::AreEqual(uint2(1, 1), rgb.level(1).size);
+		Assert::AreEqual<size_t>(9, rgb.row_byte_count(0));
+		Assert::IsTrue(check_level(rgb, 0, 0));
+		Assert::IsTrue(check_level(rgb, 1, 0));
+
+		// the faces of a mip level follow each other, the smallest level is stored first.
+		const texture_data cube(Filenames::ktx2_bc5_cube_8x8);
+		Assert::AreEqual(pixel_format::bc5, cube.format());
+		Assert::AreEqual<size_t>(2, cube.level_count());
+		Assert::AreEqual<size_t>(6, cube.face_count());
+		Assert::AreEqual<size_t>(64, cube.subresource(0, 0).byte_count);
+		Assert::AreEqual<size_t>(16, cube.subresource(1, 0).byte_count);
+		Assert::AreEqual(cube.subresource(0, 0).offset + 64, cube.subresource(0, 1).offset);
+		Assert::IsTrue(cube.subresource(1, 5).offset < cube.subresource(0, 0).offset);
+		for (size_t f = 0; f < 6; ++f) {
+			Assert::IsTrue(check_level(cube, 0, f));
+			Assert::IsTrue(check_level(cube, 1, f));
+		}
+	}
+
+	TEST_METHOD(ctor_mapped_file)
+	{
+		Mapped_file file(Filenames::ktx2_rgb8_mips_3x2);
+		const uint8_t* data = file.data();
+
+		const texture_data tex_data(std::move(file));
+		Assert::AreEqual<size_t>(2, tex_data.level_count());
+		// the pixels are not copied.
+		Assert::IsTrue(data + tex_data.subresource(0).offset == tex_data.level(0).data);
+	}
+
+	TEST_METHOD(ctor_move)
+	{
+		texture_data t0(Filenames::dds_bc1_mips_8x4);
+		const void* data = t0.level(1).data;
+
+		texture_data t1(std::move(t0));
+		Assert::AreEqual<size_t>(4, t1.level_count());
+		Assert::IsTrue(data == t1.level(1).data);
+	}
+};
+
+TEST_CLASS(cg_data_texture_data_Funcs) {
+public:
+
+	TEST_METHOD(is_dds_is_ktx2)
+	{
+		const Mapped_file dds(Filenames::dds_bc1_mips_8x4);
+		const Mapped_file ktx2(Filenames::ktx2_rgb8_mips_3x2);
+
+		Assert::IsTrue(cg::data::is_dds(dds.data(), dds.byte_count()));
+		Assert::IsFalse(cg::data::is_dds(ktx2.data(), ktx2.byte_count()));
+		Assert::IsFalse(cg::data::is_dds(dds.data(), 3));
+
+		Assert::IsTrue(cg::data::is_ktx2(ktx2.data(), ktx2.byte_count()));
+		Assert::IsFalse(cg::data::is_ktx2(dds.data(), dds.byte_count()));
+		Assert::IsFalse(cg::data::is_ktx2(nullptr, 0));
+	}
+};
+
+} // namespace unittest
@@ -0,0 +1,92 @@
+#include "cg/data/tiled_image.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include "cg/base/math.h"
+#include "CppUnitTest.h"
+
+using cg::data::cgimg_source;
+using cg::data::image_2d;
+using cg::data::image_view;
+using cg::data::pixel_format;
+using cg::data::tiled_image;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace unittest {
+
+TEST_CLASS(cg_data_tiled_image) {
+public:
+
+	TEST_METHOD(ctors)
+	{
+		const std::string filename = "tiled_image_unittest_ctors.cgimg";
+		const uint8_t pixels[5 * 3 * 3] = {};
+		cg::data::write_cgimg(filename, image_view(pixels, uint2(5, 3), pixel_format::rgb_8), cgimg_source());
+
+		{
+			tiled_image img(filename, 2, 100);
+			Assert::IsTrue(img.size() == uint2(5, 3));
+			Assert::IsTrue(img.format() == pixel_format::rgb_8);
+			Assert::AreEqual<uint32_t>(2, img.tile_size());
+			Assert::IsTrue(img.tile_count() == uint2(3, 2));
+			Assert::AreEqual<size_t>(0, img.resident_tile_count());
+			Assert::AreEqual<size_t>(0, img.resident_byte_count());
+		}
+
+		std::remove(filename.c_str());
+
+		Assert::ExpectException<std::runtime_error>([] { tiled_image img("unknown-file.cgimg"); });
+	}
+
+	TEST_METHOD(tiles_and_regions)
+	{
+		const std::string filename = "tiled_image_unittest.cgimg";
+		const uint2 size(37, 21);
+		std::vector<uint8_t> pixels(square(size) * 2);
+		for (size_t i = 0; i < pixels.size(); ++i) pixels[i] = uint8_t(i * 13);
+		cg::data::write_cgimg(filename, image_view(pixels.data(), size, pixel_format::rg_8), cgimg_source());
+
+		{
+			// every tile is 8 * 8 * 2 = 128 bytes, the budget holds 3 tiles.
+			tiled_image img(filename, 8, 3 * 128);
+
+			// the last tile is 5x5.
+			const auto last = img.tile(uint2(4, 2));
+			Assert::IsTrue(last->size == uint2(5, 5));
+			Assert::IsTrue(last->pixel_format == pixel_format::rg_8);
+			for (uint32_t y = 0; y < 5; ++y) {
+				const uint8_t* expected = pixels.data() + ((16 + y) * size.x + 32) * 2;
+				Assert::AreEqual(0, std::memcmp(expected, static_cast<const uint8_t*>(last->data) + y * 5 * 2, 10));
+			}
+
+			// the same tile is not loaded twice.
+			Assert::IsTrue(last == img.tile(uint2(4, 2)));
+			Assert::AreEqual<size_t>(1, img.resident_tile_count());
+
+			// a region which spans 4 tiles.
+			const image_2d region = img.read_region(uint2(5, 6), uint2(10, 7));
+			Assert::IsTrue(region.size == uint2(10, 7));
+			for (uint32_t y = 0; y < 7; ++y) {
+				const uint8_t* expected = pixels.data() + ((6 + y) * size.x + 5) * 2;
+				Assert::AreEqual(0, std::memcmp(expected, static_cast<const uint8_t*>(region.data) + y * 10 * 2, 20));
+			}
+
+			// the least recently used tiles are evicted, the held tile stays valid.
+			Assert::AreEqual<size_t>(3, img.resident_tile_count());
+			Assert::IsTrue(img.resident_byte_count() <= 3 * 128);
+			Assert::AreEqual(pixels[(16 * size.x + 32) * 2], static_cast<const uint8_t*>(last->data)[0]);
+
+			// the whole image.
+			const image_2d whole = img.read_region(uint2::zero, size);
+			Assert::AreEqual(0, std::memcmp(pixels.data(), whole.data, pixels.size()));
+		}
+
+		std::remove(filename.c_str());
+	}
+};
+
+} // namespace unittest
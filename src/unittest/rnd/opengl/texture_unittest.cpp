@@ -71,6 +71,12 @@ public:
 		Assert::AreEqual<GLenum>(GL_RG, texture_sub_image_format(pixel_format::rg_8));
 		Assert::AreEqual<GLenum>(GL_RGB, texture_sub_image_format(pixel_format::rgb_8));
 		Assert::AreEqual<GLenum>(GL_RGBA, texture_sub_image_format(pixel_format::rgba_8));
+		Assert::AreEqual<GLenum>(GL_RGB, texture_sub_image_format(pixel_format::rgb_32f));
+		Assert::AreEqual<GLenum>(GL_RGBA, texture_sub_image_format(pixel_format::rgba_32f));
+		Assert::AreEqual<GLenum>(GL_RGB, texture_sub_image_format(pixel_format::rgb_16f));
+		Assert::AreEqual<GLenum>(GL_RGBA, texture_sub_image_format(pixel_format::rgba_16f));
+		Assert::AreEqual<GLenum>(GL_RG, texture_sub_image_format(pixel_format::rg_32f));
+		Assert::AreEqual<GLenum>(GL_RG, texture_sub_image_format(pixel_format::rg_16f));
 
 		Assert::AreEqual<GLenum>(GL_NONE, texture_sub_image_format(GL_RED));
 		Assert::AreEqual<GLenum>(GL_NONE, texture_sub_image_format(GL_TEXTURE_2D));
@@ -82,6 +88,9 @@ public:
 		Assert::AreEqual<GLenum>(GL_RGB, texture_sub_image_format(GL_RGB32F));
 		Assert::AreEqual<GLenum>(GL_RGBA, texture_sub_image_format(GL_RGBA8));
 		Assert::AreEqual<GLenum>(GL_RGBA, texture_sub_image_format(GL_RGBA32F));
+		Assert::AreEqual<GLenum>(GL_RGB, texture_sub_image_format(GL_RGB16F));
+		Assert::AreEqual<GLenum>(GL_RGBA, texture_sub_image_format(GL_RGBA16F));
+		Assert::AreEqual<GLenum>(GL_RG, texture_sub_image_format(GL_RG16F));
 		Assert::AreEqual<GLenum>(GL_DEPTH_COMPONENT, texture_sub_image_format(GL_DEPTH_COMPONENT24));
 		Assert::AreEqual<GLenum>(GL_DEPTH_COMPONENT, texture_sub_image_format(GL_DEPTH_COMPONENT32));
 		Assert::AreEqual<GLenum>(GL_DEPTH_COMPONENT, texture_sub_image_format(GL_DEPTH_COMPONENT32F));
@@ -98,6 +107,12 @@ public:
 		Assert::AreEqual<GLenum>(GL_UNSIGNED_BYTE, texture_sub_image_type(pixel_format::rg_8));
 		Assert::AreEqual<GLenum>(GL_UNSIGNED_BYTE, texture_sub_image_type(pixel_format::rgb_8));
 		Assert::AreEqual<GLenum>(GL_UNSIGNED_BYTE, texture_sub_image_type(pixel_format::rgba_8));
+		Assert::AreEqual<GLenum>(GL_FLOAT, texture_sub_image_type(pixel_format::rgb_32f));
+		Assert::AreEqual<GLenum>(GL_FLOAT, texture_sub_image_type(pixel_format::rgba_32f));
+		Assert::AreEqual<GLenum>(GL_HALF_FLOAT, texture_sub_image_type(pixel_format::rgb_16f));
+		Assert::AreEqual<GLenum>(GL_HALF_FLOAT, texture_sub_image_type(pixel_format::rgba_16f));
+		Assert::AreEqual<GLenum>(GL_FLOAT, texture_sub_image_type(pixel_format::rg_32f));
+		Assert::AreEqual<GLenum>(GL_HALF_FLOAT, texture_sub_image_type(pixel_format::rg_16f));
 
 		Assert::AreEqual<GLenum>(GL_NONE, texture_sub_image_type(GL_RED));
 		Assert::AreEqual<GLenum>(GL_NONE, texture_sub_image_type(GL_TEXTURE_2D));
@@ -109,6 +124,9 @@ public:
 		Assert::AreEqual<GLenum>(GL_FLOAT, texture_sub_image_type(GL_RGB32F));
 		Assert::AreEqual<GLenum>(GL_UNSIGNED_BYTE, texture_sub_image_type(GL_RGBA8));
 		Assert::AreEqual<GLenum>(GL_FLOAT, texture_sub_image_type(GL_RGBA32F));
+		Assert::AreEqual<GLenum>(GL_HALF_FLOAT, texture_sub_image_type(GL_RGB16F));
+		Assert::AreEqual<GLenum>(GL_HALF_FLOAT, texture_sub_image_type(GL_RGBA16F));
+		Assert::AreEqual<GLenum>(GL_HALF_FLOAT, texture_sub_image_type(GL_RG16F));
 		Assert::AreEqual<GLenum>(GL_UNSIGNED_INT, texture_sub_image_type(GL_DEPTH_COMPONENT24));
 		Assert::AreEqual<GLenum>(GL_UNSIGNED_INT, texture_sub_image_type(GL_DEPTH_COMPONENT32));
 		Assert::AreEqual<GLenum>(GL_FLOAT, texture_sub_image_type(GL_DEPTH_COMPONENT32F));
@@ -116,6 +134,25 @@ public:
 		Assert::AreEqual<GLenum>(GL_FLOAT_32_UNSIGNED_INT_24_8_REV, texture_sub_image_type(GL_DEPTH32F_STENCIL8));
 	}
 
+	TEST_METHOD(compressed_texture_internal_format)
+	{
+		using cg::rnd::opengl::compressed_texture_internal_format;
+		using cg::rnd::opengl::is_valid_texture_internal_format;
+
+		Assert::AreEqual<GLenum>(GL_COMPRESSED_RGB_S3TC_DXT1_EXT, compressed_texture_internal_format(pixel_format::bc1));
+		Assert::AreEqual<GLenum>(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, compressed_texture_internal_format(pixel_format::bc3));
+		Assert::AreEqual<GLenum>(GL_COMPRESSED_RED_RGTC1, compressed_texture_internal_format(pixel_format::bc4));
+		Assert::AreEqual<GLenum>(GL_COMPRESSED_RG_RGTC2, compressed_texture_internal_format(pixel_format::bc5));
+
+		Assert::AreEqual<GLenum>(GL_NONE, compressed_texture_internal_format(pixel_format::none));
+		Assert::AreEqual<GLenum>(GL_NONE, compressed_texture_internal_format(pixel_format::rgba_8));
+		Assert::AreEqual<GLenum>(GL_NONE, compressed_texture_internal_format(pixel_format::rgba_32f));
+
+		// textures are created with the returned formats.
+		for (pixel_format fmt : { pixel_format::bc1, pixel_format::bc3, pixel_format::bc4, pixel_format::bc5 })
+			Assert::IsTrue(is_valid_texture_internal_format(compressed_texture_internal_format(fmt)));
+	}
+
 	TEST_METHOD(is_valid_texture_internal_format)
 	{
 		using cg::rnd::opengl::is_valid_texture_internal_format;
@@ -123,6 +160,7 @@ public:
 		Assert::IsTrue(is_valid_texture_internal_format(GL_R8));
 		Assert::IsTrue(is_valid_texture_internal_format(GL_R32F));
 		Assert::IsTrue(is_valid_texture_internal_format(GL_RG8));
+		Assert::IsTrue(is_valid_texture_internal_format(GL_RG16F));
 		Assert::IsTrue(is_valid_texture_internal_format(GL_RG32F));
 		Assert::IsTrue(is_valid_texture_internal_format(GL_RGB8));
 		Assert::IsTrue(is_valid_texture_internal_format(GL_RGB32F));
@@ -133,6 +171,10 @@ public:
 		Assert::IsTrue(is_valid_texture_internal_format(GL_DEPTH32F_STENCIL8));
 		Assert::IsTrue(is_valid_texture_internal_format(GL_DEPTH_COMPONENT32));
 		Assert::IsTrue(is_valid_texture_internal_format(GL_DEPTH_COMPONENT32F));
+		Assert::IsTrue(is_valid_texture_internal_format(GL_COMPRESSED_RGB_S3TC_DXT1_EXT));
+		Assert::IsTrue(is_valid_texture_internal_format(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT));
+		Assert::IsTrue(is_valid_texture_internal_format(GL_COMPRESSED_RED_RGTC1));
+		Assert::IsTrue(is_valid_texture_internal_format(GL_COMPRESSED_RG_RGTC2));
 
 		Assert::IsFalse(is_valid_texture_internal_format(GL_NONE));
 		Assert::IsFalse(is_valid_texture_internal_format(GL_RED));